@@ -30,6 +30,7 @@
  */
 
 import XCTest
+import AppKit
 import AJRFoundation
 @testable import AJRInterfaceFoundation
 
@@ -86,6 +87,44 @@ class AJRBezierPathTests: XCTestCase {
         }
     }
 
+    func testFlattenedEnumeration() throws {
+        let path = AJRBezierPath(ovalIn: CGRect(x: -10, y: -10, width: 20, height: 20))
+        var lastPoint : CGPoint? = nil
+        var subpaths = 0
+
+        path.enumerateFlattenedPath { (line, isNewSubpath, stop) in
+            if isNewSubpath {
+                subpaths += 1
+            } else if let lastPoint {
+                XCTAssertEqual(line.start, lastPoint)
+            }
+            XCTAssertEqual(hypot(line.end.x, line.end.y), 10.0, accuracy: 0.1)
+            lastPoint = line.end
+        }
+        XCTAssertEqual(subpaths, 1)
+    }
+
+    func testQuadraticFlattening() throws {
+        let path = AJRBezierPath()
+
+        path.move(to: CGPoint(x: 0, y: 0))
+        path.curve(to: CGPoint(x: 20, y: 0), controlPoint: CGPoint(x: 10, y: 10))
+
+        let enumerator = path.pathEnumerator
+        var segments = 0
+        var lastPoint = CGPoint.zero
+        while let line = enumerator.nextLineSegment() {
+            XCTAssertEqual(line.pointee.start, lastPoint)
+            // The curve is y = x - x^2 / 20, whose peak is 5.0.
+            let x = line.pointee.end.x
+            XCTAssertEqual(line.pointee.end.y, x - x * x / 20.0, accuracy: 0.000001)
+            lastPoint = line.pointee.end
+            segments += 1
+        }
+        XCTAssertGreaterThan(segments, 1)
+        XCTAssertEqual(lastPoint, CGPoint(x: 20, y: 0))
+    }
+
     func testBounds() throws {
         let path = AJRBezierPath()
         let frame = CGRect(x: 360.0, y: 180.0, width: 68, height: 90)
@@ -101,4 +140,959 @@ class AJRBezierPathTests: XCTestCase {
         print("bounds: \(path.bounds)")
     }
 
+    func testExactBounds() throws {
+        let oval = AJRBezierPath(ovalIn: CGRect(x: 10, y: 20, width: 30, height: 40))
+        let bounds = oval.bounds
+        XCTAssertEqual(bounds.minX, 10, accuracy: 0.0001)
+        XCTAssertEqual(bounds.minY, 20, accuracy: 0.0001)
+        XCTAssertEqual(bounds.maxX, 40, accuracy: 0.0001)
+        XCTAssertEqual(bounds.maxY, 60, accuracy: 0.0001)
+
+        // Once bounds are valid, appending keeps them current rather than recomputing them.
+        let path = AJRBezierPath()
+        path.move(to: CGPoint(x: 0, y: 0))
+        path.line(to: CGPoint(x: 10, y: 0))
+        XCTAssertEqual(path.bounds, CGRect(x: 0, y: 0, width: 10, height: 0))
+        path.curve(to: CGPoint(x: 10, y: 10), controlPoint1: CGPoint(x: 20, y: 0), controlPoint2: CGPoint(x: 20, y: 10))
+        path.move(to: CGPoint(x: 100, y: 100))
+        XCTAssertEqual(path.bounds.minX, 0, accuracy: 0.0001)
+        XCTAssertEqual(path.bounds.maxX, 17.5, accuracy: 0.0001)
+        XCTAssertEqual(path.bounds.maxY, 10, accuracy: 0.0001)
+        path.close()
+        XCTAssertEqual(path.bounds, (path.copy() as! AJRBezierPath).bounds)
+    }
+
+    func testHitTesting() throws {
+        let path = AJRBezierPath()
+
+        path.appendOval(in: CGRect(x: -10, y: -10, width: 20, height: 20))
+        path.appendRect(CGRect(x: -5, y: -5, width: 10, height: 10))
+
+        path.windingRule = .nonZero
+        XCTAssert(path.isHit(by: CGPoint(x: 0, y: 0)))
+        XCTAssert(path.isHit(by: CGPoint(x: 9, y: 0)))
+        XCTAssert(!path.isHit(by: CGPoint(x: 8, y: 8)))
+        XCTAssert(!path.isHit(by: CGPoint(x: 20, y: 0)))
+
+        path.windingRule = .evenOdd
+        XCTAssert(!path.isHit(by: CGPoint(x: 0, y: 0)))
+        XCTAssert(path.isHit(by: CGPoint(x: 9, y: 0)))
+
+        path.lineWidth = 2.0
+        XCTAssert(path.isStrokeHit(by: CGPoint(x: 10.5, y: 0)))
+        XCTAssert(path.isStrokeHit(by: CGPoint(x: 0, y: -9.5)))
+        XCTAssert(!path.isStrokeHit(by: CGPoint(x: 0, y: 0)))
+        XCTAssert(!path.isStrokeHit(by: CGPoint(x: 7.5, y: 0)))
+    }
+
+    func testHitTestingAfterMutation() throws {
+        let path = AJRBezierPath()
+
+        path.appendRect(CGRect(x: 0, y: 0, width: 10, height: 10))
+        XCTAssert(path.isHit(by: CGPoint(x: 5, y: 5)))
+        XCTAssert(!path.isHit(by: CGPoint(x: 25, y: 5)))
+
+        // The first queries cached the path's segments, so make sure changing the path throws them away.
+        path.appendRect(CGRect(x: 20, y: 0, width: 10, height: 10))
+        XCTAssert(path.isHit(by: CGPoint(x: 25, y: 5)))
+
+        path.transform(using: AffineTransform(translationByX: 100, byY: 0))
+        XCTAssert(!path.isHit(by: CGPoint(x: 5, y: 5)))
+        XCTAssert(path.isHit(by: CGPoint(x: 105, y: 5)))
+
+        path.removeAllPoints()
+        XCTAssert(!path.isHit(by: CGPoint(x: 105, y: 5)))
+    }
+
+    func testBooleanOperations() throws {
+        let square = AJRBezierPath(rect: CGRect(x: 0, y: 0, width: 10, height: 10))
+        let circle = AJRBezierPath(ovalIn: CGRect(x: 5, y: 5, width: 10, height: 10))
+
+        let union = square.unioning(with: circle)
+        XCTAssertEqual(union.bounds.minX, 0.0, accuracy: 0.001)
+        XCTAssertEqual(union.bounds.maxX, 15.0, accuracy: 0.001)
+        XCTAssert(union.isHit(by: CGPoint(x: 1, y: 1)))
+        XCTAssert(union.isHit(by: CGPoint(x: 14, y: 10)))
+        XCTAssert(!union.isHit(by: CGPoint(x: 14, y: 14)))
+
+        let intersection = square.intersecting(with: circle)
+        XCTAssertEqual(intersection.bounds.minX, 5.0, accuracy: 0.001)
+        XCTAssertEqual(intersection.bounds.maxX, 10.0, accuracy: 0.001)
+        XCTAssert(intersection.isHit(by: CGPoint(x: 8, y: 8)))
+        XCTAssert(!intersection.isHit(by: CGPoint(x: 2, y: 2)))
+
+        let difference = square.subtracting(with: circle)
+        XCTAssert(difference.isHit(by: CGPoint(x: 2, y: 2)))
+        XCTAssert(!difference.isHit(by: CGPoint(x: 8, y: 8)))
+        // Exclusively intersecting has always subtracted, unlike the symmetric difference, which keeps both sides.
+        let exclusive = square.exclusivelyIntersecting(with: circle)
+        XCTAssert(exclusive.isHit(by: CGPoint(x: 2, y: 2)))
+        XCTAssert(!exclusive.isHit(by: CGPoint(x: 8, y: 8)))
+        XCTAssert(!exclusive.isHit(by: CGPoint(x: 14, y: 10)))
+        let symmetric = AJRBezierPathBySymmetricDifferenceOfPaths([square, circle]) as! AJRBezierPath
+        XCTAssert(symmetric.isHit(by: CGPoint(x: 2, y: 2)))
+        XCTAssert(!symmetric.isHit(by: CGPoint(x: 8, y: 8)))
+        XCTAssert(symmetric.isHit(by: CGPoint(x: 14, y: 10)))
+
+        // Shapes that share an edge should merge into one.
+        let right = AJRBezierPath(rect: CGRect(x: 10, y: 0, width: 10, height: 10))
+        let merged = square.unioning(with: right)
+        XCTAssertEqual(merged.bounds, CGRect(x: 0, y: 0, width: 20, height: 10))
+        XCTAssert(merged.isHit(by: CGPoint(x: 10, y: 5)))
+    }
+
+    func testUnioningManyPaths() throws {
+        var paths = [AJRBezierPath]()
+
+        // Two separate grids of overlapping squares, plus a square inside the first grid.
+        for row in 0 ..< 8 {
+            for column in 0 ..< 8 {
+                paths.append(AJRBezierPath(rect: CGRect(x: CGFloat(column) * 8.0, y: CGFloat(row) * 8.0, width: 10, height: 10)))
+                paths.append(AJRBezierPath(rect: CGRect(x: 200.0 + CGFloat(column) * 8.0, y: CGFloat(row) * 8.0, width: 10, height: 10)))
+            }
+        }
+        paths.append(AJRBezierPath(rect: CGRect(x: 2, y: 2, width: 4, height: 4)))
+
+        let union = AJRBezierPathByUnioningPaths(paths) as! AJRBezierPath
+        XCTAssertEqual(union.bounds, CGRect(x: 0, y: 0, width: 266, height: 66))
+        XCTAssert(union.isHit(by: CGPoint(x: 33, y: 33)))
+        XCTAssert(union.isHit(by: CGPoint(x: 233, y: 33)))
+        XCTAssert(!union.isHit(by: CGPoint(x: 100, y: 33)))
+        XCTAssert(!union.isHit(by: CGPoint(x: 70, y: 70)))
+
+        // Squares that are all apart from one another each form their own cluster.
+        let apart = AJRBezierPathByUnioningManyPaths((0 ..< 40).map { AJRBezierPath(rect: CGRect(x: CGFloat($0) * 20.0, y: 0, width: 10, height: 10)) }) as! AJRBezierPath
+        XCTAssert(apart.isHit(by: CGPoint(x: 5, y: 5)))
+        XCTAssert(!apart.isHit(by: CGPoint(x: 15, y: 5)))
+        XCTAssert(apart.isHit(by: CGPoint(x: 785, y: 5)))
+    }
+
+    func testStrokeBounds() throws {
+        let square = AJRBezierPath(rect: CGRect(x: 0, y: 0, width: 10, height: 10))
+        square.lineWidth = 2.0
+        XCTAssertEqual(square.strokeBounds, CGRect(x: -1, y: -1, width: 12, height: 12))
+
+        let line = AJRBezierPath()
+        line.move(to: CGPoint(x: 0, y: 0))
+        line.line(to: CGPoint(x: 10, y: 0))
+        line.lineWidth = 2.0
+        line.lineCapStyle = .butt
+        XCTAssertEqual(line.strokeBounds, CGRect(x: 0, y: -1, width: 10, height: 2))
+        line.lineCapStyle = .square
+        XCTAssertEqual(line.strokeBounds, CGRect(x: -1, y: -1, width: 12, height: 2))
+
+        // Queries on a path that isn't changing may run on any number of threads at once.
+        let circle = AJRBezierPath(ovalIn: CGRect(x: 0, y: 0, width: 100, height: 100))
+        circle.lineWidth = 4.0
+        let expected = circle.strokeBounds
+        DispatchQueue.concurrentPerform(iterations: 64) { _ in
+            let copy = circle.copy() as! AJRBezierPath
+            XCTAssertEqual(copy.strokeBounds, expected)
+            XCTAssert(circle.isHit(by: CGPoint(x: 50, y: 50)))
+            XCTAssert(circle.isStrokeHit(by: CGPoint(x: 0, y: 50)))
+            XCTAssert(circle.bezierPathFromStrokedPath.isHit(by: CGPoint(x: 1, y: 50)))
+        }
+        XCTAssertEqual(expected.minX, -2.0, accuracy: 0.001)
+        XCTAssertEqual(expected.maxY, 102.0, accuracy: 0.001)
+    }
+
+    func testCopyOnWrite() throws {
+        let original = AJRBezierPath(rect: CGRect(x: 0, y: 0, width: 10, height: 10))
+        let copy = original.copy() as! AJRBezierPath
+
+        // Changing either path mustn't show through in the other.
+        original.setPointAt(0, to: CGPoint(x: -5, y: -5))
+        XCTAssertEqual(original.point(at: 0), CGPoint(x: -5, y: -5))
+        XCTAssertEqual(copy.point(at: 0), CGPoint(x: 0, y: 0))
+
+        copy.transform(using: AffineTransform(translationByX: 100, byY: 0))
+        XCTAssertEqual(copy.bounds, CGRect(x: 100, y: 0, width: 10, height: 10))
+        XCTAssertEqual(original.point(at: 0), CGPoint(x: -5, y: -5))
+
+        // An empty path takes on the storage of the first path appended to it.
+        let appended = AJRBezierPath()
+        appended.append(copy)
+        appended.line(to: CGPoint(x: 200, y: 200))
+        XCTAssertEqual(appended.elementCount, copy.elementCount + 1)
+        XCTAssertEqual(copy.bounds, CGRect(x: 100, y: 0, width: 10, height: 10))
+
+        appended.removeAllPoints()
+        XCTAssert(appended.isEmpty)
+        XCTAssertEqual(copy.bounds, CGRect(x: 100, y: 0, width: 10, height: 10))
+    }
+
+    func testBinaryRepresentation() throws {
+        let path = AJRBezierPath()
+        path.move(to: CGPoint(x: 0, y: 0))
+        path.line(to: CGPoint(x: 10, y: 0))
+        path.curve(to: CGPoint(x: 10, y: 10), controlPoint1: CGPoint(x: 20, y: 0), controlPoint2: CGPoint(x: 20, y: 10))
+        path.curve(to: CGPoint(x: 0, y: 10), controlPoint: CGPoint(x: 5, y: 15))
+        path.close()
+        path.move(to: CGPoint(x: 2, y: 2))
+        path.line(to: CGPoint(x: 4, y: 4))
+        path.lineWidth = 3.0
+        path.lineCapStyle = .square
+
+        let data = path.binaryRepresentation
+        let loaded = try XCTUnwrap(AJRBezierPath(binaryRepresentation: data))
+        XCTAssert(path.isEqual(loaded))
+        XCTAssertEqual(loaded.bounds, path.bounds)
+        XCTAssertEqual(loaded.strokeBounds, path.strokeBounds)
+
+        // The loaded path may be using data's points directly, so changing it mustn't touch data.
+        loaded.line(to: CGPoint(x: 50, y: 50))
+        loaded.setPointAt(0, to: CGPoint(x: -1, y: -1))
+        XCTAssert(path.isEqual(AJRBezierPath(binaryRepresentation: data)))
+
+        // Keyed archives use the binary representation too.
+        let archive = try NSKeyedArchiver.archivedData(withRootObject: path, requiringSecureCoding: false)
+        let unarchived = try XCTUnwrap(NSKeyedUnarchiver.unarchiveObject(with: archive) as? AJRBezierPath)
+        XCTAssert(path.isEqual(unarchived))
+
+        // Malformed data is refused rather than trusted.
+        XCTAssertNil(AJRBezierPath(binaryRepresentation: data.prefix(40)))
+        XCTAssertNil(AJRBezierPath(binaryRepresentation: data.prefix(data.count - 8)))
+        var corrupt = data
+        corrupt[48] = 42
+        XCTAssertNil(AJRBezierPath(binaryRepresentation: corrupt))
+        // Winding rule, cap and join styles out of range.
+        for offset in 16 ... 18 {
+            corrupt = data
+            corrupt[offset] = 9
+            XCTAssertNil(AJRBezierPath(binaryRepresentation: corrupt))
+        }
+        // Line width, miter limit and flatness that aren't finite and non-negative.
+        for offset in [24, 32, 40] {
+            for value in [Double.nan, Double.infinity, -1.0] {
+                corrupt = data
+                withUnsafeBytes(of: value.bitPattern.littleEndian) { corrupt.replaceSubrange(offset ..< offset + 8, with: $0) }
+                XCTAssertNil(AJRBezierPath(binaryRepresentation: corrupt))
+            }
+        }
+        // Elements that need a current point before any move to. Each keeps the point count the same, so only the missing move to is wrong.
+        corrupt = data
+        corrupt[48] = UInt8(AJRBezierPathElement.lineTo.rawValue)
+        XCTAssertNil(AJRBezierPath(binaryRepresentation: corrupt))
+        corrupt = data
+        corrupt[48] = UInt8(AJRBezierPathElement.close.rawValue)
+        corrupt[49] = UInt8(AJRBezierPathElement.quadraticCurveTo.rawValue)
+        XCTAssertNil(AJRBezierPath(binaryRepresentation: corrupt))
+        corrupt = data
+        corrupt[48] = UInt8(AJRBezierPathElement.close.rawValue)
+        corrupt[49] = UInt8(AJRBezierPathElement.cubicCurveTo.rawValue)
+        corrupt[50] = UInt8(AJRBezierPathElement.quadraticCurveTo.rawValue)
+        XCTAssertNil(AJRBezierPath(binaryRepresentation: corrupt))
+    }
+
+    func testBulkAppend() throws {
+        let expected = AJRBezierPath()
+        expected.move(to: CGPoint(x: 0, y: 0))
+        expected.line(to: CGPoint(x: 10, y: 0))
+        expected.curve(to: CGPoint(x: 10, y: 10), controlPoint1: CGPoint(x: 20, y: 0), controlPoint2: CGPoint(x: 20, y: 10))
+        expected.close()
+        expected.line(to: CGPoint(x: -5, y: 5))
+        expected.move(to: CGPoint(x: 2, y: 2))
+        expected.curve(to: CGPoint(x: 4, y: 2), controlPoint: CGPoint(x: 3, y: 30))
+
+        let elements: [AJRBezierPathElement] = [.moveTo, .lineTo, .cubicCurveTo, .close, .lineTo, .moveTo, .quadraticCurveTo]
+        let points = [CGPoint(x: 0, y: 0), CGPoint(x: 10, y: 0),
+                      CGPoint(x: 20, y: 0), CGPoint(x: 20, y: 10), CGPoint(x: 10, y: 10),
+                      CGPoint(x: -5, y: 5), CGPoint(x: 2, y: 2),
+                      CGPoint(x: 3, y: 30), CGPoint(x: 4, y: 2)]
+        let path = AJRBezierPath()
+        path.append(elements: elements, count: elements.count, points: points, count: points.count)
+        XCTAssert(path.isEqual(expected))
+        XCTAssertEqual(path.bounds, expected.bounds)
+        XCTAssertEqual(path.controlPointBounds, expected.controlPointBounds)
+
+        // Building a large path one element at a time must not cost quadratic copying.
+        let large = AJRBezierPath()
+        large.reserveCapacity(elements: 100_001, points: 100_001)
+        large.move(to: .zero)
+        for index in 1 ... 100_000 {
+            large.line(to: CGPoint(x: CGFloat(index), y: CGFloat(index % 7)))
+        }
+        XCTAssertEqual(large.elementCount, 100_001)
+        XCTAssertEqual(large.bounds, CGRect(x: 0, y: 0, width: 100_000, height: 6))
+    }
+
+    func testCachedCGPath() throws {
+        let path = AJRBezierPath(rect: CGRect(x: 0, y: 0, width: 10, height: 10))
+        let first = path.cgPath
+        XCTAssert(path.cgPath === first)
+        XCTAssertEqual(first.boundingBoxOfPath, CGRect(x: 0, y: 0, width: 10, height: 10))
+
+        // Copies start out with the same geometry, so they can share the CGPath.
+        let copy = path.copy() as! AJRBezierPath
+        XCTAssert(copy.cgPath === first)
+
+        // Changing a path rebuilds its CGPath, but leaves its copies' alone.
+        path.line(to: CGPoint(x: 20, y: 20))
+        XCTAssert(path.cgPath !== first)
+        XCTAssertEqual(path.cgPath.boundingBoxOfPath, CGRect(x: 0, y: 0, width: 20, height: 20))
+        XCTAssert(copy.cgPath === first)
+
+        // Changing the line style only changes the stroke, so the geometry stays cached.
+        let flattened = copy.flattenedPath(withTolerance: 0.5)
+        copy.lineWidth = 6.0
+        copy.lineJoinStyle = .round
+        XCTAssert(copy.cgPath === first)
+        XCTAssert(copy.flattenedPath(withTolerance: 0.5) === flattened)
+        XCTAssertEqual(copy.strokeBounds, CGRect(x: -3, y: -3, width: 16, height: 16))
+    }
+
+    func testCurveLineIntersections() throws {
+        // An S curve crossing the x axis three times.
+        let curve = AJRBezierCurve(start: CGPoint(x: 0, y: -10), handle1: CGPoint(x: 10, y: 40), handle2: CGPoint(x: 20, y: -40), end: CGPoint(x: 30, y: 10))
+        let line = AJRLine(start: CGPoint(x: -5, y: 0), end: CGPoint(x: 35, y: 0))
+        let intersections = try XCTUnwrap(AJRIntersection.intersections(for: curve, with: line, error: 1.0) as? [AJRIntersection])
+        XCTAssertEqual(intersections.count, 3)
+        var lastT = -1.0
+        for intersection in intersections {
+            XCTAssertEqual(intersection.point().y, 0.0, accuracy: 1.0e-9)
+            XCTAssertEqual(AJRBezierCurveAtT(curve, intersection.t()).x, intersection.point().x, accuracy: 1.0e-9)
+            XCTAssertGreaterThan(intersection.t(), lastT)
+            lastT = intersection.t()
+        }
+
+        // Pieces of the curve begin and end where it passes through their ends, even when they have no length.
+        for (t0, t1) in [(0.25, 0.75), (0.75, 0.25), (0.0, 0.0), (0.4, 0.4), (1.0, 1.0)] {
+            let piece = AJRBezierCurveGetSubcurve(curve, t0, t1)
+            XCTAssertEqual(piece.start.x, AJRBezierCurveAtT(curve, t0).x, accuracy: 1.0e-9)
+            XCTAssertEqual(piece.start.y, AJRBezierCurveAtT(curve, t0).y, accuracy: 1.0e-9)
+            XCTAssertEqual(piece.end.x, AJRBezierCurveAtT(curve, t1).x, accuracy: 1.0e-9)
+            XCTAssertEqual(piece.end.y, AJRBezierCurveAtT(curve, t1).y, accuracy: 1.0e-9)
+            if t0 == t1 {
+                XCTAssertEqual(piece.handle1, piece.start)
+                XCTAssertEqual(piece.handle2, piece.start)
+            }
+        }
+
+        // A line that stops short of the curve doesn't hit it.
+        XCTAssertNil(AJRIntersection.intersections(for: curve, with: AJRLine(start: CGPoint(x: -5, y: 0), end: CGPoint(x: -1, y: 0)), error: 1.0))
+
+        let quadratic = AJRQuadraticCurve(start: CGPoint(x: 0, y: 0), controlPoint: CGPoint(x: 10, y: 20), end: CGPoint(x: 20, y: 0))
+        let quadraticIntersections = try XCTUnwrap(AJRIntersection.intersections(for: quadratic, with: AJRLine(start: CGPoint(x: -5, y: 5), end: CGPoint(x: 25, y: 5)), error: 1.0) as? [AJRIntersection])
+        XCTAssertEqual(quadraticIntersections.count, 2)
+        XCTAssertEqual(quadraticIntersections[0].t(), (1.0 - sqrt(0.5)) / 2.0, accuracy: 1.0e-12)
+    }
+
+    func testIntersectionBuffer() throws {
+        let path = AJRBezierPath(rect: CGRect(x: 0, y: 0, width: 10, height: 10))
+        // Offset, so the line doesn't pass through the ends of the oval's curves, where two of them would meet it.
+        path.appendOval(in: CGRect(x: 20, y: -2, width: 10, height: 10))
+        let line = AJRLine(start: CGPoint(x: 40, y: 5), end: CGPoint(x: -10, y: 5))
+
+        var buffer = AJRIntersectionBuffer()
+        defer { AJRIntersectionBufferFree(&buffer) }
+        XCTAssertEqual(path.appendIntersections(with: line, toBuffer: &buffer), 4)
+
+        // The records match what the object API reports.
+        let objects = try XCTUnwrap(path.intersections(with: line, error: 0.0))
+        XCTAssertEqual(objects.count, 4)
+        for (index, intersection) in objects.enumerated() {
+            XCTAssertEqual(intersection.point(), buffer.records![index].point)
+            XCTAssertEqual(intersection.segment(), buffer.records![index].segment)
+        }
+
+        AJRIntersectionBufferSortFromPoint(&buffer, line.start)
+        let xs = (0 ..< buffer.count).map { buffer.records![$0].point.x }
+        XCTAssertEqual(xs[0], 25.0 + sqrt(21.0), accuracy: 0.01)
+        XCTAssertEqual(xs[1], 25.0 - sqrt(21.0), accuracy: 0.01)
+        XCTAssertEqual(xs[2], 10.0, accuracy: 1.0e-9)
+        XCTAssertEqual(xs[3], 0.0, accuracy: 1.0e-9)
+
+        AJRIntersectionBufferSortByParameter(&buffer)
+        XCTAssert(buffer.records![0].segment <= buffer.records![1].segment)
+
+        // Emptying the buffer keeps its storage for the next query.
+        let capacity = buffer.capacity
+        AJRIntersectionBufferRemoveAll(&buffer)
+        XCTAssertEqual(path.appendIntersections(with: line, toBuffer: &buffer), 4)
+        XCTAssertEqual(buffer.capacity, capacity)
+    }
+
+
+    func testScanlines() throws {
+        let path = AJRBezierPath(rect: CGRect(x: 0, y: 0, width: 100, height: 100))
+        path.appendRect(CGRect(x: 40, y: 40, width: 20, height: 20))
+        path.windingRule = .evenOdd
+
+        var buffers = [AJRIntersectionBuffer](repeating: AJRIntersectionBuffer(), count: 2)
+        path.appendIntersectionsWithHorizontalLines(at: [10, 50], count: 2, toBuffers: &buffers)
+        XCTAssertEqual((0 ..< buffers[0].count).map { buffers[0].records![$0].point.x }, [0, 100])
+        XCTAssertEqual((0 ..< buffers[1].count).map { buffers[1].records![$0].point.x }, [0, 40, 60, 100])
+
+        // Lines running up the page are offset to their left, so these are at x = 50 and x = 10.
+        for index in 0 ..< buffers.count {
+            AJRIntersectionBufferRemoveAll(&buffers[index])
+        }
+        path.appendIntersectionsWithParallelLines(along: CGVector(dx: 0, dy: 1), offsets: [-50, -10], count: 2, toBuffers: &buffers)
+        XCTAssertEqual((0 ..< buffers[0].count).map { buffers[0].records![$0].point.y }, [0, 40, 60, 100])
+        XCTAssertEqual((0 ..< buffers[1].count).map { buffers[1].records![$0].point.y }, [0, 100])
+        for index in 0 ..< buffers.count {
+            XCTAssert((0 ..< buffers[index].count).allSatisfy { abs(buffers[index].records![$0].point.x - [50.0, 10.0][index]) < 1.0e-9 })
+            AJRIntersectionBufferFree(&buffers[index])
+        }
+
+        let rects = path.inscribedRectangles(baselines: [20, 35, 90, 120], height: 10)
+        XCTAssertEqual(rects[0], [CGRect(x: 0, y: 20, width: 100, height: 10)])
+        XCTAssertEqual(rects[1], [CGRect(x: 0, y: 35, width: 40, height: 10), CGRect(x: 60, y: 35, width: 40, height: 10)])
+        XCTAssertEqual(rects[2], [CGRect(x: 0, y: 90, width: 100, height: 10)])
+        XCTAssertEqual(rects[3], [])
+        XCTAssertEqual(path.inscribedRectangles(from: 35, height: 10), rects[1])
+    }
+
+
+    func testSubrectangles() throws {
+        let path = AJRBezierPath()
+        path.move(to: CGPoint(x: 0, y: 0))
+        path.line(to: CGPoint(x: 100, y: 0))
+        path.line(to: CGPoint(x: 100, y: 40))
+        path.line(to: CGPoint(x: 40, y: 40))
+        path.line(to: CGPoint(x: 40, y: 100))
+        path.line(to: CGPoint(x: 0, y: 100))
+        path.close()
+        let bounds = CGRect(x: -10, y: -10, width: 200, height: 200)
+
+        // The straight edges line up from band to band, so the L comes back as just two tiles, in sweep order.
+        XCTAssertEqual(path.subrectangles(containedIn: bounds, error: 0.5, lineSweep: .down, minimumSize: 0).map { $0.rectValue },
+                       [CGRect(x: 0, y: 0, width: 100, height: 40), CGRect(x: 0, y: 40, width: 40, height: 60)])
+        XCTAssertEqual(path.subrectangles(containedIn: bounds, error: 0.5, lineSweep: .up, minimumSize: 0).map { $0.rectValue },
+                       [CGRect(x: 0, y: 40, width: 40, height: 60), CGRect(x: 0, y: 0, width: 100, height: 40)])
+        XCTAssertEqual(path.subrectangles(containedIn: bounds, error: 0.5, lineSweep: .right, minimumSize: 0).map { $0.rectValue },
+                       [CGRect(x: 0, y: 0, width: 40, height: 100), CGRect(x: 40, y: 0, width: 60, height: 40)])
+        XCTAssertEqual(path.subrectangles(containedIn: CGRect(x: 50, y: 0, width: 100, height: 100), error: 0.5, lineSweep: .down, minimumSize: 0).map { $0.rectValue },
+                       [CGRect(x: 50, y: 0, width: 50, height: 40)])
+        // Bands can't be thinner than 50, so there's just one, and the only thing that fits in it is the 40 wide arm, which is too narrow.
+        XCTAssertEqual(path.subrectangles(containedIn: bounds, error: 0.5, lineSweep: .down, minimumSize: 50).count, 0)
+    }
+
+    func testSubrectanglesOfGlyphs() throws {
+        let font = NSFont.systemFont(ofSize: 144)
+        var characters = Array("Bezier@&%8g".utf16)
+        var glyphs = [CGGlyph](repeating: 0, count: characters.count)
+        XCTAssert(CTFontGetGlyphsForCharacters(font, &characters, &glyphs, characters.count))
+        let path = AJRBezierPath()
+        path.move(to: .zero)
+        path.append(withCGGlyphs: &glyphs, count: glyphs.count, in: font)
+        path.windingRule = .nonZero
+
+        var tiles = [CGRect]()
+        measure {
+            tiles = path.subrectangles(containedIn: path.bounds, error: 0.5, lineSweep: .down, minimumSize: 1).map { $0.rectValue }
+        }
+
+        XCTAssert(tiles.count > 0)
+        var area : CGFloat = 0
+        for (index, tile) in tiles.enumerated() {
+            XCTAssert(tile.width >= 1 && tile.height >= 1)
+            XCTAssert(path.isHit(by: CGPoint(x: tile.midX, y: tile.midY)))
+            area += tile.width * tile.height
+            // No two tiles overlap.
+            for other in tiles[(index + 1)...] {
+                XCTAssert(tile.intersection(other).isNull || tile.intersection(other).width * tile.intersection(other).height < 1.0e-6)
+            }
+        }
+        XCTAssert(area > 0)
+    }
+
+    func testPathIntersections() throws {
+        let square = AJRBezierPath(rect: CGRect(x: 0, y: 0, width: 10, height: 10))
+        let other = AJRBezierPath(rect: CGRect(x: 5, y: 5, width: 10, height: 10))
+        let points = square.intersections(with: other).map { $0.point() }
+        XCTAssertEqual(points.count, 2)
+        XCTAssert(points.contains(CGPoint(x: 10, y: 5)))
+        XCTAssert(points.contains(CGPoint(x: 5, y: 10)))
+
+        // Both sides of each crossing are reported, in the same order.
+        var buffer = AJRIntersectionBuffer()
+        var otherBuffer = AJRIntersectionBuffer()
+        XCTAssertEqual(square.appendIntersections(with: other, toBuffer: &buffer, otherBuffer: &otherBuffer), 2)
+        for index in 0 ..< buffer.count {
+            XCTAssertEqual(buffer.records![index].point, otherBuffer.records![index].point)
+        }
+        AJRIntersectionBufferFree(&buffer)
+        AJRIntersectionBufferFree(&otherBuffer)
+
+        let circle = AJRBezierPath(ovalIn: CGRect(x: -10, y: -10, width: 20, height: 20))
+        let line = AJRBezierPath()
+        line.move(to: CGPoint(x: -20, y: 0))
+        line.line(to: CGPoint(x: 20, y: 0))
+        let crossings = circle.intersections(with: line).map { $0.point().x }.sorted()
+        XCTAssertEqual(crossings.count, 2)
+        XCTAssertEqual(crossings[0], -10, accuracy: 1.0e-6)
+        XCTAssertEqual(crossings[1], 10, accuracy: 1.0e-6)
+        // A circle crosses a copy of itself that's been moved, but doesn't cross itself.
+        let moved = AJRBezierPath(ovalIn: CGRect(x: -5, y: -10, width: 20, height: 20))
+        XCTAssertEqual(circle.intersections(with: moved).count, 2)
+        XCTAssertEqual(circle.intersections(with: circle).count, 0)
+
+        // A short line inside the circle doesn't cross its outline, but it's still inside its fill.
+        let inside = AJRBezierPath()
+        inside.move(to: CGPoint(x: -1, y: 0))
+        inside.line(to: CGPoint(x: 1, y: 0))
+        XCTAssertFalse(circle.outlineIntersects(inside))
+        XCTAssert(circle.isHit(by: inside))
+        XCTAssert(inside.isHit(by: circle))
+        XCTAssertFalse(circle.isStrokeHit(by: inside))
+        XCTAssert(inside.isStrokeHit(by: circle))
+        XCTAssert(circle.isHit(by: square))
+        XCTAssertFalse(circle.isHit(by: AJRBezierPath(rect: CGRect(x: 20, y: 20, width: 5, height: 5))))
+
+        XCTAssert(square.isHit(by: CGRect(x: 4, y: 4, width: 2, height: 2)))
+        XCTAssert(square.isHit(by: CGRect(x: -5, y: 4, width: 6, height: 2)))
+        XCTAssertFalse(square.isHit(by: CGRect(x: 20, y: 4, width: 2, height: 2)))
+        XCTAssertFalse(square.isStrokeHit(by: CGRect(x: 4, y: 4, width: 2, height: 2)))
+        XCTAssert(square.isStrokeHit(by: CGRect(x: 4, y: 8.5, width: 2, height: 1)))
+        XCTAssert(square.isStrokeHit(by: CGRect(x: 4, y: 11, width: 2, height: 2)))
+        XCTAssertFalse(square.isStrokeHit(by: CGRect(x: 4, y: 13, width: 2, height: 2)))
+
+        // Open paths are hit by their strokes, so lines that never cross still touch when they're wide enough.
+        let upper = AJRBezierPath()
+        upper.move(to: CGPoint(x: 0, y: 1))
+        upper.line(to: CGPoint(x: 10, y: 1))
+        let lower = AJRBezierPath()
+        lower.move(to: CGPoint(x: 0, y: 0))
+        lower.line(to: CGPoint(x: 10, y: 0))
+        upper.lineWidth = 4.0
+        lower.lineWidth = 4.0
+        XCTAssertFalse(upper.outlineIntersects(lower))
+        XCTAssert(upper.isHit(by: lower))
+        XCTAssert(upper.isStrokeHit(by: lower))
+        upper.lineWidth = 0.5
+        lower.lineWidth = 0.5
+        XCTAssertFalse(upper.isHit(by: lower))
+        XCTAssertFalse(upper.isStrokeHit(by: lower))
+
+        // A closed path's stroke reaches half its width outside its fill.
+        let box = AJRBezierPath(rect: CGRect(x: 0, y: 0, width: 10, height: 10))
+        let beside = AJRBezierPath(rect: CGRect(x: 10.2, y: 4, width: 2, height: 2))
+        box.lineWidth = 1.0
+        XCTAssert(box.isStrokeHit(by: beside))
+        box.lineWidth = 0.2
+        XCTAssertFalse(box.isStrokeHit(by: beside))
+    }
+
+    func testPathIndex() throws {
+        // A 10 x 10 grid of squares, and a big square underneath them all.
+        var squares = [AJRBezierPath]()
+        for row in 0 ..< 10 {
+            for column in 0 ..< 10 {
+                squares.append(AJRBezierPath(rect: CGRect(x: column * 20, y: row * 20, width: 10, height: 10)))
+            }
+        }
+        let background = AJRBezierPath(rect: CGRect(x: -5, y: -5, width: 200, height: 200))
+        let index = AJRBezierPathIndex(paths: [background] + squares)
+        XCTAssertEqual(index.count, 101)
+        XCTAssert(index.paths.first === background)
+
+        // Topmost first, so the square comes before the background.
+        let hits = index.paths(hitBy: CGPoint(x: 45, y: 65), options: .fill)
+        XCTAssertEqual(hits.count, 2)
+        XCTAssert(hits[0] === squares[3 * 10 + 2])
+        XCTAssert(hits[1] === background)
+        XCTAssert(index.topmostPath(hitBy: CGPoint(x: 55, y: 65), options: .fill) === background)
+        XCTAssertNil(index.topmostPath(hitBy: CGPoint(x: 55, y: 65), options: .stroke))
+        XCTAssert(index.topmostPath(hitBy: CGPoint(x: 50.5, y: 65), options: .stroke) === squares[3 * 10 + 2])
+
+        // The rect overlaps four squares, and sits inside the background.
+        XCTAssertEqual(index.paths(hitBy: CGRect(x: 25, y: 25, width: 20, height: 20), options: .fill).count, 5)
+        XCTAssertEqual(index.paths(hitBy: CGRect(x: 25, y: 25, width: 20, height: 20), options: .stroke).count, 4)
+        XCTAssertEqual(index.paths(hitBy: squares[0], options: .fill).count, 1)
+
+        // Paths can move, and come and go.
+        let moved = squares[0]
+        moved.transform(using: AffineTransform(translationByX: 500, byY: 500))
+        index.update(moved)
+        XCTAssert(index.topmostPath(hitBy: CGPoint(x: 505, y: 505), options: .fill) === moved)
+        XCTAssert(index.topmostPath(hitBy: CGPoint(x: 5, y: 5), options: .fill) === background)
+        index.remove(background)
+        XCTAssertNil(index.topmostPath(hitBy: CGPoint(x: 5, y: 5), options: .fill))
+        XCTAssertFalse(index.contains(background))
+        let top = AJRBezierPath(rect: CGRect(x: 0, y: 0, width: 100, height: 100))
+        index.add(top)
+        XCTAssert(index.topmostPath(hitBy: CGPoint(x: 25, y: 25), options: .fill) === top)
+        XCTAssert(index.paths.last === top)
+
+        // Nearest first, by outline.
+        var distances = [CGFloat]()
+        index.enumeratePathsByDistance(from: CGPoint(x: 600, y: 600)) { path, distance, stop in
+            distances.append(distance)
+            stop.pointee = distances.count == 3
+        }
+        XCTAssertEqual(distances.count, 3)
+        XCTAssertEqual(distances, distances.sorted())
+
+        // The point is inside the diagonal's box, but a long way from its line, so the square just beside the point comes first.
+        let diagonal = AJRBezierPath()
+        diagonal.move(to: CGPoint(x: 0, y: 0))
+        diagonal.line(to: CGPoint(x: 100, y: 100))
+        let beside = AJRBezierPath(rect: CGRect(x: 92, y: 6, width: 4, height: 8))
+        let nearby = AJRBezierPathIndex(paths: [diagonal, beside])
+        var order = [AJRBezierPath]()
+        distances.removeAll()
+        nearby.enumeratePathsByDistance(from: CGPoint(x: 90, y: 10)) { path, distance, stop in
+            order.append(path)
+            distances.append(distance)
+        }
+        XCTAssertEqual(order.count, 2)
+        XCTAssert(order[0] === beside)
+        XCTAssert(order[1] === diagonal)
+        XCTAssertEqual(distances[0], 2.0, accuracy: 1.0e-9)
+        XCTAssertEqual(distances[1], 80.0 / sqrt(2.0), accuracy: 1.0e-9)
+    }
+
+    func testNearestPoint() throws {
+        // Elements are the move to, the left, top and right sides, and the close along the bottom.
+        let square = AJRBezierPath(rect: CGRect(x: 0, y: 0, width: 10, height: 10))
+        var nearest = AJRBezierPathNearestPoint()
+
+        XCTAssert(square.getNearestPoint(&nearest, to: CGPoint(x: 5, y: 12), maximumDistance: .greatestFiniteMagnitude))
+        XCTAssertEqual(nearest.elementIndex, 2)
+        XCTAssertEqual(nearest.t, 0.5, accuracy: 1.0e-9)
+        XCTAssertEqual(nearest.distance, 2.0, accuracy: 1.0e-9)
+        XCTAssertEqual(nearest.point.x, 5.0, accuracy: 1.0e-9)
+        XCTAssertEqual(nearest.point.y, 10.0, accuracy: 1.0e-9)
+
+        // The corner belongs to both the left side and the close, and the earlier element wins.
+        XCTAssert(square.getNearestPoint(&nearest, to: CGPoint(x: -1, y: -1), maximumDistance: .greatestFiniteMagnitude))
+        XCTAssertEqual(nearest.elementIndex, 1)
+        XCTAssertEqual(nearest.t, 0.0)
+
+        XCTAssertFalse(square.getNearestPoint(&nearest, to: CGPoint(x: 5, y: 12), maximumDistance: 1.0))
+        XCTAssertEqual(nearest.elementIndex, NSNotFound)
+
+        var t : CGFloat = 0.0
+        XCTAssertEqual(square.elementIndexOfElementHit(by: CGPoint(x: 10.5, y: 4), atTValue: &t, width: 6.0), 3)
+        XCTAssertEqual(t, 0.6, accuracy: 1.0e-9)
+        XCTAssertEqual(square.elementIndexOfElementHit(by: CGPoint(x: 5, y: 5), atTValue: &t, width: 6.0), NSNotFound)
+
+        // Curves are solved, rather than sampled.
+        let arch = AJRBezierPath()
+        arch.move(to: CGPoint(x: 0, y: 0))
+        arch.curve(to: CGPoint(x: 20, y: 0), controlPoint: CGPoint(x: 10, y: 10))
+        XCTAssert(arch.getNearestPoint(&nearest, to: CGPoint(x: 10, y: 10), maximumDistance: .greatestFiniteMagnitude))
+        XCTAssertEqual(nearest.elementIndex, 1)
+        XCTAssertEqual(nearest.t, 0.5, accuracy: 1.0e-9)
+        XCTAssertEqual(nearest.distance, 5.0, accuracy: 1.0e-9)
+
+        // And many points at once, as when snapping.
+        let points = [CGPoint(x: 5, y: 12), CGPoint(x: 5, y: 4.5), CGPoint(x: 50, y: 50)]
+        var answers = [AJRBezierPathNearestPoint](repeating: AJRBezierPathNearestPoint(), count: points.count)
+        XCTAssertEqual(square.getNearestPoints(&answers, to: points, count: points.count, maximumDistance: 10.0), 2)
+        XCTAssertEqual(answers[0].elementIndex, 2)
+        XCTAssertEqual(answers[1].elementIndex, 4)
+        XCTAssertEqual(answers[1].distance, 4.5, accuracy: 1.0e-9)
+        XCTAssertEqual(answers[2].elementIndex, NSNotFound)
+    }
+
+    func testFlattenedPath() throws {
+        let arch = AJRBezierPath()
+        arch.move(to: CGPoint(x: 0, y: 0))
+        arch.curve(to: CGPoint(x: 20, y: 0), controlPoint: CGPoint(x: 10, y: 10))
+
+        // Tolerances round down to a power of two, so nearby tolerances share a flattening.
+        let coarse = arch.flattenedPath(withTolerance: 0.3)
+        XCTAssertEqual(coarse.tolerance, 0.25)
+        XCTAssert(arch.flattenedPath(withTolerance: 0.4) === coarse)
+        let fine = arch.flattenedPath(withTolerance: 0.01)
+        XCTAssert(fine !== coarse)
+        XCTAssertGreaterThan(fine.pointCount, coarse.pointCount)
+        XCTAssertEqual(coarse.subpathCount, 1)
+        XCTAssertFalse(coarse.isSubpathClosed(at: 0))
+        XCTAssertEqual(coarse.points[0], CGPoint(x: 0, y: 0))
+        XCTAssertEqual(coarse.points[coarse.pointCount - 1], CGPoint(x: 20, y: 0))
+        for index in 0 ..< coarse.pointCount {
+            var nearest = AJRBezierPathNearestPoint()
+            XCTAssert(arch.getNearestPoint(&nearest, to: coarse.points[index], maximumDistance: 1.0e-9))
+        }
+
+        // The scale divides the path's flatness.
+        arch.flatness = 1.0
+        XCTAssert(arch.flattenedPath(forScale: 4.0) === coarse)
+
+        // Changing the path throws its flattenings away.
+        arch.transform(using: AffineTransform(translationByX: 10, byY: 0))
+        let moved = arch.flattenedPath(withTolerance: 0.3)
+        XCTAssert(moved !== coarse)
+        XCTAssertEqual(moved.points[0], CGPoint(x: 10, y: 0))
+
+        // A closed subpath doesn't repeat its first point, but still has its closing edge.
+        let square = AJRBezierPath(rect: CGRect(x: 0, y: 0, width: 10, height: 10))
+        let flattened = square.flattenedPath(withTolerance: 1.0)
+        XCTAssertEqual(flattened.pointCount, 4)
+        XCTAssertEqual(flattened.rangeOfSubpath(at: 0), NSRange(location: 0, length: 4))
+        XCTAssert(flattened.isSubpathClosed(at: 0))
+        var lines = [AJRLine]()
+        flattened.enumerateLineSegments { line, isNewSubpath, stop in
+            XCTAssertEqual(isNewSubpath, lines.isEmpty)
+            lines.append(line)
+        }
+        XCTAssertEqual(lines.count, 4)
+        XCTAssertEqual(lines.last?.end, CGPoint(x: 0, y: 0))
+    }
+
+    func testStrokedPath() throws {
+        // A square stroked two wide covers a band one unit either side of its edges, with mitered corners.
+        let square = AJRBezierPath(rect: CGRect(x: 0, y: 0, width: 10, height: 10))
+        square.lineWidth = 2.0
+        square.lineJoinStyle = .mitered
+        let outline = square.bezierPathFromStrokedPath()
+        XCTAssertEqual(outline.bounds.minX, -1.0, accuracy: 1.0e-9)
+        XCTAssertEqual(outline.bounds.minY, -1.0, accuracy: 1.0e-9)
+        XCTAssertEqual(outline.bounds.maxX, 11.0, accuracy: 1.0e-9)
+        XCTAssertEqual(outline.bounds.maxY, 11.0, accuracy: 1.0e-9)
+        XCTAssert(outline.isHit(by: CGPoint(x: 5, y: 0.5)))
+        XCTAssert(outline.isHit(by: CGPoint(x: 10.5, y: 5)))
+        XCTAssert(!outline.isHit(by: CGPoint(x: 5, y: 5)))
+        XCTAssert(!outline.isHit(by: CGPoint(x: 5, y: 12)))
+
+        // The outline is cached until the stroke changes, and each caller gets a copy of its own to change.
+        let cached = square.bezierPathFromStrokedPath()
+        XCTAssertEqual(cached, outline)
+        XCTAssert(cached !== outline)
+        outline.appendRect(CGRect(x: 100, y: 100, width: 5, height: 5))
+        XCTAssertEqual(square.bezierPathFromStrokedPath(), cached)
+        XCTAssertNotEqual(square.bezierPathFromStrokedPath(), outline)
+        square.lineWidth = 4.0
+        let wider = square.bezierPathFromStrokedPath()
+        XCTAssertNotEqual(wider, cached)
+        XCTAssertEqual(wider.bounds.minX, -2.0, accuracy: 1.0e-9)
+        square.lineWidth = 2.0
+        XCTAssertEqual(square.bezierPathFromStrokedPath(), cached)
+        square.setLineDash([4, 4], phase: 0)
+        let dashed = square.bezierPathFromStrokedPath()
+        XCTAssertNotEqual(dashed, cached)
+        XCTAssertEqual(dashed.flattenedPath(withTolerance: 0.1).subpathCount, 5)
+        square.setLineDash(nil, phase: 0)
+        XCTAssertEqual(square.bezierPathFromStrokedPath(), cached)
+        square.lineJoinStyle = .beveled
+        XCTAssert(!square.bezierPathFromStrokedPath().isHit(by: CGPoint(x: -0.9, y: -0.9)))
+
+        // Round caps and joins reach exactly half the line width from a curve.
+        let arch = AJRBezierPath()
+        arch.move(to: CGPoint(x: 0, y: 0))
+        arch.curve(to: CGPoint(x: 20, y: 0), controlPoint1: CGPoint(x: 0, y: 15), controlPoint2: CGPoint(x: 20, y: 15))
+        arch.lineWidth = 4.0
+        arch.lineCapStyle = .round
+        arch.flatness = 0.01
+        let archOutline = arch.bezierPathFromStrokedPath()
+        for index in 0 ... 20 {
+            var nearest = AJRBezierPathNearestPoint()
+            let t = CGFloat(index) / 20.0
+            let point = CGPoint(x: 20 * (3 * t * t - 2 * t * t * t), y: 45 * t * (1 - t))
+            XCTAssert(archOutline.isHit(by: point))
+            XCTAssert(archOutline.getNearestPoint(&nearest, to: point, maximumDistance: 3.0))
+            XCTAssertEqual(nearest.distance, 2.0, accuracy: 0.01)
+        }
+        // A flatness of 0 asks for the most accurate outline, just as it does when flattening.
+        arch.flatness = 0.0
+        let preciseOutline = arch.bezierPathFromStrokedPath()
+        for index in 0 ... 20 {
+            var nearest = AJRBezierPathNearestPoint()
+            let t = CGFloat(index) / 20.0
+            let point = CGPoint(x: 20 * (3 * t * t - 2 * t * t * t), y: 45 * t * (1 - t))
+            XCTAssert(preciseOutline.getNearestPoint(&nearest, to: point, maximumDistance: 3.0))
+            XCTAssertEqual(nearest.distance, 2.0, accuracy: 0.02)
+        }
+        // Stroking happens outside the cache lock, but every thread still ends up with the same outline.
+        arch.lineWidth = 3.0
+        DispatchQueue.concurrentPerform(iterations: 16) { _ in
+            XCTAssertEqual(arch.bezierPathFromStrokedPath().bounds, arch.bezierPathFromStrokedPath().bounds)
+        }
+
+        // Each dash gets an outline of its own.
+        let line = AJRBezierPath()
+        line.move(to: CGPoint(x: 0, y: 0))
+        line.line(to: CGPoint(x: 100, y: 0))
+        line.lineWidth = 2.0
+        line.setLineDash([10, 10], phase: 5)
+        let dashes = line.bezierPathFromStrokedPath()
+        XCTAssertEqual(dashes.flattenedPath(withTolerance: 0.1).subpathCount, 6)
+        XCTAssert(dashes.isHit(by: CGPoint(x: 2, y: 0)))
+        XCTAssert(!dashes.isHit(by: CGPoint(x: 10, y: 0)))
+        XCTAssert(dashes.isHit(by: CGPoint(x: 20, y: 0.5)))
+        line.setLineDash(nil, phase: 0)
+        XCTAssertEqual(line.bezierPathFromStrokedPath().flattenedPath(withTolerance: 0.1).subpathCount, 1)
+    }
+
+    func testLengthTable() throws {
+        // Runs up 20, across 10, down 20, and closes back across 10.
+        let rect = AJRBezierPath(rect: CGRect(x: 0, y: 0, width: 10, height: 20))
+        XCTAssertEqual(rect.length, 60.0, accuracy: 1.0e-9)
+        XCTAssertEqual(rect.point(atLength: 25.0), CGPoint(x: 5, y: 20))
+        XCTAssertEqual(rect.tangent(atLength: 25.0), CGPoint(x: 1, y: 0))
+        XCTAssertEqual(rect.point(atLength: -5.0), CGPoint(x: 0, y: 0))
+        XCTAssertEqual(rect.point(atLength: 100.0), CGPoint(x: 0, y: 0))
+
+        var t : CGFloat = 0.0
+        XCTAssertEqual(rect.elementIndex(atLength: 25.0, t: &t), 2)
+        XCTAssertEqual(t, 0.5, accuracy: 1.0e-9)
+        // A length at the end of an element belongs to it, rather than to the next one.
+        XCTAssertEqual(rect.elementIndex(atLength: 20.0, t: &t), 1)
+        XCTAssertEqual(t, 1.0)
+        XCTAssertEqual(rect.length(atElement: 3, t: 0.5), 40.0, accuracy: 1.0e-9)
+        XCTAssertEqual(rect.length(atElement: 0, t: 0.0), 0.0)
+
+        var points = [CGPoint](repeating: .zero, count: 7)
+        XCTAssertEqual(rect.getEvenlySpacedPoints(&points, tangents: nil, count: 7), 7)
+        let expected = [CGPoint(x: 0, y: 0), CGPoint(x: 0, y: 10), CGPoint(x: 0, y: 20), CGPoint(x: 10, y: 20), CGPoint(x: 10, y: 10), CGPoint(x: 10, y: 0), CGPoint(x: 0, y: 0)]
+        for (point, expectedPoint) in zip(points, expected) {
+            XCTAssertEqual(point.x, expectedPoint.x, accuracy: 1.0e-9)
+            XCTAssertEqual(point.y, expectedPoint.y, accuracy: 1.0e-9)
+        }
+
+        // Changing the path rebuilds the table.
+        rect.transform(using: AffineTransform(scaleByX: 2, byY: 2))
+        XCTAssertEqual(rect.length, 120.0, accuracy: 1.0e-9)
+
+        // Around a circle, evenly spaced points stay on it, and each heads at right angles to its radius.
+        let circle = AJRBezierPath(ovalIn: CGRect(x: -10, y: -10, width: 20, height: 20))
+        XCTAssertEqual(circle.length, 20.0 * .pi, accuracy: 0.05)
+        var tangents = [CGPoint](repeating: .zero, count: 33)
+        points = [CGPoint](repeating: .zero, count: 33)
+        XCTAssertEqual(circle.getEvenlySpacedPoints(&points, tangents: &tangents, count: 33), 33)
+        for index in 0 ..< 33 {
+            XCTAssertEqual(hypot(points[index].x, points[index].y), 10.0, accuracy: 0.01)
+            XCTAssertEqual(points[index].x * tangents[index].x + points[index].y * tangents[index].y, 0.0, accuracy: 0.01)
+            XCTAssertEqual(circle.length(atElement: circle.elementIndex(atLength: circle.length * CGFloat(index) / 32.0, t: &t), t: t), circle.length * CGFloat(index) / 32.0, accuracy: 1.0e-6)
+        }
+
+        // A curve with its handles pulled back onto its end points traces a line, but its t eases in and out, so it's 25.9% of the way along at t = 1/3.
+        let retracted = AJRBezierPath()
+        retracted.move(to: CGPoint(x: 0, y: 0))
+        retracted.curve(to: CGPoint(x: 100, y: 0), controlPoint1: CGPoint(x: 0, y: 0), controlPoint2: CGPoint(x: 100, y: 0))
+        XCTAssertEqual(retracted.length, 100.0, accuracy: 1.0e-9)
+        XCTAssertEqual(retracted.length(atElement: 1, t: 1.0 / 3.0), 700.0 / 27.0, accuracy: 1.0e-6)
+        for index in 1 ..< 10 {
+            let elementT = CGFloat(index) / 10.0
+            XCTAssertEqual(retracted.elementIndex(atLength: retracted.length(atElement: 1, t: elementT), t: &t), 1)
+            XCTAssertEqual(t, elementT, accuracy: 1.0e-6)
+        }
+
+        XCTAssertEqual(AJRBezierPath().length, 0.0)
+        XCTAssertEqual(AJRBezierPath().getEvenlySpacedPoints(&points, tangents: nil, count: 4), 0)
+    }
+
+    func testGlyphOutlines() throws {
+        let font = NSFont.systemFont(ofSize: 24.0)
+        let path = AJRBezierPath()
+        path.appendString("Hello", font: font)
+        XCTAssertFalse(path.isEmpty)
+
+        // The second time around comes out of the cache, and must match.
+        let again = AJRBezierPath()
+        again.appendString("Hello", font: font)
+        XCTAssertEqual(path, again)
+
+        // Appending picks up at the current point, so a second copy sits one line's width along.
+        let width = path.currentPoint.x
+        XCTAssertGreaterThan(width, 0.0)
+        path.appendString("Hello", font: font)
+        XCTAssertEqual(path.currentPoint.x, 2.0 * width, accuracy: 1.0e-6)
+
+        // Laying text out no longer touches the text system, so it works off the main thread.
+        var paths = [AJRBezierPath?](repeating: nil, count: 8)
+        paths.withUnsafeMutableBufferPointer { buffer in
+            DispatchQueue.concurrentPerform(iterations: 8) { index in
+                let threaded = AJRBezierPath()
+                threaded.appendString("Hello", font: font)
+                buffer[index] = threaded
+            }
+        }
+        for threaded in paths {
+            XCTAssertEqual(threaded, again)
+        }
+    }
+
+    func testCurveFitter() throws {
+        // A wobbly stroke, sampled the way a pen would be.
+        var points = [CGPoint]()
+        for index in 0 ..< 400 {
+            let x = CGFloat(index) * 0.75
+            points.append(CGPoint(x: x, y: 40.0 * sin(x / 15.0)))
+        }
+
+        let fitter = AJRCurveFitter(tolerance: 0.5)
+        for point in points {
+            fitter.addPoint(point)
+            // The pending curve always picks up where the path leaves off.
+            if fitter.hasPendingCurve {
+                XCTAssertEqual(fitter.pendingCurve.start, fitter.path.currentPoint)
+            }
+        }
+        XCTAssert(fitter.hasPendingCurve)
+        fitter.finishStroke()
+        XCTAssertFalse(fitter.hasPendingCurve)
+
+        let path = fitter.path
+        XCTAssertLessThan(path.elementCount, 40)
+        XCTAssertEqual(path.currentPoint, points.last!)
+        var nearest = AJRBezierPathNearestPoint()
+        for point in points {
+            XCTAssert(path.getNearestPoint(&nearest, to: point, maximumDistance: .greatestFiniteMagnitude))
+            XCTAssertLessThanOrEqual(nearest.distance, 0.5 + 1.0e-6)
+        }
+
+        // The batch fitter comes within the tolerance too.
+        var curves = [AJRBezierCurve]()
+        let count = withUnsafeMutablePointer(to: &curves) { curvesPointer in
+            AJRBezierCurvesFromPoints(points, points.count, 0.5, { curve, context in
+                context!.assumingMemoryBound(to: [AJRBezierCurve].self).pointee.append(curve)
+            }, curvesPointer)
+        }
+        XCTAssertEqual(count, curves.count)
+        XCTAssertEqual(curves.first!.start, points.first!)
+        XCTAssertEqual(curves.last!.end, points.last!)
+
+        // A second stroke starts a new subpath.
+        fitter.addPoints([CGPoint(x: 0, y: 100), CGPoint(x: 10, y: 100), CGPoint(x: 20, y: 100)], count: 3)
+        fitter.finishStroke()
+        XCTAssertEqual(path.currentPoint, CGPoint(x: 20, y: 100))
+        XCTAssertEqual(path.lastElementType, .cubicCurveTo)
+    }
+
+    func testSimplification() throws {
+        // A finely detailed outline: a wobbly ring, drawn as thousands of little lines.
+        let outline = AJRBezierPath()
+        var points = [CGPoint]()
+        for index in 0 ..< 3000 {
+            let angle = CGFloat(index) / 3000.0 * 2.0 * .pi
+            let radius = 200.0 + 30.0 * sin(angle * 7.0)
+            points.append(CGPoint(x: radius * cos(angle), y: radius * sin(angle)))
+        }
+        outline.appendPoints(&points, count: points.count)
+        outline.close()
+
+        let simplified = outline.bezierPathBySimplifying(withTolerance: 0.5)
+        XCTAssertLessThan(simplified.elementCount, outline.elementCount / 10)
+        var nearest = AJRBezierPathNearestPoint()
+        for point in points {
+            XCTAssert(simplified.getNearestPoint(&nearest, to: point, maximumDistance: .greatestFiniteMagnitude))
+            XCTAssertLessThanOrEqual(nearest.distance, 0.5)
+        }
+
+        // Corners survive, and straight sides stay straight.
+        let square = AJRBezierPath(rect: CGRect(x: 0, y: 0, width: 100, height: 100))
+        let simplifiedSquare = square.bezierPathBySimplifying(withTolerance: 1.0)
+        XCTAssertEqual(simplifiedSquare.elementCount, 5)
+        XCTAssertEqual(simplifiedSquare.bounds, square.bounds)
+
+        // The renderer gets the coarsest level that's close enough.
+        let levels = outline.levelsOfDetail(withFinestTolerance: 0.25, levelCount: 6)
+        XCTAssertEqual(levels.levelCount, 6)
+        XCTAssertEqual(levels.tolerance(atLevel: 3), 2.0)
+        XCTAssertLessThan(levels.path(atLevel: 5).elementCount, levels.path(atLevel: 0).elementCount)
+        XCTAssert(levels.path(forTolerance: 3.0) === levels.path(atLevel: 3))
+        XCTAssert(levels.path(forTolerance: 1000.0) === levels.path(atLevel: 5))
+        XCTAssert(levels.path(forTolerance: 0.1) === outline)
+        // Drawn at a tenth of its size, the path's flatness of 1 allows for 10 units of error, which level 5 is within.
+        XCTAssert(levels.path(forScale: 0.1) === levels.path(atLevel: 5))
+
+        // Islands smaller than the tolerance disappear.
+        let dot = AJRBezierPath(ovalIn: CGRect(x: 0, y: 0, width: 0.5, height: 0.5))
+        XCTAssert(dot.bezierPathBySimplifying(withTolerance: 2.0).isEmpty)
+    }
+
 }
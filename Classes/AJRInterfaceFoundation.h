@@ -44,8 +44,11 @@ FOUNDATION_EXPORT const unsigned char AJRInterfaceFoundationVersionString[];
 #import <AJRInterfaceFoundation/AJRBezierCurves.h>
 #import <AJRInterfaceFoundation/AJRBezierPath.h>
 #import <AJRInterfaceFoundation/AJRBezierPathFunctions.h>
+#import <AJRInterfaceFoundation/AJRBezierPathIndex.h>
 #import <AJRInterfaceFoundation/AJRBezierPathP.h>
+#import <AJRInterfaceFoundation/AJRFlattenedPath.h>
 #import <AJRInterfaceFoundation/AJRColorUtilities.h>
+#import <AJRInterfaceFoundation/AJRCurveFitter.h>
 #import <AJRInterfaceFoundation/AJRGeometry.h>
 #import <AJRInterfaceFoundation/AJRGraphicsUtilities.h>
 #import <AJRInterfaceFoundation/AJRImageUtilities.h>
@@ -53,7 +56,12 @@ FOUNDATION_EXPORT const unsigned char AJRInterfaceFoundationVersionString[];
 #import <AJRInterfaceFoundation/AJRInterfaceFoundation.h>
 #import <AJRInterfaceFoundation/AJRIntersection.h>
 #import <AJRInterfaceFoundation/AJRPathAnalyzer.h>
+#import <AJRInterfaceFoundation/AJRPathBoolean.h>
 #import <AJRInterfaceFoundation/AJRPathEnumerator.h>
+#import <AJRInterfaceFoundation/AJRPathIterator.h>
+#import <AJRInterfaceFoundation/AJRPathLengthTable.h>
+#import <AJRInterfaceFoundation/AJRPathSegmentTable.h>
+#import <AJRInterfaceFoundation/AJRPathStroker.h>
 #import <AJRInterfaceFoundation/AJRPolygon.h>
 #import <AJRInterfaceFoundation/AJRTrigonometry.h>
 #import <AJRInterfaceFoundation/AJRVector.h>
@@ -32,8 +32,9 @@
 #import "AJRBezierPathP.h"
 
 #import "AJRBezierPathFunctions.h"
-#import "AJRIntersection.h"
 #import "AJRPathEnumerator.h"
+#import "AJRPathIterator.h"
+#import "AJRPathStroker.h"
 
 #import <AJRFoundation/AJRFoundation.h>
 
@@ -61,6 +62,7 @@
 
 - (void)setStrokePointTransform:(AJRBezierPathPointTransform)strokeTransform {
     _strokePointTransform = [strokeTransform copy];
+    [self _discardCGPath:&_strokeCGPath];
 }
 
 - (AJRBezierPathPointTransform)strokePointTransform {
@@ -69,6 +71,7 @@
 
 - (void)setFillPointTransform:(AJRBezierPathPointTransform)fillTransform {
     _fillPointTransform = [fillTransform copy];
+    [self _discardCGPath:&_fillCGPath];
 }
 
 - (AJRBezierPathPointTransform)fillPointTransform {
@@ -85,6 +88,7 @@
     BOOL first = YES;
     NSInteger offset = 0;
     
+    [self _prepareForMutation];
     if ([self isClosed]) {
         offset = -1;
         _moveToOffset = _elementToPointIndex[_elementCount - 1];
@@ -172,6 +176,7 @@
     BOOL first = YES;
     NSInteger offset = 0;
     
+    [self _prepareForMutation];
     if ([self isClosed]) {
         offset = -1;
         _moveToOffset = _elementToPointIndex[_elementCount - 1];
@@ -302,6 +307,7 @@
 }
 
 - (void)openPath {
+    [self _prepareForMutation];
     if ([self isClosed]) {
         _elementCount--;
     }
@@ -312,6 +318,7 @@
 }
 
 - (void)insertMoveToPoint:(CGPoint)point atIndex:(NSUInteger)elementIndex {
+    [self _prepareForMutation];
     if (elementIndex == _elementCount) {
         // This is the simplest case.
         [self moveToPoint:point];
@@ -370,6 +377,7 @@
     NSUInteger startingPointIndex;
     NSInteger x;
     
+    [self _prepareForMutation];
     elementIndex += 1;
     
     if (elementIndex == 1) {
@@ -418,6 +426,7 @@
     NSUInteger startingPointIndex;
     NSInteger x;
     
+    [self _prepareForMutation];
     elementIndex += 1;
     
     if (elementIndex == 1) {
@@ -508,6 +517,7 @@
 }
 
 - (void)movePointAtIndex:(NSInteger)index byDelta:(CGPoint)aDelta {
+    [self _prepareForMutation];
     if (index + 2 < _pointCount) {
         _points[index + 2].x += aDelta.x;
         _points[index + 2].y += aDelta.y;
@@ -621,6 +631,7 @@
 }
 
 - (void)translateByDelta:(CGPoint)delta {
+    [self _prepareForMutation];
     for (NSInteger x = 0; x < _pointCount; x++) {
         _points[x].x += delta.x;
         _points[x].y += delta.y;
@@ -634,6 +645,8 @@
         _bounds.origin.x += delta.x;
         _bounds.origin.y += delta.y;
     }
+    // The bounds just move with us, but everything else has to be rebuilt.
+    [self _discardCachedGeometry];
 }
 
 - (void)rotateByDegrees:(CGFloat)degrees aroundPoint:(CGPoint)origin {
@@ -653,6 +666,7 @@
     CGRect someBounds = [self controlPointBounds];
     BOOL flipX, flipY;
     
+    [self _prepareForMutation];
     flipX = newBounds.size.width < 0;
     flipY = newBounds.size.height < 0;
     
@@ -786,6 +800,7 @@
 }
 
 - (void)changeToCurveToWithControlPoint1:(CGPoint)control1 controlPoint2:(CGPoint)control2 elementAtIndex:(NSUInteger)elementIndex {
+    [self _prepareForMutation];
     elementIndex++;
     
     switch (_elements[elementIndex]) {
@@ -824,6 +839,7 @@
     NSInteger x;
     BOOL promoteMoveTo = NO;
     
+    [self _prepareForMutation];
     elementIndex += 1;
     
     if (elementIndex >= _elementCount) {
@@ -890,76 +906,85 @@
 }
 
 - (NSUInteger)elementIndexOfElementHitByPoint:(CGPoint)point atTValue:(CGFloat *)t width:(CGFloat)width {
-    NSInteger x;
-    CGPoint moveTo = CGPointZero, currentPoint = CGPointZero;
-    CGFloat error = width / 2.0;
-    AJRIntersection *intersection;
-    AJRLine line;
+    AJRBezierPathNearestPoint nearest;
     
     *t = 0.0;
+    if ([self getNearestPoint:&nearest toPoint:point maximumDistance:width / 2.0] && nearest.distance < width / 2.0) {
+        *t = nearest.t;
+        return nearest.elementIndex;
+    }
     
-    for (x = 1; x < _elementCount; x++) {
-        switch (_elements[x]) {
-            case AJRBezierPathElementSetBoundingBox:
-                break;
-            case AJRBezierPathElementMoveTo:
-                currentPoint = _points[_elementToPointIndex[x]];
-                moveTo = currentPoint;
-                break;
-            case AJRBezierPathElementLineTo:
-                line.start = currentPoint;
-                line.end = _points[_elementToPointIndex[x]];
-                intersection = [AJRIntersection intersectionForLine:line withPerpendicularLineThroughPoint:point];
-                if (intersection) {
-                    if (AJRDistanceBetweenPoints([intersection point], point) < error) {
-                        if (line.start.x == line.end.x) {
-                            *t = (line.start.y - [intersection point].y) / (line.start.y - line.end.y);
-                        } else {
-                            *t = (line.start.x - [intersection point].x) / (line.start.x - line.end.x);
-                        }
-                        return x - 1;
-                    }
-                }
-                currentPoint = line.end;
-                break;
-            case AJRBezierPathElementCubicCurveTo:
-                intersection = [AJRIntersection intersectionForCurve:(AJRBezierCurve){currentPoint, _points[_elementToPointIndex[x] + 0], _points[_elementToPointIndex[x] + 1], _points[_elementToPointIndex[x] + 2]} withPoint:point];
-                if (AJRDistanceBetweenPoints(point, [intersection point]) < error) {
-                    *t = [intersection t];
-                    return x - 1;
-                }
-                currentPoint = _points[_elementToPointIndex[x] + 2];
-                break;
-            case AJRBezierPathElementQuadraticCurveTo:
-                intersection = [AJRIntersection intersectionForQuadraticCurve:(AJRQuadraticCurve){currentPoint, _points[_elementToPointIndex[x] + 0], _points[_elementToPointIndex[x] + 1]} withPoint:point];
-                if (AJRDistanceBetweenPoints(point, [intersection point]) < error) {
-                    *t = [intersection t];
-                    return x - 1;
-                }
-                currentPoint = _points[_elementToPointIndex[x] + 2];
-                break;
-            case AJRBezierPathElementClose:
-                line.start = currentPoint;
-                line.end = moveTo;
-                intersection = [AJRIntersection intersectionForLine:line withPerpendicularLineThroughPoint:point];
-                if (intersection) {
-                    if (AJRDistanceBetweenPoints([intersection point], point) < error) {
-                        if (line.start.x == line.end.x) {
-                            *t = (line.start.y - [intersection point].y) / (line.start.y - line.end.y);
-                        } else {
-                            *t = (line.start.x - [intersection point].x) / (line.start.x - line.end.x);
-                        }
-                        return x - 1;
-                    }
-                }
-                currentPoint = moveTo;
-                break;
+    return NSNotFound;
+}
+
+- (BOOL)getNearestPoint:(AJRBezierPathNearestPoint *)nearest toPoint:(CGPoint)point maximumDistance:(CGFloat)maximumDistance {
+    if (AJRPathSegmentTableNearestPoint([self _pathSegmentTable], point, maximumDistance, nearest)) {
+        // The table counts the bounding box element, but our callers don't.
+        nearest->elementIndex -= 1;
+        return YES;
+    }
+    return NO;
+}
+
+- (NSUInteger)getNearestPoints:(AJRBezierPathNearestPoint *)nearest toPoints:(const CGPoint *)points count:(NSUInteger)count maximumDistance:(CGFloat)maximumDistance {
+    NSUInteger found = AJRPathSegmentTableNearestPoints([self _pathSegmentTable], points, count, maximumDistance, nearest);
+    
+    for (NSUInteger x = 0; x < count; x++) {
+        if (nearest[x].elementIndex != NSNotFound) {
+            nearest[x].elementIndex -= 1;
         }
     }
     
-    if (x == _elementCount) return NSNotFound;
+    return found;
+}
+
+#pragma mark - Measuring the path
+
+- (CGFloat)length {
+    return [self _pathLengthTable]->length;
+}
+
+- (CGPoint)pointAtLength:(CGFloat)length {
+    CGPoint point = CGPointZero;
     
-    return x - 1;
+    if (AJRPathLengthTableLocate([self _pathLengthTable], length, NULL, &point, NULL) == NSNotFound && _elementCount > 1) {
+        // Nothing has any length, so everything is where the path starts.
+        point = _points[_elementToPointIndex[1]];
+    }
+    
+    return point;
+}
+
+- (CGPoint)tangentAtLength:(CGFloat)length {
+    CGPoint tangent = CGPointZero;
+    
+    AJRPathLengthTableLocate([self _pathLengthTable], length, NULL, NULL, &tangent);
+    
+    return tangent;
+}
+
+- (NSUInteger)elementIndexAtLength:(CGFloat)length t:(CGFloat *)t {
+    double elementT;
+    NSUInteger elementIndex = AJRPathLengthTableLocate([self _pathLengthTable], length, &elementT, NULL, NULL);
+    
+    AJRSetOutParameter(t, elementT);
+    // The table counts the bounding box element, but our callers don't.
+    return elementIndex == NSNotFound ? NSNotFound : elementIndex - 1;
+}
+
+- (CGFloat)lengthAtElement:(NSUInteger)elementIndex t:(CGFloat)t {
+    if (_elementCount <= 1) {
+        // Only the set bounding box element, so there's no range to report.
+        [NSException raise:NSRangeException format:@"Index %lu is out of range, because the path has no elements", (unsigned long)elementIndex];
+    }
+    if (elementIndex + 1 >= _elementCount) {
+        [NSException raise:NSRangeException format:@"Index %lu is out of range [0..%lu]", (unsigned long)elementIndex, (unsigned long)(_elementCount - 2)];
+    }
+    return AJRPathLengthTableLengthAtElement([self _pathLengthTable], elementIndex + 1, t);
+}
+
+- (NSUInteger)getEvenlySpacedPoints:(CGPoint *)points tangents:(CGPoint *)tangents count:(NSUInteger)count {
+    return AJRPathLengthTableSample([self _pathLengthTable], count, points, tangents);
 }
 
 - (AJRPathEnumerator *)pathEnumerator {
@@ -967,24 +992,26 @@
 }
 
 - (void)enumerateWithBlock:(void (^)(NSBezierPathElement element, CGPoint *points, BOOL *stop))enumerationBlock {
-    AJRPathEnumerator *enumerator = [self pathEnumerator];
-    AJRBezierPathElement *element;
+    AJRPathIterator iterator;
+    AJRBezierPathElement element;
     CGPoint points[4];
     BOOL stop = NO;
     
-    while ((element = [enumerator nextElementWithPoints:points]) && !stop) {
-        enumerationBlock((NSBezierPathElement)*element, points, &stop);
+    AJRPathIteratorInit(&iterator, self);
+    while (!stop && AJRPathIteratorNextElement(&iterator, &element, points)) {
+        enumerationBlock((NSBezierPathElement)element, points, &stop);
     }
 }
 
 - (void)enumerateFlattenedPathWithBlock:(void (^)(AJRLine lineSegment, BOOL isNewSubpath, BOOL *stop))enumerationBlock {
-    AJRPathEnumerator *enumerator = [self pathEnumerator];
-    AJRLine *line;
+    AJRPathIterator iterator;
+    AJRLine line;
     BOOL stop = NO;
     BOOL isNewSubpath = NO;
     
-    while ((line = [enumerator nextLineSegmentIsNewSubpath:&isNewSubpath]) && !stop) {
-        enumerationBlock(*line, isNewSubpath, &stop);
+    AJRPathIteratorInit(&iterator, self);
+    while (!stop && AJRPathIteratorNextLine(&iterator, &line, &isNewSubpath)) {
+        enumerationBlock(line, isNewSubpath, &stop);
     }
 }
 
@@ -1067,16 +1094,19 @@
 }
 
 - (CGRect)strokeBounds:(BOOL)flag {
-    if (!flag && _strokeBoundsValid) return _strokeBounds;
+    CGRect strokeBounds;
     
     if (_elementCount <= 1) return NSZeroRect;
     
-    [self _setupDrawingContext:AJRHitTestContext()];
-    _strokeBounds = AJRstrokebounds(AJRHitTestContext(), _points, _pointCount, _elements, _elementCount);
-    
-    _strokeBoundsValid = YES;
+    os_unfair_lock_lock(&_cacheLock);
+    if (flag || !_strokeBoundsValid) {
+        _strokeBounds = AJRpathstrokebounds(_points, _pointCount, _elements, _elementCount, _lineWidth, _lineCapStyle, _lineJoinStyle, _miterLimit);
+        _strokeBoundsValid = YES;
+    }
+    strokeBounds = _strokeBounds;
+    os_unfair_lock_unlock(&_cacheLock);
     
-    return _strokeBounds;
+    return strokeBounds;
 }
 
 - (CGRect)strokeBounds {
@@ -1086,6 +1116,10 @@
 - (void)setBoundsAreValid:(BOOL)flag {
     _strokeBoundsValid = flag;
     _boundsValid = flag;
+    if (!flag) {
+        // Everything that changes the path comes through here, so this is where we drop the cached geometry.
+        [self _discardCachedGeometry];
+    }
 }
 
 - (void)appendBezierPathWithCrossedRect:(CGRect)rect {
@@ -1151,73 +1185,54 @@
     [self closePath];
 }
 
-static NSTextView *_textView = nil;
-
 - (void)appendBezierPathWithString:(NSString *)string font:(NSFont *)font {
-    NSRange range;
-    NSLayoutManager *lm;
-    CGGlyph *glyphs;
-    NSSize advancement;
-    NSInteger x;
-    NSPoint where = [self currentPoint];
-
-    if (_textView == nil) {
-        _textView = [[NSTextView alloc] init];
-        [_textView setRichText:NO];
-        [[_textView layoutManager] setBackgroundLayoutEnabled:NO];
-    }
-
-    [_textView setString:string];
-    [_textView setFont:font];
-
-    lm = [_textView layoutManager];
-    range = [lm glyphRangeForCharacterRange:(NSRange){0, [string length]} actualCharacterRange:NULL];
-
-    glyphs = (CGGlyph *)NSZoneMalloc(nil, sizeof(CGGlyph) * (range.length * 2));
-    [lm getGlyphsInRange:range glyphs:glyphs properties:NULL characterIndexes:NULL bidiLevels:NULL];
-
-    for (x = 0; x < range.length; x++) {
-        [self appendBezierPathWithCGGlyph:glyphs[x] inFont:font];
-        advancement = [font advancementForGlyph:glyphs[x]];
-        where.x += advancement.width;
-        where.y += advancement.height;
-        [self moveToPoint:where];
-    }
-
-    NSZoneFree(nil, glyphs);
+    NSAttributedString *attributedString = [[NSAttributedString alloc] initWithString:string attributes:@{NSFontAttributeName:font}];
+    [self appendBezierPathWithAttributedString:attributedString];
 }
 
 - (void)appendBezierPathWithAttributedString:(NSAttributedString *)string {
-    NSLayoutManager *lm;
-
-    if (_textView == nil) {
-        _textView = [[NSTextView alloc] init];
-        [_textView setRichText:NO];
-        [[_textView layoutManager] setBackgroundLayoutEnabled:NO];
-    }
-
-    [[_textView textStorage] replaceCharactersInRange:(NSRange){0, 0} withAttributedString:string];
-
-    lm = [_textView layoutManager];
-
-    [[_textView textStorage] enumerateAttribute:NSFontAttributeName inRange:(NSRange){0, [string length]} options:0 usingBlock:^(NSFont *font, NSRange subrange, BOOL *stop) {
-        NSRange range = [lm glyphRangeForCharacterRange:subrange actualCharacterRange:NULL];
-        NSPoint where = [self currentPoint];
-        NSSize advancement;
-
-        CGGlyph *glyphs = (CGGlyph *)NSZoneMalloc(nil, sizeof(CGGlyph) * (range.length * 2));
-        [lm getGlyphsInRange:range glyphs:glyphs properties:NULL characterIndexes:NULL bidiLevels:NULL];
-
-        for (NSInteger x = 0; x < range.length; x++) {
-            [self appendBezierPathWithCGGlyph:glyphs[x] inFont:font];
-            advancement = [font advancementForGlyph:glyphs[x]];
-            where.x += advancement.width;
-            where.y += advancement.height;
-            [self moveToPoint:where];
+    // Core Text lays out lines without touching any shared state, so unlike the text system, this is safe on any thread.
+    CTLineRef line = CTLineCreateWithAttributedString((__bridge CFAttributedStringRef)string);
+    CFArrayRef runs = CTLineGetGlyphRuns(line);
+    CGPoint origin = [self isEmpty] ? CGPointZero : [self currentPoint];
+    
+    for (CFIndex x = 0, max = CFArrayGetCount(runs); x < max; x++) {
+        CTRunRef run = (CTRunRef)CFArrayGetValueAtIndex(runs, x);
+        CTFontRef font = (CTFontRef)CFDictionaryGetValue(CTRunGetAttributes(run), kCTFontAttributeName);
+        CFIndex count = CTRunGetGlyphCount(run);
+        const CGGlyph *glyphs = CTRunGetGlyphsPtr(run);
+        const CGPoint *positions = CTRunGetPositionsPtr(run);
+        CGGlyph *glyphsBuffer = NULL;
+        CGPoint *positionsBuffer = NULL;
+        
+        if (font == NULL || count == 0) {
+            continue;
         }
-
-        NSZoneFree(nil, glyphs);
-    }];
+        // The runs don't always keep their glyphs and positions in a form they can hand back directly.
+        if (glyphs == NULL) {
+            glyphsBuffer = (CGGlyph *)NSZoneMalloc(NULL, count * sizeof(CGGlyph));
+            CTRunGetGlyphs(run, CFRangeMake(0, 0), glyphsBuffer);
+            glyphs = glyphsBuffer;
+        }
+        if (positions == NULL) {
+            positionsBuffer = (CGPoint *)NSZoneMalloc(NULL, count * sizeof(CGPoint));
+            CTRunGetPositions(run, CFRangeMake(0, 0), positionsBuffer);
+            positions = positionsBuffer;
+        }
+        
+        [self _appendOutlineOfGlyphs:glyphs positions:positions count:count inFont:font origin:origin];
+        
+        if (glyphsBuffer) {
+            NSZoneFree(NULL, glyphsBuffer);
+        }
+        if (positionsBuffer) {
+            NSZoneFree(NULL, positionsBuffer);
+        }
+    }
+    
+    // Leave the current point at the end of the line, ready for whatever comes next.
+    [self moveToPoint:(CGPoint){origin.x + CTLineGetTypographicBounds(line, NULL, NULL, NULL), origin.y}];
+    CFRelease(line);
 }
 
 
@@ -1243,20 +1258,61 @@ void AJRPathToBezierIterator(void *info, const CGPathElement *element) {
     }
 }
 
+- (AJRBezierPath *)_strokedOutline {
+    AJRBezierPath *strokedPath;
+    AJRStrokeStyle style = {0};
+    CGFloat *dashes = NULL;
+    NSUInteger generation = 0;
+    
+    os_unfair_lock_lock(&_cacheLock);
+    strokedPath = _strokedPath;
+    if (strokedPath == nil) {
+        // Take a copy of the style, dashes and all, since stroking happens without the lock.
+        if (_dashCount > 0) {
+            dashes = NSZoneMalloc(nil, _dashCount * sizeof(CGFloat));
+            memcpy(dashes, _dashValues, _dashCount * sizeof(CGFloat));
+        }
+        style = (AJRStrokeStyle){
+            .lineWidth = _lineWidth,
+            .lineCap = _lineCapStyle,
+            .lineJoin = _lineJoinStyle,
+            .miterLimit = _miterLimit,
+            .dashes = dashes,
+            .dashCount = dashes ? _dashCount : 0,
+            .dashPhase = _dashOffset,
+            // Flatness is how far a flattened curve may stray, and the outline's curves will be flattened again when they're drawn, so we leave them most of that.
+            .error = [self _effectiveFlatness] / 10.0,
+        };
+        generation = _strokeGeneration;
+    }
+    os_unfair_lock_unlock(&_cacheLock);
+    
+    if (strokedPath == nil) {
+        // Stroking, with its dashes and joins, can take a while, so it's done without the lock, which leaves our other caches free meanwhile.
+        AJRBezierPath *made = AJRBezierPathByStrokingPath(self, style);
+        
+        if (dashes) {
+            NSZoneFree(nil, dashes);
+        }
+        os_unfair_lock_lock(&_cacheLock);
+        if (_strokedPath != nil) {
+            // Another thread got there first, so everyone shares theirs.
+            strokedPath = _strokedPath;
+        } else {
+            strokedPath = made;
+            // If the style or geometry changed while we were stroking, our outline is still right for the style we were asked about, but mustn't be kept.
+            if (_strokeGeneration == generation) {
+                _strokedPath = made;
+            }
+        }
+        os_unfair_lock_unlock(&_cacheLock);
+    }
+    
+    return strokedPath;
+}
+
 - (AJRBezierPath *)bezierPathFromStrokedPath {
-    CGContextRef context = AJRHitTestContext();
-    CGPathRef strokedPath;
-    AJRBezierPath *newPath;
-    
-    [self _setupDrawingContext:context];
-    AJRbuildpath(context, _points, _pointCount, _elements, _elementCount, NULL);
-    CGContextReplacePathWithStrokedPath(context);
-    strokedPath = CGContextCopyPath(context);
-    newPath = [[AJRBezierPath alloc] init];
-    CGPathApply(strokedPath, (__bridge void *)newPath, AJRPathToBezierIterator);
-    CGPathRelease(strokedPath);
-    
-    return newPath;
+    return [[self _strokedOutline] copy];
 }
 
 - (BOOL)isContourClockwiseFromIndex:(NSUInteger)startIndex toIndex:(NSUInteger)endIndex {
@@ -29,10 +29,11 @@
  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#import "AJRBezierPath.h"
+#import "AJRBezierPathP.h"
 
 #import "AJRGeometry.h"
 #import "AJRIntersection.h"
+#import "AJRPathBoolean.h"
 #import "NSValue+Extensions.h"
 
 #import <AJRFoundation/AJRFoundation.h>
@@ -70,104 +71,215 @@
 
 @implementation AJRBezierPath (AJRIntersection)
 
-- (NSArray *)intersectionsWithLine:(AJRLine)line error:(double)error {
-    NSMutableArray *intersections;
-    NSArray *subintersections;
-    AJRIntersection *subintersection;
-    NSInteger x, y;
+- (NSUInteger)appendIntersectionsWithLine:(AJRLine)line toBuffer:(AJRIntersectionBuffer *)buffer {
+    NSUInteger startCount = buffer->count;
     NSInteger coordinateIndex = 2;
-    CGPoint moveTo = CGPointZero, currentPoint, lastPoint = CGPointZero, where;
+    CGPoint moveTo = CGPointZero, currentPoint, lastPoint = CGPointZero;
+    AJRPathSegmentTable *table = [self _pathSegmentTable];
+    AJRIntersectionRecord record;
+    
+    for (NSInteger x = 1; x < _elementCount; x++) {
+        switch (_elements[x]) {
+            case AJRBezierPathElementSetBoundingBox:
+                break;
+                
+            case AJRBezierPathElementMoveTo:
+                moveTo = _points[coordinateIndex];
+                coordinateIndex++;
+                lastPoint = moveTo;
+                break;
+                
+            case AJRBezierPathElementLineTo:
+                currentPoint = _points[coordinateIndex];
+                coordinateIndex++;
+                if (AJRPathSegmentTableElementMayCrossLine(table, x, line)
+                    && AJRIntersectLineWithLine(line, (AJRLine){lastPoint, currentPoint}, &record)) {
+                    record.segment = x - 1;
+                    *AJRIntersectionBufferAppend(buffer) = record;
+                }
+                lastPoint = currentPoint;
+                break;
+                
+            case AJRBezierPathElementCubicCurveTo: {
+                AJRBezierCurve curve;
+                curve.start = lastPoint;
+                curve.handle1 = _points[coordinateIndex + 0];
+                curve.handle2 = _points[coordinateIndex + 1];
+                curve.end = _points[coordinateIndex + 2];
+                coordinateIndex += 3;
+                if (AJRPathSegmentTableElementMayCrossLine(table, x, line)) {
+                    AJRIntersectCurveWithLine(curve, line, x - 1, buffer);
+                }
+                lastPoint = curve.end;
+                break;
+            }
+                
+            case AJRBezierPathElementQuadraticCurveTo: {
+                AJRQuadraticCurve curve;
+                curve.start = lastPoint;
+                curve.controlPoint = _points[coordinateIndex + 0];
+                curve.end = _points[coordinateIndex + 1];
+                coordinateIndex += 2;
+                if (AJRPathSegmentTableElementMayCrossLine(table, x, line)) {
+                    AJRIntersectQuadraticCurveWithLine(curve, line, x - 1, buffer);
+                }
+                lastPoint = curve.end;
+                break;
+            }
+                
+            case AJRBezierPathElementClose:
+                if (AJRPathSegmentTableElementMayCrossLine(table, x, line)
+                    && AJRIntersectLineWithLine(line, (AJRLine){lastPoint, moveTo}, &record)) {
+                    record.segment = x - 1;
+                    *AJRIntersectionBufferAppend(buffer) = record;
+                }
+                lastPoint = moveTo;
+                break;
+        }
+    }
+    
+    return buffer->count - startCount;
+}
+
+static void AJRCheckScanlineOrder(const CGFloat *values, NSUInteger count) {
+    for (NSUInteger x = 1; x < count; x++) {
+        if (values[x] < values[x - 1]) {
+            [NSException raise:NSInvalidArgumentException format:@"Scanlines must be given in ascending order, but %g follows %g.", values[x], values[x - 1]];
+        }
+    }
+}
 
-    if (error == 0.0) {
-        error = [self flatness];
+// The table works in internal element indexes, which count the bounding box element, so shift the new records back to public ones.
+static void AJRConvertScanlineSegments(AJRIntersectionBuffer *buffers, const NSUInteger *starts, NSUInteger count) {
+    for (NSUInteger x = 0; x < count; x++) {
+        for (NSUInteger y = starts[x]; y < buffers[x].count; y++) {
+            if (buffers[x].records[y].segment != NSNotFound) {
+                buffers[x].records[y].segment -= 1;
+            }
+        }
     }
+}
+
+- (void)appendIntersectionsWithHorizontalLinesAt:(const CGFloat *)ys count:(NSUInteger)count toBuffers:(AJRIntersectionBuffer *)buffers {
+    NSUInteger *starts;
     
-    intersections = [[NSMutableArray allocWithZone:nil] initWithCapacity:8];
+    AJRCheckScanlineOrder(ys, count);
+    if (count == 0) {
+        return;
+    }
+    starts = NSZoneMalloc(nil, count * sizeof(NSUInteger));
+    for (NSUInteger x = 0; x < count; x++) {
+        starts[x] = buffers[x].count;
+    }
+    AJRPathSegmentTableIntersectHorizontalLines([self _pathSegmentTable], ys, count, buffers);
+    AJRConvertScanlineSegments(buffers, starts, count);
+    NSZoneFree(nil, starts);
+}
+
+- (void)appendIntersectionsWithParallelLinesAlong:(CGVector)direction offsets:(const CGFloat *)offsets count:(NSUInteger)count toBuffers:(AJRIntersectionBuffer *)buffers {
+    double length = sqrt(direction.dx * direction.dx + direction.dy * direction.dy);
+    double dx, dy;
+    CGPoint *points;
+    NSUInteger *starts;
+    AJRPathSegmentTable *table;
     
-    @autoreleasepool {
+    if (length == 0.0) {
+        [NSException raise:NSInvalidArgumentException format:@"The direction of the lines can't be zero."];
+    }
+    dx = direction.dx / length;
+    dy = direction.dy / length;
+    if (dy == 0.0 && dx > 0.0) {
+        // Already horizontal, so we can use our own table.
+        [self appendIntersectionsWithHorizontalLinesAt:offsets count:count toBuffers:buffers];
+        return;
+    }
+    AJRCheckScanlineOrder(offsets, count);
+    if (count == 0) {
+        return;
+    }
+    
+    // Turn the path so that the lines run left to right, and do the work on a table built from that.
+    points = NSZoneMalloc(nil, MAX(_pointCount, 1) * sizeof(CGPoint));
+    for (NSInteger x = 0; x < _pointCount; x++) {
+        points[x] = (CGPoint){_points[x].x * dx + _points[x].y * dy, _points[x].y * dx - _points[x].x * dy};
+    }
+    table = AJRPathSegmentTableCreate(points, _pointCount, _elements, _elementCount);
+    starts = NSZoneMalloc(nil, count * sizeof(NSUInteger));
+    for (NSUInteger x = 0; x < count; x++) {
+        starts[x] = buffers[x].count;
+    }
+    AJRPathSegmentTableIntersectHorizontalLines(table, offsets, count, buffers);
+    AJRConvertScanlineSegments(buffers, starts, count);
     
-        for (x = 1; x < _elementCount; x++) {
+    // And turn the intersections back. The t values don't need converting, since turning a curve doesn't change its parameterization. The directions are left relative to the lines.
+    for (NSUInteger x = 0; x < count; x++) {
+        for (NSUInteger y = starts[x]; y < buffers[x].count; y++) {
+            AJRIntersectionRecord *record = buffers[x].records + y;
+            CGPoint point = record->point;
             
-            switch (_elements[x]) {
-                    
-                case AJRBezierPathElementSetBoundingBox:
-                    break;
-                    
-                case AJRBezierPathElementMoveTo:
-                    moveTo = _points[coordinateIndex];
-                    coordinateIndex++;
-                    lastPoint = moveTo;
-                    break;
-                    
-                case AJRBezierPathElementLineTo:
-                    currentPoint = _points[coordinateIndex];
-                    coordinateIndex++;
-                    subintersection = [AJRIntersection intersectionForLine:line withLine:(AJRLine){lastPoint, currentPoint}];
-                    if (subintersection) {
-                        where = [subintersection point];
-                        [subintersection setSegment:x - 1];
-                        [intersections addObject:subintersection];
-                    }
-                    lastPoint = currentPoint;
-                    break;
-                    
-                case AJRBezierPathElementCubicCurveTo: {
-                    AJRBezierCurve curve;
-                    curve.start = lastPoint;
-                    curve.handle1 = _points[coordinateIndex + 0];
-                    curve.handle2 = _points[coordinateIndex + 1];
-                    curve.end = _points[coordinateIndex + 2];
-                    coordinateIndex += 3;
-                    subintersections = [AJRIntersection intersectionsForCurve:curve withLine:line error:error];
-                    if (subintersections) {
-                        for (y = 0; y < (const NSInteger)[subintersections count]; y++) {
-                            subintersection = [subintersections objectAtIndex:y];
-                            [subintersection setSegment:x - 1];
-                            [intersections addObject:subintersection];
-                        }
-                    }
-                    lastPoint = curve.end;
-                    break;
-                }
+            record->point = (CGPoint){point.x * dx - point.y * dy, point.x * dy + point.y * dx};
+        }
+    }
+    
+    NSZoneFree(nil, starts);
+    AJRPathSegmentTableFree(table);
+    NSZoneFree(nil, points);
+}
 
-                case AJRBezierPathElementQuadraticCurveTo: {
-                    AJRQuadraticCurve curve;
-                    curve.start = lastPoint;
-                    curve.controlPoint = _points[coordinateIndex + 0];
-                    curve.end = _points[coordinateIndex + 1];
-                    coordinateIndex += 3;
-                    subintersections = [AJRIntersection intersectionsForQuadraticCurve:curve withLine:line error:error];
-                    if (subintersections) {
-                        for (y = 0; y < (const NSInteger)[subintersections count]; y++) {
-                            subintersection = [subintersections objectAtIndex:y];
-                            [subintersection setSegment:x - 1];
-                            [intersections addObject:subintersection];
-                        }
-                    }
-                    lastPoint = curve.end;
-                    break;
-                }
+- (void)enumerateInscribedRectanglesWithBaselines:(const CGFloat *)baselines count:(NSUInteger)count height:(CGFloat)height usingBlock:(void (^)(NSUInteger index, CGRect rect, BOOL *stop))block {
+    AJRCheckScanlineOrder(baselines, count);
+    AJRPathSegmentTableEnumerateInscribedRects([self _pathSegmentTable], _windingRule, baselines, count, height, block);
+}
 
-                case AJRBezierPathElementClose:
-                    subintersection = [AJRIntersection intersectionForLine:line withLine:(AJRLine){lastPoint, moveTo}];
-                    if (subintersection) {
-                        [subintersection setSegment:x - 1];
-                        [intersections addObject:subintersection];
-                    }
-                    lastPoint = moveTo;
-                    break;
-            }
+- (NSArray *)intersectionsWithLine:(AJRLine)line error:(double)error {
+    AJRIntersectionBuffer buffer = {};
+    NSMutableArray *intersections = nil;
+    
+    // Intersections are solved for exactly, so error isn't needed any more.
+    if ([self appendIntersectionsWithLine:line toBuffer:&buffer] > 0) {
+        intersections = [[NSMutableArray alloc] initWithCapacity:buffer.count];
+        for (NSUInteger x = 0; x < buffer.count; x++) {
+            [intersections addObject:[AJRIntersection intersectionWithRecord:buffer.records[x]]];
         }
+    }
+    AJRIntersectionBufferFree(&buffer);
+    
+    return intersections;
+}
+
+- (NSUInteger)appendIntersectionsWithPath:(AJRBezierPath *)path toBuffer:(AJRIntersectionBuffer *)buffer otherBuffer:(AJRIntersectionBuffer *)otherBuffer {
+    NSUInteger start = buffer ? buffer->count : 0;
+    NSUInteger otherStart = otherBuffer ? otherBuffer->count : 0;
+    NSUInteger count = AJRPathSegmentTableIntersectTable([self _pathSegmentTable], [path _pathSegmentTable], buffer, otherBuffer);
     
+    // Shift the tables' internal element indexes back to public ones. Closing segments aren't intersected, so every record has a real element.
+    for (NSUInteger x = start; buffer && x < buffer->count; x++) {
+        buffer->records[x].segment -= 1;
     }
+    for (NSUInteger x = otherStart; otherBuffer && x < otherBuffer->count; x++) {
+        otherBuffer->records[x].segment -= 1;
+    }
+    
+    return count;
+}
+
+- (NSArray<AJRIntersection *> *)intersectionsWithPath:(AJRBezierPath *)path {
+    AJRIntersectionBuffer buffer = {};
+    NSMutableArray *intersections = [NSMutableArray array];
     
-    if (![intersections count]) {
-        return nil;
+    [self appendIntersectionsWithPath:path toBuffer:&buffer otherBuffer:NULL];
+    for (NSUInteger x = 0; x < buffer.count; x++) {
+        [intersections addObject:[AJRIntersection intersectionWithRecord:buffer.records[x]]];
     }
+    AJRIntersectionBufferFree(&buffer);
     
     return intersections;
 }
 
+- (BOOL)outlineIntersectsPath:(AJRBezierPath *)path {
+    return [self appendIntersectionsWithPath:path toBuffer:NULL otherBuffer:NULL] > 0;
+}
+
 - (BOOL)isRectangular {
     if (((_pointCount == 6) && (_elementCount == 4)) ||
         ((_pointCount == 6) && (_elementCount == 5))) {
@@ -206,8 +318,195 @@
     return NO;
 }
 
-- (NSArray *)subrectanglesContainedInRect:(CGRect)proposedRect error:(CGFloat)error lineSweep:(NSLineSweepDirection)sweepDirection minimumSize:(CGFloat)minSize {
-    return [NSArray array];
+// The most bands a single piece of the path is allowed to add, no matter how small the error.
+#define AJRMaxBandsPerSegment 256
+
+static void AJRAppendBandEdge(CGFloat **edges, NSUInteger *count, NSUInteger *max, CGFloat edge) {
+    if (*count == *max) {
+        *max = *max ? *max * 2 : 64;
+        *edges = NSZoneRealloc(nil, *edges, *max * sizeof(CGFloat));
+    }
+    (*edges)[*count] = edge;
+    *count += 1;
+}
+
+// Adds band edges wherever segment starts or stops within rect, and often enough in between that it doesn't move more than error sideways in any one band.
+static void AJRAppendBandEdgesForSegment(const AJRPathSegment *segment, CGRect rect, CGFloat error, CGFloat **edges, NSUInteger *count, NSUInteger *max) {
+    CGFloat y0, y1;
+    NSInteger steps;
+    
+    if (!CGRectIntersectsRect(CGRectInset(segment->bounds, -error, -error), rect)) {
+        return;
+    }
+    y0 = MAX(segment->bounds.origin.y, rect.origin.y);
+    y1 = MIN(CGRectGetMaxY(segment->bounds), CGRectGetMaxY(rect));
+    if (y0 > y1) {
+        return;
+    }
+    steps = (NSInteger)MIN(ceil(segment->bounds.size.width / error), AJRMaxBandsPerSegment);
+    AJRAppendBandEdge(edges, count, max, y0);
+    for (NSInteger step = 1; step < steps; step++) {
+        CGFloat y = segment->bounds.origin.y + segment->bounds.size.height * step / steps;
+        if (y > y0 && y < y1) {
+            AJRAppendBandEdge(edges, count, max, y);
+        }
+    }
+    AJRAppendBandEdge(edges, count, max, y1);
+}
+
+static int AJRCompareBandEdges(const void *first, const void *second) {
+    CGFloat one = *(const CGFloat *)first, two = *(const CGFloat *)second;
+    return one < two ? -1 : (one > two ? 1 : 0);
+}
+
+typedef struct _ajrTile {
+    CGRect rect;
+    NSUInteger band;
+} AJRTile;
+
+static void AJRAppendTile(AJRTile **tiles, NSUInteger *count, NSUInteger *max, AJRTile tile) {
+    if (*count == *max) {
+        *max = *max ? *max * 2 : 64;
+        *tiles = NSZoneRealloc(nil, *tiles, *max * sizeof(AJRTile));
+    }
+    (*tiles)[*count] = tile;
+    *count += 1;
+}
+
+// Orders tiles by the edge the sweep reaches first, and then from left to right. A reversed sweep reaches the tops first, so those are negated to sort the same way. These are plain functions, rather than a block for qsort_b(), so they work with qsort() everywhere.
+static inline int AJRCompareTiles(const AJRTile *first, const AJRTile *second, BOOL reversed) {
+    CGRect one = first->rect, two = second->rect;
+    CGFloat edge1 = reversed ? -CGRectGetMaxY(one) : one.origin.y;
+    CGFloat edge2 = reversed ? -CGRectGetMaxY(two) : two.origin.y;
+    
+    if (edge1 != edge2) {
+        return edge1 < edge2 ? -1 : 1;
+    }
+    return one.origin.x < two.origin.x ? -1 : (one.origin.x > two.origin.x ? 1 : 0);
+}
+
+static int AJRCompareTilesForward(const void *first, const void *second) {
+    return AJRCompareTiles(first, second, NO);
+}
+
+static int AJRCompareTilesReversed(const void *first, const void *second) {
+    return AJRCompareTiles(first, second, YES);
+}
+
+- (NSArray<NSValue *> *)subrectanglesContainedInRect:(CGRect)proposedRect error:(CGFloat)error lineSweep:(NSLineSweepDirection)sweepDirection minimumSize:(CGFloat)minSize {
+    BOOL vertical = sweepDirection == NSLineSweepLeft || sweepDirection == NSLineSweepRight;
+    BOOL reversed = sweepDirection == NSLineSweepLeft || sweepDirection == NSLineSweepUp;
+    AJRPathSegmentTable *table;
+    CGPoint *points = NULL;
+    CGFloat *edges = NULL, *bottoms, *tops;
+    NSUInteger edgeCount = 0, edgeMax = 0, bandCount = 0;
+    CGRect rect = CGRectStandardize(proposedRect);
+    NSMutableArray<NSValue *> *subrectangles = [NSMutableArray array];
+    __block AJRTile *tiles = NULL;
+    __block NSUInteger tileCount = 0, tileMax = 0, openStart = 0, openEnd = 0, bandStart = 0, lastBand = NSNotFound;
+    
+    if (error <= 0.0) {
+        error = _flatness > 0.0 ? _flatness : 1.0;
+    }
+    minSize = MAX(minSize, 0.0);
+    
+    // Lines sweeping sideways run up and down the page, so do the work on the path turned on its side, which lets everything below think in horizontal bands.
+    if (vertical) {
+        points = NSZoneMalloc(nil, MAX(_pointCount, 1) * sizeof(CGPoint));
+        for (NSInteger x = 0; x < _pointCount; x++) {
+            points[x] = (CGPoint){_points[x].y, _points[x].x};
+        }
+        table = AJRPathSegmentTableCreate(points, _pointCount, _elements, _elementCount);
+        rect = (CGRect){{rect.origin.y, rect.origin.x}, {rect.size.height, rect.size.width}};
+    } else {
+        table = [self _pathSegmentTable];
+    }
+    rect = CGRectIntersection(rect, table->bounds);
+    
+    if (!CGRectIsNull(rect) && rect.size.height > 0.0 && rect.size.height >= minSize) {
+        // The sweep stops wherever a piece of the path starts or ends, since that's where the set of pieces crossing a band changes, and wherever a piece has moved more than error sideways, since that's how much room each band loses to slanted and curved edges.
+        for (NSUInteger x = 0; x < table->segmentCount; x++) {
+            AJRAppendBandEdgesForSegment(table->segments + x, rect, error, &edges, &edgeCount, &edgeMax);
+        }
+        for (NSUInteger x = 0; x < table->closingSegmentCount; x++) {
+            AJRAppendBandEdgesForSegment(table->closingSegments + x, rect, error, &edges, &edgeCount, &edgeMax);
+        }
+        AJRAppendBandEdge(&edges, &edgeCount, &edgeMax, rect.origin.y);
+        AJRAppendBandEdge(&edges, &edgeCount, &edgeMax, CGRectGetMaxY(rect));
+        qsort(edges, edgeCount, sizeof(CGFloat), AJRCompareBandEdges);
+        
+        // Drop any edges that would make a band shorter than minSize. The last band absorbs whatever's left over at the end.
+        bottoms = NSZoneMalloc(nil, edgeCount * sizeof(CGFloat));
+        tops = NSZoneMalloc(nil, edgeCount * sizeof(CGFloat));
+        for (NSUInteger x = 1; x < edgeCount; x++) {
+            CGFloat bottom = bandCount ? tops[bandCount - 1] : edges[0];
+            if (edges[x] - bottom >= MAX(minSize, 1.0e-9 * MAX(fabs(bottom), 1.0))) {
+                bottoms[bandCount] = bottom;
+                tops[bandCount] = edges[x];
+                bandCount++;
+            }
+        }
+        if (bandCount) {
+            tops[bandCount - 1] = CGRectGetMaxY(rect);
+        }
+        
+        // Each band's rectangles arrive from left to right. One that lines up exactly with a tile ending in the band before, which happens all the time along straight up and down edges, just extends that tile, so those parts of the shape come out whole.
+        AJRPathSegmentTableEnumerateInscribedRectsInBands(table, _windingRule, bottoms, tops, bandCount, ^(NSUInteger band, CGRect found, BOOL *stop) {
+            CGFloat minX = MAX(found.origin.x, rect.origin.x);
+            CGFloat maxX = MIN(CGRectGetMaxX(found), CGRectGetMaxX(rect));
+            
+            if (maxX <= minX || maxX - minX < minSize) {
+                return;
+            }
+            if (band != lastBand) {
+                if (lastBand != NSNotFound && band == lastBand + 1) {
+                    openStart = bandStart;
+                    openEnd = tileCount;
+                } else {
+                    openStart = openEnd = tileCount;
+                }
+                bandStart = tileCount;
+                lastBand = band;
+            }
+            while (openStart < openEnd && tiles[openStart].rect.origin.x < minX) {
+                openStart++;
+            }
+            if (openStart < openEnd && tiles[openStart].rect.origin.x == minX && CGRectGetMaxX(tiles[openStart].rect) == maxX) {
+                // Move the tile into this band, so that it's still open for the next one.
+                AJRTile tile = tiles[openStart];
+                tile.rect.size.height = CGRectGetMaxY(found) - tile.rect.origin.y;
+                tile.band = band;
+                tiles[openStart].rect = CGRectNull;
+                openStart++;
+                AJRAppendTile(&tiles, &tileCount, &tileMax, tile);
+            } else {
+                AJRAppendTile(&tiles, &tileCount, &tileMax, (AJRTile){CGRectMake(minX, found.origin.y, maxX - minX, found.size.height), band});
+            }
+        });
+        NSZoneFree(nil, bottoms);
+        NSZoneFree(nil, tops);
+    }
+    
+    // Hand the tiles back in the order they're reached by the sweep, and from left to right (or bottom to top) within that.
+    if (tileCount > 1) {
+        qsort(tiles, tileCount, sizeof(AJRTile), reversed ? AJRCompareTilesReversed : AJRCompareTilesForward);
+    }
+    for (NSUInteger x = 0; x < tileCount; x++) {
+        CGRect tile = tiles[x].rect;
+        
+        if (!CGRectIsNull(tile)) {
+            [subrectangles addObject:[NSValue valueWithRect:vertical ? (CGRect){{tile.origin.y, tile.origin.x}, {tile.size.height, tile.size.width}} : tile]];
+        }
+    }
+    
+    if (tiles) NSZoneFree(nil, tiles);
+    if (edges) NSZoneFree(nil, edges);
+    if (vertical) {
+        AJRPathSegmentTableFree(table);
+        NSZoneFree(nil, points);
+    }
+    
+    return subrectangles;
 }
 
 - (AJRBezierPath *)pathByUnioningWithPath:(id <AJRBezierPathProtocol>)path {
@@ -236,78 +535,25 @@
 
 @end
 
-static id <AJRBezierPathProtocol> _AJRBezierPathUsingOperation(NSArray<id <AJRBezierPathProtocol>> *paths, CGPathRef (^block)(CGPathRef path1, CGPathRef _Nullable path2)) {
-    if (paths.count == 0) {
-        return nil;
-    } else if (paths.count == 1) {
-        // This happens when we're doing an operation on a single path, like when normalizing.
-        CGPathRef intermediate = block(paths[0].CGPath, NULL);
-        id <AJRBezierPathProtocol> result = (id <AJRBezierPathProtocol>)[[paths[0] class] bezierPathWithCGPath:intermediate];
-        CGPathRelease(intermediate);
-        return result;
-    } else {
-        CGPathRef leftPath = CGPathRetain(paths[0].CGPath);
-        Class finalClass = paths[0].class;
-
-        for (NSInteger x = 1; x < paths.count; x++) {
-            CGPathRef intermediate = block(leftPath, paths[x].CGPath);
-            CGPathRelease(leftPath);
-            leftPath = intermediate;
-        }
-
-        id <AJRBezierPathProtocol> result = (id <AJRBezierPathProtocol>)[finalClass bezierPathWithCGPath:leftPath];
-        CGPathRelease(leftPath);
-
-        return result;
-    }
-}
-
-
 id <AJRBezierPathProtocol> AJRBezierPathByUnioningPaths(NSArray<id <AJRBezierPathProtocol>> *paths) {
-    if (paths.count) {
-        NSWindingRule rule = paths[0].windingRule;
-        return _AJRBezierPathUsingOperation(paths, ^CGPathRef(CGPathRef path1, CGPathRef path2) {
-            return CGPathCreateCopyByUnioningPath(path1, path2, rule == NSWindingRuleEvenOdd);
-        });
-    }
-    return nil;
+    return AJRBezierPathByUnioningManyPaths(paths);
 }
 
 id <AJRBezierPathProtocol> AJRBezierPathByIntersectingPaths(NSArray<id <AJRBezierPathProtocol>> *paths) {
-    if (paths.count) {
-        NSWindingRule rule = paths[0].windingRule;
-        return _AJRBezierPathUsingOperation(paths, ^CGPathRef(CGPathRef path1, CGPathRef path2) {
-            return CGPathCreateCopyByIntersectingPath(path1, path2, rule == NSWindingRuleEvenOdd);
-        });
-    }
-    return nil;
+    return AJRBezierPathByApplyingBooleanOperation(paths, AJRPathBooleanOperationIntersection);
 }
 
 id <AJRBezierPathProtocol> AJRBezierPathBySubtractingPaths(NSArray<id <AJRBezierPathProtocol>> *paths) {
-    if (paths.count) {
-        NSWindingRule rule = paths[0].windingRule;
-        return _AJRBezierPathUsingOperation(paths, ^CGPathRef(CGPathRef path1, CGPathRef path2) {
-            return CGPathCreateCopyBySubtractingPath(path1, path2, rule == NSWindingRuleEvenOdd);
-        });
-    }
-    return nil;
+    return AJRBezierPathByApplyingBooleanOperation(paths, AJRPathBooleanOperationSubtraction);
 }
 
 id <AJRBezierPathProtocol> AJRBezierPathBySymmetricDifferenceOfPaths(NSArray<id <AJRBezierPathProtocol>> *paths) {
-    if (paths.count) {
-        NSWindingRule rule = paths[0].windingRule;
-        return _AJRBezierPathUsingOperation(paths, ^CGPathRef(CGPathRef path1, CGPathRef path2) {
-            return CGPathCreateCopyBySymmetricDifferenceOfPath(path1, path2, rule == NSWindingRuleEvenOdd);
-        });
-    }
-    return nil;
+    return AJRBezierPathByApplyingBooleanOperation(paths, AJRPathBooleanOperationExclusiveOr);
 }
 
 id <AJRBezierPathProtocol> AJRBezierPathByNormalizingPath(id <AJRBezierPathProtocol> path) {
-    return _AJRBezierPathUsingOperation(@[path], ^CGPathRef(CGPathRef path1, CGPathRef path2) {
-        return CGPathCreateCopyByNormalizing(path1, path.windingRule == NSWindingRuleEvenOdd);
-    });
-    return nil;
+    // The union of a single path is just the area it fills, without any overlaps or self intersections.
+    return AJRBezierPathByApplyingBooleanOperation(@[path], AJRPathBooleanOperationUnion);
 }
 
 NSArray *AJRBezierPathGetSubcomponents(id <AJRBezierPathProtocol> path) {
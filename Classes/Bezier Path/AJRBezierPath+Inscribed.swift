@@ -97,7 +97,7 @@ public struct AJRIntersectionRect: Equatable {
      - returns `true` if `other` is fully contained within the receiver, otherwise, `false`.
      */
     public func contains(_ other: AJRIntersectionRect) -> Bool {
-        return other.rect.minX >= rect.minX && other.rect.maxX < rect.maxX
+        return other.rect.minX >= rect.minX && other.rect.maxX <= rect.maxX
     }
 
     /**
@@ -108,7 +108,7 @@ public struct AJRIntersectionRect: Equatable {
      - returns `true` if the receiver and `other` overlap, `false` otherwise.
      */
     public func intersects(_ other: AJRIntersectionRect) -> Bool {
-        return false
+        return other.rect.minX <= rect.maxX && other.rect.maxX >= rect.minX
     }
 
 }
@@ -138,33 +138,24 @@ public struct AJRIntersectionRect: Equatable {
 public extension AJRBezierPath {
 
     /**
-     Takes in an array of intersection rects and modify them as appropriate.
+     Takes in an array of intersection rects and makes sure that no two of them overlap.
 
-     This mehod basically entails making sure that no rectangles overlap with any other rectangles. When rectangles overlap, the following happens:
-
-     1. If the rectangles don't overlap any other rectangles, then the rectangles are left alone.
-     2. If the one rectangle is fully contained by other rectangle, it's removed.
-     3. If the rectangles overlap, but don't intersect, then we split the rectangles and selectively remove the rectangles that no longer matter.
-
-     Note that this isn't necessarily super efficient, but since we should only ever be dealing with a relatively small number of rectangles, we're not going to worry too much about complex optimizations. We can revisit that decision if we find that we're spending a lot of time in this method.
+     The rects all share the same `y` and `height`, so they're really just intervals along x. Sorting them by their left edges puts every group of overlapping rects next to each other, so one sweep can merge each group into a single rect, which also takes care of rects that are contained by others. That's O(n log n), rather than comparing every pair.
 
      - parameter rects: The input rects to clean up.
 
-     - returns An array of rectangles that should not overlap with each other.
+     - returns An array of rectangles that don't overlap with each other, sorted from left to right. Each merged rect carries the union of the directions of the rects it replaced.
      */
     func cleanUp(rects: [AJRIntersectionRect]) -> [AJRIntersectionRect] {
-        let newRects = [AJRIntersectionRect](rects)
+        var newRects = [AJRIntersectionRect]()
 
-        for index1 in stride(from: 0, to: rects.count, by: 1) {
-            let rect1 = rects[index1]
-            for index2 in stride(from: index1, to: rects.count, by: 1) {
-                let rect2 = rects[index2]
-
-                if rect1.contains(rect2) {
-                    //newRects.remove(element: rect2)
-                } else if rect2.contains(rect1) {
-                    //newRects.remove(element: rect1)
-                }
+        for rect in rects.sorted(by: { $0.rect.minX < $1.rect.minX }) {
+            if var last = newRects.last, last.intersects(rect) {
+                last.add(point: CGPoint(x: rect.rect.maxX, y: last.rect.minY))
+                last.add(direction: rect.direction)
+                newRects[newRects.count - 1] = last
+            } else {
+                newRects.append(rect)
             }
         }
 
@@ -296,12 +287,37 @@ public extension AJRBezierPath {
         return intersectionRects.count == 0 ? nil : cleanUp(rects: intersectionRects)
     }
 
-    // TODO: Currently this is wrong, but it will be made right by the time we finish.
     /**
+     Returns the widest rectangles from `baseline` to `baseline + height` that fit inside the path, from left to right.
+
+     - parameter baseline: The bottom of the band.
+     - parameter height: The height of the band.
 
+     - returns The rectangles, or `nil` if no part of the band is inside the path.
      */
     func inscribedRectangles(from baseline: CGFloat, height: CGFloat) -> [CGRect]? {
-        return nil
+        let rects = inscribedRectangles(baselines: [baseline], height: height)[0]
+        return rects.count == 0 ? nil : rects
+    }
+
+    /**
+     The batched form of `inscribedRectangles(from:height:)`, which answers every band with one pass over the path, rather than one pass per band. This is what you want when flowing text into a shape, where each line of text is a band.
+
+     - parameter baselines: The bottoms of the bands, in ascending order.
+     - parameter height: The height of every band.
+
+     - returns An array with an entry for each band, holding the band's rectangles from left to right. Bands that are entirely outside the path have no rectangles.
+     */
+    func inscribedRectangles(baselines: [CGFloat], height: CGFloat) -> [[CGRect]] {
+        var rects = [[CGRect]](repeating: [], count: baselines.count)
+        baselines.withUnsafeBufferPointer { buffer in
+            if let baseAddress = buffer.baseAddress {
+                enumerateInscribedRectangles(withBaselines: baseAddress, count: buffer.count, height: height) { index, rect, stop in
+                    rects[index].append(rect)
+                }
+            }
+        }
+        return rects
     }
 
 }
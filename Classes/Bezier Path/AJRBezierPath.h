@@ -30,13 +30,15 @@
  */
 
 #import <CoreGraphics/CoreGraphics.h>
+#import <os/lock.h>
 
 #import <AJRInterfaceFoundation/AJRGeometry.h>
 #import <AJRInterfaceFoundation/AJRBezierCurves.h>
+#import <AJRInterfaceFoundation/AJRIntersection.h>
 
 NS_ASSUME_NONNULL_BEGIN
 
-@class AJRPathEnumerator, AJRMutableBezierRangeArray, AJRIntersection;
+@class AJRFlattenedPath, AJRPathEnumerator, AJRPathLevelsOfDetail, AJRMutableBezierRangeArray;
 
 extern const CGFloat AJRHairLineWidth;
 
@@ -70,6 +72,18 @@ extern void AJRExpandRect(CGRect *rect, CGPoint *point);
 
 typedef CGPoint (^AJRBezierPathPointTransform)(CGPoint point);
 
+/*! Where a path passes closest to a point. */
+typedef struct _ajrBezierPathNearestPoint {
+    /*! The nearest point on the path. */
+    CGPoint point;
+    /*! The index of the element the point lies on, or NSNotFound if no element was close enough. */
+    NSUInteger elementIndex;
+    /*! Where the point lies along the element, from 0.0 at its start to 1.0 at its end. */
+    double t;
+    /*! The distance from the point asked about to point. */
+    CGFloat distance;
+} AJRBezierPathNearestPoint;
+
 
 /*!
  Defines basic path expectations. This is mainly used where either a `AJRBezierPath` or an `NSBezierPath` can be passed as a parameter.
@@ -104,6 +118,11 @@ typedef CGPoint (^AJRBezierPathPointTransform)(CGPoint point);
 @end
 
 
+/*!
+ A bezier path that, unlike NSBezierPath, exposes its geometry for querying and editing.
+
+ A path isn't safe to mutate from more than one thread at once, or to mutate while another thread is reading it. Once a path stops changing, though, all of its queries, such as -bounds, -strokeBounds, -isHitByPoint:, -isStrokeHitByPoint:, its enumerators and iterators, and the boolean operations, may be run on it from any number of threads at once. The geometry they cache is built under a lock, and none of them go through shared drawing state.
+ */
 @interface AJRBezierPath : NSObject <NSCoding, NSCopying, AJRXMLCoding> {
 	CGPoint *_points;
 	NSUInteger _pointCount;
@@ -122,6 +141,25 @@ typedef CGPoint (^AJRBezierPathPointTransform)(CGPoint point);
 	CGRect _bounds;
 	CGRect _strokeBounds;
 	
+	// Built on demand by -_pathSegmentTable, and discarded by -setBoundsAreValid:NO.
+	struct _ajrPathSegmentTable *_segmentTable;
+	// Built on demand by -_pathLengthTable, and discarded along with the segment table.
+	struct _ajrPathLengthTable *_lengthTable;
+	// Shared with copies of the path until one of them changes. NULL when the path owns its buffers outright.
+	struct _ajrBezierPathStorage *_storage;
+	// Built on demand, one for the path as is, and one each for the fill and stroke point transforms. Discarded along with the segment table.
+	CGPathRef _CGPath;
+	CGPathRef _fillCGPath;
+	CGPathRef _strokeCGPath;
+	// The keys of the flattenings we've put in the shared flattened path cache, most recently used first. Discarded, along with the flattenings, with the segment table.
+	NSMutableArray *_flattenedPathKeys;
+	// The outline built by -bezierPathFromStrokedPath. Discarded with the segment table, and when the line style or flatness changes.
+	AJRBezierPath *_strokedPath;
+	// Bumped whenever _strokedPath is discarded, so an outline stroked without the lock can tell whether it's still current.
+	NSUInteger _strokeGeneration;
+	// Guards the lazily computed bounds, stroke bounds, segment and length tables, CGPaths, flattenings, and stroked outline, so that concurrent readers can share them.
+	os_unfair_lock _cacheLock;
+	
 	AJRBezierPathPointTransform _strokePointTransform;
 	AJRBezierPathPointTransform _fillPointTransform;
 	
@@ -146,12 +184,31 @@ typedef CGPoint (^AJRBezierPathPointTransform)(CGPoint point);
 - (void)appendBezierPathWithArcWithCenter:(CGPoint)center radius:(CGFloat)radius startAngle:(CGFloat)startAngle endAngle:(CGFloat)endAngle NS_SWIFT_NAME(appendArc(withCenter:radius:startAngle:endAngle:));
 - (void)appendBezierPathWithArcFromPoint:(CGPoint)point1 toPoint:(CGPoint)point2 radius:(CGFloat)radius NS_SWIFT_NAME(appendArc(from:to:radius:));
 - (void)appendBezierPathWithCGGlyph:(CGGlyph)aGlyph inFont:(NSFont *)font NS_SWIFT_NAME(append(withCGGlyph:in:));
+/*!
+ Appends the outlines of glyphs, set one after another starting at the current point, or at the origin if the path is empty. Afterwards, the current point is just past the last glyph's advance.
+
+ Outlines are kept in a cache shared by every path, keyed by the font's descriptor, its size, and the glyph, so each glyph is only pulled out of its font once. This may be called from any thread.
+ */
 - (void)appendBezierPathWithCGGlyphs:(CGGlyph *)glyphs count:(NSInteger)count inFont:(NSFont *)font NS_SWIFT_NAME(append(withCGGlyphs:count:in:));
+/*! The most memory, in bytes, that cached glyph outlines may use between all paths. The default is 4 MB. */
+@property (class,nonatomic,assign) NSUInteger glyphOutlineCacheLimit;
 - (void)appendBezierPathWithOvalInRect:(CGRect)rect NS_SWIFT_NAME(appendOval(in:));
 - (void)appendBezierPathWithPoints:(CGPoint *)points count:(NSInteger)count NS_SWIFT_NAME(appendPoints(_:count:));
 - (void)appendBezierPathWithRect:(CGRect)rect NS_SWIFT_NAME(appendRect(_:));
 - (void)appendBezierPathWithRoundedRect:(NSRect)rect xRadius:(CGFloat)xRadius yRadius:(CGFloat)yRadius NS_SWIFT_NAME(appendRoundedRect(_:xRadius:yRadius:));
 
+/*!
+ Makes room for the path to hold at least elementCount elements and pointCount points in total, so building it up to that size doesn't need to reallocate. The path's storage grows geometrically on its own, so this is only worthwhile when you know the final size ahead of time.
+ */
+- (void)reserveCapacityForElements:(NSUInteger)elementCount points:(NSUInteger)pointCount NS_SWIFT_NAME(reserveCapacity(elements:points:));
+
+/*!
+ Appends elements as though each had been added with -moveToPoint:, -lineToPoint:, -curveToPoint:controlPoint1:controlPoint2:, -curveToPoint:controlPoint: or -closePath, but in a single pass, with the bounding box updated as it goes. Points holds each element's points in turn, in the order -elementAtIndex:associatedPoints: returns them, so a cubic curve contributes its two control points followed by its end point. Neither buffer is retained.
+
+ Raises NSInvalidArgumentException, leaving the path unchanged, if an element type is invalid, or pointCount isn't exactly the number of points the elements use.
+ */
+- (void)appendElements:(const AJRBezierPathElement *)elements count:(NSUInteger)elementCount points:(const CGPoint *)points count:(NSUInteger)pointCount NS_SWIFT_NAME(append(elements:count:points:count:));
+
 #pragma mark - Clipping paths
 
 - (void)addClip;
@@ -189,11 +246,15 @@ typedef CGPoint (^AJRBezierPathPointTransform)(CGPoint point);
 
 #pragma mark - Hit detection
 
+/*! Returns YES if the receiver and aBezierPath overlap. A closed path is treated as the area it fills, and an open one as its outline, without any width. */
 - (BOOL)isHitByPath:(AJRBezierPath *)aBezierPath;
 - (BOOL)isHitByPoint:(CGPoint)aPoint;
+/*! Returns YES if rect overlaps the area filled by the receiver, or, if the receiver's open, its stroke. */
 - (BOOL)isHitByRect:(CGRect)rect;
+/*! Returns YES if aBezierPath crosses the receiver's outline or, when aBezierPath is closed, covers any of it. */
 - (BOOL)isStrokeHitByPath:(AJRBezierPath *)aBezierPath;
 - (BOOL)isStrokeHitByPoint:(CGPoint)aPoint;
+/*! Returns YES if rect comes within half the line width of the receiver's outline. Like -isStrokeHitByPoint:, thin lines are treated as at least 4 points wide. */
 - (BOOL)isStrokeHitByRect:(CGRect)rect;
 
 #pragma mark - Contructing paths
@@ -235,6 +296,27 @@ typedef CGPoint (^AJRBezierPathPointTransform)(CGPoint point);
 
 - (id)bezierPathByFlatteningPath;
 - (id)bezierPathByReversingPath;
+/*! Returns a copy of the path with as few elements as it takes to stay within tolerance of it. See -[AJRPathAnalyzer simplifiedPathWithTolerance:]. */
+- (AJRBezierPath *)bezierPathBySimplifyingWithTolerance:(CGFloat)tolerance;
+
+#pragma mark - Levels of Detail
+
+/*!
+ Returns the path flattened so that it's never further than tolerance from the real path. Flattenings are made at power of two tolerances, rounding down, so asking again at a nearby tolerance, such as while zooming, returns the same flattening rather than making a new one.
+
+ Flattenings are kept in a cache shared by every path, which holds at most flattenedPathCacheLimit bytes, and throws out the least recently used flattenings to make room for new ones. Each path also keeps no more than a few levels of detail in the cache at once. Changing the path discards its flattenings.
+
+ @param tolerance The largest distance allowed between the path and its flattening, in the path's own units. This must be greater than 0.
+ */
+- (AJRFlattenedPath *)flattenedPathWithTolerance:(CGFloat)tolerance;
+/*! Returns the path flattened for drawing at scale, which keeps it within the path's flatness of the real path in device space, just as Core Graphics would when drawing the path at that scale. */
+- (AJRFlattenedPath *)flattenedPathForScale:(CGFloat)scale;
+/*! Returns the path flattened for drawing into the current graphics context, using the scale of the context's current transform. */
+- (AJRFlattenedPath *)flattenedPathForCurrentScale;
+/*! The most memory, in bytes, that cached flattenings may use between all paths. The default is 32 MB. */
+@property (class,nonatomic,assign) NSUInteger flattenedPathCacheLimit;
+/*! Simplifies the path ahead of time to levelCount tolerances, starting at tolerance and doubling from there, for drawing the path at many scales. Unlike flattenings, these aren't cached, so hang on to the result, and make a new one when the path changes. */
+- (AJRPathLevelsOfDetail *)levelsOfDetailWithFinestTolerance:(CGFloat)tolerance levelCount:(NSInteger)levelCount;
 
 #pragma mark - Applying transformations
 
@@ -267,7 +349,9 @@ typedef CGPoint (^AJRBezierPathPointTransform)(CGPoint point);
 
 - (void)appendBezierPathWithPolygonInRect:(CGRect)rect sides:(NSInteger)sides starPercent:(CGFloat)starPercent offset:(CGFloat)offset NS_SWIFT_NAME(appendPolygon(in:sides:starPercent:offset:));
 
+/*! Appends the outline of string set in font on a single line. See -appendBezierPathWithAttributedString:. */
 - (void)appendBezierPathWithString:(NSString *)string font:(NSFont *)font NS_SWIFT_NAME(appendString(_:font:));
+/*! Lays string out as a single line with Core Text, and appends the outlines of its glyphs, with the baseline starting at the current point, or at the origin if the path is empty. Afterwards, the current point is at the end of the line. The outlines come from the glyph outline cache, and this may be called from any thread. */
 - (void)appendBezierPathWithAttributedString:(NSAttributedString *)string NS_SWIFT_NAME(appendAttributedString(_:));
 
 #pragma mark - Contructing Paths
@@ -309,11 +393,71 @@ typedef CGPoint (^AJRBezierPathPointTransform)(CGPoint point);
 #pragma mark - Additional Hit Detection
 
 - (NSUInteger)elementIndexOfElementHitByPoint:(CGPoint)point atTValue:(CGFloat *)t;
+/*! Returns the index of the element nearest to point, as long as it's closer than width / 2.0, and where along it the nearest point lies in t. Returns NSNotFound if no element is that close. */
 - (NSUInteger)elementIndexOfElementHitByPoint:(CGPoint)point atTValue:(CGFloat *)t width:(CGFloat)width;
 
+/*!
+ Finds the point on the path nearest to point, such as for snapping to the path, or picking the element under the mouse. The path's monotone pieces are kept in a bounding box tree, so only pieces whose boxes are closer than the best answer so far are measured. Lines are projected onto exactly, and curves are solved with Newton's method to well within a millionth of their size. Nothing is allocated, so this is cheap enough to call on every mouse move. The implicit closing edges of open subpaths aren't part of the path's outline, so they're never the answer.
+
+ @param nearest Filled in with the nearest point. If nothing is within maximumDistance, its elementIndex is NSNotFound.
+ @param point The point to measure from.
+ @param maximumDistance Elements further than this are ignored, which also makes the search faster. Pass CGFLOAT_MAX to find the nearest point anywhere on the path.
+
+ @returns YES if some point on the path is within maximumDistance.
+ */
+- (BOOL)getNearestPoint:(AJRBezierPathNearestPoint *)nearest toPoint:(CGPoint)point maximumDistance:(CGFloat)maximumDistance NS_SWIFT_NAME(getNearestPoint(_:to:maximumDistance:));
+
+/*!
+ Finds the nearest point on the path to each of count points at once, as -getNearestPoint:toPoint:maximumDistance: would. Each search starts from the piece of the path that answered the one before, so points that are near each other, such as the points of a shape being snapped to the path, are answered quickly.
+
+ @returns The number of points that had some point on the path within maximumDistance.
+ */
+- (NSUInteger)getNearestPoints:(AJRBezierPathNearestPoint *)nearest toPoints:(const CGPoint *)points count:(NSUInteger)count maximumDistance:(CGFloat)maximumDistance NS_SWIFT_NAME(getNearestPoints(_:to:count:maximumDistance:));
+
+#pragma mark - Measuring the path
+
+/*!
+ The length of the path, summed over all of its subpaths. Move tos don't add to it, but the edges drawn by close paths do.
+
+ This, and the methods below, answer from a table of the length at the start of every element, and at a few points along every curve, measured with Gauss-Legendre quadrature. The table is built the first time it's needed, and kept until the path changes, so a distance along the path costs a binary search, and then a few Newton steps on a short stretch of a single curve.
+ */
+@property (nonatomic,readonly) CGFloat length;
+/*! Returns the point length along the path. Lengths before the start or past the end of the path are clamped to it. Where a subpath ends exactly at length, its end point is returned, rather than the start of the next subpath. */
+- (CGPoint)pointAtLength:(CGFloat)length;
+/*! Returns the unit vector pointing the way the path heads at length along it, or CGPointZero if the path has no length. */
+- (CGPoint)tangentAtLength:(CGFloat)length;
+/*! Returns the index of the element at length along the path, and where along it in t. Returns NSNotFound if the path has no length. */
+- (NSUInteger)elementIndexAtLength:(CGFloat)length t:(nullable CGFloat *)t;
+/*! Returns how far along the path the point at t in the element at elementIndex lies. This is the inverse of -elementIndexAtLength:t:. */
+- (CGFloat)lengthAtElement:(NSUInteger)elementIndex t:(CGFloat)t;
+/*!
+ Fills points with count points spaced evenly along the path, the first at its start, and the last at its end, such as for placing markers, or moving something along the path at a steady speed. All count points are found in one walk along the path.
+
+ @param points Room for count points.
+ @param tangents If not NULL, room for count unit vectors, pointing the way the path heads at each point.
+
+ @returns count, or 0 if the path has no length, in which case points is left alone.
+ */
+- (NSUInteger)getEvenlySpacedPoints:(CGPoint *)points tangents:(nullable CGPoint *)tangents count:(NSUInteger)count NS_SWIFT_NAME(getEvenlySpacedPoints(_:tangents:count:));
+
 - (NSString *)psDescription;
 - (NSString *)psDescriptionWithFill:(BOOL)flag;
 
+#pragma mark - Binary Representation
+
+/*!
+ Creates a path from data returned by -binaryRepresentation, or returns nil if data isn't something we can read. On little-endian 64-bit hosts, the path uses the points in data where they lie, rather than copying them, until the path is changed. This makes data mapped from a file especially cheap to load.
+
+ @param data A path's binary representation.
+
+ @returns A new path, or nil if data is malformed or from a newer version.
+ */
+- (nullable instancetype)initWithBinaryRepresentation:(NSData *)data;
++ (nullable instancetype)bezierPathWithBinaryRepresentation:(NSData *)data;
+
+/*! The path's geometry and line style, in a compact, versioned, little-endian form. This is also how paths are archived, both by NSCoder and AJRXMLCoder. */
+@property (nonatomic,readonly) NSData *binaryRepresentation;
+
 #pragma mark - Enumerator for going over the edge. This is an easy way to flatten the path.
 
 @property (readonly) AJRPathEnumerator *pathEnumerator;
@@ -327,6 +471,9 @@ typedef CGPoint (^AJRBezierPathPointTransform)(CGPoint point);
 
 #pragma mark - Transforming the path
 
+/*!
+ Returns the outline of the path as it would be stroked with its line width, cap and join styles, miter limit, and dash pattern. Filling the result with the nonzero winding rule paints what stroking the path would. The outline is built by AJRBezierPathByStrokingPath(), without Core Graphics, to within a tenth of the path's flatness, and is cached until the path or its stroke attributes change.
+ */
 - (AJRBezierPath *)bezierPathFromStrokedPath;
 
 #pragma mark - Applying the path to the current context
@@ -354,7 +501,75 @@ typedef CGPoint (^AJRBezierPathPointTransform)(CGPoint point);
  */
 - (NSArray<AJRIntersection *> *)intersectionsWithLine:(AJRLine)line error:(double)error;
 
-- (NSArray *)subrectanglesContainedInRect:(CGRect)proposedRect error:(CGFloat)error lineSweep:(NSLineSweepDirection)sweepDirection minimumSize:(CGFloat)minSize;
+/*!
+ Finds the same intersections as -intersectionsWithLine:error:, but appends them to buffer as plain records, rather than creating an object for each. Their segments are the indexes of the elements they fall on, and they're appended in path order. Reuse the buffer across calls, such as for each scanline of a fill, and this won't allocate at all once the buffer is big enough.
+
+ @param line The line to intersect across the path.
+ @param buffer The buffer to append to. Its existing contents are left alone.
+
+ @returns The number of intersections appended.
+ */
+- (NSUInteger)appendIntersectionsWithLine:(AJRLine)line toBuffer:(AJRIntersectionBuffer *)buffer;
+
+/*!
+ Intersects the path with many horizontal lines at once, such as the scanlines of a fill, or the lines of text being flowed into a shape. Rather than walking the whole path once per line, this makes a single pass over the path's monotone pieces, each of which can only cross a contiguous run of the lines, and only once each.
+
+ The intersections with ys[i] are appended to buffers[i], sorted from left to right. A line through a vertex meets only one of the pieces that share it, and horizontal pieces aren't crossed, so along each line the crossings alternate properly for filling. Open subpaths are treated as closed, as they are when filled, and crossings with the closing edge have a segment of NSNotFound.
+
+ @param ys The heights of the lines, in ascending order.
+ @param count The number of lines.
+ @param buffers An array of count buffers to append to.
+ */
+- (void)appendIntersectionsWithHorizontalLinesAt:(const CGFloat *)ys count:(NSUInteger)count toBuffers:(AJRIntersectionBuffer *)buffers NS_SWIFT_NAME(appendIntersectionsWithHorizontalLines(at:count:toBuffers:));
+
+/*!
+ Like -appendIntersectionsWithHorizontalLinesAt:count:toBuffers:, but for lines running in any direction. Each line is offset from the origin by offsets[i], measured to the left of direction, so a direction of (1, 0) makes the offsets y values. The crossings are sorted in the direction of the lines, and their directions are given as though the lines were horizontal.
+
+ @param direction The direction the lines run in.
+ @param offsets The offsets of the lines, in ascending order.
+ @param count The number of lines.
+ @param buffers An array of count buffers to append to.
+ */
+- (void)appendIntersectionsWithParallelLinesAlong:(CGVector)direction offsets:(const CGFloat *)offsets count:(NSUInteger)count toBuffers:(AJRIntersectionBuffer *)buffers NS_SWIFT_NAME(appendIntersectionsWithParallelLines(along:offsets:count:toBuffers:));
+
+/*!
+ Finds, for many horizontal bands at once, the widest rectangles spanning each band's full height that fit inside the path. The bands run from baselines[i] to baselines[i] + height, and each band's rectangles are passed to block from left to right. This is what's needed to flow lines of text into a shape. The rectangles never cross the path's outline, even where it runs through the inside of the fill, as it does where overlapping subpaths cross.
+
+ @param baselines The bottoms of the bands, in ascending order.
+ @param count The number of bands.
+ @param height The height of every band.
+ @param block Called with the index of the band and one of its rectangles. Set stop to YES to stop early.
+ */
+- (void)enumerateInscribedRectanglesWithBaselines:(const CGFloat *)baselines count:(NSUInteger)count height:(CGFloat)height usingBlock:(void (^)(NSUInteger index, CGRect rect, BOOL *stop))block NS_SWIFT_NAME(enumerateInscribedRectangles(withBaselines:count:height:using:));
+
+/*!
+ Tiles the part of proposedRect that's inside the path with rectangles that don't overlap. This works as a sweep: the rect is cut into bands across the sweep direction wherever a piece of the path starts or ends, and wherever a slanted or curved piece has moved sideways by more than error. The widest rectangles inside the path are found for every band at once, and rectangles that line up exactly from one band to the next are joined, so straight edged parts of the shape come out as single tiles.
+
+ @param proposedRect The area to tile.
+ @param error How much of the shape each band may give up along a slanted or curved edge. If error is 0.0, the path's flatness is used.
+ @param sweepDirection The direction the bands advance in. NSLineSweepDown advances toward larger y, and NSLineSweepRight toward larger x. The tiles are returned in the order the sweep reaches them.
+ @param minSize The smallest width and height a tile may have. Bands are never made thinner than this, and narrower tiles are dropped.
+
+ @returns An array of NSValues holding the tiles.
+ */
+- (NSArray<NSValue *> *)subrectanglesContainedInRect:(CGRect)proposedRect error:(CGFloat)error lineSweep:(NSLineSweepDirection)sweepDirection minimumSize:(CGFloat)minSize NS_SWIFT_NAME(subrectangles(containedIn:error:lineSweep:minimumSize:));
+
+/*!
+ Finds every point where the receiver's outline crosses path's outline. Both paths keep a bounding box tree over their monotone pieces, and the trees are walked together, so only pieces whose boxes overlap are ever compared. Lines are intersected with curves exactly, and pairs of curves are split in half until they're flat enough to treat as lines, which gives answers well within a millionth of the paths' size. Only the drawn elements count, so the implicit closing edges of open subpaths are ignored, and where the outlines run along each other, rather than crossing, nothing is reported.
+
+ @param path The path to intersect with the receiver.
+ @param buffer If not NULL, the crossings are appended here as seen from the receiver, sorted by element index and then t.
+ @param otherBuffer If not NULL, the same crossings are appended here as seen from path, in the same order as buffer, so the records at the same index describe the same point.
+
+ @returns The number of crossings found. If both buffers are NULL, this stops at the first crossing, and returns 1 if there is one.
+ */
+- (NSUInteger)appendIntersectionsWithPath:(AJRBezierPath *)path toBuffer:(nullable AJRIntersectionBuffer *)buffer otherBuffer:(nullable AJRIntersectionBuffer *)otherBuffer NS_SWIFT_NAME(appendIntersections(with:toBuffer:otherBuffer:));
+
+/*! Returns an AJRIntersection for each point where the receiver's outline crosses path's, as described for -appendIntersectionsWithPath:toBuffer:otherBuffer:. Their segments are the receiver's element indexes. */
+- (NSArray<AJRIntersection *> *)intersectionsWithPath:(AJRBezierPath *)path NS_SWIFT_NAME(intersections(with:));
+
+/*! Returns YES if the receiver's outline crosses or touches path's. This stops at the first crossing found, so it's much cheaper than finding them all. */
+- (BOOL)outlineIntersectsPath:(AJRBezierPath *)path NS_SWIFT_NAME(outlineIntersects(_:));
 
 - (AJRBezierPath *)pathByUnioningWithPath:(id <AJRBezierPathProtocol>)path NS_SWIFT_NAME(unioning(with:));
 - (AJRBezierPath *)pathByIntersectingWithPath:(id <AJRBezierPathProtocol>)path NS_SWIFT_NAME(intersecting(with:));
@@ -381,7 +596,9 @@ extern NSArray *AJRBezierPathGetSubcomponents(id <AJRBezierPathProtocol> path);
 @property (nonatomic,readonly) NSBezierPath *asBezierPath;
 
 /*!
- Builds and returns a CGPath based on the receiver. This is useful for interoperating with some of the underlying CoreGraphics libraries.
+ Returns a CGPath matching the receiver. This is useful for interoperating with some of the underlying CoreGraphics libraries.
+
+ The CGPath is built the first time it's asked for, and then cached until the receiver changes, so asking for it repeatedly is cheap. It belongs to the receiver, so don't release it. If you need it to outlive the receiver, or to survive the receiver changing, retain it.
  */
 @property (nonatomic,readonly) CGPathRef CGPath;
 
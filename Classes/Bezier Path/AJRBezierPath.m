@@ -33,17 +33,138 @@
 
 #import "AJRBezierCurves.h"
 #import "AJRBezierPathFunctions.h"
+#import "AJRFlattenedPath.h"
 #import "AJRGraphicsUtilities.h"
 #import "AJRIntersection.h"
+#import "AJRPathAnalyzer.h"
 #import "AJRPathEnumerator.h"
 
 #import <AJRFoundation/AJRFoundation.h>
 #import <AJRInterfaceFoundation/AJRInterfaceFoundation-Swift.h>
+#import <CoreText/CoreText.h>
+#import <libkern/OSByteOrder.h>
+#import <pthread.h>
+#import <stdatomic.h>
 
 //extern void CGContextResetClip(CGContextRef context);
 
 const CGFloat AJRHairLineWidth = 0.0;
 
+/*
+ Copies of a path share its points and elements until one of them changes. The paths sharing a set of buffers each point straight at them, and also share one of these, which counts them. A path with no storage record owns its buffers outright.
+
+ The points may also be borrowed from some other object, such as the data a path was loaded from, in which case pointsOwner keeps that object alive and the points are never written to or freed.
+ */
+typedef struct _ajrBezierPathStorage {
+    atomic_long referenceCount;
+    CFTypeRef pointsOwner;
+} AJRBezierPathStorage;
+
+static AJRBezierPathStorage *AJRBezierPathStorageCreate(CFTypeRef pointsOwner) {
+    AJRBezierPathStorage *storage = NSZoneMalloc(nil, sizeof(AJRBezierPathStorage));
+    atomic_init(&storage->referenceCount, 1);
+    storage->pointsOwner = pointsOwner;
+    return storage;
+}
+
+static void AJRBezierPathStorageRetain(AJRBezierPathStorage *storage) {
+    atomic_fetch_add_explicit(&storage->referenceCount, 1, memory_order_relaxed);
+}
+
+// Drops one reference, and if it was the last, frees the buffers along with the record.
+static void AJRBezierPathStorageRelease(AJRBezierPathStorage *storage, CGPoint *points, AJRBezierPathElement *elements, NSUInteger *elementToPointIndex) {
+    if (atomic_fetch_sub_explicit(&storage->referenceCount, 1, memory_order_acq_rel) == 1) {
+        if (storage->pointsOwner) {
+            CFRelease(storage->pointsOwner);
+        } else if (points) {
+            NSZoneFree(nil, points);
+        }
+        if (elements) NSZoneFree(nil, elements);
+        if (elementToPointIndex) NSZoneFree(nil, elementToPointIndex);
+        NSZoneFree(nil, storage);
+    }
+}
+
+// How many levels of detail one path keeps in the flattened path cache at once.
+#define AJRFlattenedPathMaxLevels 4
+
+// Stands for one of a path's flattenings in the flattened path cache. Keys compare by identity, so a path's flattenings can't be confused with anyone else's, even after the path is gone.
+@interface AJRFlattenedPathKey : NSObject
+@property (nonatomic,readonly) int level;
+@end
+
+@implementation AJRFlattenedPathKey
+
+- (instancetype)initWithLevel:(int)level {
+    if ((self = [super init])) {
+        _level = level;
+    }
+    return self;
+}
+
+@end
+
+static NSCache<AJRFlattenedPathKey *, AJRFlattenedPath *> *AJRFlattenedPathCache(void) {
+    static NSCache *cache = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        cache = [[NSCache alloc] init];
+        cache.name = @"AJRFlattenedPathCache";
+        cache.totalCostLimit = 32 * 1024 * 1024;
+    });
+    return cache;
+}
+
+// Identifies a glyph's outline in the glyph outline cache. The descriptor takes in everything about the font other than its size, including any matrix it's drawn with.
+@interface AJRGlyphOutlineKey : NSObject
+- (instancetype)initWithFontDescriptor:(NSFontDescriptor *)fontDescriptor pointSize:(CGFloat)pointSize glyph:(CGGlyph)glyph;
+@end
+
+@implementation AJRGlyphOutlineKey {
+    NSFontDescriptor *_fontDescriptor;
+    CGFloat _pointSize;
+    CGGlyph _glyph;
+    NSUInteger _hash;
+}
+
+- (instancetype)initWithFontDescriptor:(NSFontDescriptor *)fontDescriptor pointSize:(CGFloat)pointSize glyph:(CGGlyph)glyph {
+    if ((self = [super init])) {
+        _fontDescriptor = fontDescriptor;
+        _pointSize = pointSize;
+        _glyph = glyph;
+        _hash = [fontDescriptor hash] ^ ((NSUInteger)(pointSize * 64.0) << 16) ^ glyph;
+    }
+    return self;
+}
+
+- (NSUInteger)hash {
+    return _hash;
+}
+
+- (BOOL)isEqual:(id)other {
+    if (self == other) {
+        return YES;
+    }
+    if (![other isKindOfClass:[AJRGlyphOutlineKey class]]) {
+        return NO;
+    }
+    AJRGlyphOutlineKey *key = other;
+    return _glyph == key->_glyph && _pointSize == key->_pointSize && [_fontDescriptor isEqual:key->_fontDescriptor];
+}
+
+@end
+
+static NSCache<AJRGlyphOutlineKey *, AJRBezierPath *> *AJRGlyphOutlineCache(void) {
+    static NSCache *cache = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        cache = [[NSCache alloc] init];
+        cache.name = @"AJRGlyphOutlineCache";
+        cache.totalCostLimit = 4 * 1024 * 1024;
+    });
+    return cache;
+}
+
 @implementation AJRBezierPath
 
 #pragma mark - Global State
@@ -80,7 +201,76 @@ static CGFloat _ajrDefaultDashOffset = 0.0;
     return self;
 }
 
+- (void)dealloc {
+    [self _discardCachedGeometry];
+    [self _releaseStorage];
+    if (_dashValues) NSZoneFree(nil, _dashValues);
+}
+
+- (void)_releaseStorage {
+    if (_storage == NULL) {
+        if (_points) NSZoneFree(nil, _points);
+        if (_elements) NSZoneFree(nil, _elements);
+        if (_elementToPointIndex) NSZoneFree(nil, _elementToPointIndex);
+    } else {
+        AJRBezierPathStorageRelease(_storage, _points, _elements, _elementToPointIndex);
+    }
+    _storage = NULL;
+    _points = NULL;
+    _elements = NULL;
+    _elementToPointIndex = NULL;
+}
+
+- (void)_prepareForMutation {
+    if (_storage != NULL) {
+        if (_storage->pointsOwner == NULL && atomic_load_explicit(&_storage->referenceCount, memory_order_acquire) == 1) {
+            // Everyone else has let go, so the buffers are ours now.
+            NSZoneFree(nil, _storage);
+        } else {
+            CGPoint *points = NSZoneMalloc(nil, _currentMaxPoints * sizeof(CGPoint));
+            AJRBezierPathElement *elements = NSZoneMalloc(nil, _currentMaxElements * sizeof(AJRBezierPathElement));
+            NSUInteger *elementToPointIndex = NSZoneMalloc(nil, _currentMaxElements * sizeof(NSUInteger));
+            
+            memcpy(points, _points, _pointCount * sizeof(CGPoint));
+            memcpy(elements, _elements, _elementCount * sizeof(AJRBezierPathElement));
+            memcpy(elementToPointIndex, _elementToPointIndex, _elementCount * sizeof(NSUInteger));
+            // If the other sharers went away while we were copying, this frees the old buffers.
+            AJRBezierPathStorageRelease(_storage, _points, _elements, _elementToPointIndex);
+            _points = points;
+            _elements = elements;
+            _elementToPointIndex = elementToPointIndex;
+        }
+        _storage = NULL;
+    }
+}
+
+- (void)_shareStorageWithPath:(AJRBezierPath *)other {
+    // Copying may happen on several threads at once, even though nothing is changing the path.
+    os_unfair_lock_lock(&other->_cacheLock);
+    if (other->_storage == NULL) {
+        other->_storage = AJRBezierPathStorageCreate(NULL);
+    }
+    AJRBezierPathStorageRetain(other->_storage);
+    // The same geometry makes the same CGPath, and it's immutable, so we can share that, too.
+    CGPathRef path = CGPathRetain(other->_CGPath);
+    os_unfair_lock_unlock(&other->_cacheLock);
+    
+    CGPathRelease(_CGPath);
+    _CGPath = path;
+    
+    _storage = other->_storage;
+    _points = other->_points;
+    _elements = other->_elements;
+    _elementToPointIndex = other->_elementToPointIndex;
+    _currentMaxPoints = other->_currentMaxPoints;
+    _currentMaxElements = other->_currentMaxElements;
+    _pointCount = other->_pointCount;
+    _elementCount = other->_elementCount;
+    _moveToOffset = other->_moveToOffset;
+}
+
 - (void)_setCoordinateMaxCount:(NSUInteger)max {
+    [self _prepareForMutation];
     _currentMaxPoints = max;
     if (!_points) {
         _points = NSZoneMalloc(nil, _currentMaxPoints * sizeof(CGPoint));
@@ -89,17 +279,26 @@ static CGFloat _ajrDefaultDashOffset = 0.0;
     }
 }
 
-- (void)_increaseCoordinateCountBy:(NSUInteger)count {
-    NSInteger temp = _currentMaxPoints;
+// Grows by half again each time we run out of room, so building a path point by point costs amortized constant time per point.
+static inline NSUInteger AJRBezierPathGrownCapacity(NSUInteger current, NSUInteger required) {
+    NSUInteger grown = current + current / 2;
     
-    while (temp < _pointCount + count) {
-        temp += 8;
+    if (grown < 16) {
+        grown = 16;
+    }
+    return grown < required ? required : grown;
+}
+
+- (void)_increaseCoordinateCountBy:(NSUInteger)count {
+    if (_pointCount + count > _currentMaxPoints) {
+        [self _setCoordinateMaxCount:AJRBezierPathGrownCapacity(_currentMaxPoints, _pointCount + count)];
+    } else {
+        [self _prepareForMutation];
     }
-    
-    [self _setCoordinateMaxCount:temp];
 }
 
 - (void)_setOperationMaxCount:(NSUInteger)max {
+    [self _prepareForMutation];
     if (_currentMaxElements != max) {
         _currentMaxElements = max;
         if (!_elements) {
@@ -113,16 +312,15 @@ static CGFloat _ajrDefaultDashOffset = 0.0;
 }
 
 - (void)_increaseOperationCountBy:(NSUInteger)count {
-    NSInteger temp = _currentMaxElements;
-    
-    while (temp < _elementCount + count) {
-        temp += 8;
+    if (_elementCount + count > _currentMaxElements) {
+        [self _setOperationMaxCount:AJRBezierPathGrownCapacity(_currentMaxElements, _elementCount + count)];
+    } else {
+        [self _prepareForMutation];
     }
-    
-    [self _setOperationMaxCount:temp];
 }
 
 - (void)_unionRectWithBoundingBox:(CGRect)rect {
+    [self _prepareForMutation];
     if (_hasBoundingBox) {
         if (_points[0].x > rect.origin.x) {
             _points[0].x = rect.origin.x;
@@ -144,6 +342,7 @@ static CGFloat _ajrDefaultDashOffset = 0.0;
 }
 
 - (void)_intersectPointWithBounds:(CGPoint)aPoint forMoveTo:(BOOL)flag {
+    [self _prepareForMutation];
     if (flag && (_elementCount <= 2)) {
         _points[0] = aPoint;
         _points[1] = aPoint;
@@ -168,6 +367,7 @@ static CGFloat _ajrDefaultDashOffset = 0.0;
 - (void)_updateBoundingBox {
     NSInteger x;
     
+    [self _prepareForMutation];
     if (_pointCount > 2) {
         _points[0] = _points[2];
         _points[1] = _points[2];
@@ -192,6 +392,205 @@ static CGFloat _ajrDefaultDashOffset = 0.0;
     [self setBoundsAreValid:NO];
 }
 
+- (void)_includeElementInBounds:(NSUInteger)elementIndex {
+    CGPoint current = CGPointZero;
+    CGPoint subpathStart = _points[_moveToOffset];
+    
+    if (_elements[elementIndex] == AJRBezierPathElementClose) {
+        current = _points[_pointCount - 1];
+    } else if (_elements[elementIndex - 1] != AJRBezierPathElementSetBoundingBox) {
+        // Every element's points directly follow the points of the element before it, so the last of those is where we start.
+        current = _points[_elementToPointIndex[elementIndex] - 1];
+    }
+    _bounds = CGRectUnion(_bounds, AJRelementbounds(_elements[elementIndex], current, subpathStart, _points + _elementToPointIndex[elementIndex]));
+    _boundsValid = YES;
+}
+
+- (void)_discardCachedGeometry {
+    if (_segmentTable) {
+        AJRPathSegmentTableFree(_segmentTable);
+        _segmentTable = NULL;
+    }
+    if (_lengthTable) {
+        AJRPathLengthTableFree(_lengthTable);
+        _lengthTable = NULL;
+    }
+    [self _discardCGPath:&_CGPath];
+    [self _discardCGPath:&_fillCGPath];
+    [self _discardCGPath:&_strokeCGPath];
+    [self _discardFlattenedPaths];
+    [self _discardCachedStroke];
+}
+
+- (void)_discardCachedStroke {
+    os_unfair_lock_lock(&_cacheLock);
+    _strokeBoundsValid = NO;
+    _strokedPath = nil;
+    _strokeGeneration += 1;
+    os_unfair_lock_unlock(&_cacheLock);
+}
+
+- (CGFloat)_effectiveFlatness {
+    // Flatness is measured in device space, like Core Graphics does. A flatness of 0 asks for the most accurate rendering, which for us is a tenth of a device pixel.
+    return _flatness > 0.0 ? _flatness : 0.1;
+}
+
+- (void)_discardCGPath:(CGPathRef *)cache {
+    if (*cache) {
+        CGPathRelease(*cache);
+        *cache = NULL;
+    }
+}
+
+- (CGPathRef)_CGPathForCache:(CGPathRef *)cache pointTransform:(AJRBezierPathPointTransform)pointTransform {
+    CGPathRef path;
+    
+    os_unfair_lock_lock(&_cacheLock);
+    if (*cache == NULL) {
+        *cache = AJRcreatepath(_points, _pointCount, _elements, _elementCount, pointTransform);
+    }
+    path = *cache;
+    os_unfair_lock_unlock(&_cacheLock);
+    
+    return path;
+}
+
+- (CGPathRef)_CGPathForFill {
+    return _fillPointTransform ? [self _CGPathForCache:&_fillCGPath pointTransform:_fillPointTransform] : self.CGPath;
+}
+
+- (CGPathRef)_CGPathForStroke {
+    return _strokePointTransform ? [self _CGPathForCache:&_strokeCGPath pointTransform:_strokePointTransform] : self.CGPath;
+}
+
+- (void)_getPoints:(const CGPoint **)points elements:(const AJRBezierPathElement **)elements {
+    *points = _points;
+    *elements = _elements;
+}
+
+- (AJRPathSegmentTable *)_pathSegmentTable {
+    AJRPathSegmentTable *table;
+    
+    os_unfair_lock_lock(&_cacheLock);
+    if (_segmentTable == NULL) {
+        _segmentTable = AJRPathSegmentTableCreate(_points, _pointCount, _elements, _elementCount);
+    }
+    table = _segmentTable;
+    os_unfair_lock_unlock(&_cacheLock);
+    
+    return table;
+}
+
+- (AJRPathLengthTable *)_pathLengthTable {
+    AJRPathLengthTable *table;
+    
+    os_unfair_lock_lock(&_cacheLock);
+    if (_lengthTable == NULL) {
+        _lengthTable = AJRPathLengthTableCreate(_points, _pointCount, _elements, _elementCount);
+    }
+    table = _lengthTable;
+    os_unfair_lock_unlock(&_cacheLock);
+    
+    return table;
+}
+
+#pragma mark - Levels of Detail
+
++ (NSUInteger)flattenedPathCacheLimit {
+    return AJRFlattenedPathCache().totalCostLimit;
+}
+
++ (void)setFlattenedPathCacheLimit:(NSUInteger)limit {
+    AJRFlattenedPathCache().totalCostLimit = limit;
+}
+
+- (void)_discardFlattenedPaths {
+    if (_flattenedPathKeys.count) {
+        NSCache *cache = AJRFlattenedPathCache();
+        for (AJRFlattenedPathKey *key in _flattenedPathKeys) {
+            [cache removeObjectForKey:key];
+        }
+        [_flattenedPathKeys removeAllObjects];
+    }
+}
+
+// Looks up the flattening for level, and moves it to the front of our levels. Returns the level's key in key, if we have one, even when the cache has thrown out its flattening. Call with _cacheLock held.
+- (AJRFlattenedPath *)_cachedFlattenedPathAtLevel:(int)level key:(AJRFlattenedPathKey **)key {
+    *key = nil;
+    for (NSUInteger x = 0; x < _flattenedPathKeys.count; x++) {
+        if (((AJRFlattenedPathKey *)_flattenedPathKeys[x]).level == level) {
+            *key = _flattenedPathKeys[x];
+            if (x > 0) {
+                [_flattenedPathKeys removeObjectAtIndex:x];
+                [_flattenedPathKeys insertObject:*key atIndex:0];
+            }
+            return [AJRFlattenedPathCache() objectForKey:*key];
+        }
+    }
+    return nil;
+}
+
+- (AJRFlattenedPath *)flattenedPathWithTolerance:(CGFloat)tolerance {
+    AJRFlattenedPathKey *key;
+    AJRFlattenedPath *flattened;
+    int level;
+    
+    if (!(tolerance > 0.0) || isinf(tolerance)) {
+        [NSException raise:NSInvalidArgumentException format:@"A path can't be flattened to a tolerance of %g.", tolerance];
+    }
+    // Round down to a power of two, so we're never coarser than asked, and nearby tolerances share a flattening.
+    level = ilogb(tolerance);
+    
+    os_unfair_lock_lock(&_cacheLock);
+    flattened = [self _cachedFlattenedPathAtLevel:level key:&key];
+    os_unfair_lock_unlock(&_cacheLock);
+    
+    if (flattened == nil) {
+        // Either we've never made this level, or the cache threw it out to make room. Flattening can take a while, so it's done without the lock, which leaves our other caches free meanwhile.
+        AJRFlattenedPath *made = [[AJRFlattenedPath alloc] initWithPath:self tolerance:ldexp(1.0, level)];
+        
+        os_unfair_lock_lock(&_cacheLock);
+        // Another thread may have made the same level while we weren't looking, in which case we use theirs, so that every caller shares one.
+        flattened = [self _cachedFlattenedPathAtLevel:level key:&key];
+        if (flattened == nil) {
+            NSCache *cache = AJRFlattenedPathCache();
+            
+            if (key == nil) {
+                if (_flattenedPathKeys == nil) {
+                    _flattenedPathKeys = [[NSMutableArray alloc] init];
+                }
+                if (_flattenedPathKeys.count == AJRFlattenedPathMaxLevels) {
+                    [cache removeObjectForKey:_flattenedPathKeys.lastObject];
+                    [_flattenedPathKeys removeLastObject];
+                }
+                key = [[AJRFlattenedPathKey alloc] initWithLevel:level];
+                [_flattenedPathKeys insertObject:key atIndex:0];
+            }
+            [cache setObject:made forKey:key cost:made.byteCount];
+            flattened = made;
+        }
+        os_unfair_lock_unlock(&_cacheLock);
+    }
+    
+    return flattened;
+}
+
+- (AJRFlattenedPath *)flattenedPathForScale:(CGFloat)scale {
+    return [self flattenedPathWithTolerance:[self _effectiveFlatness] / MAX(scale, 1.0e-6)];
+}
+
+- (AJRFlattenedPath *)flattenedPathForCurrentScale {
+    return [self flattenedPathForScale:AJRGetCurrentScale()];
+}
+
+- (AJRBezierPath *)bezierPathBySimplifyingWithTolerance:(CGFloat)tolerance {
+    return [[[AJRPathAnalyzer alloc] initWithPath:self] simplifiedPathWithTolerance:tolerance];
+}
+
+- (AJRPathLevelsOfDetail *)levelsOfDetailWithFinestTolerance:(CGFloat)tolerance levelCount:(NSInteger)levelCount {
+    return [[AJRPathLevelsOfDetail alloc] initWithPath:self finestTolerance:tolerance levelCount:levelCount];
+}
+
 // Not thread safe!
 //+ (AJRBezierPath *)_bezierPathWithRect:(CGRect)rect {
 //    static AJRBezierPath *path = nil;
@@ -250,6 +649,16 @@ static CGFloat _ajrDefaultDashOffset = 0.0;
 - (void)appendBezierPath:(AJRBezierPath *)path {
     NSInteger x;
     
+    if (_elementCount <= 1 && path != self && path->_elementCount > 1) {
+        // We don't have anything of our own yet, so we can just share path's storage, rather than copying it.
+        [self _releaseStorage];
+        [self _shareStorageWithPath:path];
+        _hasCurves = path->_hasCurves;
+        _hasBoundingBox = path->_hasBoundingBox;
+        [self setBoundsAreValid:NO];
+        return;
+    }
+    
     [self _increaseOperationCountBy:path->_elementCount - 1];
     [self _increaseCoordinateCountBy:path->_pointCount - 2];
     
@@ -445,54 +854,109 @@ static inline void AJR_UNUSED _ajrCheckFrame(CGRect *frame, CGPoint *point) {
     [self setBoundsAreValid:NO];
 }
 
-- (void)_appendBezierPath:(NSBezierPath *)path {
-    NSInteger x, max;
-    CGPoint somePoints[4];
++ (NSUInteger)glyphOutlineCacheLimit {
+    return AJRGlyphOutlineCache().totalCostLimit;
+}
+
++ (void)setGlyphOutlineCacheLimit:(NSUInteger)limit {
+    AJRGlyphOutlineCache().totalCostLimit = limit;
+}
+
+// Returns the outline of glyph in font, drawn at the origin. Outlines come from the glyph outline cache when they can, so each one is only pulled out of the font once. The paths handed back are shared, and must never be changed.
++ (AJRBezierPath *)_outlineForGlyph:(CGGlyph)glyph inFont:(CTFontRef)font fontDescriptor:(NSFontDescriptor *)fontDescriptor {
+    NSCache *cache = AJRGlyphOutlineCache();
+    AJRGlyphOutlineKey *key = [[AJRGlyphOutlineKey alloc] initWithFontDescriptor:fontDescriptor pointSize:CTFontGetSize(font) glyph:glyph];
+    AJRBezierPath *outline = [cache objectForKey:key];
     
-    for (x = 0, max = [path elementCount]; x < max; x++) {
-        switch ([path elementAtIndex:x associatedPoints:somePoints]) {
-            case NSBezierPathElementMoveTo:
-                [self moveToPoint:somePoints[0]];
-                break;
-            case NSBezierPathElementLineTo:
-                [self lineToPoint:somePoints[0]];
-                break;
-            case NSBezierPathElementCubicCurveTo:
-                [self curveToPoint:somePoints[2] controlPoint1:somePoints[0] controlPoint2:somePoints[1]];
-                break;
-            case NSBezierPathElementQuadraticCurveTo:
-                [self curveToPoint:somePoints[1] controlPoint:somePoints[0]];
-                break;
-            case NSBezierPathElementClosePath:
-                [self closePath];
-                break;
+    if (outline == nil) {
+        CGPathRef path = CTFontCreatePathForGlyph(font, glyph, NULL);
+        
+        // Glyphs such as spaces have no outline, and come back NULL. They're cached all the same, so we don't keep asking.
+        outline = [[AJRBezierPath alloc] init];
+        if (path != NULL) {
+            [outline appendBezierPathWithCGPath:path];
+            CGPathRelease(path);
         }
+        // Two threads can both miss on the same glyph, in which case they both make the same outline, and it doesn't matter whose is kept.
+        [cache setObject:outline forKey:key cost:outline->_pointCount * sizeof(CGPoint) + outline->_elementCount * sizeof(AJRBezierPathElement)];
     }
     
-    [self setBoundsAreValid:NO];
+    return outline;
 }
 
-static NSImage *_ajrHack = nil;
+- (void)_appendBezierPath:(AJRBezierPath *)path offset:(CGPoint)offset {
+    // Skip the other path's bounding box.
+    NSUInteger pointCount = path->_pointCount - 2;
+    NSUInteger elementCount = path->_elementCount - 1;
+    CGPoint stackPoints[256];
+    CGPoint *points = stackPoints;
+    
+    if (elementCount == 0) {
+        return;
+    }
+    
+    if (pointCount > 256) {
+        points = (CGPoint *)NSZoneMalloc(NULL, pointCount * sizeof(CGPoint));
+    }
+    for (NSUInteger x = 0; x < pointCount; x++) {
+        points[x].x = path->_points[x + 2].x + offset.x;
+        points[x].y = path->_points[x + 2].y + offset.y;
+    }
+    [self appendElements:path->_elements + 1 count:elementCount points:points count:pointCount];
+    
+    if (points != stackPoints) {
+        NSZoneFree(NULL, points);
+    }
+}
+
+- (void)_appendOutlineOfGlyphs:(const CGGlyph *)glyphs positions:(const CGPoint *)positions count:(NSInteger)count inFont:(CTFontRef)font origin:(CGPoint)origin {
+    NSFontDescriptor *fontDescriptor = [(__bridge NSFont *)font fontDescriptor];
+    
+    for (NSInteger x = 0; x < count; x++) {
+        AJRBezierPath *outline = [AJRBezierPath _outlineForGlyph:glyphs[x] inFont:font fontDescriptor:fontDescriptor];
+        [self _appendBezierPath:outline offset:(CGPoint){origin.x + positions[x].x, origin.y + positions[x].y}];
+    }
+}
 
 - (void)appendBezierPathWithCGGlyphs:(CGGlyph *)glyphs count:(NSInteger)count inFont:(NSFont *)fontObj {
-    NSBezierPath *path = [[NSBezierPath alloc] init];
+    CTFontRef font = (__bridge CTFontRef)fontObj;
+    CGPoint origin = _pointCount > 2 ? [self currentPoint] : CGPointZero;
+    CGSize stackAdvances[64];
+    CGPoint stackPositions[64];
+    CGSize *advances = stackAdvances;
+    CGPoint *positions = stackPositions;
+    CGPoint where = CGPointZero;
+    
+    if (count <= 0) {
+        return;
+    }
     
-    if (_ajrHack == nil) {
-        _ajrHack = [[NSImage alloc] initWithSize:(CGSize){10, 10}];
+    if (count > 64) {
+        advances = (CGSize *)NSZoneMalloc(NULL, count * sizeof(CGSize));
+        positions = (CGPoint *)NSZoneMalloc(NULL, count * sizeof(CGPoint));
     }
     
-    [_ajrHack lockFocus];
-    [path moveToPoint:[self currentPoint]];
-    [path appendBezierPathWithCGGlyphs:glyphs count:count inFont:fontObj];
-    [_ajrHack unlockFocus];
+    // The glyphs are set one after another along the baseline, starting at the current point.
+    CTFontGetAdvancesForGlyphs(font, kCTFontOrientationDefault, glyphs, advances, count);
+    for (NSInteger x = 0; x < count; x++) {
+        positions[x] = where;
+        where.x += advances[x].width;
+        where.y += advances[x].height;
+    }
+    [self _appendOutlineOfGlyphs:glyphs positions:positions count:count inFont:font origin:origin];
+    [self moveToPoint:(CGPoint){origin.x + where.x, origin.y + where.y}];
     
-    [self _appendBezierPath:path];
+    if (advances != stackAdvances) {
+        NSZoneFree(NULL, advances);
+        NSZoneFree(NULL, positions);
+    }
 }
 
 - (void)appendBezierPathWithOvalInRect:(CGRect)rect {
     CGFloat fractionHeight;
     CGFloat fractionWidth;
     
+    [self _prepareForMutation];
     fractionHeight = rect.size.height * .224225;
     fractionWidth = rect.size.width * .224225;
     
@@ -608,6 +1072,132 @@ static NSImage *_ajrHack = nil;
     [self setBoundsAreValid:NO];
 }
 
+- (void)reserveCapacityForElements:(NSUInteger)elementCount points:(NSUInteger)pointCount {
+    // Our counts include the bounding box, which the caller doesn't know about.
+    if (elementCount + 1 > _currentMaxElements) {
+        [self _setOperationMaxCount:elementCount + 1];
+    }
+    if (pointCount + 2 > _currentMaxPoints) {
+        [self _setCoordinateMaxCount:pointCount + 2];
+    }
+}
+
+- (void)appendElements:(const AJRBezierPathElement *)elements count:(NSUInteger)elementCount points:(const CGPoint *)points count:(NSUInteger)pointCount {
+    NSUInteger requiredPointCount = 0;
+    
+    // Check everything up front, so that bad input leaves us untouched.
+    for (NSUInteger x = 0; x < elementCount; x++) {
+        switch (elements[x]) {
+            case AJRBezierPathElementMoveTo:
+            case AJRBezierPathElementLineTo:
+                requiredPointCount += 1;
+                break;
+            case AJRBezierPathElementCubicCurveTo:
+                requiredPointCount += 3;
+                break;
+            case AJRBezierPathElementQuadraticCurveTo:
+                requiredPointCount += 2;
+                break;
+            case AJRBezierPathElementClose:
+                break;
+            default:
+                [NSException raise:NSInvalidArgumentException format:@"Element %lu has an invalid type (%ld).", (unsigned long)x, (long)elements[x]];
+        }
+    }
+    if (requiredPointCount != pointCount) {
+        [NSException raise:NSInvalidArgumentException format:@"The elements use %lu points, but %lu were given.", (unsigned long)requiredPointCount, (unsigned long)pointCount];
+    }
+    if (elementCount == 0) {
+        return;
+    }
+    
+    // Each element adds at most one element, because a close moved out of the way is made up for by the one being appended.
+    [self _increaseOperationCountBy:elementCount];
+    [self _increaseCoordinateCountBy:pointCount];
+    
+    BOOL boundsWereValid = _boundsValid;
+    [self setBoundsAreValid:NO];
+    _boundsValid = boundsWereValid;
+    
+    BOOL hasBoundingBox = _hasBoundingBox;
+    CGPoint minimum = _points[0];
+    CGPoint maximum = _points[1];
+    const CGPoint *source = points;
+    
+    // This mirrors -moveToPoint:, -lineToPoint:, the -curveToPoint: methods and -closePath, so the result is the same as calling those one at a time.
+    for (NSUInteger x = 0; x < elementCount; x++) {
+        AJRBezierPathElement element = elements[x];
+        NSUInteger elementPointCount = 0;
+        
+        if (element == AJRBezierPathElementClose) {
+            if (_elements[_elementCount - 1] != AJRBezierPathElementClose) {
+                _elements[_elementCount] = AJRBezierPathElementClose;
+                _elementToPointIndex[_elementCount] = _moveToOffset;
+                _elementCount++;
+                if (_boundsValid) {
+                    [self _includeElementInBounds:_elementCount - 1];
+                }
+            }
+            continue;
+        }
+        
+        if (element == AJRBezierPathElementMoveTo) {
+            if (_elementCount <= 2) {
+                // A leading move to starts the bounding box over.
+                hasBoundingBox = NO;
+            }
+            if (_elements[_elementCount - 1] == AJRBezierPathElementMoveTo) {
+                _points[_pointCount - 1] = *source;
+            } else {
+                _elements[_elementCount] = AJRBezierPathElementMoveTo;
+                _elementToPointIndex[_elementCount] = _pointCount;
+                _moveToOffset = _pointCount;
+                _points[_pointCount] = *source;
+                _elementCount++;
+                _pointCount++;
+            }
+            elementPointCount = 1;
+        } else {
+            NSInteger offset = _elements[_elementCount - 1] == AJRBezierPathElementClose ? -1 : 0;
+            
+            elementPointCount = element == AJRBezierPathElementLineTo ? 1 : (element == AJRBezierPathElementCubicCurveTo ? 3 : 2);
+            _elements[_elementCount + offset] = element;
+            _elementToPointIndex[_elementCount + offset] = _pointCount;
+            memcpy(_points + _pointCount, source, elementPointCount * sizeof(CGPoint));
+            _elementCount++;
+            _pointCount += elementPointCount;
+            if (element != AJRBezierPathElementLineTo) {
+                _hasCurves = YES;
+            }
+            if (offset == -1) {
+                _elements[_elementCount - 1] = AJRBezierPathElementClose;
+                _elementToPointIndex[_elementCount - 1] = _moveToOffset;
+            }
+            if (_boundsValid) {
+                [self _includeElementInBounds:_elementCount - 1 + offset];
+            }
+        }
+        
+        for (NSUInteger p = 0; p < elementPointCount; p++) {
+            if (!hasBoundingBox) {
+                minimum = source[p];
+                maximum = source[p];
+                hasBoundingBox = YES;
+            } else {
+                if (minimum.x > source[p].x) minimum.x = source[p].x;
+                if (minimum.y > source[p].y) minimum.y = source[p].y;
+                if (maximum.x < source[p].x) maximum.x = source[p].x;
+                if (maximum.y < source[p].y) maximum.y = source[p].y;
+            }
+        }
+        source += elementPointCount;
+    }
+    
+    _points[0] = minimum;
+    _points[1] = maximum;
+    _hasBoundingBox = hasBoundingBox;
+}
+
 - (void)appendBezierPathWithRect:(CGRect)rect {
     [self _increaseCoordinateCountBy:4];
     _points[_pointCount + 0] = rect.origin;
@@ -641,6 +1231,7 @@ static NSImage *_ajrHack = nil;
     CGFloat xDiameter = xRadius * 2.0;
     CGFloat yDiameter = yRadius * 2.0;
 
+    [self _prepareForMutation];
     if (xRadius == 0.0 || yRadius == 0) {
         [self appendBezierPathWithRect:rect];
     } else {
@@ -732,10 +1323,12 @@ static NSImage *_ajrHack = nil;
     
     if (_elementCount <= 1) return;
     CGContextSetFlatness(context, _flatness);
+    CGContextBeginPath(context);
+    CGContextAddPath(context, self.CGPath);
     if (_windingRule == AJRWindingRuleNonZero) {
-        AJRclip(context, _points, _pointCount, _elements, _elementCount);
+        CGContextClip(context);
     } else {
-        AJReoclip(context, _points, _pointCount, _elements, _elementCount);
+        CGContextEOClip(context);
     }
 }
 
@@ -757,10 +1350,12 @@ static NSImage *_ajrHack = nil;
     if (_elementCount <= 1) return;
     
     CGContextSetFlatness(context, _flatness);
+    CGContextBeginPath(context);
+    CGContextAddPath(context, [self _CGPathForFill]);
     if (_windingRule == AJRWindingRuleNonZero) {
-        AJRfill(context, _points, _pointCount, _elements, _elementCount, _fillPointTransform);
+        CGContextFillPath(context);
     } else {
-        AJReofill(context, _points, _pointCount, _elements, _elementCount, _fillPointTransform);
+        CGContextEOFillPath(context);
     }
 }
 
@@ -807,7 +1402,9 @@ static NSImage *_ajrHack = nil;
     }
     CGContextSetFlatness(context, _flatness);
     
-    AJRstroke(context, _points, _pointCount, _elements, _elementCount, _strokePointTransform);
+    CGContextBeginPath(context);
+    CGContextAddPath(context, [self _CGPathForStroke]);
+    CGContextStrokePath(context);
 }
 
 + (void)drawPackedGlyphs:(const char *)packedGlyphs atPoint:(CGPoint)aPoint {
@@ -834,25 +1431,29 @@ static NSImage *_ajrHack = nil;
 
 - (void)setFlatness:(CGFloat)aFlatness {
     _flatness = aFlatness;
+    // The stroked outline is only as accurate as the flatness asks.
+    [self _discardCachedStroke];
 }
 
+// The line style only changes how the path is stroked, so the geometry we've cached stays good.
 - (void)setLineCapStyle:(AJRLineCapStyle)lineCap {
     _lineCapStyle = lineCap;
+    [self _discardCachedStroke];
 }
 
 - (void)setLineJoinStyle:(AJRLineJoinStyle)lineJoinStyle {
     _lineJoinStyle = lineJoinStyle;
-    [self setBoundsAreValid:NO];
+    [self _discardCachedStroke];
 }
 
 - (void)setLineWidth:(CGFloat)width {
     _lineWidth = width;
-    [self setBoundsAreValid:NO];
+    [self _discardCachedStroke];
 }
 
 - (void)setMiterLimit:(CGFloat)limit {
     _miterLimit = limit;
-    [self setBoundsAreValid:NO];
+    [self _discardCachedStroke];
 }
 
 - (void)setLineDash:(CGFloat *)values count:(NSInteger)count phase:(CGFloat)phase {
@@ -869,6 +1470,7 @@ static NSImage *_ajrHack = nil;
         _dashCount = 0;
         _dashOffset = 0.0;
     }
+    [self _discardCachedStroke];
 }
 
 - (void)getLineDash:(CGFloat *)values count:(NSInteger *)count phase:(CGFloat *)phase {
@@ -953,84 +1555,117 @@ static NSImage *_ajrHack = nil;
 
 #pragma mark - Hit detection
 
+typedef struct _ajrHitTestContextStorage {
+    CGContextRef context;
+    uint8_t bitmap[4];
+} AJRHitTestContextStorage;
+
+static pthread_key_t _ajrHitTestContextKey;
+
+static void AJRHitTestContextStorageFree(void *value) {
+    AJRHitTestContextStorage *storage = value;
+    CGContextRelease(storage->context);
+    NSZoneFree(nil, storage);
+}
+
 CGContextRef AJRHitTestContext(void) {
-    typedef union {
-        uint8_t bytes[4];
-        struct {
-            uint8_t r, g, b ,a;
-        } components;
-    } AJRSinglePixelRGBA8Bitmap;
-    static AJRSinglePixelRGBA8Bitmap bitmap = {.components = { 0, 0, 0, 0 }};
-    static CGContextRef context = NULL;
-    
-    if (context == NULL) {
+    static dispatch_once_t onceToken;
+    AJRHitTestContextStorage *storage;
+    
+    dispatch_once(&onceToken, ^{
+        pthread_key_create(&_ajrHitTestContextKey, AJRHitTestContextStorageFree);
+    });
+    
+    // Callers set up the context's line state and path before each use, so each thread gets a context of its own, which goes away with the thread.
+    storage = pthread_getspecific(_ajrHitTestContextKey);
+    if (storage == NULL) {
         CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
-        context = CGBitmapContextCreate(bitmap.bytes, 1, 1, 8, 4, colorSpace, kCGBitmapByteOrder32Host | kCGImageAlphaPremultipliedLast);
+        storage = NSZoneCalloc(nil, 1, sizeof(AJRHitTestContextStorage));
+        storage->context = CGBitmapContextCreate(storage->bitmap, 1, 1, 8, 4, colorSpace, kCGBitmapByteOrder32Host | kCGImageAlphaPremultipliedLast);
         CGColorSpaceRelease(colorSpace);
+        pthread_setspecific(_ajrHitTestContextKey, storage);
     }
     
-    return context;
+    return storage->context;
 }
 
-- (BOOL)isHitByPath:(AJRBezierPath *)path {
-    // Maybe find a better way to do this? Right now, I'm just checking to see if the path's bounds intersect.
-    CGPathRef path1;
-    CGPathRef path2;
-    // NOTE: It's a bit heavy handed to get teh stroke path, but in the case where the path's width or height is 0, the CGPathIntersectsPath() function will return NO, even thought the "line" of the path does, in fact, intersect. This is because, presumably, the method is based on fills.
-    if (self.isClosed) {
-        path1 = self.CGPath;
-    } else {
-        path1 = self.bezierPathFromStrokedPath.CGPath;
-    }
-    if (path.isClosed) {
-        path2 = path.CGPath;
-    } else {
-        path2 = path.bezierPathFromStrokedPath.CGPath;
+// Returns YES if the start of any of path's subpaths lies in the area table fills. When two outlines don't cross, either one lies entirely inside the other, or they're apart, so one point from each subpath is enough to tell.
+static BOOL AJRPathSegmentTableContainsSubpathOfPath(AJRPathSegmentTable *table, AJRWindingRule windingRule, AJRBezierPath *path) {
+    for (NSInteger x = 1; x < path->_elementCount; x++) {
+        if (path->_elements[x] == AJRBezierPathElementMoveTo) {
+            CGPoint point = path->_points[path->_elementToPointIndex[x]];
+            // The table's bounds are a cheap reject for subpaths that are nowhere near it.
+            if (point.x >= table->bounds.origin.x && point.x <= CGRectGetMaxX(table->bounds)
+                && point.y >= table->bounds.origin.y && point.y <= CGRectGetMaxY(table->bounds)
+                && AJRPathSegmentTableContainsPoint(table, point.x, point.y, windingRule)) {
+                return YES;
+            }
+        }
     }
-    return CGPathIntersectsPath(path1, path2, NO);
+    return NO;
 }
 
-- (BOOL)isHitByPoint:(CGPoint)aPoint {
-    CGContextRef context = AJRHitTestContext();
-    BOOL hit;
-    
-    [self _setupDrawingContext:context];
-    if ([self windingRule] == AJRWindingRuleNonZero) {
-        AJRinfill(context, aPoint.x, aPoint.y, _points, _pointCount, _elements, _elementCount, &hit);
-    } else {
-        AJRineofill(context, aPoint.x, aPoint.y, _points, _pointCount, _elements, _elementCount, &hit);
+// Returns the area path covers when hit testing: its fill when it's closed, and otherwise the cached outline of its stroke. A stroke with no width has no outline, so then the path's own line is all there is to hit.
+static AJRBezierPath *AJRHitTestAreaOfPath(AJRBezierPath *path) {
+    return [path isClosed] || path->_lineWidth <= 0.0 ? path : [path _strokedOutline];
+}
+
+// Returns YES if one and two touch, where each covers its line, and its fill too when filled is YES. The outlines are intersected directly, which, unlike CGPathIntersectsPath(), also works for paths with no width or height. If they don't cross, they can still overlap by one lying inside the other's fill.
+static BOOL AJRPathAreasTouch(AJRBezierPath *one, BOOL oneIsFilled, AJRBezierPath *two, BOOL twoIsFilled) {
+    if ([one outlineIntersectsPath:two]) {
+        return YES;
     }
+    if (oneIsFilled && AJRPathSegmentTableContainsSubpathOfPath([one _pathSegmentTable], one->_windingRule, two)) {
+        return YES;
+    }
+    return twoIsFilled && AJRPathSegmentTableContainsSubpathOfPath([two _pathSegmentTable], two->_windingRule, one);
+}
+
+- (BOOL)isHitByPath:(AJRBezierPath *)path {
+    AJRBezierPath *area = AJRHitTestAreaOfPath(self);
+    AJRBezierPath *other = AJRHitTestAreaOfPath(path);
     
-    return hit;
+    return AJRPathAreasTouch(area, [area isClosed], other, [other isClosed]);
+}
+
+- (BOOL)isHitByPoint:(CGPoint)aPoint {
+    // This works directly on our points, rather than going through AJRHitTestContext(), so it's reentrant and cheap enough to call for every shape on every mouse move. The segment table lets us skip any elements that aren't level with the point.
+    return AJRPathSegmentTableContainsPoint([self _pathSegmentTable], aPoint.x, aPoint.y, _windingRule);
 }
 
 - (BOOL)isHitByRect:(CGRect)rect {
-    return [self isHitByPath:[AJRBezierPath bezierPathWithRect:rect]];
+    AJRPathSegmentTable *table = [self _pathSegmentTable];
+    
+    if ([self isClosed]) {
+        // If the outline doesn't touch the rect, the rect is either entirely inside the fill, or entirely outside it.
+        return AJRPathSegmentTableIntersectsRect(table, rect) || AJRPathSegmentTableContainsPoint(table, CGRectGetMidX(rect), CGRectGetMidY(rect), _windingRule);
+    }
+    return AJRPathSegmentTableIntersectsRect(table, CGRectInset(rect, -_lineWidth / 2.0, -_lineWidth / 2.0));
 }
 
 - (BOOL)isStrokeHitByPath:(AJRBezierPath *)path {
-    return NO;
+    AJRBezierPath *other = AJRHitTestAreaOfPath(path);
+    
+    // Our stroke covers its outline, which reaches half the line width either side of our line. Without any width, only the line itself can be hit.
+    if (_lineWidth > 0.0) {
+        return AJRPathAreasTouch([self _strokedOutline], YES, other, [other isClosed]);
+    }
+    return AJRPathAreasTouch(self, NO, other, [other isClosed]);
 }
 
 - (BOOL)isStrokeHitByPoint:(CGPoint)aPoint {
-    CGContextRef context = AJRHitTestContext();
-    BOOL hit;
-    
-    [self _setupDrawingContext:context];
-    if (self.lineWidth < 4.0) {
-        CGContextSetLineWidth(context, 4.0);
-    }
-    AJRinstroke(context, aPoint.x, aPoint.y, _points, _pointCount, _elements, _elementCount, &hit);
-    
-    return hit;
+    // Thin lines are still given a 4 point wide target, otherwise they're almost impossible to click on.
+    return AJRPathSegmentTableStrokeContainsPoint([self _pathSegmentTable], aPoint.x, aPoint.y, MAX(_lineWidth, 4.0));
 }
 
 - (BOOL)isStrokeHitByRect:(CGRect)rect {
-    return NO;
+    CGFloat outset = MAX(_lineWidth, 4.0) / 2.0;
+    return AJRPathSegmentTableIntersectsRect([self _pathSegmentTable], CGRectInset(rect, -outset, -outset));
 }
 
 - (void)curveToPoint:(CGPoint)aPoint controlPoint1:(CGPoint)controlPoint1 controlPoint2:(CGPoint)controlPoint2 {
     NSInteger offset;
+    BOOL boundsWereValid = _boundsValid;
     
     [self _intersectPointWithBounds:aPoint forMoveTo:NO];
     [self _intersectPointWithBounds:controlPoint1 forMoveTo:NO];
@@ -1052,10 +1687,14 @@ CGContextRef AJRHitTestContext(void) {
         _elements[_elementCount - 1] = AJRBezierPathElementClose;
         _elementToPointIndex[_elementCount - 1] = _moveToOffset;
     }
+    if (boundsWereValid) {
+        [self _includeElementInBounds:_elementCount - 1 + offset];
+    }
 }
 
 - (void)curveToPoint:(CGPoint)aPoint controlPoint:(CGPoint)controlPoint {
     NSInteger offset;
+    BOOL boundsWereValid = _boundsValid;
 
     [self _intersectPointWithBounds:aPoint forMoveTo:NO];
     [self _intersectPointWithBounds:controlPoint forMoveTo:NO];
@@ -1075,10 +1714,14 @@ CGContextRef AJRHitTestContext(void) {
         _elements[_elementCount - 1] = AJRBezierPathElementClose;
         _elementToPointIndex[_elementCount - 1] = _moveToOffset;
     }
+    if (boundsWereValid) {
+        [self _includeElementInBounds:_elementCount - 1 + offset];
+    }
 }
 
 - (void)lineToPoint:(CGPoint)aPoint {
     NSInteger offset;
+    BOOL boundsWereValid = _boundsValid;
     
     [self _intersectPointWithBounds:aPoint forMoveTo:NO];
     
@@ -1096,14 +1739,20 @@ CGContextRef AJRHitTestContext(void) {
         _elements[_elementCount - 1] = AJRBezierPathElementClose;
         _elementToPointIndex[_elementCount - 1] = _moveToOffset;
     }
+    if (boundsWereValid) {
+        [self _includeElementInBounds:_elementCount - 1 + offset];
+    }
 }
 
 - (void)moveToPoint:(CGPoint)point {
     //BOOL isClosed = _elements[_elementCount - 1] == AJRBezierPathElementClose;
     BOOL isClosed = NO;
     NSInteger offset = isClosed ? 2 : 1;
+    BOOL boundsWereValid = _boundsValid;
     
     [self _intersectPointWithBounds:point forMoveTo:YES];
+    // A move to doesn't draw anything, so it can't change the bounds.
+    _boundsValid = boundsWereValid;
     
     if (_elements[_elementCount - offset] == AJRBezierPathElementMoveTo) {
         _points[_pointCount - 1] = point;
@@ -1156,27 +1805,43 @@ CGContextRef AJRHitTestContext(void) {
 }
 
 - (void)removeAllPoints {
+    if (_storage != NULL) {
+        // Someone else may still need the points, and there's no sense copying them just to throw them away.
+        [self _releaseStorage];
+        _currentMaxElements = 0;
+        [self _setCoordinateMaxCount:10];
+        [self _setOperationMaxCount:9];
+    }
     _elementCount = 1;
     _pointCount = 2;
     _hasBoundingBox = NO;
     _hasCurves = NO;
     _points[0] = (CGPoint){0.0, 0.0};
     _points[1] = _points[0];
+    [self setBoundsAreValid:NO];
 }
 
 - (void)closePath {
+    [self _prepareForMutation];
     if (![self isClosed]) {
+        BOOL boundsWereValid = _boundsValid;
+        
         [self _increaseOperationCountBy:1];
         _elements[_elementCount] = AJRBezierPathElementClose;
         _elementToPointIndex[_elementCount] = _moveToOffset;
         _elementCount++;
+        [self setBoundsAreValid:NO];
+        if (boundsWereValid) {
+            [self _includeElementInBounds:_elementCount - 1];
+        }
     }
 }
 
 #pragma mark - Removing Elements
 
 - (void)removeLastElement {
-    switch (_elements[_elementCount]) {
+    [self _prepareForMutation];
+    switch (_elements[_elementCount - 1]) {
         case AJRBezierPathElementSetBoundingBox:
             [NSException raise:NSRangeException format:@"No remaining _elements to remove"];
             break;
@@ -1200,6 +1865,7 @@ CGContextRef AJRHitTestContext(void) {
             _elementCount--;
             break;
     }
+    [self _updateBoundingBox];
 }
 
 #pragma mark - Querying paths
@@ -1227,29 +1893,18 @@ void AJRExpandRect(CGRect *rect, CGPoint *point) {
 }
 
 - (CGRect)bounds {
-    if (_boundsValid) return _bounds;
+    CGRect bounds;
     
-    if (_elementCount <= 1) {
-        _bounds = NSZeroRect;
-    } else {
-        AJRPathEnumerator *enumerator = [self pathEnumerator];
-        AJRLine *line;
-        
-        line = [enumerator nextLineSegment];
-        if (line) {
-            _bounds.origin = line->start;
-            _bounds.size = (CGSize){0, 0};
-            do {
-                AJRExpandRect(&_bounds, &line->end);
-            } while ((line = [enumerator nextLineSegment]));
-        } else {
-            _bounds = NSZeroRect;
-        }
+    os_unfair_lock_lock(&_cacheLock);
+    if (!_boundsValid) {
+        // _bounds is CGRectNull while the path draws nothing, which lets _includeElementInBounds: simply union onto it.
+        _bounds = AJRpathbounds(_points, _pointCount, _elements, _elementCount);
+        _boundsValid = YES;
     }
+    bounds = _bounds;
+    os_unfair_lock_unlock(&_cacheLock);
     
-    _boundsValid = YES;
-    
-    return _bounds;
+    return CGRectIsNull(bounds) ? NSZeroRect : bounds;
 }
 
 - (CGRect)controlPointBounds {
@@ -1320,6 +1975,7 @@ void AJRExpandRect(CGRect *rect, CGPoint *point) {
 }
 
 - (void)setPointAtIndex:(NSInteger)index toPoint:(CGPoint)aPoint {
+    [self _prepareForMutation];
     if (index + 2 < _pointCount) {
         _points[index + 2] = aPoint;
         [self _updateBoundingBox];
@@ -1378,6 +2034,7 @@ void AJRExpandRect(CGRect *rect, CGPoint *point) {
 - (void)setAssociatedPoints:(CGPoint *)somePoints atIndex:(NSInteger)index {
     NSUInteger        offset;
     
+    [self _prepareForMutation];
     if (index + 1 >= _elementCount) {
         [NSException raise:NSRangeException format:@"Index %ld is out of range [0..%lu]", index, _elementCount - 1];
     }
@@ -1407,6 +2064,7 @@ void AJRExpandRect(CGRect *rect, CGPoint *point) {
         case AJRBezierPathElementClose:
             break;
     }
+    [self _updateBoundingBox];
 }
 
 #pragma mark - Path modifications
@@ -1558,6 +2216,7 @@ void AJRExpandRect(CGRect *rect, CGPoint *point) {
 - (void)transformUsingAffineTransform:(NSAffineTransform *)transform {
     NSInteger        x;
     
+    [self _prepareForMutation];
     for (x = _elementCount - 1; x >= 1; x--) {
         switch (_elements[x]) {
             case AJRBezierPathElementSetBoundingBox:
@@ -1581,11 +2240,239 @@ void AJRExpandRect(CGRect *rect, CGPoint *point) {
                 break;
         }
     }
+    [self _updateBoundingBox];
+}
+
+#pragma mark - Binary Representation
+
+/*
+ The binary representation is little-endian throughout:
+
+    0  char[4]    'AJRP'
+    4  uint16     version
+    6  uint16     header length, which is also where the element types begin
+    8  uint32     element count, not counting the bounding box
+   12  uint32     point count, counting the two bounding box points
+   16  uint8      winding rule
+   17  uint8      line cap style
+   18  uint8      line join style
+   19  uint8      flags
+   20  uint32     reserved
+   24  float64    line width
+   32  float64    miter limit
+   40  float64    flatness
+   48  uint8[]    element types, padded with zeros to a multiple of 8 bytes
+       float64[]  points, as x, y pairs
+
+ The points are laid out just like our own _points, bounding box first, so on little-endian 64-bit hosts they can be used right where they lie.
+ */
+static const char AJRBezierPathBinaryMagic[4] = {'A', 'J', 'R', 'P'};
+static const uint16_t AJRBezierPathBinaryVersion = 1;
+static const NSUInteger AJRBezierPathBinaryHeaderLength = 48;
+static const uint8_t AJRBezierPathBinaryFlagHasBoundingBox = 1 << 0;
+
+static inline NSUInteger AJRBezierPathBinaryPointsOffset(NSUInteger headerLength, NSUInteger elementCount) {
+    return (headerLength + elementCount + 7) & ~(NSUInteger)7;
+}
+
+static inline void AJRBezierPathBinaryWriteDouble(uint8_t *bytes, NSUInteger offset, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    OSWriteLittleInt64(bytes, offset, bits);
+}
+
+static inline double AJRBezierPathBinaryReadDouble(const uint8_t *bytes, NSUInteger offset) {
+    uint64_t bits = OSReadLittleInt64(bytes, offset);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
++ (instancetype)bezierPathWithBinaryRepresentation:(NSData *)data {
+    return [[self alloc] initWithBinaryRepresentation:data];
+}
+
+- (instancetype)initWithBinaryRepresentation:(NSData *)data {
+    if ((self = [super init])) {
+        // For immutable data this is just a retain, but it makes sure nobody can change the points out from under us.
+        data = [data copy];
+        if (![self _setBinaryRepresentationBytes:data.bytes length:data.length owner:data]) {
+            return nil;
+        }
+    }
+    return self;
+}
+
+- (NSData *)binaryRepresentation {
+    NSUInteger elementCount = _elementCount - 1;
+    NSUInteger pointsOffset = AJRBezierPathBinaryPointsOffset(AJRBezierPathBinaryHeaderLength, elementCount);
+    
+    if (_pointCount > UINT32_MAX) {
+        [NSException raise:NSRangeException format:@"Path has too many points (%lu) for its binary representation.", (unsigned long)_pointCount];
+    }
+    
+    NSMutableData *data = [NSMutableData dataWithLength:pointsOffset + _pointCount * 2 * sizeof(double)];
+    uint8_t *bytes = data.mutableBytes;
+    
+    memcpy(bytes, AJRBezierPathBinaryMagic, sizeof(AJRBezierPathBinaryMagic));
+    OSWriteLittleInt16(bytes, 4, AJRBezierPathBinaryVersion);
+    OSWriteLittleInt16(bytes, 6, AJRBezierPathBinaryHeaderLength);
+    OSWriteLittleInt32(bytes, 8, (uint32_t)elementCount);
+    OSWriteLittleInt32(bytes, 12, (uint32_t)_pointCount);
+    bytes[16] = (uint8_t)_windingRule;
+    bytes[17] = (uint8_t)_lineCapStyle;
+    bytes[18] = (uint8_t)_lineJoinStyle;
+    bytes[19] = _hasBoundingBox ? AJRBezierPathBinaryFlagHasBoundingBox : 0;
+    AJRBezierPathBinaryWriteDouble(bytes, 24, _lineWidth);
+    AJRBezierPathBinaryWriteDouble(bytes, 32, _miterLimit);
+    AJRBezierPathBinaryWriteDouble(bytes, 40, _flatness);
+    
+    for (NSUInteger x = 0; x < elementCount; x++) {
+        bytes[AJRBezierPathBinaryHeaderLength + x] = (uint8_t)_elements[x + 1];
+    }
+#if __LITTLE_ENDIAN__ && CGFLOAT_IS_DOUBLE
+    memcpy(bytes + pointsOffset, _points, _pointCount * sizeof(CGPoint));
+#else
+    for (NSUInteger x = 0; x < _pointCount; x++) {
+        AJRBezierPathBinaryWriteDouble(bytes, pointsOffset + x * 16, _points[x].x);
+        AJRBezierPathBinaryWriteDouble(bytes, pointsOffset + x * 16 + 8, _points[x].y);
+    }
+#endif
+    
+    return data;
+}
+
+- (BOOL)_setBinaryRepresentationBytes:(const uint8_t *)bytes length:(NSUInteger)length owner:(NSData *)owner {
+    if (bytes == NULL
+        || length < AJRBezierPathBinaryHeaderLength
+        || memcmp(bytes, AJRBezierPathBinaryMagic, sizeof(AJRBezierPathBinaryMagic)) != 0
+        || OSReadLittleInt16(bytes, 4) != AJRBezierPathBinaryVersion) {
+        return NO;
+    }
+    
+    NSUInteger headerLength = OSReadLittleInt16(bytes, 6);
+    NSUInteger elementCount = OSReadLittleInt32(bytes, 8);
+    NSUInteger pointCount = OSReadLittleInt32(bytes, 12);
+    NSUInteger pointsOffset = AJRBezierPathBinaryPointsOffset(headerLength, elementCount);
+    
+    if (headerLength < AJRBezierPathBinaryHeaderLength
+        || pointCount < 2
+        || pointsOffset > length
+        || pointCount > (length - pointsOffset) / (2 * sizeof(double))) {
+        return NO;
+    }
+    
+    // The styles and metrics go straight into our ivars, so anything we couldn't have written ourselves is refused.
+    double lineWidth = AJRBezierPathBinaryReadDouble(bytes, 24);
+    double miterLimit = AJRBezierPathBinaryReadDouble(bytes, 32);
+    double flatness = AJRBezierPathBinaryReadDouble(bytes, 40);
+    if (bytes[16] > AJRWindingRuleEvenOdd
+        || bytes[17] > AJRLineCapStyleSquare
+        || bytes[18] > AJRLineJoinStyleBeveled
+        || !isfinite(lineWidth) || lineWidth < 0.0
+        || !isfinite(miterLimit) || miterLimit < 0.0
+        || !isfinite(flatness) || flatness < 0.0) {
+        return NO;
+    }
+    
+    // Element types are stored as bytes, but we keep them in full, so they're widened here. We rebuild the element to point index as we go, which also proves the elements and points agree.
+    AJRBezierPathElement *elements = NSZoneMalloc(nil, (elementCount + 1) * sizeof(AJRBezierPathElement));
+    NSUInteger *elementToPointIndex = NSZoneMalloc(nil, (elementCount + 1) * sizeof(NSUInteger));
+    NSUInteger pointIndex = 2;
+    NSUInteger moveToOffset = 0;
+    BOOL hasCurves = NO;
+    BOOL hasCurrentPoint = NO;
+    BOOL valid = YES;
+    
+    elements[0] = AJRBezierPathElementSetBoundingBox;
+    elementToPointIndex[0] = 0;
+    for (NSUInteger x = 1; valid && x <= elementCount; x++) {
+        AJRBezierPathElement element = bytes[headerLength + x - 1];
+        elements[x] = element;
+        elementToPointIndex[x] = pointIndex;
+        switch (element) {
+            case AJRBezierPathElementMoveTo:
+                moveToOffset = pointIndex;
+                pointIndex += 1;
+                hasCurrentPoint = YES;
+                break;
+            case AJRBezierPathElementLineTo:
+                pointIndex += 1;
+                valid = hasCurrentPoint;
+                break;
+            case AJRBezierPathElementCubicCurveTo:
+                pointIndex += 3;
+                hasCurves = YES;
+                valid = hasCurrentPoint;
+                break;
+            case AJRBezierPathElementQuadraticCurveTo:
+                pointIndex += 2;
+                hasCurves = YES;
+                valid = hasCurrentPoint;
+                break;
+            case AJRBezierPathElementClose:
+                elementToPointIndex[x] = moveToOffset;
+                valid = hasCurrentPoint;
+                break;
+            default:
+                valid = NO;
+                break;
+        }
+    }
+    if (!valid || pointIndex != pointCount) {
+        NSZoneFree(nil, elements);
+        NSZoneFree(nil, elementToPointIndex);
+        return NO;
+    }
+    
+    CGPoint *points = NULL;
+    CFTypeRef pointsOwner = NULL;
+#if __LITTLE_ENDIAN__ && CGFLOAT_IS_DOUBLE
+    if (owner != nil && ((uintptr_t)(bytes + pointsOffset) % _Alignof(CGPoint)) == 0) {
+        points = (CGPoint *)(bytes + pointsOffset);
+        pointsOwner = CFBridgingRetain(owner);
+    }
+#endif
+    if (points == NULL) {
+        points = NSZoneMalloc(nil, pointCount * sizeof(CGPoint));
+        for (NSUInteger x = 0; x < pointCount; x++) {
+            points[x].x = AJRBezierPathBinaryReadDouble(bytes, pointsOffset + x * 16);
+            points[x].y = AJRBezierPathBinaryReadDouble(bytes, pointsOffset + x * 16 + 8);
+        }
+    }
+    
+    [self _releaseStorage];
+    _storage = pointsOwner ? AJRBezierPathStorageCreate(pointsOwner) : NULL;
+    _points = points;
+    _elements = elements;
+    _elementToPointIndex = elementToPointIndex;
+    _currentMaxPoints = pointCount;
+    _currentMaxElements = elementCount + 1;
+    _pointCount = pointCount;
+    _elementCount = elementCount + 1;
+    _moveToOffset = moveToOffset;
+    _hasCurves = hasCurves;
+    _hasBoundingBox = (bytes[19] & AJRBezierPathBinaryFlagHasBoundingBox) != 0;
+    _windingRule = bytes[16];
+    _lineCapStyle = bytes[17];
+    _lineJoinStyle = bytes[18];
+    _lineWidth = lineWidth;
+    _miterLimit = miterLimit;
+    _flatness = flatness;
+    [self setBoundsAreValid:NO];
+    
+    return YES;
 }
 
 #pragma mark - NSCoding
 
 - (id)initWithCoder:(NSCoder *)coder {
+    NSData *binary = [coder decodeObjectOfClass:[NSData class] forKey:@"binary"];
+    if (binary != nil) {
+        return [self initWithBinaryRepresentation:binary];
+    }
+    
+    // Archives written before the binary representation existed.
     [self _setCoordinateMaxCount:[coder decodeIntegerForKey:@"currentMaxPoints"]];
     [self _setOperationMaxCount:[coder decodeIntegerForKey:@"currentMaxElements"]];
     _moveToOffset = [coder decodeIntegerForKey:@"moveToOffset"];
@@ -1614,34 +2501,18 @@ void AJRExpandRect(CGRect *rect, CGPoint *point) {
 }
 
 - (void)encodeWithCoder:(NSCoder *)coder {
-    [coder encodeInteger:_currentMaxPoints forKey:@"currentMaxPoints"];
-    [coder encodeInteger:_currentMaxElements forKey:@"currentMaxElements"];
-    [coder encodeInteger:_moveToOffset forKey:@"moveToOffset"];
-    
-    [coder encodeInteger:_pointCount forKey:@"pointCount"];
-    for (NSInteger pointIndex = 0; pointIndex < _pointCount; pointIndex++) {
-        [coder encodePoint:_points[pointIndex] forKey:[NSString stringWithFormat:@"p%ld", pointIndex]];
-    }
-    
-    [coder encodeInteger:_elementCount forKey:@"elementCount"];
-    for (NSInteger elementIndex = 0; elementIndex < _elementCount; elementIndex++) {
-        [coder encodeInteger:_elements[elementIndex] forKey:[NSString stringWithFormat:@"e%ld", elementIndex]];
-        [coder encodeInteger:_elementToPointIndex[elementIndex] forKey:[NSString stringWithFormat:@"ei%ld", elementIndex]];
-    }
-    
-    [coder encodeInteger:_windingRule forKey:@"windingRule"];
-    [coder encodeBool:_hasCurves forKey:@"hasCurves"];
-    [coder encodeBool:_hasBoundingBox forKey:@"hasBoundingBox"];
-    [coder encodeFloat:_lineWidth forKey:@"lineWidth"];
-    [coder encodeFloat:_miterLimit forKey:@"miterLimit"];
-    [coder encodeFloat:_flatness forKey:@"flatness"];
-    [coder encodeInteger:_lineCapStyle forKey:@"lineCapStyle"];
-    [coder encodeInteger:_lineJoinStyle forKey:@"lineJoinStyle"];
+    [coder encodeObject:self.binaryRepresentation forKey:@"binary"];
 }
 
 #pragma mark - AJRXMLCoding
 
 - (void)decodeWithXMLCoder:(AJRXMLCoder *)coder {
+    [coder decodeBytesForKey:@"binary" setter:^(uint8_t *bytes, NSUInteger length) {
+        if (![self _setBinaryRepresentationBytes:bytes length:length owner:nil]) {
+            AJRLogWarning(@"Ignoring a path whose binary representation couldn't be read.");
+        }
+    }];
+    // Documents written before the binary representation existed.
     [coder decodeGroupForKey:@"elements" usingBlock:^{
         [coder decodePointForKey:@"moveTo" setter:^(CGPoint point) {
             [self moveToPoint:point];
@@ -1676,7 +2547,7 @@ void AJRExpandRect(CGRect *rect, CGPoint *point) {
                 c1.y = value;
             }];
             [coder decodeDoubleForKey:@"cx" setter:^(double value) {
-                c0.y = value;
+                c0.x = value;
                 isQuadratic = YES;
             }];
             [coder decodeDoubleForKey:@"cy" setter:^(double value) {
@@ -1714,60 +2585,9 @@ void AJRExpandRect(CGRect *rect, CGPoint *point) {
 }
 
 - (void)encodeWithXMLCoder:(AJRXMLCoder *)coder {
-    if (!self.isEmpty) {
-        [coder encodeGroupForKey:@"elements" usingBlock:^{
-            [self enumerateWithBlock:^(NSBezierPathElement element, CGPoint *points, BOOL *stop) {
-                switch (element) {
-                    case NSBezierPathElementMoveTo: {
-                        CGPoint point = points[0];
-                        [coder encodePoint:point forKey:@"moveTo"];
-                        break;
-                    }
-                    case NSBezierPathElementLineTo: {
-                        CGPoint point = points[0];
-                        [coder encodePoint:point forKey:@"lineTo"];
-                        break;
-                    }
-                    case NSBezierPathElementClosePath:
-                        [coder encodeGroupForKey:@"close" usingBlock:^{
-                        }];
-                        break;
-                    case NSBezierPathElementCubicCurveTo: {
-                        CGPoint point = points[0];
-                        CGPoint pointC0 = points[1];
-                        CGPoint pointC1 = points[2];
-                        [coder encodeGroupForKey:@"curveTo" usingBlock:^{
-                            [coder encodeString:[AJRXMLCoderGetFloatFormatter() stringFromNumber:@(point.x)] forKey:@"x"];
-                            [coder encodeString:[AJRXMLCoderGetFloatFormatter() stringFromNumber:@(point.y)] forKey:@"y"];
-                            [coder encodeString:[AJRXMLCoderGetFloatFormatter() stringFromNumber:@(pointC0.x)] forKey:@"c0x"];
-                            [coder encodeString:[AJRXMLCoderGetFloatFormatter() stringFromNumber:@(pointC0.y)] forKey:@"c0y"];
-                            [coder encodeString:[AJRXMLCoderGetFloatFormatter() stringFromNumber:@(pointC1.x)] forKey:@"c1x"];
-                            [coder encodeString:[AJRXMLCoderGetFloatFormatter() stringFromNumber:@(pointC1.y)] forKey:@"c1y"];
-                        }];
-                        break;
-                    }
-                    case NSBezierPathElementQuadraticCurveTo: {
-                        CGPoint point = points[0];
-                        CGPoint controlPoint = points[1];
-                        [coder encodeGroupForKey:@"curveTo" usingBlock:^{
-                            [coder encodeString:[AJRXMLCoderGetFloatFormatter() stringFromNumber:@(point.x)] forKey:@"x"];
-                            [coder encodeString:[AJRXMLCoderGetFloatFormatter() stringFromNumber:@(point.y)] forKey:@"y"];
-                            [coder encodeString:[AJRXMLCoderGetFloatFormatter() stringFromNumber:@(controlPoint.x)] forKey:@"cx"];
-                            [coder encodeString:[AJRXMLCoderGetFloatFormatter() stringFromNumber:@(controlPoint.y)] forKey:@"cy"];
-                        }];
-                        break;
-                    }
-                }
-            }];
-        }];
-    }
-
-    [coder encodeInteger:_windingRule forKey:@"windingRule"];
-    [coder encodeDouble:_lineWidth forKey:@"lineWidth"];
-    [coder encodeDouble:_miterLimit forKey:@"miterLimit"];
-    [coder encodeDouble:_flatness forKey:@"flatness"];
-    [coder encodeInteger:_lineCapStyle forKey:@"lineCapStyle"];
-    [coder encodeInteger:_lineJoinStyle forKey:@"lineJoinStyle"];
+    // The binary representation carries the line style too, and it's far quicker to read back than one group per element.
+    NSData *binary = self.binaryRepresentation;
+    [coder encodeBytes:(uint8_t *)binary.bytes length:binary.length forKey:@"binary"];
 }
 
 + (NSString *)ajr_nameForXMLArchiving {
@@ -1779,15 +2599,8 @@ void AJRExpandRect(CGRect *rect, CGPoint *point) {
 - (id)copyWithZone:(NSZone *)zone {
     AJRBezierPath *new = [[self class] allocWithZone:zone];
     
-    [new _setCoordinateMaxCount:_currentMaxPoints];
-    [new _setOperationMaxCount:_currentMaxElements];
-    new->_moveToOffset = _moveToOffset;
-    
-    memcpy(new->_points, _points, sizeof(CGPoint) * _pointCount);
-    new->_pointCount = _pointCount;
-    memcpy(new->_elements, _elements, sizeof(AJRBezierPathElement) * _elementCount);
-    memcpy(new->_elementToPointIndex, _elementToPointIndex, sizeof(NSUInteger) * _elementCount);
-    new->_elementCount = _elementCount;
+    // The copy shares our points and elements until one of us changes, so copying is cheap no matter how big the path is.
+    [new _shareStorageWithPath:self];
     
     new->_lineWidth = _lineWidth;
     new->_miterLimit = _miterLimit;
@@ -1840,7 +2653,7 @@ void AJRExpandRect(CGRect *rect, CGPoint *point) {
 }
 
 - (CGPathRef)CGPath {
-    return AJRcreatepath(_points, _pointCount, _elements, _elementCount, NULL);
+    return [self _CGPathForCache:&_CGPath pointTransform:NULL];
 }
 
 + (AJRBezierPath *)bezierPathWithCGPath:(CGPathRef)path {
@@ -77,6 +77,45 @@ extern void AJRinstroke(CGContextRef context,
                        CGPoint *points, NSUInteger pointCount,
                        AJRBezierPathElement *elements, NSUInteger elementCount,
                        BOOL *hit);
+
+/*!
+ Computes the winding number of the path around (x, y) directly from the path's points and elements, without building a CGPath. Curves are split where they change vertical direction and each y-monotone piece is solved for its crossing, so the answer is exact rather than dependent on flattening. Every subpath is treated as implicitly closed, as it would be when filled.
+
+ These functions don't touch any shared state, so they may be called concurrently from any number of threads.
+
+ @result The sum of the signed crossings of a ray cast from (x, y) towards +x.
+ */
+extern NSInteger AJRpathwinding(CGFloat x, CGFloat y,
+                                const CGPoint *points, NSUInteger pointCount,
+                                const AJRBezierPathElement *elements, NSUInteger elementCount);
+/*! Returns YES if (x, y) is inside the fill of the path under windingRule. */
+extern BOOL AJRpathinfill(CGFloat x, CGFloat y, AJRWindingRule windingRule,
+                          const CGPoint *points, NSUInteger pointCount,
+                          const AJRBezierPathElement *elements, NSUInteger elementCount);
+/*! Returns YES if (x, y) lies within width / 2.0 of the path's outline. Joins and caps are treated as round and dashes are ignored, which is what you want when picking a stroke with the mouse. */
+extern BOOL AJRpathinstroke(CGFloat x, CGFloat y, CGFloat width,
+                            const CGPoint *points, NSUInteger pointCount,
+                            const AJRBezierPathElement *elements, NSUInteger elementCount);
+
+/*!
+ Returns the exact bounds of a single element. currentPoint is where the element starts, subpathStart is the point the enclosing subpath began with (which is only used by close path), and points are the element's associated points. Curves contribute their extrema, not their control points. Move tos, which draw nothing, return CGRectNull.
+ */
+extern CGRect AJRelementbounds(AJRBezierPathElement element, CGPoint currentPoint, CGPoint subpathStart, const CGPoint *points);
+/*!
+ Returns the exact bounds of everything the path draws, or CGRectNull if it draws nothing. Like AJRelementbounds(), this solves for each curve's extrema, so it doesn't depend on the flatness and doesn't allocate anything.
+ */
+extern CGRect AJRpathbounds(const CGPoint *points, NSUInteger pointCount,
+                            const AJRBezierPathElement *elements, NSUInteger elementCount);
+
+/*!
+ Returns the bounds of the area the path covers when stroked with the given line width, caps, joins, and miter limit, or CGRectNull if stroking it draws nothing. This works directly from the path's points, without building a stroked path through a CGContext, so like the functions above it may be called concurrently from any number of threads.
+
+ Lines, joins, and caps are measured exactly. Curves are measured by splitting them until their tangent barely turns, so their contribution may be a hair larger than the true stroke, but never smaller. Dashes are ignored, since the dashed stroke never reaches past the solid one.
+ */
+extern CGRect AJRpathstrokebounds(const CGPoint *points, NSUInteger pointCount,
+                                  const AJRBezierPathElement *elements, NSUInteger elementCount,
+                                  CGFloat lineWidth, AJRLineCapStyle lineCap, AJRLineJoinStyle lineJoin, CGFloat miterLimit);
+/*! Strokes the path into context and returns the stroked path's bounds. The context's line settings are used, and its current path is replaced. Prefer AJRpathstrokebounds(), which doesn't need a context. */
 extern CGRect AJRstrokebounds(CGContextRef context,
                              CGPoint *points, NSUInteger pointCount,
                              AJRBezierPathElement *elements, NSUInteger elementCount);
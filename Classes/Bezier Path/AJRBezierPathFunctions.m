@@ -31,6 +31,7 @@
 
 #import "AJRBezierPathFunctions.h"
 
+#import "AJRBezierCurves.h"
 #import "AJRBezierPath.h"
 #import "AJRGeometry.h"
 
@@ -190,6 +191,488 @@ void AJRinstroke(CGContextRef context,
     *hit = CGContextPathContainsPoint(context, (CGPoint){x, y}, kCGPathStroke);
 }
 
+static inline NSInteger AJRLineWinding(CGPoint p0, CGPoint p1, CGFloat x, CGFloat y) {
+    double cross;
+    
+    // Edges include their lower end point and exclude their upper one, so a ray passing exactly through a vertex is only counted once.
+    if (p0.y <= y) {
+        if (p1.y > y) {
+            cross = ((double)p1.x - (double)p0.x) * ((double)y - (double)p0.y) - ((double)x - (double)p0.x) * ((double)p1.y - (double)p0.y);
+            if (cross > 0.0) {
+                return 1;
+            }
+        }
+    } else if (p1.y <= y) {
+        cross = ((double)p1.x - (double)p0.x) * ((double)y - (double)p0.y) - ((double)x - (double)p0.x) * ((double)p1.y - (double)p0.y);
+        if (cross < 0.0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static NSInteger AJRCurveWinding(AJRBezierCurve curve, CGFloat x, CGFloat y) {
+    double tValues[4];
+    NSInteger count, index, winding = 0;
+    double t0 = 0.0;
+    CGPoint p0 = curve.start;
+    
+    // The curve lies inside the hull of its control points, so most curves can be rejected without solving anything.
+    if (y < MIN(MIN(curve.start.y, curve.handle1.y), MIN(curve.handle2.y, curve.end.y))
+        || y >= MAX(MAX(curve.start.y, curve.handle1.y), MAX(curve.handle2.y, curve.end.y))
+        || x >= MAX(MAX(curve.start.x, curve.handle1.x), MAX(curve.handle2.x, curve.end.x))) {
+        return 0;
+    }
+    
+    count = AJRBezierCurveGetYMonotoneTValues(curve, tValues);
+    tValues[count] = 1.0;
+    for (index = 0; index <= count; index++) {
+        double t1 = tValues[index];
+        CGPoint p1 = index == count ? curve.end : AJRBezierCurveAtT(curve, t1);
+        NSInteger direction = 0;
+        
+        if (p0.y <= y && p1.y > y) {
+            direction = 1;
+        } else if (p1.y <= y && p0.y > y) {
+            direction = -1;
+        }
+        if (direction != 0) {
+            double t = AJRBezierCurveTForY(curve, y, t0, t1);
+            if (AJRBezierCurveAtT(curve, t).x > x) {
+                winding += direction;
+            }
+        }
+        t0 = t1;
+        p0 = p1;
+    }
+    
+    return winding;
+}
+
+NSInteger AJRpathwinding(CGFloat x, CGFloat y,
+                         const CGPoint *points, NSUInteger pointCount,
+                         const AJRBezierPathElement *elements, NSUInteger elementCount) {
+    NSUInteger pointIndex = 0;
+    NSUInteger elementIndex = 0;
+    CGPoint current = CGPointZero;
+    CGPoint subpathStart = CGPointZero;
+    NSInteger winding = 0;
+    
+    for (elementIndex = 0; elementIndex < elementCount; elementIndex++) {
+        switch (elements[elementIndex]) {
+            case AJRBezierPathElementSetBoundingBox:
+                pointIndex += 2;
+                break;
+            case AJRBezierPathElementMoveTo:
+                winding += AJRLineWinding(current, subpathStart, x, y);
+                current = subpathStart = points[pointIndex];
+                pointIndex += 1;
+                break;
+            case AJRBezierPathElementLineTo:
+                winding += AJRLineWinding(current, points[pointIndex], x, y);
+                current = points[pointIndex];
+                pointIndex += 1;
+                break;
+            case AJRBezierPathElementCubicCurveTo:
+                winding += AJRCurveWinding((AJRBezierCurve){current, points[pointIndex], points[pointIndex + 1], points[pointIndex + 2]}, x, y);
+                current = points[pointIndex + 2];
+                pointIndex += 3;
+                break;
+            case AJRBezierPathElementQuadraticCurveTo:
+                winding += AJRCurveWinding(AJRBezierCurveFromQuadraticCurve((AJRQuadraticCurve){current, points[pointIndex], points[pointIndex + 1]}), x, y);
+                current = points[pointIndex + 1];
+                pointIndex += 2;
+                break;
+            case AJRBezierPathElementClose:
+                winding += AJRLineWinding(current, subpathStart, x, y);
+                current = subpathStart;
+                break;
+        }
+    }
+    // Filling implicitly closes the last subpath.
+    winding += AJRLineWinding(current, subpathStart, x, y);
+    
+    return winding;
+}
+
+BOOL AJRpathinfill(CGFloat x, CGFloat y, AJRWindingRule windingRule,
+                   const CGPoint *points, NSUInteger pointCount,
+                   const AJRBezierPathElement *elements, NSUInteger elementCount) {
+    NSInteger winding = AJRpathwinding(x, y, points, pointCount, elements, elementCount);
+    return windingRule == AJRWindingRuleEvenOdd ? (winding % 2) != 0 : winding != 0;
+}
+
+BOOL AJRpathinstroke(CGFloat x, CGFloat y, CGFloat width,
+                     const CGPoint *points, NSUInteger pointCount,
+                     const AJRBezierPathElement *elements, NSUInteger elementCount) {
+    NSUInteger pointIndex = 0;
+    NSUInteger elementIndex = 0;
+    CGPoint point = (CGPoint){x, y};
+    CGPoint current = CGPointZero;
+    CGPoint subpathStart = CGPointZero;
+    double distance = width / 2.0;
+    
+    for (elementIndex = 0; elementIndex < elementCount; elementIndex++) {
+        switch (elements[elementIndex]) {
+            case AJRBezierPathElementSetBoundingBox:
+                pointIndex += 2;
+                break;
+            case AJRBezierPathElementMoveTo:
+                current = subpathStart = points[pointIndex];
+                pointIndex += 1;
+                break;
+            case AJRBezierPathElementLineTo:
+                if (AJRDistanceBetweenPointAndLineSegment(point, (AJRLine){current, points[pointIndex]}) <= distance) {
+                    return YES;
+                }
+                current = points[pointIndex];
+                pointIndex += 1;
+                break;
+            case AJRBezierPathElementCubicCurveTo:
+                if (AJRBezierCurveIsWithinDistanceOfPoint((AJRBezierCurve){current, points[pointIndex], points[pointIndex + 1], points[pointIndex + 2]}, point, distance)) {
+                    return YES;
+                }
+                current = points[pointIndex + 2];
+                pointIndex += 3;
+                break;
+            case AJRBezierPathElementQuadraticCurveTo:
+                if (AJRBezierCurveIsWithinDistanceOfPoint(AJRBezierCurveFromQuadraticCurve((AJRQuadraticCurve){current, points[pointIndex], points[pointIndex + 1]}), point, distance)) {
+                    return YES;
+                }
+                current = points[pointIndex + 1];
+                pointIndex += 2;
+                break;
+            case AJRBezierPathElementClose:
+                if (AJRDistanceBetweenPointAndLineSegment(point, (AJRLine){current, subpathStart}) <= distance) {
+                    return YES;
+                }
+                current = subpathStart;
+                break;
+        }
+    }
+    
+    return NO;
+}
+
+static inline CGRect AJRRectEnclosingPoints(CGPoint one, CGPoint two) {
+    return (CGRect){{MIN(one.x, two.x), MIN(one.y, two.y)}, {fabs(two.x - one.x), fabs(two.y - one.y)}};
+}
+
+CGRect AJRelementbounds(AJRBezierPathElement element, CGPoint currentPoint, CGPoint subpathStart, const CGPoint *points) {
+    switch (element) {
+        case AJRBezierPathElementSetBoundingBox:
+        case AJRBezierPathElementMoveTo:
+            break;
+        case AJRBezierPathElementLineTo:
+            return AJRRectEnclosingPoints(currentPoint, points[0]);
+        case AJRBezierPathElementCubicCurveTo:
+            return AJRBezierCurveGetBounds((AJRBezierCurve){currentPoint, points[0], points[1], points[2]});
+        case AJRBezierPathElementQuadraticCurveTo:
+            return AJRQuadraticCurveGetBounds((AJRQuadraticCurve){currentPoint, points[0], points[1]});
+        case AJRBezierPathElementClose:
+            return AJRRectEnclosingPoints(currentPoint, subpathStart);
+    }
+    return CGRectNull;
+}
+
+CGRect AJRpathbounds(const CGPoint *points, NSUInteger pointCount,
+                     const AJRBezierPathElement *elements, NSUInteger elementCount) {
+    NSUInteger pointIndex = 0;
+    NSUInteger elementIndex = 0;
+    CGPoint current = CGPointZero;
+    CGPoint subpathStart = CGPointZero;
+    CGRect bounds = CGRectNull;
+    
+    for (elementIndex = 0; elementIndex < elementCount; elementIndex++) {
+        switch (elements[elementIndex]) {
+            case AJRBezierPathElementSetBoundingBox:
+                pointIndex += 2;
+                break;
+            case AJRBezierPathElementMoveTo:
+                current = subpathStart = points[pointIndex];
+                pointIndex += 1;
+                break;
+            case AJRBezierPathElementLineTo:
+                bounds = CGRectUnion(bounds, AJRelementbounds(AJRBezierPathElementLineTo, current, subpathStart, points + pointIndex));
+                current = points[pointIndex];
+                pointIndex += 1;
+                break;
+            case AJRBezierPathElementCubicCurveTo:
+                bounds = CGRectUnion(bounds, AJRelementbounds(AJRBezierPathElementCubicCurveTo, current, subpathStart, points + pointIndex));
+                current = points[pointIndex + 2];
+                pointIndex += 3;
+                break;
+            case AJRBezierPathElementQuadraticCurveTo:
+                bounds = CGRectUnion(bounds, AJRelementbounds(AJRBezierPathElementQuadraticCurveTo, current, subpathStart, points + pointIndex));
+                current = points[pointIndex + 1];
+                pointIndex += 2;
+                break;
+            case AJRBezierPathElementClose:
+                bounds = CGRectUnion(bounds, AJRelementbounds(AJRBezierPathElementClose, current, subpathStart, points + pointIndex));
+                current = subpathStart;
+                break;
+        }
+    }
+    
+    return bounds;
+}
+
+#pragma mark - Stroke Bounds
+
+typedef struct _ajrStrokeBoundsState {
+    CGRect bounds;
+    double halfWidth;
+    AJRLineCapStyle lineCap;
+    AJRLineJoinStyle lineJoin;
+    double miterLimit;
+    // Whether the current subpath has drawn anything yet, and whether any of what it drew had a direction.
+    BOOL drawn;
+    BOOL hasTangent;
+    CGPoint firstTangent;
+    CGPoint lastTangent;
+} AJRStrokeBoundsState;
+
+static inline void AJRStrokeBoundsAddPoint(AJRStrokeBoundsState *state, double x, double y) {
+    state->bounds = CGRectUnion(state->bounds, (CGRect){{x, y}, {0.0, 0.0}});
+}
+
+static inline void AJRStrokeBoundsAddDisc(AJRStrokeBoundsState *state, CGPoint center) {
+    AJRStrokeBoundsAddPoint(state, center.x - state->halfWidth, center.y - state->halfWidth);
+    AJRStrokeBoundsAddPoint(state, center.x + state->halfWidth, center.y + state->halfWidth);
+}
+
+// Adds the two ends of the stroke's cross section at point, where tangent is the unit direction of the path.
+static inline void AJRStrokeBoundsAddCrossSection(AJRStrokeBoundsState *state, CGPoint point, CGPoint tangent) {
+    double nx = -tangent.y * state->halfWidth, ny = tangent.x * state->halfWidth;
+    AJRStrokeBoundsAddPoint(state, point.x + nx, point.y + ny);
+    AJRStrokeBoundsAddPoint(state, point.x - nx, point.y - ny);
+}
+
+static inline BOOL AJRStrokeBoundsNormalize(double x, double y, CGPoint *tangent) {
+    double length = sqrt(x * x + y * y);
+    if (length == 0.0) {
+        return NO;
+    }
+    *tangent = (CGPoint){x / length, y / length};
+    return YES;
+}
+
+// The first and last directions the curve actually moves in. A handle that sits on its end point doesn't give a direction, so we fall back to the next point along.
+static BOOL AJRStrokeBoundsGetEndTangents(AJRBezierCurve curve, CGPoint *startTangent, CGPoint *endTangent) {
+    if (!(AJRStrokeBoundsNormalize(curve.handle1.x - curve.start.x, curve.handle1.y - curve.start.y, startTangent)
+          || AJRStrokeBoundsNormalize(curve.handle2.x - curve.start.x, curve.handle2.y - curve.start.y, startTangent)
+          || AJRStrokeBoundsNormalize(curve.end.x - curve.start.x, curve.end.y - curve.start.y, startTangent))) {
+        return NO;
+    }
+    if (!(AJRStrokeBoundsNormalize(curve.end.x - curve.handle2.x, curve.end.y - curve.handle2.y, endTangent)
+          || AJRStrokeBoundsNormalize(curve.end.x - curve.handle1.x, curve.end.y - curve.handle1.y, endTangent))) {
+        AJRStrokeBoundsNormalize(curve.end.x - curve.start.x, curve.end.y - curve.start.y, endTangent);
+    }
+    return YES;
+}
+
+static void AJRStrokeBoundsAddJoin(AJRStrokeBoundsState *state, CGPoint vertex, CGPoint incoming, CGPoint outgoing) {
+    double cosine = incoming.x * outgoing.x + incoming.y * outgoing.y;
+    double cross = incoming.x * outgoing.y - incoming.y * outgoing.x;
+    
+    switch (state->lineJoin) {
+        case AJRLineJoinStyleRound:
+            AJRStrokeBoundsAddDisc(state, vertex);
+            break;
+        case AJRLineJoinStyleMitered:
+            // The miter is as long as 1 / sin(angle / 2) line widths, which works out to sqrt(2 / (1 + cosine)) of the turn. Past the limit it's drawn beveled, and the bevel's corners are already covered by the cross sections.
+            if (cross != 0.0 && 1.0 + cosine > 0.0 && sqrt(2.0 / (1.0 + cosine)) <= state->miterLimit) {
+                // The tip lies on the outside of the turn, where the offset edges of the two pieces meet.
+                double side = cross > 0.0 ? -1.0 : 1.0;
+                double scale = side * state->halfWidth / (1.0 + cosine);
+                AJRStrokeBoundsAddPoint(state,
+                                        vertex.x - (incoming.y + outgoing.y) * scale,
+                                        vertex.y + (incoming.x + outgoing.x) * scale);
+            }
+            break;
+        case AJRLineJoinStyleBeveled:
+            break;
+    }
+}
+
+static void AJRStrokeBoundsAddCap(AJRStrokeBoundsState *state, CGPoint point, CGPoint outward) {
+    switch (state->lineCap) {
+        case AJRLineCapStyleButt:
+            break;
+        case AJRLineCapStyleRound:
+            AJRStrokeBoundsAddDisc(state, point);
+            break;
+        case AJRLineCapStyleSquare:
+            AJRStrokeBoundsAddCrossSection(state, (CGPoint){point.x + outward.x * state->halfWidth, point.y + outward.y * state->halfWidth}, outward);
+            break;
+    }
+}
+
+// A curve is split until its tangent turns through less than this many radians, or until it's been split this many times.
+#define AJRStrokeBoundsMaxTurn (M_PI / 90.0)
+#define AJRStrokeBoundsMaxDepth 16
+
+/*
+ Gets the range of directions, as angles relative to the first one, that the curve's tangent can take. The tangent always lies within the cone of the control polygon's edges, which is what we actually measure. Returns NO if the cone is a half turn or more, in which case the range means nothing.
+ */
+static BOOL AJRStrokeBoundsGetTangentCone(AJRBezierCurve curve, double *minAngle, double *maxAngle) {
+    CGPoint edges[3] = {
+        {curve.handle1.x - curve.start.x, curve.handle1.y - curve.start.y},
+        {curve.handle2.x - curve.handle1.x, curve.handle2.y - curve.handle1.y},
+        {curve.end.x - curve.handle2.x, curve.end.y - curve.handle2.y},
+    };
+    CGPoint reference = CGPointZero;
+    BOOL haveReference = NO;
+    
+    *minAngle = *maxAngle = 0.0;
+    for (NSInteger x = 0; x < 3; x++) {
+        if (edges[x].x == 0.0 && edges[x].y == 0.0) {
+            continue;
+        }
+        if (!haveReference) {
+            reference = edges[x];
+            haveReference = YES;
+        } else {
+            double angle = atan2(reference.x * edges[x].y - reference.y * edges[x].x, reference.x * edges[x].x + reference.y * edges[x].y);
+            *minAngle = MIN(*minAngle, angle);
+            *maxAngle = MAX(*maxAngle, angle);
+        }
+    }
+    if (haveReference) {
+        double base = atan2(reference.y, reference.x);
+        *minAngle += base;
+        *maxAngle += base;
+    }
+    return *maxAngle - *minAngle < M_PI;
+}
+
+// The largest |sin(angle)| over [minAngle..maxAngle], which must span less than a full turn.
+static double AJRStrokeBoundsMaxAbsSine(double minAngle, double maxAngle) {
+    // |sin| peaks at odd multiples of pi / 2.
+    if (floor((maxAngle - M_PI_2) / M_PI) != floor((minAngle - M_PI_2) / M_PI)) {
+        return 1.0;
+    }
+    return MAX(fabs(sin(minAngle)), fabs(sin(maxAngle)));
+}
+
+/*
+ Adds the area swept by the curve's cross sections. When the tangent barely turns over the curve, the cross sections all point almost the same way, so the curve's own bounds, grown by the most any cross section could reach along each axis, are a close fit. Otherwise we split the curve and try again. Near a cusp the tangent never settles, so once we're deep enough we just treat the cross sections as swinging all the way around.
+ */
+static void AJRStrokeBoundsAddSweep(AJRStrokeBoundsState *state, AJRBezierCurve curve, NSInteger depth) {
+    double minAngle, maxAngle;
+    CGRect bounds = AJRBezierCurveGetBounds(curve);
+    
+    if (AJRStrokeBoundsGetTangentCone(curve, &minAngle, &maxAngle) && (maxAngle - minAngle <= AJRStrokeBoundsMaxTurn || depth >= AJRStrokeBoundsMaxDepth)) {
+        // The normal is the tangent turned a quarter, so its x reach follows the tangent's sine, and its y reach the tangent's cosine.
+        double dx = state->halfWidth * AJRStrokeBoundsMaxAbsSine(minAngle, maxAngle);
+        double dy = state->halfWidth * AJRStrokeBoundsMaxAbsSine(minAngle + M_PI_2, maxAngle + M_PI_2);
+        state->bounds = CGRectUnion(state->bounds, CGRectInset(bounds, -dx, -dy));
+    } else if (depth >= AJRStrokeBoundsMaxDepth) {
+        state->bounds = CGRectUnion(state->bounds, CGRectInset(bounds, -state->halfWidth, -state->halfWidth));
+    } else {
+        AJRBezierCurve left, right;
+        AJRSplitBezierCurve(curve, &left, &right);
+        AJRStrokeBoundsAddSweep(state, left, depth + 1);
+        AJRStrokeBoundsAddSweep(state, right, depth + 1);
+    }
+}
+
+/*
+ Adds the body of one element, plus its join with the element before it. Lines are passed as curves with their handles on their end points.
+ */
+static void AJRStrokeBoundsAddCurve(AJRStrokeBoundsState *state, AJRBezierCurve curve) {
+    CGPoint startTangent, endTangent;
+    
+    state->drawn = YES;
+    if (!AJRStrokeBoundsGetEndTangents(curve, &startTangent, &endTangent)) {
+        // All four points coincide, so there's nothing to join or to sweep.
+        return;
+    }
+    
+    if (state->hasTangent) {
+        AJRStrokeBoundsAddJoin(state, curve.start, state->lastTangent, startTangent);
+    } else {
+        state->firstTangent = startTangent;
+        state->hasTangent = YES;
+    }
+    state->lastTangent = endTangent;
+    
+    // The cross sections at the ends are exact, and for a line they're all there is.
+    AJRStrokeBoundsAddCrossSection(state, curve.start, startTangent);
+    AJRStrokeBoundsAddCrossSection(state, curve.end, endTangent);
+    if (!(CGPointEqualToPoint(curve.start, curve.handle1) && CGPointEqualToPoint(curve.handle2, curve.end))) {
+        AJRStrokeBoundsAddSweep(state, curve, 0);
+    }
+}
+
+static void AJRStrokeBoundsEndSubpath(AJRStrokeBoundsState *state, CGPoint subpathStart, CGPoint current, BOOL closed) {
+    if (closed) {
+        AJRStrokeBoundsAddCurve(state, (AJRBezierCurve){current, current, subpathStart, subpathStart});
+        if (state->hasTangent) {
+            AJRStrokeBoundsAddJoin(state, subpathStart, state->lastTangent, state->firstTangent);
+        }
+    } else if (state->hasTangent) {
+        AJRStrokeBoundsAddCap(state, subpathStart, (CGPoint){-state->firstTangent.x, -state->firstTangent.y});
+        AJRStrokeBoundsAddCap(state, current, state->lastTangent);
+    } else if (state->drawn && state->lineCap != AJRLineCapStyleButt) {
+        // A subpath that never goes anywhere still draws a dot with round or square caps.
+        AJRStrokeBoundsAddDisc(state, subpathStart);
+    }
+    state->drawn = NO;
+    state->hasTangent = NO;
+}
+
+CGRect AJRpathstrokebounds(const CGPoint *points, NSUInteger pointCount,
+                           const AJRBezierPathElement *elements, NSUInteger elementCount,
+                           CGFloat lineWidth, AJRLineCapStyle lineCap, AJRLineJoinStyle lineJoin, CGFloat miterLimit) {
+    NSUInteger pointIndex = 0;
+    NSUInteger elementIndex = 0;
+    CGPoint current = CGPointZero;
+    CGPoint subpathStart = CGPointZero;
+    AJRStrokeBoundsState state = {0};
+    
+    state.bounds = CGRectNull;
+    state.halfWidth = lineWidth / 2.0;
+    state.lineCap = lineCap;
+    state.lineJoin = lineJoin;
+    state.miterLimit = miterLimit;
+    
+    for (elementIndex = 0; elementIndex < elementCount; elementIndex++) {
+        switch (elements[elementIndex]) {
+            case AJRBezierPathElementSetBoundingBox:
+                pointIndex += 2;
+                break;
+            case AJRBezierPathElementMoveTo:
+                AJRStrokeBoundsEndSubpath(&state, subpathStart, current, NO);
+                current = subpathStart = points[pointIndex];
+                pointIndex += 1;
+                break;
+            case AJRBezierPathElementLineTo:
+                AJRStrokeBoundsAddCurve(&state, (AJRBezierCurve){current, current, points[pointIndex], points[pointIndex]});
+                current = points[pointIndex];
+                pointIndex += 1;
+                break;
+            case AJRBezierPathElementCubicCurveTo:
+                AJRStrokeBoundsAddCurve(&state, (AJRBezierCurve){current, points[pointIndex], points[pointIndex + 1], points[pointIndex + 2]});
+                current = points[pointIndex + 2];
+                pointIndex += 3;
+                break;
+            case AJRBezierPathElementQuadraticCurveTo:
+                AJRStrokeBoundsAddCurve(&state, AJRBezierCurveFromQuadraticCurve((AJRQuadraticCurve){current, points[pointIndex], points[pointIndex + 1]}));
+                current = points[pointIndex + 1];
+                pointIndex += 2;
+                break;
+            case AJRBezierPathElementClose:
+                AJRStrokeBoundsEndSubpath(&state, subpathStart, current, YES);
+                current = subpathStart;
+                break;
+        }
+    }
+    AJRStrokeBoundsEndSubpath(&state, subpathStart, current, NO);
+    
+    return state.bounds;
+}
+
 extern CGRect AJRstrokebounds(CGContextRef context,
                              CGPoint *points, NSUInteger pointCount,
                              AJRBezierPathElement *elements, NSUInteger elementCount) {
@@ -0,0 +1,97 @@
+/*
+ AJRBezierPathIndex.h
+ AJRInterfaceFoundation
+
+ Copyright © 2022, AJ Raftis and AJRInterfaceFoundation authors
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of AJRInterfaceFoundation nor the names of its contributors may be
+   used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL AJ RAFTIS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#import <Foundation/Foundation.h>
+#import <CoreGraphics/CoreGraphics.h>
+
+@class AJRBezierPath;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*! Which parts of a path a query counts as hitting it. */
+typedef NS_OPTIONS(NSUInteger, AJRBezierPathHitOptions) {
+    /*! The area the path fills, as tested by -isHitByPoint:, -isHitByRect: and -isHitByPath:. */
+    AJRBezierPathHitFill = 1 << 0,
+    /*! The path's stroke, as tested by -isStrokeHitByPoint:, -isStrokeHitByRect: and -isStrokeHitByPath:. */
+    AJRBezierPathHitStroke = 1 << 1,
+};
+
+/*!
+ Holds a collection of paths, such as every shape in a drawing, so that hit tests and region queries only look at the paths near the point or area in question, rather than at every path in turn.
+
+ The paths are kept in a bounding box tree. Each path is placed by its bounds, grown by half its stroke's hit width, so a box test never rejects a path that one of its own hit tests would accept. Paths can be added and removed one at a time, and the tree rebalances itself as they are, or they can be loaded all at once with -initWithPaths:, which builds a better tree, faster.
+
+ The index also keeps the paths in a stacking order, with each path added on top of those before it. Queries return their paths topmost first, since that's the one a click lands on.
+
+ The index can't see a path change, so after changing a path that's in the index, call -updatePath: to move it. An index isn't thread safe, but its queries only read it, so it may be queried from any number of threads while nothing changes it.
+ */
+@interface AJRBezierPathIndex : NSObject
+
+/*! Creates an empty index. */
+- (instancetype)init;
+/*! Creates an index holding paths, stacked in the order given, so the last path is on top. This is much faster than adding the paths one at a time. */
+- (instancetype)initWithPaths:(NSArray<AJRBezierPath *> *)paths;
+
+/*! The number of paths in the index. */
+@property (nonatomic,readonly) NSUInteger count;
+/*! All the paths in the index, in stacking order, from bottom to top. */
+@property (nonatomic,readonly) NSArray<AJRBezierPath *> *paths;
+
+/*! Adds path on top of every other path. Adding a path that's already in the index just updates it, without changing its place in the stacking order. */
+- (void)addPath:(AJRBezierPath *)path NS_SWIFT_NAME(add(_:));
+/*! Removes path. Does nothing if path isn't in the index. */
+- (void)removePath:(AJRBezierPath *)path NS_SWIFT_NAME(remove(_:));
+- (void)removeAllPaths;
+/*! Moves path to match its current bounds and line width. Call this after changing a path that's in the index. */
+- (void)updatePath:(AJRBezierPath *)path NS_SWIFT_NAME(update(_:));
+/*! Returns YES if this exact path, rather than one equal to it, is in the index. */
+- (BOOL)containsPath:(AJRBezierPath *)path NS_SWIFT_NAME(contains(_:));
+
+/*! Returns the paths whose boxes in the index touch rect, topmost first, without testing the paths themselves. This is the cheap first step of the other queries. */
+- (NSArray<AJRBezierPath *> *)pathsNearRect:(CGRect)rect NS_SWIFT_NAME(paths(near:));
+
+/*! Returns the paths hit by point, topmost first. */
+- (NSArray<AJRBezierPath *> *)pathsHitByPoint:(CGPoint)point options:(AJRBezierPathHitOptions)options NS_SWIFT_NAME(paths(hitBy:options:));
+/*! Returns the topmost path hit by point, or nil if there isn't one. This only tests paths until it finds one that's hit, so it's cheaper than taking the first of -pathsHitByPoint:options:. */
+- (nullable AJRBezierPath *)topmostPathHitByPoint:(CGPoint)point options:(AJRBezierPathHitOptions)options NS_SWIFT_NAME(topmostPath(hitBy:options:));
+/*! Returns the paths hit by rect, topmost first. */
+- (NSArray<AJRBezierPath *> *)pathsHitByRect:(CGRect)rect options:(AJRBezierPathHitOptions)options NS_SWIFT_NAME(paths(hitBy:options:));
+/*! Returns the paths hit by path, topmost first. path itself is never returned, even if it's in the index. */
+- (NSArray<AJRBezierPath *> *)pathsHitByPath:(AJRBezierPath *)path options:(AJRBezierPathHitOptions)options NS_SWIFT_NAME(paths(hitBy:options:));
+
+/*!
+ Calls block with the paths in order of their distance from point, nearest first, until block sets stop, or every path has been seen. The distance is to the nearest point on the path's outline, as found by -[AJRBezierPath getNearestPoint:toPoint:maximumDistance:], and ties are broken topmost first. The boxes in the index are only used to decide which paths to measure next, so stopping early only costs as much as the paths seen so far, plus any whose boxes were nearer than the last path's outline. Paths with no outline come last.
+ */
+- (void)enumeratePathsByDistanceFromPoint:(CGPoint)point usingBlock:(void (^)(AJRBezierPath *path, CGFloat distance, BOOL *stop))block NS_SWIFT_NAME(enumeratePathsByDistance(from:using:));
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,693 @@
+/*
+ AJRBezierPathIndex.m
+ AJRInterfaceFoundation
+
+ Copyright © 2022, AJ Raftis and AJRInterfaceFoundation authors
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of AJRInterfaceFoundation nor the names of its contributors may be
+   used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL AJ RAFTIS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#import "AJRBezierPathIndex.h"
+
+#import "AJRBezierPath.h"
+
+#pragma mark - Bounding Box Tree
+
+// The tree is a dynamic bounding volume hierarchy. Every node's box encloses its children's, every interior node has exactly two children, and the paths hang off the leaves. Nodes live in one array and refer to each other by index, so growing the array never invalidates them.
+
+#define AJRPathIndexNullNode NSNotFound
+
+typedef struct _ajrPathIndexNode {
+    CGRect bounds;
+    // For nodes on the free list, this is the next free node.
+    NSUInteger parent;
+    NSUInteger child1;
+    NSUInteger child2;
+    // 0 for leaves, and -1 for free nodes.
+    NSInteger height;
+    // The leaf's place in the stacking order. Higher is closer to the top.
+    NSUInteger order;
+    // The index's map table holds onto the paths.
+    __unsafe_unretained AJRBezierPath *path;
+} AJRPathIndexNode;
+
+typedef struct _ajrPathIndexTree {
+    AJRPathIndexNode *nodes;
+    NSUInteger capacity;
+    NSUInteger root;
+    NSUInteger freeList;
+} AJRPathIndexTree;
+
+static inline BOOL AJRPathIndexRectsTouch(CGRect first, CGRect second) {
+    // Inclusive, so that boxes with no width or height, like those of horizontal lines, and single points, still find each other.
+    return (first.origin.x <= second.origin.x + second.size.width && second.origin.x <= first.origin.x + first.size.width
+            && first.origin.y <= second.origin.y + second.size.height && second.origin.y <= first.origin.y + first.size.height);
+}
+
+// Half the perimeter. This is what the tree tries to keep small, rather than area, since area is 0 for lines, and would let them pile up anywhere.
+static inline CGFloat AJRPathIndexCost(CGRect rect) {
+    return rect.size.width + rect.size.height;
+}
+
+static inline CGRect AJRPathIndexUnion(CGRect first, CGRect second) {
+    CGFloat minX = MIN(first.origin.x, second.origin.x), minY = MIN(first.origin.y, second.origin.y);
+    CGFloat maxX = MAX(first.origin.x + first.size.width, second.origin.x + second.size.width);
+    CGFloat maxY = MAX(first.origin.y + first.size.height, second.origin.y + second.size.height);
+    return (CGRect){{minX, minY}, {maxX - minX, maxY - minY}};
+}
+
+static void AJRPathIndexTreeInit(AJRPathIndexTree *tree) {
+    tree->nodes = NULL;
+    tree->capacity = 0;
+    tree->root = AJRPathIndexNullNode;
+    tree->freeList = AJRPathIndexNullNode;
+}
+
+static void AJRPathIndexTreeFree(AJRPathIndexTree *tree) {
+    if (tree->nodes) NSZoneFree(nil, tree->nodes);
+    AJRPathIndexTreeInit(tree);
+}
+
+static NSUInteger AJRPathIndexAllocateNode(AJRPathIndexTree *tree) {
+    NSUInteger index;
+    
+    if (tree->freeList == AJRPathIndexNullNode) {
+        NSUInteger oldCapacity = tree->capacity;
+        
+        tree->capacity = oldCapacity < 16 ? 16 : oldCapacity * 2;
+        tree->nodes = NSZoneRealloc(nil, tree->nodes, tree->capacity * sizeof(AJRPathIndexNode));
+        // Thread the new nodes onto the free list, in order.
+        for (NSUInteger x = oldCapacity; x < tree->capacity; x++) {
+            tree->nodes[x].parent = x + 1 < tree->capacity ? x + 1 : AJRPathIndexNullNode;
+            tree->nodes[x].height = -1;
+            tree->nodes[x].path = nil;
+        }
+        tree->freeList = oldCapacity;
+    }
+    index = tree->freeList;
+    tree->freeList = tree->nodes[index].parent;
+    tree->nodes[index].parent = AJRPathIndexNullNode;
+    tree->nodes[index].child1 = AJRPathIndexNullNode;
+    tree->nodes[index].child2 = AJRPathIndexNullNode;
+    tree->nodes[index].height = 0;
+    tree->nodes[index].order = 0;
+    tree->nodes[index].path = nil;
+    
+    return index;
+}
+
+static void AJRPathIndexFreeNode(AJRPathIndexTree *tree, NSUInteger index) {
+    tree->nodes[index].parent = tree->freeList;
+    tree->nodes[index].height = -1;
+    tree->nodes[index].path = nil;
+    tree->freeList = index;
+}
+
+static inline void AJRPathIndexRefitNode(AJRPathIndexTree *tree, NSUInteger index) {
+    AJRPathIndexNode *node = tree->nodes + index;
+    AJRPathIndexNode *child1 = tree->nodes + node->child1, *child2 = tree->nodes + node->child2;
+    
+    node->bounds = AJRPathIndexUnion(child1->bounds, child2->bounds);
+    node->height = 1 + MAX(child1->height, child2->height);
+}
+
+// If the subtree at a is lopsided, rotates its taller grandchild up to replace a, and returns the index of the subtree's new root. This is the same rotation an AVL tree does, which keeps the tree's height logarithmic however the paths are added.
+static NSUInteger AJRPathIndexBalance(AJRPathIndexTree *tree, NSUInteger a) {
+    AJRPathIndexNode *A = tree->nodes + a;
+    NSUInteger b, c;
+    NSInteger balance;
+    
+    if (A->height < 2) {
+        return a;
+    }
+    b = A->child1;
+    c = A->child2;
+    balance = tree->nodes[c].height - tree->nodes[b].height;
+    
+    if (balance > 1 || balance < -1) {
+        // Rotate the taller child, up, into a's place, and give a one of up's children in exchange.
+        NSUInteger up = balance > 1 ? c : b;
+        AJRPathIndexNode *Up = tree->nodes + up;
+        NSUInteger f = Up->child1, g = Up->child2;
+        NSUInteger keep, give;
+        
+        Up->child1 = a;
+        Up->parent = A->parent;
+        A->parent = up;
+        if (Up->parent == AJRPathIndexNullNode) {
+            tree->root = up;
+        } else if (tree->nodes[Up->parent].child1 == a) {
+            tree->nodes[Up->parent].child1 = up;
+        } else {
+            tree->nodes[Up->parent].child2 = up;
+        }
+        
+        // up keeps its taller child, and a gets the shorter one.
+        if (tree->nodes[f].height > tree->nodes[g].height) {
+            keep = f;
+            give = g;
+        } else {
+            keep = g;
+            give = f;
+        }
+        Up->child2 = keep;
+        if (balance > 1) {
+            A->child2 = give;
+        } else {
+            A->child1 = give;
+        }
+        tree->nodes[give].parent = a;
+        AJRPathIndexRefitNode(tree, a);
+        AJRPathIndexRefitNode(tree, up);
+        
+        return up;
+    }
+    
+    return a;
+}
+
+// Walks from index up to the root, refitting boxes and heights, and rebalancing as it goes.
+static void AJRPathIndexRefitAncestors(AJRPathIndexTree *tree, NSUInteger index) {
+    while (index != AJRPathIndexNullNode) {
+        index = AJRPathIndexBalance(tree, index);
+        AJRPathIndexRefitNode(tree, index);
+        index = tree->nodes[index].parent;
+    }
+}
+
+static void AJRPathIndexInsertLeaf(AJRPathIndexTree *tree, NSUInteger leaf) {
+    CGRect bounds = tree->nodes[leaf].bounds;
+    NSUInteger index, sibling, oldParent, newParent;
+    
+    if (tree->root == AJRPathIndexNullNode) {
+        tree->root = leaf;
+        tree->nodes[leaf].parent = AJRPathIndexNullNode;
+        return;
+    }
+    
+    // Find the best sibling for the leaf, by walking down the tree, and stopping when pairing with the current node costs less than pushing the leaf into either child. Every node we pass through grows to hold the leaf, so that growth is charged to both children.
+    index = tree->root;
+    while (tree->nodes[index].height > 0) {
+        AJRPathIndexNode *node = tree->nodes + index;
+        CGFloat combinedCost = AJRPathIndexCost(AJRPathIndexUnion(node->bounds, bounds));
+        CGFloat cost = 2.0 * combinedCost;
+        CGFloat inheritanceCost = 2.0 * (combinedCost - AJRPathIndexCost(node->bounds));
+        CGFloat childCosts[2];
+        NSUInteger children[2] = {node->child1, node->child2};
+        
+        for (NSInteger x = 0; x < 2; x++) {
+            AJRPathIndexNode *child = tree->nodes + children[x];
+            CGFloat grown = AJRPathIndexCost(AJRPathIndexUnion(child->bounds, bounds));
+            childCosts[x] = (child->height == 0 ? grown : grown - AJRPathIndexCost(child->bounds)) + inheritanceCost;
+        }
+        if (cost < childCosts[0] && cost < childCosts[1]) {
+            break;
+        }
+        index = childCosts[0] <= childCosts[1] ? children[0] : children[1];
+    }
+    sibling = index;
+    
+    // Pair the leaf with the sibling under a new parent.
+    oldParent = tree->nodes[sibling].parent;
+    newParent = AJRPathIndexAllocateNode(tree);
+    tree->nodes[newParent].parent = oldParent;
+    tree->nodes[newParent].child1 = sibling;
+    tree->nodes[newParent].child2 = leaf;
+    tree->nodes[sibling].parent = newParent;
+    tree->nodes[leaf].parent = newParent;
+    if (oldParent == AJRPathIndexNullNode) {
+        tree->root = newParent;
+    } else if (tree->nodes[oldParent].child1 == sibling) {
+        tree->nodes[oldParent].child1 = newParent;
+    } else {
+        tree->nodes[oldParent].child2 = newParent;
+    }
+    AJRPathIndexRefitAncestors(tree, newParent);
+}
+
+static void AJRPathIndexRemoveLeaf(AJRPathIndexTree *tree, NSUInteger leaf) {
+    NSUInteger parent, grandParent, sibling;
+    
+    if (leaf == tree->root) {
+        tree->root = AJRPathIndexNullNode;
+        return;
+    }
+    
+    // The leaf's sibling takes its parent's place.
+    parent = tree->nodes[leaf].parent;
+    grandParent = tree->nodes[parent].parent;
+    sibling = tree->nodes[parent].child1 == leaf ? tree->nodes[parent].child2 : tree->nodes[parent].child1;
+    tree->nodes[sibling].parent = grandParent;
+    AJRPathIndexFreeNode(tree, parent);
+    tree->nodes[leaf].parent = AJRPathIndexNullNode;
+    if (grandParent == AJRPathIndexNullNode) {
+        tree->root = sibling;
+    } else {
+        if (tree->nodes[grandParent].child1 == parent) {
+            tree->nodes[grandParent].child1 = sibling;
+        } else {
+            tree->nodes[grandParent].child2 = sibling;
+        }
+        AJRPathIndexRefitAncestors(tree, grandParent);
+    }
+}
+
+// Sorts leaves by the center of their boxes along one axis, for building the tree in bulk.
+// Leaves are sorted by the centers of their boxes. The center goes along with each leaf, so that plain qsort() can do the sorting, since qsort_r() takes its arguments in a different order on each platform.
+typedef struct _ajrPathIndexSortEntry {
+    CGFloat center;
+    NSUInteger leaf;
+} AJRPathIndexSortEntry;
+
+static int AJRPathIndexCompareSortEntries(const void *first, const void *second) {
+    CGFloat center1 = ((const AJRPathIndexSortEntry *)first)->center, center2 = ((const AJRPathIndexSortEntry *)second)->center;
+    return center1 < center2 ? -1 : (center1 > center2 ? 1 : 0);
+}
+
+// Builds a subtree over leaves[0..count - 1] from the top down, splitting the leaves in half across the longer side of the box around their centers, and returns its root.
+static NSUInteger AJRPathIndexBuildSubtree(AJRPathIndexTree *tree, NSUInteger *leaves, NSUInteger count) {
+    CGFloat minX = CGFLOAT_MAX, minY = CGFLOAT_MAX, maxX = -CGFLOAT_MAX, maxY = -CGFLOAT_MAX;
+    NSUInteger node, child1, child2;
+    AJRPathIndexSortEntry *entries;
+    
+    if (count == 1) {
+        return leaves[0];
+    }
+    for (NSUInteger x = 0; x < count; x++) {
+        CGRect bounds = tree->nodes[leaves[x]].bounds;
+        minX = MIN(minX, CGRectGetMidX(bounds));
+        maxX = MAX(maxX, CGRectGetMidX(bounds));
+        minY = MIN(minY, CGRectGetMidY(bounds));
+        maxY = MAX(maxY, CGRectGetMidY(bounds));
+    }
+    entries = NSZoneMalloc(nil, count * sizeof(AJRPathIndexSortEntry));
+    for (NSUInteger x = 0; x < count; x++) {
+        CGRect bounds = tree->nodes[leaves[x]].bounds;
+        entries[x].center = maxX - minX >= maxY - minY ? CGRectGetMidX(bounds) : CGRectGetMidY(bounds);
+        entries[x].leaf = leaves[x];
+    }
+    qsort(entries, count, sizeof(AJRPathIndexSortEntry), AJRPathIndexCompareSortEntries);
+    for (NSUInteger x = 0; x < count; x++) {
+        leaves[x] = entries[x].leaf;
+    }
+    NSZoneFree(nil, entries);
+    
+    node = AJRPathIndexAllocateNode(tree);
+    child1 = AJRPathIndexBuildSubtree(tree, leaves, count / 2);
+    child2 = AJRPathIndexBuildSubtree(tree, leaves + count / 2, count - count / 2);
+    tree->nodes[node].child1 = child1;
+    tree->nodes[node].child2 = child2;
+    tree->nodes[child1].parent = node;
+    tree->nodes[child2].parent = node;
+    AJRPathIndexRefitNode(tree, node);
+    
+    return node;
+}
+
+#pragma mark - Queries
+
+typedef struct _ajrPathIndexStack {
+    NSUInteger *nodes;
+    NSUInteger count;
+    NSUInteger capacity;
+} AJRPathIndexStack;
+
+static inline void AJRPathIndexStackPush(AJRPathIndexStack *stack, NSUInteger node) {
+    if (stack->count == stack->capacity) {
+        stack->capacity = stack->capacity ? stack->capacity * 2 : 64;
+        stack->nodes = NSZoneRealloc(nil, stack->nodes, stack->capacity * sizeof(NSUInteger));
+    }
+    stack->nodes[stack->count++] = node;
+}
+
+typedef struct _ajrPathIndexCandidate {
+    NSUInteger order;
+    __unsafe_unretained AJRBezierPath *path;
+} AJRPathIndexCandidate;
+
+static int AJRPathIndexCompareCandidatesTopmostFirst(const void *first, const void *second) {
+    NSUInteger order1 = ((const AJRPathIndexCandidate *)first)->order, order2 = ((const AJRPathIndexCandidate *)second)->order;
+    return order1 > order2 ? -1 : (order1 < order2 ? 1 : 0);
+}
+
+// Returns the leaves whose boxes touch rect, topmost first. The caller frees the result.
+static AJRPathIndexCandidate *AJRPathIndexCandidatesNearRect(const AJRPathIndexTree *tree, CGRect rect, NSUInteger *count) {
+    AJRPathIndexStack stack = {};
+    AJRPathIndexCandidate *candidates = NULL;
+    NSUInteger capacity = 0;
+    
+    *count = 0;
+    if (tree->root != AJRPathIndexNullNode) {
+        AJRPathIndexStackPush(&stack, tree->root);
+    }
+    while (stack.count > 0) {
+        const AJRPathIndexNode *node = tree->nodes + stack.nodes[--stack.count];
+        
+        if (!AJRPathIndexRectsTouch(node->bounds, rect)) {
+            continue;
+        }
+        if (node->height == 0) {
+            if (*count == capacity) {
+                capacity = capacity ? capacity * 2 : 16;
+                candidates = NSZoneRealloc(nil, candidates, capacity * sizeof(AJRPathIndexCandidate));
+            }
+            candidates[*count].order = node->order;
+            candidates[*count].path = node->path;
+            (*count)++;
+        } else {
+            AJRPathIndexStackPush(&stack, node->child1);
+            AJRPathIndexStackPush(&stack, node->child2);
+        }
+    }
+    if (stack.nodes) NSZoneFree(nil, stack.nodes);
+    if (*count > 1) {
+        qsort(candidates, *count, sizeof(AJRPathIndexCandidate), AJRPathIndexCompareCandidatesTopmostFirst);
+    }
+    
+    return candidates;
+}
+
+static inline CGFloat AJRPathIndexDistanceToRect(CGPoint point, CGRect rect) {
+    CGFloat dx = MAX(MAX(rect.origin.x - point.x, point.x - (rect.origin.x + rect.size.width)), 0.0);
+    CGFloat dy = MAX(MAX(rect.origin.y - point.y, point.y - (rect.origin.y + rect.size.height)), 0.0);
+    return sqrt(dx * dx + dy * dy);
+}
+
+typedef struct _ajrPathIndexHeapEntry {
+    CGFloat distance;
+    NSUInteger node;
+    BOOL isLeaf;
+    // Set once a leaf's distance is to its path's outline, rather than to its box.
+    BOOL isMeasured;
+    NSUInteger order;
+} AJRPathIndexHeapEntry;
+
+// Nearer entries come first. At the same distance, interior nodes come before leaves, and leaves still to be measured before those that have been, since either may turn out to hold a path at that distance that's higher in the stacking order. Then measured leaves come topmost first.
+static inline BOOL AJRPathIndexHeapEntryPrecedes(const AJRPathIndexHeapEntry *first, const AJRPathIndexHeapEntry *second) {
+    if (first->distance != second->distance) {
+        return first->distance < second->distance;
+    }
+    if (first->isLeaf != second->isLeaf) {
+        return !first->isLeaf;
+    }
+    if (first->isMeasured != second->isMeasured) {
+        return !first->isMeasured;
+    }
+    return first->order > second->order;
+}
+
+typedef struct _ajrPathIndexHeap {
+    AJRPathIndexHeapEntry *entries;
+    NSUInteger count;
+    NSUInteger capacity;
+} AJRPathIndexHeap;
+
+static void AJRPathIndexHeapPush(AJRPathIndexHeap *heap, AJRPathIndexHeapEntry entry) {
+    NSUInteger index;
+    
+    if (heap->count == heap->capacity) {
+        heap->capacity = heap->capacity ? heap->capacity * 2 : 64;
+        heap->entries = NSZoneRealloc(nil, heap->entries, heap->capacity * sizeof(AJRPathIndexHeapEntry));
+    }
+    index = heap->count++;
+    while (index > 0 && AJRPathIndexHeapEntryPrecedes(&entry, heap->entries + (index - 1) / 2)) {
+        heap->entries[index] = heap->entries[(index - 1) / 2];
+        index = (index - 1) / 2;
+    }
+    heap->entries[index] = entry;
+}
+
+static AJRPathIndexHeapEntry AJRPathIndexHeapPop(AJRPathIndexHeap *heap) {
+    AJRPathIndexHeapEntry first = heap->entries[0];
+    AJRPathIndexHeapEntry last = heap->entries[--heap->count];
+    NSUInteger index = 0;
+    
+    while (2 * index + 1 < heap->count) {
+        NSUInteger child = 2 * index + 1;
+        if (child + 1 < heap->count && AJRPathIndexHeapEntryPrecedes(heap->entries + child + 1, heap->entries + child)) {
+            child++;
+        }
+        if (!AJRPathIndexHeapEntryPrecedes(heap->entries + child, &last)) {
+            break;
+        }
+        heap->entries[index] = heap->entries[child];
+        index = child;
+    }
+    heap->entries[index] = last;
+    
+    return first;
+}
+
+#pragma mark - AJRBezierPathIndex
+
+// A path's box in the index. isStrokeHitByPoint: accepts points within MAX(lineWidth, 4) / 2 of the outline, and every other hit test accepts less, so this box holds everything that can hit the path.
+static CGRect AJRPathIndexBoundsForPath(AJRBezierPath *path) {
+    CGFloat outset = MAX([path lineWidth], 4.0) / 2.0;
+    return CGRectInset([path bounds], -outset, -outset);
+}
+
+@implementation AJRBezierPathIndex {
+    AJRPathIndexTree _tree;
+    // Maps each path, by identity, to its leaf. This is also what keeps the paths alive.
+    NSMapTable<AJRBezierPath *, NSNumber *> *_leaves;
+    NSUInteger _nextOrder;
+}
+
+- (instancetype)init {
+    if ((self = [super init])) {
+        AJRPathIndexTreeInit(&_tree);
+        _leaves = [[NSMapTable alloc] initWithKeyOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality valueOptions:NSPointerFunctionsStrongMemory capacity:0];
+    }
+    return self;
+}
+
+- (instancetype)initWithPaths:(NSArray<AJRBezierPath *> *)paths {
+    if ((self = [self init])) {
+        NSUInteger *leaves = NSZoneMalloc(nil, MAX(paths.count, 1) * sizeof(NSUInteger));
+        NSUInteger count = 0;
+        
+        for (AJRBezierPath *path in paths) {
+            NSNumber *existing = [_leaves objectForKey:path];
+            NSUInteger leaf;
+            
+            if (existing) {
+                // Listed twice, so it just moves up to its later place.
+                _tree.nodes[existing.unsignedIntegerValue].order = _nextOrder++;
+                continue;
+            }
+            leaf = AJRPathIndexAllocateNode(&_tree);
+            _tree.nodes[leaf].bounds = AJRPathIndexBoundsForPath(path);
+            _tree.nodes[leaf].order = _nextOrder++;
+            _tree.nodes[leaf].path = path;
+            [_leaves setObject:@(leaf) forKey:path];
+            leaves[count++] = leaf;
+        }
+        if (count > 0) {
+            _tree.root = AJRPathIndexBuildSubtree(&_tree, leaves, count);
+            _tree.nodes[_tree.root].parent = AJRPathIndexNullNode;
+        }
+        NSZoneFree(nil, leaves);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    AJRPathIndexTreeFree(&_tree);
+}
+
+#pragma mark - Properties
+
+- (NSUInteger)count {
+    return _leaves.count;
+}
+
+- (NSArray<AJRBezierPath *> *)paths {
+    NSUInteger count = 0;
+    AJRPathIndexCandidate *candidates = NSZoneMalloc(nil, MAX(_leaves.count, 1) * sizeof(AJRPathIndexCandidate));
+    NSMutableArray *paths = [NSMutableArray arrayWithCapacity:_leaves.count];
+    
+    for (AJRBezierPath *path in _leaves) {
+        candidates[count].order = _tree.nodes[[[_leaves objectForKey:path] unsignedIntegerValue]].order;
+        candidates[count].path = path;
+        count++;
+    }
+    qsort(candidates, count, sizeof(AJRPathIndexCandidate), AJRPathIndexCompareCandidatesTopmostFirst);
+    for (NSUInteger x = count; x > 0; x--) {
+        [paths addObject:candidates[x - 1].path];
+    }
+    NSZoneFree(nil, candidates);
+    
+    return paths;
+}
+
+#pragma mark - Adding and Removing Paths
+
+- (void)addPath:(AJRBezierPath *)path {
+    NSUInteger leaf;
+    
+    if ([_leaves objectForKey:path]) {
+        [self updatePath:path];
+        return;
+    }
+    leaf = AJRPathIndexAllocateNode(&_tree);
+    _tree.nodes[leaf].bounds = AJRPathIndexBoundsForPath(path);
+    _tree.nodes[leaf].order = _nextOrder++;
+    _tree.nodes[leaf].path = path;
+    [_leaves setObject:@(leaf) forKey:path];
+    AJRPathIndexInsertLeaf(&_tree, leaf);
+}
+
+- (void)removePath:(AJRBezierPath *)path {
+    NSNumber *leaf = [_leaves objectForKey:path];
+    
+    if (leaf) {
+        AJRPathIndexRemoveLeaf(&_tree, leaf.unsignedIntegerValue);
+        AJRPathIndexFreeNode(&_tree, leaf.unsignedIntegerValue);
+        // This may release the last reference to path, so it goes last.
+        [_leaves removeObjectForKey:path];
+    }
+}
+
+- (void)removeAllPaths {
+    AJRPathIndexTreeFree(&_tree);
+    [_leaves removeAllObjects];
+    _nextOrder = 0;
+}
+
+- (void)updatePath:(AJRBezierPath *)path {
+    NSNumber *leafNumber = [_leaves objectForKey:path];
+    NSUInteger leaf;
+    CGRect bounds;
+    
+    if (leafNumber == nil) {
+        return;
+    }
+    leaf = leafNumber.unsignedIntegerValue;
+    bounds = AJRPathIndexBoundsForPath(path);
+    if (!CGRectEqualToRect(bounds, _tree.nodes[leaf].bounds)) {
+        AJRPathIndexRemoveLeaf(&_tree, leaf);
+        _tree.nodes[leaf].bounds = bounds;
+        AJRPathIndexInsertLeaf(&_tree, leaf);
+    }
+}
+
+- (BOOL)containsPath:(AJRBezierPath *)path {
+    return [_leaves objectForKey:path] != nil;
+}
+
+#pragma mark - Queries
+
+- (NSArray<AJRBezierPath *> *)pathsNearRect:(CGRect)rect usingTest:(BOOL (^)(AJRBezierPath *path))test {
+    NSUInteger count;
+    AJRPathIndexCandidate *candidates = AJRPathIndexCandidatesNearRect(&_tree, rect, &count);
+    NSMutableArray *paths = [NSMutableArray array];
+    
+    for (NSUInteger x = 0; x < count; x++) {
+        if (test == nil || test(candidates[x].path)) {
+            [paths addObject:candidates[x].path];
+        }
+    }
+    if (candidates) NSZoneFree(nil, candidates);
+    
+    return paths;
+}
+
+- (NSArray<AJRBezierPath *> *)pathsNearRect:(CGRect)rect {
+    return [self pathsNearRect:rect usingTest:nil];
+}
+
+- (NSArray<AJRBezierPath *> *)pathsHitByPoint:(CGPoint)point options:(AJRBezierPathHitOptions)options {
+    return [self pathsNearRect:(CGRect){point, CGSizeZero} usingTest:^BOOL(AJRBezierPath *path) {
+        return (((options & AJRBezierPathHitFill) && [path isHitByPoint:point])
+                || ((options & AJRBezierPathHitStroke) && [path isStrokeHitByPoint:point]));
+    }];
+}
+
+- (AJRBezierPath *)topmostPathHitByPoint:(CGPoint)point options:(AJRBezierPathHitOptions)options {
+    NSUInteger count;
+    AJRPathIndexCandidate *candidates = AJRPathIndexCandidatesNearRect(&_tree, (CGRect){point, CGSizeZero}, &count);
+    AJRBezierPath *hit = nil;
+    
+    for (NSUInteger x = 0; x < count && hit == nil; x++) {
+        AJRBezierPath *path = candidates[x].path;
+        if (((options & AJRBezierPathHitFill) && [path isHitByPoint:point])
+            || ((options & AJRBezierPathHitStroke) && [path isStrokeHitByPoint:point])) {
+            hit = path;
+        }
+    }
+    if (candidates) NSZoneFree(nil, candidates);
+    
+    return hit;
+}
+
+- (NSArray<AJRBezierPath *> *)pathsHitByRect:(CGRect)rect options:(AJRBezierPathHitOptions)options {
+    return [self pathsNearRect:rect usingTest:^BOOL(AJRBezierPath *path) {
+        return (((options & AJRBezierPathHitFill) && [path isHitByRect:rect])
+                || ((options & AJRBezierPathHitStroke) && [path isStrokeHitByRect:rect]));
+    }];
+}
+
+- (NSArray<AJRBezierPath *> *)pathsHitByPath:(AJRBezierPath *)other options:(AJRBezierPathHitOptions)options {
+    return [self pathsNearRect:[other bounds] usingTest:^BOOL(AJRBezierPath *path) {
+        return (path != other
+                && (((options & AJRBezierPathHitFill) && [path isHitByPath:other])
+                    || ((options & AJRBezierPathHitStroke) && [path isStrokeHitByPath:other])));
+    }];
+}
+
+- (void)enumeratePathsByDistanceFromPoint:(CGPoint)point usingBlock:(void (^)(AJRBezierPath *path, CGFloat distance, BOOL *stop))block {
+    AJRPathIndexHeap heap = {};
+    BOOL stop = NO;
+    
+    if (_tree.root != AJRPathIndexNullNode) {
+        AJRPathIndexNode *root = _tree.nodes + _tree.root;
+        AJRPathIndexHeapPush(&heap, (AJRPathIndexHeapEntry){AJRPathIndexDistanceToRect(point, root->bounds), _tree.root, root->height == 0, NO, root->order});
+    }
+    // Whatever comes off the heap is nearer than anything still on it, or anything under anything still on it, since a node's box holds its children's, and a path's box holds its outline. So a leaf is only measured exactly when it comes off the heap, and then goes back on at its true distance, and the paths whose boxes are far away never need measuring at all.
+    while (heap.count > 0 && !stop) {
+        AJRPathIndexHeapEntry entry = AJRPathIndexHeapPop(&heap);
+        AJRPathIndexNode *node = _tree.nodes + entry.node;
+        
+        if (entry.isMeasured) {
+            block(node->path, entry.distance, &stop);
+        } else if (entry.isLeaf) {
+            AJRBezierPathNearestPoint nearest;
+            
+            // A path with no outline is as far away as it gets, but it's still seen.
+            entry.distance = [node->path getNearestPoint:&nearest toPoint:point maximumDistance:CGFLOAT_MAX] ? MAX(nearest.distance, entry.distance) : CGFLOAT_MAX;
+            entry.isMeasured = YES;
+            AJRPathIndexHeapPush(&heap, entry);
+        } else {
+            NSUInteger children[2] = {node->child1, node->child2};
+            for (NSInteger x = 0; x < 2; x++) {
+                AJRPathIndexNode *child = _tree.nodes + children[x];
+                AJRPathIndexHeapPush(&heap, (AJRPathIndexHeapEntry){AJRPathIndexDistanceToRect(point, child->bounds), children[x], child->height == 0, NO, child->order});
+            }
+        }
+    }
+    if (heap.entries) NSZoneFree(nil, heap.entries);
+}
+
+@end
@@ -30,13 +30,19 @@
  */
 
 #import <AJRInterfaceFoundation/AJRBezierPath.h>
+#import <AJRInterfaceFoundation/AJRPathLengthTable.h>
+#import <AJRInterfaceFoundation/AJRPathSegmentTable.h>
+#import <CoreText/CoreText.h>
 
+/*! Returns a 1x1 bitmap context for stroking and hit testing through Core Graphics. Each thread gets its own, so callers may freely change its state, but must set up everything they rely on before each use. */
 extern CGContextRef AJRHitTestContext(void);
 extern void AJRPathToBezierIterator(void *info, const CGPathElement *element);
 
 @interface AJRBezierPath (Private)
 
 - (void)_setupDrawingContext:(CGContextRef)context;
+/*! Gives the receiver its own copy of its points and elements, if it's sharing them with another path. Anything that writes to _points, _elements, or _elementToPointIndex must call this first. */
+- (void)_prepareForMutation;
 - (void)_setCoordinateMaxCount:(NSUInteger)max;
 - (void)_increaseCoordinateCountBy:(NSUInteger)count;
 - (void)_setOperationMaxCount:(NSUInteger)max;
@@ -44,5 +50,30 @@ extern void AJRPathToBezierIterator(void *info, const CGPathElement *element);
 - (void)_unionRectWithBoundingBox:(CGRect)rect;
 - (void)_intersectPointWithBounds:(CGPoint)aPoint forMoveTo:(BOOL)flag;
 - (void)_updateBoundingBox;
+/*! Grows valid bounds to cover a just appended element, so appending doesn't force the next call to -bounds to walk the whole path. */
+- (void)_includeElementInBounds:(NSUInteger)elementIndex;
+/*! Throws away anything we've derived from the path's geometry. Called by -setBoundsAreValid:NO. */
+- (void)_discardCachedGeometry;
+/*! Throws away anything we've derived from the line style, which is the stroke bounds and the stroked outline. Called by the line style setters, which leave the cached geometry alone, and by -_discardCachedGeometry. */
+- (void)_discardCachedStroke;
+/*! The accuracy the receiver's curves are approximated to, in device space. This is the flatness, unless that's 0, which asks for the most accurate rendering, and gets a tenth of a device pixel. */
+- (CGFloat)_effectiveFlatness;
+/*! Returns the outline built by -bezierPathFromStrokedPath, without copying it, so its own caches carry over from one call to the next. It belongs to the receiver, and must not be changed. */
+- (AJRBezierPath *)_strokedOutline;
+/*! Releases and clears one of the receiver's cached CGPaths. */
+- (void)_discardCGPath:(CGPathRef _Nullable * _Nonnull)cache;
+/*! Returns the cached CGPath to fill or stroke with, which has the matching point transform applied, if there is one. Like -CGPath, it belongs to the receiver. */
+- (CGPathRef)_CGPathForFill;
+- (CGPathRef)_CGPathForStroke;
+/*! Returns the receiver's segment table, building it if the path has changed since it was last asked for. The table belongs to the receiver. */
+- (AJRPathSegmentTable *)_pathSegmentTable;
+/*! Returns the receiver's length table, building it if the path has changed since it was last asked for. The table belongs to the receiver. */
+- (AJRPathLengthTable *)_pathLengthTable;
+/*! Returns the receiver's raw storage, which includes the leading set bounding box element and its two points. This is for AJRPathIterator, which can't reach our ivars directly. */
+- (void)_getPoints:(const CGPoint * _Nullable * _Nonnull)points elements:(const AJRBezierPathElement * _Nullable * _Nonnull)elements;
+/*! Replaces the receiver's geometry and line style with those in bytes, which hold a binary representation. If owner isn't nil, it must own bytes, and bytes must not change for as long as owner lives, because the receiver may hang onto owner and use its points directly. Without an owner, everything is copied. Returns NO, leaving the receiver untouched, if bytes can't be read. */
+- (BOOL)_setBinaryRepresentationBytes:(const uint8_t *)bytes length:(NSUInteger)length owner:(NSData *)owner;
+/*! Appends the outline of each glyph in font, with the glyph's origin placed at origin plus its position. The outlines come from the glyph outline cache shared by all paths. This doesn't move the current point past the glyphs afterwards. */
+- (void)_appendOutlineOfGlyphs:(const CGGlyph *)glyphs positions:(const CGPoint *)positions count:(NSInteger)count inFont:(CTFontRef)font origin:(CGPoint)origin;
 
 @end
@@ -0,0 +1,66 @@
+/*
+ AJRCurveFitter.h
+ AJRInterfaceFoundation
+
+ Copyright © 2022, AJ Raftis and AJRInterfaceFoundation authors
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of AJRInterfaceFoundation nor the names of its contributors may be
+   used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL AJ RAFTIS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import <AJRInterfaceFoundation/AJRBezierPath.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*!
+ Turns a stream of points, such as those coming from a pen or a mouse, into smooth curves as they arrive. Each point refits only the curve at the end of the stroke, which is called the pending curve. Once a point can't be fit along with the ones before it, the pending curve is appended to the path, and a new one is started from its end. Curves are joined so they meet smoothly, except at sharp corners.
+
+ No curve is ever fit to more than a fixed number of points, and the fitting is done in buffers the fitter sets up once, so the time spent on each point doesn't grow as the stroke gets longer, and nothing is allocated while points are coming in. The path is only ever appended to.
+
+ A fitter isn't thread safe, but each fitter may be used on its own thread.
+ */
+@interface AJRCurveFitter : NSObject
+
+/*! Creates a fitter that appends its curves to path. Every point will be no farther than tolerance from the curves, which is in the same units as the points. */
+- (instancetype)initWithPath:(AJRBezierPath *)path tolerance:(CGFloat)tolerance;
+/*! Creates a fitter with a new, empty path. */
+- (instancetype)initWithTolerance:(CGFloat)tolerance;
+
+@property (nonatomic,readonly) AJRBezierPath *path;
+@property (nonatomic,readonly) CGFloat tolerance;
+
+/*! Adds the next point of the stroke. The first point of a stroke starts a new subpath in the path. Points closer to the last one than a hundredth of the tolerance are ignored. */
+- (void)addPoint:(CGPoint)point;
+- (void)addPoints:(const CGPoint *)points count:(NSInteger)count NS_SWIFT_NAME(addPoints(_:count:));
+
+/*! YES if there's a curve at the end of the stroke that hasn't been appended to the path yet. Draw it after the path to show the whole stroke while it's still coming in. */
+@property (nonatomic,readonly) BOOL hasPendingCurve;
+/*! The curve fit to the points since the last one appended to the path. This changes with every point, so it's only good until the next one is added. */
+@property (nonatomic,readonly) AJRBezierCurve pendingCurve;
+
+/*! Appends the pending curve to the path, and ends the stroke. The next point added starts a new stroke. */
+- (void)finishStroke;
+
+@end
+
+NS_ASSUME_NONNULL_END
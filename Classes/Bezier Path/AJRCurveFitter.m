@@ -0,0 +1,178 @@
+/*
+ AJRCurveFitter.m
+ AJRInterfaceFoundation
+
+ Copyright © 2022, AJ Raftis and AJRInterfaceFoundation authors
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of AJRInterfaceFoundation nor the names of its contributors may be
+   used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL AJ RAFTIS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import "AJRCurveFitter.h"
+
+#import "AJRBezierCurves.h"
+#import "AJRVector.h"
+
+// The most points a single curve is fit to. Once a stroke has gone this far without the pending curve being appended, it's appended anyway, which bounds the work done for each point.
+#define AJRCurveFitterMaxPoints 64
+// Where a stroke turns by more than about 75 degrees, the curves meet at a corner, rather than smoothly.
+#define AJRCurveFitterCornerCosine 0.25
+
+typedef struct _ajrCurveFitterState {
+    CGPoint points[AJRCurveFitterMaxPoints];
+    double scratch[2 * AJRCurveFitterMaxPoints];
+    NSInteger pointCount;
+    double tolerance;
+    // The direction the last appended curve left off in, which the next one starts out in, unless it turns a corner.
+    CGPoint startTangent;
+    BOOL hasStartTangent;
+    AJRBezierCurve pendingCurve;
+    BOOL hasPendingCurve;
+} AJRCurveFitterState;
+
+// Fits a curve to the points that have come in since the last curve was appended, and returns how far it strays from them.
+static double AJRCurveFitterFit(AJRCurveFitterState *state, AJRBezierCurve *curve) {
+    const CGPoint *points = state->points;
+    NSInteger count = state->pointCount;
+    // Looking a couple of points in from each end steadies the tangents against jitter in the input.
+    CGPoint startTangent = AJRVectorNormalize(AJRVectorSubtract(points[MIN(2, count - 1)], points[0]));
+    CGPoint endTangent = AJRVectorNormalize(AJRVectorSubtract(points[MAX(count - 3, 0)], points[count - 1]));
+    
+    if (state->hasStartTangent && AJRVectorDotProduct(state->startTangent, startTangent) >= AJRCurveFitterCornerCosine) {
+        startTangent = state->startTangent;
+    }
+    
+    return AJRBezierCurveFitToPoints(points, count, startTangent, endTangent, state->tolerance, state->scratch, curve, NULL);
+}
+
+// Takes the pending curve as finished, and starts over with just its end point.
+static AJRBezierCurve AJRCurveFitterFinishPendingCurve(AJRCurveFitterState *state) {
+    AJRBezierCurve curve = state->pendingCurve;
+    CGPoint tangent = AJRVectorSubtract(curve.end, curve.handle2);
+    
+    if (tangent.x == 0.0 && tangent.y == 0.0) {
+        tangent = AJRVectorSubtract(curve.end, curve.start);
+    }
+    state->hasStartTangent = tangent.x != 0.0 || tangent.y != 0.0;
+    state->startTangent = AJRVectorNormalize(tangent);
+    state->points[0] = curve.end;
+    state->pointCount = 1;
+    state->hasPendingCurve = NO;
+    
+    return curve;
+}
+
+// Adds point to the stroke. Returns YES, and sets finished, when that finishes a curve.
+static BOOL AJRCurveFitterAddPoint(AJRCurveFitterState *state, CGPoint point, AJRBezierCurve *finished) {
+    AJRBezierCurve curve;
+    BOOL didFinish = NO;
+    double minimumSpacing = state->tolerance / 100.0;
+    
+    if (state->pointCount == 0) {
+        state->points[0] = point;
+        state->pointCount = 1;
+        return NO;
+    }
+    if (AJRVectorSquaredLength(AJRVectorSubtract(point, state->points[state->pointCount - 1])) <= minimumSpacing * minimumSpacing) {
+        return NO;
+    }
+    
+    if (state->pointCount == AJRCurveFitterMaxPoints) {
+        *finished = AJRCurveFitterFinishPendingCurve(state);
+        didFinish = YES;
+    }
+    
+    state->points[state->pointCount] = point;
+    state->pointCount += 1;
+    // Two points can always be fit exactly.
+    if (AJRCurveFitterFit(state, &curve) <= state->tolerance || state->pointCount == 2) {
+        state->pendingCurve = curve;
+        state->hasPendingCurve = YES;
+        return didFinish;
+    }
+    
+    // The new point can't be fit along with the others, so the last fit, which covered every point but this one, is finished, and a new curve runs from its end to the new point.
+    *finished = AJRCurveFitterFinishPendingCurve(state);
+    state->points[1] = point;
+    state->pointCount = 2;
+    AJRCurveFitterFit(state, &state->pendingCurve);
+    state->hasPendingCurve = YES;
+    
+    return YES;
+}
+
+@implementation AJRCurveFitter {
+    AJRCurveFitterState _state;
+}
+
+- (instancetype)initWithPath:(AJRBezierPath *)path tolerance:(CGFloat)tolerance {
+    if (!(tolerance > 0.0) || isinf(tolerance)) {
+        [NSException raise:NSInvalidArgumentException format:@"Curves can't be fit to a tolerance of %g.", tolerance];
+    }
+    if ((self = [super init])) {
+        _path = path;
+        _tolerance = tolerance;
+        _state.tolerance = tolerance;
+    }
+    return self;
+}
+
+- (instancetype)initWithTolerance:(CGFloat)tolerance {
+    return [self initWithPath:[[AJRBezierPath alloc] init] tolerance:tolerance];
+}
+
+- (void)addPoint:(CGPoint)point {
+    AJRBezierCurve finished;
+    
+    if (_state.pointCount == 0) {
+        [_path moveToPoint:point];
+    }
+    if (AJRCurveFitterAddPoint(&_state, point, &finished)) {
+        [_path curveToPoint:finished.end controlPoint1:finished.handle1 controlPoint2:finished.handle2];
+    }
+}
+
+- (void)addPoints:(const CGPoint *)points count:(NSInteger)count {
+    for (NSInteger x = 0; x < count; x++) {
+        [self addPoint:points[x]];
+    }
+}
+
+- (BOOL)hasPendingCurve {
+    return _state.hasPendingCurve;
+}
+
+- (AJRBezierCurve)pendingCurve {
+    return _state.pendingCurve;
+}
+
+- (void)finishStroke {
+    if (_state.hasPendingCurve) {
+        AJRBezierCurve finished = AJRCurveFitterFinishPendingCurve(&_state);
+        [_path curveToPoint:finished.end controlPoint1:finished.handle1 controlPoint2:finished.handle2];
+    }
+    _state.pointCount = 0;
+    _state.hasStartTangent = NO;
+}
+
+@end
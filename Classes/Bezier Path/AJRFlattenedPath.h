@@ -0,0 +1,79 @@
+/*
+ AJRFlattenedPath.h
+ AJRInterfaceFoundation
+
+ Copyright © 2022, AJ Raftis and AJRInterfaceFoundation authors
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of AJRInterfaceFoundation nor the names of its contributors may be
+   used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL AJ RAFTIS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import <AJRInterfaceFoundation/AJRGeometry.h>
+
+@protocol AJRBezierPathProtocol;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*!
+ An immutable copy of a path's outline, with every curve replaced by line segments that stay within tolerance of it. The outline is kept as one array of points, split into subpaths, so it can be walked as quickly as a plain C array.
+
+ You won't normally create these yourself. Ask an AJRBezierPath for one with -flattenedPathForScale: or -flattenedPathWithTolerance:, and the path will hand back the one it already made for that level of detail, if it still has it. Because they never change, flattened paths may be used from any thread, and stay valid after the path they came from changes or goes away.
+ */
+@interface AJRFlattenedPath : NSObject
+
+/*!
+ Flattens path, so that no point on any of its curves is further than tolerance from the line segments that replace it. Subpaths that are nothing but a move to are dropped.
+
+ @param path An AJRBezierPath or an NSBezierPath.
+ @param tolerance The largest distance allowed between a curve and its line segments, in the path's own units.
+ */
+- (instancetype)initWithPath:(id <AJRBezierPathProtocol>)path tolerance:(CGFloat)tolerance;
+
+/*! The tolerance the path was flattened to. */
+@property (nonatomic,readonly) CGFloat tolerance;
+
+/*! The points of every subpath, one after another. A closed subpath doesn't repeat its first point at its end. */
+@property (nonatomic,readonly) const CGPoint *points NS_RETURNS_INNER_POINTER;
+@property (nonatomic,readonly) NSUInteger pointCount;
+
+@property (nonatomic,readonly) NSUInteger subpathCount;
+/*! Where the subpath at index lies in points. */
+- (NSRange)rangeOfSubpathAtIndex:(NSUInteger)index;
+/*! Returns YES if the subpath at index ended with a close, and so has an edge from its last point back to its first. */
+- (BOOL)isSubpathClosedAtIndex:(NSUInteger)index;
+
+/*! Roughly how much memory the flattened path uses. */
+@property (nonatomic,readonly) NSUInteger byteCount;
+
+/*! Calls block with each line segment in turn, including the edges that close subpaths, just as -[AJRBezierPath enumerateFlattenedPathWithBlock:] would. */
+- (void)enumerateLineSegmentsUsingBlock:(void (^)(AJRLine lineSegment, BOOL isNewSubpath, BOOL *stop))block;
+
+/*! Adds the flattened path to context's current path. */
+- (void)addToContext:(CGContextRef)context;
+
+@end
+
+NS_ASSUME_NONNULL_END
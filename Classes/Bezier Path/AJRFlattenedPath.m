@@ -0,0 +1,215 @@
+/*
+ AJRFlattenedPath.m
+ AJRInterfaceFoundation
+
+ Copyright © 2022, AJ Raftis and AJRInterfaceFoundation authors
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of AJRInterfaceFoundation nor the names of its contributors may be
+   used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL AJ RAFTIS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#import "AJRFlattenedPath.h"
+
+#import "AJRPathIterator.h"
+
+typedef struct _ajrFlattenedSubpath {
+    NSUInteger start;
+    NSUInteger count;
+    BOOL closed;
+} AJRFlattenedSubpath;
+
+@implementation AJRFlattenedPath
+{
+    CGPoint *_points;
+    NSUInteger _pointCount;
+    NSUInteger _maxPoints;
+    AJRFlattenedSubpath *_subpaths;
+    NSUInteger _subpathCount;
+    NSUInteger _maxSubpaths;
+}
+
+#pragma mark - Creation
+
+- (void)_appendPoint:(CGPoint)point {
+    if (_pointCount == _maxPoints) {
+        _maxPoints = _maxPoints ? _maxPoints * 2 : 64;
+        _points = NSZoneRealloc(nil, _points, _maxPoints * sizeof(CGPoint));
+    }
+    _points[_pointCount++] = point;
+}
+
+// Drops the last subpath if it never went anywhere.
+- (void)_endSubpath {
+    if (_subpathCount > 0 && _subpaths[_subpathCount - 1].count < 2) {
+        _pointCount = _subpaths[_subpathCount - 1].start;
+        _subpathCount -= 1;
+    }
+}
+
+- (void)_beginSubpathAtPoint:(CGPoint)point {
+    [self _endSubpath];
+    if (_subpathCount == _maxSubpaths) {
+        _maxSubpaths = _maxSubpaths ? _maxSubpaths * 2 : 4;
+        _subpaths = NSZoneRealloc(nil, _subpaths, _maxSubpaths * sizeof(AJRFlattenedSubpath));
+    }
+    _subpaths[_subpathCount++] = (AJRFlattenedSubpath){_pointCount, 1, NO};
+    [self _appendPoint:point];
+}
+
+- (instancetype)initWithPath:(id <AJRBezierPathProtocol>)path tolerance:(CGFloat)tolerance {
+    if ((self = [super init])) {
+        AJRPathIterator iterator;
+        AJRBezierPathElement element;
+        AJRCurveStepper stepper;
+        CGPoint points[3], point;
+        CGPoint current = CGPointZero, subpathStart = CGPointZero;
+        // After a close, the next element starts a new subpath from where the closed one started, unless it's a move to.
+        BOOL needsSubpath = YES;
+        
+        _tolerance = tolerance;
+        AJRPathIteratorInit(&iterator, path);
+        while (AJRPathIteratorNextElement(&iterator, &element, points)) {
+            if (element == AJRBezierPathElementMoveTo) {
+                current = subpathStart = points[0];
+                [self _beginSubpathAtPoint:current];
+                needsSubpath = NO;
+                continue;
+            }
+            if (needsSubpath) {
+                [self _beginSubpathAtPoint:subpathStart];
+                current = subpathStart;
+                needsSubpath = NO;
+            }
+            switch (element) {
+                case AJRBezierPathElementLineTo:
+                    current = points[0];
+                    [self _appendPoint:current];
+                    break;
+                case AJRBezierPathElementCubicCurveTo: {
+                    AJRBezierCurve curve = {current, points[0], points[1], points[2]};
+                    AJRCurveStepperInitWithBezierCurve(&stepper, curve, AJRBezierCurveFlattenedSegmentCount(curve, tolerance));
+                    while (AJRCurveStepperNextPoint(&stepper, &point)) {
+                        [self _appendPoint:point];
+                    }
+                    current = points[2];
+                    break;
+                }
+                case AJRBezierPathElementQuadraticCurveTo: {
+                    AJRQuadraticCurve curve = {current, points[0], points[1]};
+                    AJRCurveStepperInitWithQuadraticCurve(&stepper, curve, AJRQuadraticCurveFlattenedSegmentCount(curve, tolerance));
+                    while (AJRCurveStepperNextPoint(&stepper, &point)) {
+                        [self _appendPoint:point];
+                    }
+                    current = points[1];
+                    break;
+                }
+                case AJRBezierPathElementClose:
+                    _subpaths[_subpathCount - 1].closed = YES;
+                    // The close draws back to the start, so if the last element already ended there, the point would just repeat.
+                    if (_pointCount - _subpaths[_subpathCount - 1].start > 1 && CGPointEqualToPoint(_points[_pointCount - 1], subpathStart)) {
+                        _pointCount -= 1;
+                    }
+                    current = subpathStart;
+                    needsSubpath = YES;
+                    break;
+                default:
+                    break;
+            }
+            _subpaths[_subpathCount - 1].count = _pointCount - _subpaths[_subpathCount - 1].start;
+        }
+        [self _endSubpath];
+        // We usually live in a cache, so don't hang onto room we'll never use.
+        if (_pointCount && _pointCount < _maxPoints) {
+            _maxPoints = _pointCount;
+            _points = NSZoneRealloc(nil, _points, _maxPoints * sizeof(CGPoint));
+        }
+    }
+    return self;
+}
+
+- (void)dealloc {
+    if (_points) NSZoneFree(nil, _points);
+    if (_subpaths) NSZoneFree(nil, _subpaths);
+}
+
+#pragma mark - Properties
+
+- (const CGPoint *)points {
+    return _points;
+}
+
+- (NSUInteger)pointCount {
+    return _pointCount;
+}
+
+- (NSUInteger)subpathCount {
+    return _subpathCount;
+}
+
+- (NSRange)rangeOfSubpathAtIndex:(NSUInteger)index {
+    if (index >= _subpathCount) {
+        [NSException raise:NSRangeException format:@"Subpath index %lu is out of range [0..%lu].", (unsigned long)index, (unsigned long)_subpathCount];
+    }
+    return NSMakeRange(_subpaths[index].start, _subpaths[index].count);
+}
+
+- (BOOL)isSubpathClosedAtIndex:(NSUInteger)index {
+    if (index >= _subpathCount) {
+        [NSException raise:NSRangeException format:@"Subpath index %lu is out of range [0..%lu].", (unsigned long)index, (unsigned long)_subpathCount];
+    }
+    return _subpaths[index].closed;
+}
+
+- (NSUInteger)byteCount {
+    return _maxPoints * sizeof(CGPoint) + _maxSubpaths * sizeof(AJRFlattenedSubpath);
+}
+
+#pragma mark - Using the Path
+
+- (void)enumerateLineSegmentsUsingBlock:(void (^)(AJRLine lineSegment, BOOL isNewSubpath, BOOL *stop))block {
+    BOOL stop = NO;
+    
+    for (NSUInteger x = 0; x < _subpathCount && !stop; x++) {
+        const CGPoint *points = _points + _subpaths[x].start;
+        NSUInteger count = _subpaths[x].count;
+        
+        for (NSUInteger y = 1; y < count && !stop; y++) {
+            block((AJRLine){points[y - 1], points[y]}, y == 1, &stop);
+        }
+        if (_subpaths[x].closed && !stop) {
+            block((AJRLine){points[count - 1], points[0]}, NO, &stop);
+        }
+    }
+}
+
+- (void)addToContext:(CGContextRef)context {
+    for (NSUInteger x = 0; x < _subpathCount; x++) {
+        CGContextAddLines(context, _points + _subpaths[x].start, _subpaths[x].count);
+        if (_subpaths[x].closed) {
+            CGContextClosePath(context);
+        }
+    }
+}
+
+@end
@@ -45,8 +45,64 @@
 #define AJRLeftAndRightDirectionMask 0x03
 #define AJRTopAndBottomDirectionMask 0x0C
 
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_OPTIONS(uint8_t, AJRIntersectionFlags) {
+    AJRIntersectionFlagEndPoint = 0x01,
+    AJRIntersectionFlagLinear = 0x02,
+    AJRIntersectionFlagUser3 = 0x04,
+    AJRIntersectionFlagUser4 = 0x08,
+};
+
+/*!
+ A single intersection, as a plain value. This is what AJRIntersection wraps, and what the C functions below produce, so that queries that find many intersections don't have to create an object for each one.
+ */
+typedef struct _ajrIntersectionRecord {
+    CGPoint point;
+    /*! Where along the path segment the intersection falls, from 0.0 at its start to 1.0 at its end. */
+    double t;
+    /*! The index of the path element that was intersected. */
+    NSUInteger segment;
+    /*! Which way the path segment is heading at the intersection, as a combination of the direction constants above. */
+    NSUInteger direction;
+    AJRIntersectionFlags flags;
+} AJRIntersectionRecord;
+
+/*!
+ A growable array of intersection records. Start with one that's all zeros, or AJRIntersectionBufferInit(), and call AJRIntersectionBufferFree() when you're done. Reusing a buffer across queries, emptying it with AJRIntersectionBufferRemoveAll() in between, means it stops allocating once it's big enough.
+ */
+typedef struct _ajrIntersectionBuffer {
+    AJRIntersectionRecord * _Nullable records;
+    NSUInteger count;
+    NSUInteger capacity;
+} AJRIntersectionBuffer;
+
+extern void AJRIntersectionBufferInit(AJRIntersectionBuffer *buffer);
+extern void AJRIntersectionBufferFree(AJRIntersectionBuffer *buffer);
+/*! Empties the buffer, but keeps its storage. */
+extern void AJRIntersectionBufferRemoveAll(AJRIntersectionBuffer *buffer);
+/*! Appends a zeroed record, and returns it for filling in. The pointer is only good until the buffer next grows. */
+extern AJRIntersectionRecord *AJRIntersectionBufferAppend(AJRIntersectionBuffer *buffer);
+/*! Sorts in place by position along the path: by segment, then by t within a segment. */
+extern void AJRIntersectionBufferSortByParameter(AJRIntersectionBuffer *buffer);
+/*! Sorts in place by distance from point, nearest first. */
+extern void AJRIntersectionBufferSortFromPoint(AJRIntersectionBuffer *buffer, CGPoint point);
+
+/*! Intersects line with segment, a piece of a path. Returns NO if they don't cross or are parallel. Otherwise fills in record, with t measured along segment. The record's segment index is left alone. */
+extern BOOL AJRIntersectLineWithLine(AJRLine line, AJRLine segment, AJRIntersectionRecord *record);
+/*! Appends the intersections of line with curve to buffer, in order along the curve, and returns how many there were. They're solved for exactly, using AJRBezierCurveIntersectLine(). Each record's segment index is set to segmentIndex. */
+extern NSInteger AJRIntersectCurveWithLine(AJRBezierCurve curve, AJRLine line, NSUInteger segmentIndex, AJRIntersectionBuffer *buffer);
+extern NSInteger AJRIntersectQuadraticCurveWithLine(AJRQuadraticCurve curve, AJRLine line, NSUInteger segmentIndex, AJRIntersectionBuffer *buffer);
+
+NS_ASSUME_NONNULL_END
+
 @interface AJRIntersection : NSObject <NSCopying, NSCoding>
 
+/*! Wraps record in an object, for APIs that traffic in AJRIntersection. */
++ (instancetype)intersectionWithRecord:(AJRIntersectionRecord)record;
+- (instancetype)initWithRecord:(AJRIntersectionRecord)record;
+@property (nonatomic,readonly) AJRIntersectionRecord record;
+
 + (id)intersectionWithPoint:(CGPoint)aPoint direction:(NSUInteger)direction segment:(NSUInteger)segment;
 - (id)initWithPoint:(CGPoint)aPoint direction:(NSUInteger)direction segment:(NSUInteger)segment;
 
@@ -76,10 +132,13 @@
 + (NSArray *)intersectionsForLine:(AJRLine)line withCircularArcAt:(CGPoint)origin radius:(double)radius startingAt:(double)startAngle endingAt:(double)endAngle;
 // Calls intersectionsForLine:withArcBoundedBy:startingAt:endingAt: with a square bounds and startAngle 0 and endAngle 360.0
 + (NSArray *)intersectionsForLine:(AJRLine)line withCircleAt:(CGPoint)origin radius:(double)radius;
-// Returns the intersections of a bezier curve with a line. This will produce one to three intersections. If the curve does not intersection the line segment, then nil is returned.
+// Returns the intersections of a bezier curve with a line, in order along the curve, each with its t on the curve. This will produce one to three intersections. If the curve does not intersection the line segment, then nil is returned. The intersections are solved for exactly, so error is ignored.
 + (NSArray *)intersectionsForCurve:(AJRBezierCurve)curve withLine:(AJRLine)line error:(double)error;
+// As above, but with one or two intersections.
 + (NSArray *)intersectionsForQuadraticCurve:(AJRQuadraticCurve)curve withLine:(AJRLine)line error:(double)error;
+// Returns the point on the curve nearest to aPoint, with its t. The intersection is flagged as an end point if the nearest point is one of the curve's ends.
 + (id)intersectionForCurve:(AJRBezierCurve)curve withPoint:(CGPoint)aPoint;
+// As above, for a quadratic curve.
 + (id)intersectionForQuadraticCurve:(AJRQuadraticCurve)curve withPoint:(CGPoint)aPoint;
 
 + (id)intersectionForLine:(AJRLine)line1 withPerpendicularLineThroughPoint:(CGPoint)aPoint;
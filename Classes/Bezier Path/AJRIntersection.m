@@ -33,16 +33,201 @@
 
 #import "AJRGeometry.h"
 
+#pragma mark - Intersection Buffers
+
+void AJRIntersectionBufferInit(AJRIntersectionBuffer *buffer) {
+    buffer->records = NULL;
+    buffer->count = 0;
+    buffer->capacity = 0;
+}
+
+void AJRIntersectionBufferFree(AJRIntersectionBuffer *buffer) {
+    if (buffer->records) NSZoneFree(nil, buffer->records);
+    AJRIntersectionBufferInit(buffer);
+}
+
+void AJRIntersectionBufferRemoveAll(AJRIntersectionBuffer *buffer) {
+    buffer->count = 0;
+}
+
+AJRIntersectionRecord *AJRIntersectionBufferAppend(AJRIntersectionBuffer *buffer) {
+    AJRIntersectionRecord *record;
+    
+    if (buffer->count == buffer->capacity) {
+        buffer->capacity = buffer->capacity < 8 ? 8 : buffer->capacity * 2;
+        if (buffer->records) {
+            buffer->records = NSZoneRealloc(nil, buffer->records, buffer->capacity * sizeof(AJRIntersectionRecord));
+        } else {
+            buffer->records = NSZoneMalloc(nil, buffer->capacity * sizeof(AJRIntersectionRecord));
+        }
+    }
+    record = buffer->records + buffer->count++;
+    memset(record, 0, sizeof(AJRIntersectionRecord));
+    
+    return record;
+}
+
+static int AJRIntersectionRecordCompareParameter(const void *left, const void *right) {
+    const AJRIntersectionRecord *one = left;
+    const AJRIntersectionRecord *two = right;
+    
+    if (one->segment != two->segment) return one->segment < two->segment ? -1 : 1;
+    if (one->t != two->t) return one->t < two->t ? -1 : 1;
+    return 0;
+}
+
+void AJRIntersectionBufferSortByParameter(AJRIntersectionBuffer *buffer) {
+    if (buffer->count > 1) {
+        qsort(buffer->records, buffer->count, sizeof(AJRIntersectionRecord), AJRIntersectionRecordCompareParameter);
+    }
+}
+
+typedef struct _ajrIntersectionRecordByDistance {
+    double distance;
+    AJRIntersectionRecord record;
+} AJRIntersectionRecordByDistance;
+
+static int AJRIntersectionRecordCompareDistance(const void *left, const void *right) {
+    double distance1 = ((const AJRIntersectionRecordByDistance *)left)->distance;
+    double distance2 = ((const AJRIntersectionRecordByDistance *)right)->distance;
+    
+    if (distance1 == distance2) return 0;
+    return distance1 < distance2 ? -1 : 1;
+}
+
+void AJRIntersectionBufferSortFromPoint(AJRIntersectionBuffer *buffer, CGPoint point) {
+    if (buffer->count > 1) {
+        // qsort() has no way to hand point to the comparison, so each record is sorted along with its distance, which also means each distance is only worked out once.
+        AJRIntersectionRecordByDistance *sorted = NSZoneMalloc(nil, buffer->count * sizeof(AJRIntersectionRecordByDistance));
+        
+        for (NSUInteger x = 0; x < buffer->count; x++) {
+            const AJRIntersectionRecord *record = buffer->records + x;
+            // Squared distances sort the same as distances, without the square roots.
+            sorted[x].distance = (record->point.x - point.x) * (record->point.x - point.x) + (record->point.y - point.y) * (record->point.y - point.y);
+            sorted[x].record = *record;
+        }
+        qsort(sorted, buffer->count, sizeof(AJRIntersectionRecordByDistance), AJRIntersectionRecordCompareDistance);
+        for (NSUInteger x = 0; x < buffer->count; x++) {
+            buffer->records[x] = sorted[x].record;
+        }
+        NSZoneFree(nil, sorted);
+    }
+}
+
+#pragma mark - Intersecting
+
+static NSUInteger AJRIntersectionDirection(CGPoint heading) {
+    return (heading.x > 0.0 ? AJRLeftToRightDirection : AJRRightToLeftDirection) | (heading.y > 0.0 ? AJRTopToBottomDirection : AJRBottomToTopDirection);
+}
+
+BOOL AJRIntersectLineWithLine(AJRLine first, AJRLine second, AJRIntersectionRecord *record) {
+    double a1, a2, b1, b2, c1, c2; // Coefficients of line eqns.
+    double r1, r2, r3, r4;         // 'Sign' values
+    double denom;
+    
+    // Compute a1, b1, c1, where line joining points 1 and 2 is "a1 x  +  b1 y  +  c1  =  0".
+    
+    a1 = (double)first.end.y - (double)first.start.y;
+    b1 = (double)first.start.x - (double)first.end.x;
+    c1 = (double)first.end.x * (double)first.start.y - (double)first.start.x * (double)first.end.y;
+    
+    // Compute r3 and r4.
+    
+    r3 = a1 * (double)second.start.x + b1 * (double)second.start.y + c1;
+    r4 = a1 * (double)second.end.x + b1 * (double)second.end.y + c1;
+    
+    // Check signs of r3 and r4.  If both point 3 and point 4 lie on same side of line 1, the line segments do not intersect.
+    
+    if (r3 != 0.0 && r4 != 0.0 && AJRSameSigns(r3, r4)) {
+        return NO;
+    }
+    
+    // Compute a2, b2, c2
+    
+    a2 = (double)second.end.y - (double)second.start.y;
+    b2 = (double)second.start.x - (double)second.end.x;
+    c2 = (double)second.end.x * (double)second.start.y - (double)second.start.x * (double)second.end.y;
+    
+    // Compute r1 and r2
+    
+    r1 = a2 * (double)first.start.x + b2 * (double)first.start.y + c2;
+    r2 = a2 * (double)first.end.x + b2 * (double)first.end.y + c2;
+    
+    // Check signs of r1 and r2.  If both point 1 and point 2 lie on same side of second line segment, the line segments do not intersect.
+    
+    if ( r1 != 0.0 && r2 != 0.0 && AJRSameSigns(r1, r2)) {
+        return NO;
+    }
+    
+    // Line segments intersect: compute intersection point.
+    
+    denom = a1 * b2 - a2 * b1;
+    if (denom == 0.0) {
+        return NO;
+    }
+    
+    record->point.x = (b1 * c2 - b2 * c1) / denom;
+    record->point.y = (a2 * c1 - a1 * c2) / denom;
+    
+    // The distances of second's ends from first are r3 and r4, so the crossing is r3 / (r3 - r4) of the way along second.
+    record->t = r3 / (r3 - r4);
+    record->direction = (second.start.x < second.end.x ? AJRLeftToRightDirection : AJRRightToLeftDirection) | (second.start.y < second.end.y ? AJRTopToBottomDirection : AJRBottomToTopDirection);
+    record->flags = 0;
+    if (NSEqualPoints(first.start, record->point) || NSEqualPoints(first.end, record->point) || NSEqualPoints(second.start, record->point) || NSEqualPoints(second.end, record->point)) {
+        record->flags |= AJRIntersectionFlagEndPoint;
+    }
+    
+    return YES;
+}
+
+static NSInteger AJRAppendCurveIntersections(double *tValues, CGPoint *points, CGPoint *derivatives, NSInteger count, CGPoint start, CGPoint end, NSUInteger segmentIndex, AJRIntersectionBuffer *buffer) {
+    for (NSInteger x = 0; x < count; x++) {
+        AJRIntersectionRecord *record = AJRIntersectionBufferAppend(buffer);
+        CGPoint heading = derivatives[x];
+        
+        if (heading.x == 0.0 && heading.y == 0.0) {
+            // A cusp has no direction of its own, so fall back on the curve's overall direction.
+            heading = (CGPoint){end.x - start.x, end.y - start.y};
+        }
+        record->point = points[x];
+        record->t = tValues[x];
+        record->segment = segmentIndex;
+        record->direction = AJRIntersectionDirection(heading);
+        if (tValues[x] == 0.0 || tValues[x] == 1.0) {
+            record->flags = AJRIntersectionFlagEndPoint;
+        }
+    }
+    return count;
+}
+
+NSInteger AJRIntersectCurveWithLine(AJRBezierCurve curve, AJRLine line, NSUInteger segmentIndex, AJRIntersectionBuffer *buffer) {
+    double tValues[3];
+    CGPoint points[3];
+    CGPoint derivatives[3];
+    NSInteger count = AJRBezierCurveIntersectLine(curve, line, tValues, points);
+    
+    for (NSInteger x = 0; x < count; x++) {
+        derivatives[x] = AJRBezierCurveDerivativeAtT(curve, tValues[x]);
+    }
+    return AJRAppendCurveIntersections(tValues, points, derivatives, count, curve.start, curve.end, segmentIndex, buffer);
+}
+
+NSInteger AJRIntersectQuadraticCurveWithLine(AJRQuadraticCurve curve, AJRLine line, NSUInteger segmentIndex, AJRIntersectionBuffer *buffer) {
+    double tValues[3];
+    CGPoint points[3];
+    CGPoint derivatives[3];
+    NSInteger count = AJRQuadraticCurveIntersectLine(curve, line, tValues, points);
+    
+    for (NSInteger x = 0; x < count; x++) {
+        derivatives[x] = AJRQuadraticCurveDerivativeAtT(curve, tValues[x]);
+    }
+    return AJRAppendCurveIntersections(tValues, points, derivatives, count, curve.start, curve.end, segmentIndex, buffer);
+}
+
+#pragma mark - AJRIntersection
+
 @implementation AJRIntersection {
-	CGPoint        point;
-	NSUInteger   direction;
-	NSUInteger   segment;
-	double        t;
-	
-    BOOL          isEndPoint;
-    BOOL          linear;
-    BOOL          userFlag3;
-    BOOL          userFlag4;
+    AJRIntersectionRecord _record;
 }
 
 + (id)intersectionWithPoint:(CGPoint)aPoint direction:(NSUInteger)aDirection segment:(NSUInteger)aSegment {
@@ -50,78 +235,101 @@
 }
 
 - (id)initWithPoint:(CGPoint)aPoint direction:(NSUInteger)aDirection segment:(NSUInteger)aSegment {
-    point = aPoint;
-    direction = aDirection;
-    segment = aSegment;
+    _record.point = aPoint;
+    _record.direction = aDirection;
+    _record.segment = aSegment;
     
     return self;
 }
 
++ (instancetype)intersectionWithRecord:(AJRIntersectionRecord)record {
+    return [[self alloc] initWithRecord:record];
+}
+
+- (instancetype)initWithRecord:(AJRIntersectionRecord)record {
+    if ((self = [super init])) {
+        _record = record;
+    }
+    return self;
+}
+
+- (AJRIntersectionRecord)record {
+    return _record;
+}
+
 - (void)sortFromPoint:(CGPoint)aPoint {
 }
 
 - (void)setPoint:(CGPoint)aPoint {
-    point = aPoint;
+    _record.point = aPoint;
 }
 
 - (CGPoint)point {
-    return point;
+    return _record.point;
 }
 
 - (void)setDirection:(NSUInteger)aDirection {
-    direction = aDirection;
+    _record.direction = aDirection;
 }
 
 - (NSUInteger)direction {
-    return direction;
+    return _record.direction;
 }
 
 - (void)setSegment:(NSUInteger)aSegment {
-    segment = aSegment;
+    _record.segment = aSegment;
 }
 
 - (NSUInteger)segment {
-    return segment;
+    return _record.segment;
 }
 
 - (void)setT:(double)tValue {
-    t = tValue;
+    _record.t = tValue;
 }
 
 - (double)t {
-    return t;
+    return _record.t;
+}
+
+- (void)_setFlag:(AJRIntersectionFlags)flag to:(BOOL)value {
+    if (value) {
+        _record.flags |= flag;
+    } else {
+        _record.flags &= ~flag;
+    }
 }
 
 - (void)setIsEndPoint:(BOOL)flag {
-    isEndPoint = flag;
+    [self _setFlag:AJRIntersectionFlagEndPoint to:flag];
 }
 
 - (BOOL)isEndPoint {
-    return isEndPoint;
+    return (_record.flags & AJRIntersectionFlagEndPoint) != 0;
 }
 
 - (void)setLinear:(BOOL)flag {
-    linear = flag;
+    [self _setFlag:AJRIntersectionFlagLinear to:flag];
 }
 
 - (BOOL)linear {
-    return linear;
+    return (_record.flags & AJRIntersectionFlagLinear) != 0;
 }
 
 - (void)setUserFlag3:(BOOL)flag {
-    userFlag3 = flag;
+    [self _setFlag:AJRIntersectionFlagUser3 to:flag];
 }
 
 - (BOOL)userFlag3 {
-    return userFlag3;
+    return (_record.flags & AJRIntersectionFlagUser3) != 0;
 }
 
 - (void)setUserFlag4:(BOOL)flag {
-    userFlag4 = flag;
+    [self _setFlag:AJRIntersectionFlagUser4 to:flag];
 }
 
 - (BOOL)userFlag4 {
-    return userFlag4;
+    return (_record.flags & AJRIntersectionFlagUser4) != 0;
 }
 
 - (id)copy {
@@ -132,41 +340,33 @@
     AJRIntersection    *new;
     
     new = [AJRIntersection allocWithZone:aZone];
-    new->point = point;
-    new->direction = direction;
-    new->segment = segment;
-    new->t = t;
-    
-    new->isEndPoint = isEndPoint;
-    new->linear = linear;
-    new->userFlag3 = userFlag3;
-    new->userFlag4 = userFlag4;
+    new->_record = _record;
     
     return new;
 }
 
 - (id)initWithCoder:(NSCoder *)coder {
-    point = [coder decodePointForKey:@"point"];
-    direction = [coder decodeIntegerForKey:@"direction"];
-    segment = [coder decodeIntegerForKey:@"segment"];
-    t = [coder decodeFloatForKey:@"t"];
-    isEndPoint = [coder decodeBoolForKey:@"isEndPoint"];
-    linear = [coder decodeBoolForKey:@"linear"];
-    userFlag3 = [coder decodeBoolForKey:@"userFlag3"];
-    userFlag4 = [coder decodeBoolForKey:@"userFlag4"];
+    _record.point = [coder decodePointForKey:@"point"];
+    _record.direction = [coder decodeIntegerForKey:@"direction"];
+    _record.segment = [coder decodeIntegerForKey:@"segment"];
+    _record.t = [coder decodeFloatForKey:@"t"];
+    [self setIsEndPoint:[coder decodeBoolForKey:@"isEndPoint"]];
+    [self setLinear:[coder decodeBoolForKey:@"linear"]];
+    [self setUserFlag3:[coder decodeBoolForKey:@"userFlag3"]];
+    [self setUserFlag4:[coder decodeBoolForKey:@"userFlag4"]];
     
     return self;
 }
 
 - (void)encodeWithCoder:(NSCoder *)coder {
-    [coder encodePoint:point forKey:@"point"];
-    [coder encodeInteger:direction forKey:@"direction"];
-    [coder encodeInteger:segment forKey:@"segment"];
-    [coder encodeFloat:t forKey:@"t"];
-    [coder encodeBool:isEndPoint forKey:@"isEndPoint"];
-    [coder encodeBool:linear forKey:@"linear"];
-    [coder encodeBool:userFlag3 forKey:@"userFlag3"];
-    [coder encodeBool:userFlag4 forKey:@"userFlag4"];
+    [coder encodePoint:_record.point forKey:@"point"];
+    [coder encodeInteger:_record.direction forKey:@"direction"];
+    [coder encodeInteger:_record.segment forKey:@"segment"];
+    [coder encodeFloat:_record.t forKey:@"t"];
+    [coder encodeBool:self.isEndPoint forKey:@"isEndPoint"];
+    [coder encodeBool:self.linear forKey:@"linear"];
+    [coder encodeBool:self.userFlag3 forKey:@"userFlag3"];
+    [coder encodeBool:self.userFlag4 forKey:@"userFlag4"];
 }
 
 + (id)_intersectionForLine:(AJRLine)line withPerpendicularLineThroughPoint:(CGPoint)aPoint bounded:(BOOL)flag {
@@ -209,95 +409,34 @@
     }
     
     intersection = [AJRIntersection alloc];
-    intersection->point = iPoint;
-    intersection->direction = 0;
+    intersection->_record.point = iPoint;
+    intersection->_record.direction = 0;
     if (aPoint.x < iPoint.x) {
-        intersection->direction |= AJRLeftToRightDirection;
+        intersection->_record.direction |= AJRLeftToRightDirection;
     } else {
-        intersection->direction |= AJRRightToLeftDirection;
+        intersection->_record.direction |= AJRRightToLeftDirection;
     }
     if (aPoint.y < iPoint.y) {
-        intersection->direction |= AJRTopToBottomDirection;
+        intersection->_record.direction |= AJRTopToBottomDirection;
     } else {
-        intersection->direction |= AJRBottomToTopDirection;
+        intersection->_record.direction |= AJRBottomToTopDirection;
     }
-    intersection->t = iPoint.x / (line.end.x - line.start.x);
+    intersection->_record.t = iPoint.x / (line.end.x - line.start.x);
     
     if (NSEqualPoints(line.start, iPoint) || NSEqualPoints(line.end, iPoint)) {
-        intersection->isEndPoint = YES;
+        intersection->_record.flags |= AJRIntersectionFlagEndPoint;
     }
     
     return intersection;
 }
 
 + (id)intersectionForLine:(AJRLine)first withLine:(AJRLine)second {
-    double a1, a2, b1, b2, c1, c2; // Coefficients of line eqns.
-    double r1, r2, r3, r4;         // 'Sign' values
-    double denom;
-    AJRIntersection *intersection;
-    
-    // Compute a1, b1, c1, where line joining points 1 and 2 is "a1 x  +  b1 y  +  c1  =  0".
-    
-    a1 = (double)first.end.y - (double)first.start.y;
-    b1 = (double)first.start.x - (double)first.end.x;
-    c1 = (double)first.end.x * (double)first.start.y - (double)first.start.x * (double)first.end.y;
+    AJRIntersectionRecord record = {};
     
-    // Compute r3 and r4.
-    
-    r3 = a1 * (double)second.start.x + b1 * (double)second.start.y + c1;
-    r4 = a1 * (double)second.end.x + b1 * (double)second.end.y + c1;
-    
-    // Check signs of r3 and r4.  If both point 3 and point 4 lie on same side of line 1, the line segments do not intersect.
-    
-    if (r3 != 0.0 && r4 != 0.0 && AJRSameSigns(r3, r4)) {
-        return nil;
-    }
-    
-    // Compute a2, b2, c2
-    
-    a2 = (double)second.end.y - (double)second.start.y;
-    b2 = (double)second.start.x - (double)second.end.x;
-    c2 = (double)second.end.x * (double)second.start.y - (double)second.start.x * (double)second.end.y;
-    
-    // Compute r1 and r2
-    
-    r1 = a2 * (double)first.start.x + b2 * (double)first.start.y + c2;
-    r2 = a2 * (double)first.end.x + b2 * (double)first.end.y + c2;
-    
-    // Check signs of r1 and r2.  If both point 1 and point 2 lie on same side of second line segment, the line segments do not intersect.
-    
-    if ( r1 != 0.0 && r2 != 0.0 && AJRSameSigns(r1, r2)) {
-        return nil;
+    if (AJRIntersectLineWithLine(first, second, &record)) {
+        return [AJRIntersection intersectionWithRecord:record];
     }
-    
-    // Line segments intersect: compute intersection point.
-    
-    denom = a1 * b2 - a2 * b1;
-    if (denom == 0.0) {
-        return nil;
-    }
-    
-    intersection = [AJRIntersection alloc];
-    intersection->point.x = (b1 * c2 - b2 * c1) / denom;
-    intersection->point.y = (a2 * c1 - a1 * c2) / denom;
-    
-    intersection->direction = 0;
-    if (second.start.x < second.end.x) {
-        intersection->direction |= AJRLeftToRightDirection;
-    } else {
-        intersection->direction |= AJRRightToLeftDirection;
-    }
-    if (second.start.y < second.end.y) {
-        intersection->direction |= AJRTopToBottomDirection;
-    } else {
-        intersection->direction |= AJRBottomToTopDirection;
-    }
-    
-    if (NSEqualPoints(first.start, intersection->point) || NSEqualPoints(first.end, intersection->point) || NSEqualPoints(second.start, intersection->point) || NSEqualPoints(second.end, intersection->point)) {
-        intersection->isEndPoint = YES;
-    }
-    
-    return intersection;
+    return nil;
 }
 
 + (NSArray *)intersectionsForLine:(AJRLine)line withArcBoundedBy:(CGRect)arcBounds startingAt:(double)startAngle endingAt:(double)endAngle {
@@ -343,7 +482,7 @@
     if (discriminant == 0.0) {
         if ((angle1 >= startAngle) && (angle1 <= endAngle)) {
             intersection = [AJRIntersection alloc];
-            intersection->point = intersection1;
+            intersection->_record.point = intersection1;
             return [NSArray arrayWithObject:intersection];
         } else {
             return nil;
@@ -361,20 +500,20 @@
         otherIntersection = [AJRIntersection alloc];
         
         if (AJRDistanceBetweenPoints(start, intersection1) < AJRDistanceBetweenPoints(start, intersection2)) {
-            intersection->point = intersection1;
-            otherIntersection->point = intersection2;
+            intersection->_record.point = intersection1;
+            otherIntersection->_record.point = intersection2;
         } else {
-            intersection->point = intersection2;
-            otherIntersection->point = intersection1;
+            intersection->_record.point = intersection2;
+            otherIntersection->_record.point = intersection1;
         }
         return [NSArray arrayWithObjects:intersection, otherIntersection, nil];
     } else if ((angle1 >= startAngle) && (angle1 <= endAngle)) {
         intersection = [AJRIntersection alloc];
-        intersection->point = intersection1;
+        intersection->_record.point = intersection1;
         return [NSArray arrayWithObject:intersection];
     } else if ((angle2 >= startAngle) && (angle2 <= endAngle)) {
         intersection = [AJRIntersection alloc];
-        intersection->point = intersection1;
+        intersection->_record.point = intersection1;
         return [NSArray arrayWithObject:intersection];
     }
     
@@ -403,107 +542,57 @@
     return [self intersectionsForLine:line withArcBoundedBy:bounds startingAt:0.0 endingAt:360.0];
 }
 
-+ (void)_fillIntersections:(NSMutableArray *)intersections forCurve:(AJRBezierCurve)curve originalCurve:(AJRBezierCurve)originalCurve withLine:(AJRLine)line error:(double)error {
-    CGPoint midpoint;
-    CGFloat distance;
-    AJRLine handleLine;
++ (NSArray *)_intersectionsInBuffer:(AJRIntersectionBuffer *)buffer {
+    NSMutableArray *intersections = nil;
     
-    handleLine.start = curve.start;
-    handleLine.end = curve.end;
-    
-    //fprintf(stderr, "\t%.1f %.6f moveto\n", handleLine.start.x, handleLine.start.y);
-    //fprintf(stderr, "\t%.1f %.6f lineto\n", handleLine.end.x, handleLine.end.y);
-    
-    // Find the mid point value of the curve and the distance between that midpoint and the line formed by our curve's start and end.
-    midpoint = AJRBezierCurveAtT(curve, 0.5);
-    distance = AJRDistanceBetweenPointAndLine(midpoint, handleLine);
-    
-    // If the distance is less than error, we're sufficiently flat, and we'll compute the intersection. Otherwise, divide our curve in two, and check each side for intersection.
-    if (distance < error) {
-        AJRIntersection    *intersection;
-        
-        intersection = [AJRIntersection intersectionForLine:line withLine:handleLine];
-        
-        if (intersection) {
-            if (NSEqualPoints(intersection->point, originalCurve.start) || NSEqualPoints(intersection->point, originalCurve.end)) {
-                intersection->isEndPoint = YES;
-            }
-            [intersections addObject:intersection];
+    if (buffer->count > 0) {
+        intersections = [[NSMutableArray alloc] initWithCapacity:buffer->count];
+        for (NSUInteger x = 0; x < buffer->count; x++) {
+            [intersections addObject:[AJRIntersection intersectionWithRecord:buffer->records[x]]];
         }
-    } else {
-        AJRBezierCurve        left, right;
-        
-        AJRSplitBezierCurve(curve, &left, &right);
-        
-        [self _fillIntersections:intersections forCurve:left originalCurve:originalCurve withLine:line error:error];
-        [self _fillIntersections:intersections forCurve:right originalCurve:originalCurve withLine:line error:error];
     }
+    AJRIntersectionBufferFree(buffer);
+    
+    return intersections;
 }
 
 + (NSArray *)intersectionsForCurve:(AJRBezierCurve)curve withLine:(AJRLine)line error:(double)error {
-    NSMutableArray    *intersections = [[NSMutableArray alloc] initWithCapacity:3];
-    
-    [self _fillIntersections:intersections forCurve:curve originalCurve:curve withLine:line error:error];
+    AJRIntersectionBuffer buffer = {};
     
-    if ([intersections count] == 0) {
-        return nil;
-    }
+    // This is solved exactly, so error no longer matters.
+    AJRIntersectCurveWithLine(curve, line, 0, &buffer);
     
-    return intersections;
+    return [self _intersectionsInBuffer:&buffer];
 }
 
 + (NSArray *)intersectionsForQuadraticCurve:(AJRQuadraticCurve)curve withLine:(AJRLine)line error:(double)error {
-    NSMutableArray *intersections = [NSMutableArray array];
-
-    // TODO: Make this work!
-    AJRLogWarning(@"%s not yet implemented.", __FUNCTION__);
-
-    return intersections;
-}
-
-+ (void)_findDistanceFromCurve:(AJRBezierCurve)curve withPoint:(CGPoint)aPoint tLower:(double)tLower tUpper:(double)tUpper distance:(double *)shortestDistance t:(double *)shortestT point:(CGPoint *)location {
-    CGFloat distance;
-    CGFloat tValue;
-    CGPoint where;
+    AJRIntersectionBuffer buffer = {};
     
-    // Find the mid point value of the curve and the distance between that midpoint and the line formed by our curve's start and end.
-    tValue = (tLower + tUpper) / 2.0;
-    where = AJRBezierCurveAtT(curve, tValue);
-    distance = AJRDistanceBetweenPoints(where, aPoint);
-    //AJRPrintf(@"t = %.3f [%.3f %.3f]\n", tValue, tLower, tUpper);
+    AJRIntersectQuadraticCurveWithLine(curve, line, 0, &buffer);
     
-    // If the distance is less than error, we're sufficiently flat, and we'll compute the intersection. Otherwise, divide our curve in two, and check each side for intersection.
-    if (distance < *shortestDistance) {
-        *shortestDistance = distance;
-        *shortestT = tValue;
-        *location = where;
-    }
-    
-    if (tUpper - tLower < 0.001) return;
-    
-    [self _findDistanceFromCurve:curve withPoint:aPoint tLower:tLower tUpper:tValue distance:shortestDistance t:shortestT point:location];
-    [self _findDistanceFromCurve:curve withPoint:aPoint tLower:tValue tUpper:tUpper distance:shortestDistance t:shortestT point:location];
+    return [self _intersectionsInBuffer:&buffer];
 }
 
 + (id)intersectionForCurve:(AJRBezierCurve)curve withPoint:(CGPoint)aPoint {
-    AJRIntersection *intersection;
-    double distance = 1000000000.0;
-    
-    intersection = [[AJRIntersection alloc] init];
-    
-    [self _findDistanceFromCurve:curve withPoint:aPoint tLower:0.0 tUpper:1.0 distance:&distance t:&(intersection->t) point:&(intersection->point)];
+    AJRIntersection *intersection = [[AJRIntersection alloc] init];
     
-    if (NSEqualPoints(intersection->point, curve.start) || NSEqualPoints(intersection->point, curve.end)) {
-        intersection->isEndPoint = YES;
+    intersection->_record.t = AJRBezierCurveNearestT(curve, aPoint, 0.0, 1.0, &intersection->_record.point);
+    if (intersection->_record.t == 0.0 || intersection->_record.t == 1.0) {
+        intersection->_record.flags |= AJRIntersectionFlagEndPoint;
     }
     
     return intersection;
 }
 
 + (id)intersectionForQuadraticCurve:(AJRQuadraticCurve)curve withPoint:(CGPoint)aPoint {
-    // TODO: Make this work!
-    AJRLogWarning(@"%s not yet implemented.", __FUNCTION__);
-    return nil;
+    AJRIntersection *intersection = [[AJRIntersection alloc] init];
+    
+    intersection->_record.t = AJRQuadraticCurveNearestT(curve, aPoint, &intersection->_record.point);
+    if (intersection->_record.t == 0.0 || intersection->_record.t == 1.0) {
+        intersection->_record.flags |= AJRIntersectionFlagEndPoint;
+    }
+    
+    return intersection;
 }
 
 + (id)intersectionForLine:(AJRLine)line withPerpendicularLineThroughPoint:(CGPoint)aPoint {
@@ -511,7 +600,7 @@
 }
 
 - (NSString *)description {
-    NSMutableString *string = [NSMutableString stringWithFormat:@"<%@ %p: %@, %lu, 0x%lx, 0x%lx, %@>", [self class], self, NSStringFromPoint(point), segment, direction & AJRLeftAndRightDirectionMask, direction & AJRTopAndBottomDirectionMask, linear ? @"YES" : @"NO"];
+    NSMutableString *string = [NSMutableString stringWithFormat:@"<%@ %p: %@, %lu, 0x%lx, 0x%lx, %@>", [self class], self, NSStringFromPoint(_record.point), _record.segment, _record.direction & AJRLeftAndRightDirectionMask, _record.direction & AJRTopAndBottomDirectionMask, self.linear ? @"YES" : @"NO"];
     
     return string;
 }
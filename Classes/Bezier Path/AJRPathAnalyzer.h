@@ -59,4 +59,44 @@
 
 - (AJRBezierPath *)simplifiedPath;
 
+/*!
+ Returns a copy of the path with as few elements as it takes to stay within tolerance of it. The path is flattened, and Douglas-Peucker keeps only the points that matter. Wherever the outline turns sharply at one of those points, it's kept as a corner. Stretches between corners that came down to a single line stay lines, and the rest have curves fit to them, unless lines take fewer points. Closed subpaths small enough to fit within tolerance are dropped altogether.
+
+ @param tolerance The farthest the simplified path may stray from the path, in the path's own units. This must be greater than 0.
+ */
+- (AJRBezierPath *)simplifiedPathWithTolerance:(CGFloat)tolerance;
+
+@end
+
+
+/*!
+ A path simplified ahead of time to several tolerances, each twice the one before, so that a renderer can draw the coarsest version that still looks right at the scale it's drawing at. Paths with a lot of detail, such as map outlines, draw far fewer segments when zoomed out.
+
+ The levels are all made up front, and never change, so levels of detail may be used from any thread. They don't follow changes to the path they were made from.
+ */
+@interface AJRPathLevelsOfDetail : NSObject
+
+/*!
+ Simplifies path to levelCount tolerances, starting at tolerance, and doubling from there.
+
+ @param tolerance The tolerance of the finest level, in the path's own units. This must be greater than 0.
+ @param levelCount How many levels to make. This must be at least 1.
+ */
+- (instancetype)initWithPath:(AJRBezierPath *)path finestTolerance:(CGFloat)tolerance levelCount:(NSInteger)levelCount;
+
+@property (nonatomic,readonly,strong) AJRBezierPath *path;
+@property (nonatomic,readonly) CGFloat finestTolerance;
+@property (nonatomic,readonly) NSInteger levelCount;
+
+/*! The tolerance level was simplified to. Level 0 is the finest. */
+- (CGFloat)toleranceAtLevel:(NSInteger)level;
+- (AJRBezierPath *)pathAtLevel:(NSInteger)level;
+
+/*! Returns the coarsest level that's within tolerance of the path. When even the finest level isn't close enough, returns the path itself. */
+- (AJRBezierPath *)pathForTolerance:(CGFloat)tolerance;
+/*! Returns the coarsest level that stays within the path's flatness in device space when drawn at scale, just as -[AJRBezierPath flattenedPathForScale:] does. */
+- (AJRBezierPath *)pathForScale:(CGFloat)scale;
+/*! Returns the level to draw with in the current graphics context, using the scale of the context's current transform. */
+- (AJRBezierPath *)pathForCurrentScale;
+
 @end
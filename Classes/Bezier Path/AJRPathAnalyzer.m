@@ -31,13 +31,238 @@
 
 #import "AJRPathAnalyzer.h"
 
+#import "AJRBezierCurves.h"
 #import "AJRBezierPath.h"
+#import "AJRFlattenedPath.h"
 #import "AJRGeometry.h"
+#import "AJRGraphicsUtilities.h"
 #import "AJRPathEnumerator.h"
 #import "AJRTrigonometry.h"
+#import "AJRVector.h"
 
 #import <AJRFoundation/AJRFormat.h>
 
+#pragma mark - Simplification
+
+// Where the outline turns by more than 45 degrees, the simplified path keeps a corner rather than fitting a curve through it.
+#define AJRSimplifyCornerCosine 0.70710678118654752440
+
+/*
+ Simplifies one subpath at a time into a growing list of elements and points, so the whole simplified path can be appended in one go. The buffers are reused from one subpath to the next, and only grow.
+ */
+typedef struct _ajrPathSimplifier {
+    double tolerance;
+    // The subpath being simplified. Closed subpaths repeat their first point at their end.
+    CGPoint *points;
+    BOOL *keep;
+    NSInteger *stack;
+    NSInteger capacity;
+    AJRBezierCurve *curves;
+    NSInteger curveCount;
+    NSInteger curveCapacity;
+    // The simplified path.
+    AJRBezierPathElement *elements;
+    NSInteger elementCount;
+    NSInteger elementCapacity;
+    CGPoint *outputPoints;
+    NSInteger outputPointCount;
+    NSInteger outputPointCapacity;
+} AJRPathSimplifier;
+
+static void AJRPathSimplifierFree(AJRPathSimplifier *simplifier) {
+    NSZoneFree(NULL, simplifier->points);
+    NSZoneFree(NULL, simplifier->keep);
+    NSZoneFree(NULL, simplifier->stack);
+    NSZoneFree(NULL, simplifier->curves);
+    NSZoneFree(NULL, simplifier->elements);
+    NSZoneFree(NULL, simplifier->outputPoints);
+}
+
+static void AJRPathSimplifierEmit(AJRPathSimplifier *simplifier, AJRBezierPathElement element, const CGPoint *points, NSInteger pointCount) {
+    if (simplifier->elementCount == simplifier->elementCapacity) {
+        simplifier->elementCapacity = MAX(simplifier->elementCapacity * 2, 64);
+        simplifier->elements = (AJRBezierPathElement *)NSZoneRealloc(NULL, simplifier->elements, simplifier->elementCapacity * sizeof(AJRBezierPathElement));
+    }
+    if (simplifier->outputPointCount + pointCount > simplifier->outputPointCapacity) {
+        simplifier->outputPointCapacity = MAX(simplifier->outputPointCapacity * 2, simplifier->outputPointCount + pointCount + 64);
+        simplifier->outputPoints = (CGPoint *)NSZoneRealloc(NULL, simplifier->outputPoints, simplifier->outputPointCapacity * sizeof(CGPoint));
+    }
+    simplifier->elements[simplifier->elementCount++] = element;
+    memcpy(simplifier->outputPoints + simplifier->outputPointCount, points, pointCount * sizeof(CGPoint));
+    simplifier->outputPointCount += pointCount;
+}
+
+static void AJRPathSimplifierCollectCurve(AJRBezierCurve curve, void *context) {
+    AJRPathSimplifier *simplifier = (AJRPathSimplifier *)context;
+    
+    if (simplifier->curveCount == simplifier->curveCapacity) {
+        simplifier->curveCapacity = MAX(simplifier->curveCapacity * 2, 16);
+        simplifier->curves = (AJRBezierCurve *)NSZoneRealloc(NULL, simplifier->curves, simplifier->curveCapacity * sizeof(AJRBezierCurve));
+    }
+    simplifier->curves[simplifier->curveCount++] = curve;
+}
+
+// Douglas-Peucker: marks in keep the fewest points that leave every other point within tolerance of the lines joining them. This uses its own stack, rather than recursing, so long outlines can't run out of stack.
+static void AJRPathSimplifierMarkPoints(AJRPathSimplifier *simplifier, NSInteger count, double tolerance) {
+    const CGPoint *points = simplifier->points;
+    BOOL *keep = simplifier->keep;
+    NSInteger *stack = simplifier->stack;
+    NSInteger depth = 0;
+    
+    memset(keep, 0, count * sizeof(BOOL));
+    keep[0] = YES;
+    keep[count - 1] = YES;
+    stack[depth++] = 0;
+    stack[depth++] = count - 1;
+    
+    while (depth > 0) {
+        NSInteger last = stack[--depth];
+        NSInteger first = stack[--depth];
+        NSInteger farthest = -1;
+        double farthestDistance = tolerance;
+        
+        for (NSInteger x = first + 1; x < last; x++) {
+            double distance = AJRDistanceBetweenPointAndLineSegment(points[x], (AJRLine){points[first], points[last]});
+            if (distance > farthestDistance) {
+                farthestDistance = distance;
+                farthest = x;
+            }
+        }
+        if (farthest >= 0) {
+            // The two halves don't overlap, so there are never more ranges waiting than there are points.
+            keep[farthest] = YES;
+            stack[depth++] = first;
+            stack[depth++] = farthest;
+            stack[depth++] = farthest;
+            stack[depth++] = last;
+        }
+    }
+}
+
+// Returns the cosine of the angle the outline turns through at index, which is 1 where it runs straight on, and -1 where it doubles back. In a closed subpath, where the last point repeats the first, the turn is found across the join.
+static double AJRPathSimplifierTurnCosine(const CGPoint *points, NSInteger count, BOOL closed, NSInteger index) {
+    NSInteger uniqueCount = closed ? count - 1 : count;
+    NSInteger before = index, after = index;
+    CGPoint point = points[index % uniqueCount];
+    CGPoint incoming = CGPointZero, outgoing = CGPointZero;
+    
+    // Step past any points sitting on top of this one.
+    for (NSInteger x = 1; x < uniqueCount; x++) {
+        before = index - x;
+        if (before < 0) {
+            if (!closed) {
+                return 1.0;
+            }
+            before += uniqueCount;
+        }
+        incoming = AJRVectorSubtract(point, points[before]);
+        if (incoming.x != 0.0 || incoming.y != 0.0) {
+            break;
+        }
+    }
+    for (NSInteger x = 1; x < uniqueCount; x++) {
+        after = index + x;
+        if (after >= uniqueCount) {
+            if (!closed) {
+                return 1.0;
+            }
+            after -= uniqueCount;
+        }
+        outgoing = AJRVectorSubtract(points[after], point);
+        if (outgoing.x != 0.0 || outgoing.y != 0.0) {
+            break;
+        }
+    }
+    
+    return AJRVectorDotProduct(AJRVectorNormalize(incoming), AJRVectorNormalize(outgoing));
+}
+
+// Appends the stretch of the subpath between two corners, from first to last, which has already been started at first. Stretches Douglas-Peucker reduced to a single line stay a line. Otherwise, curves are fit to every point in the stretch, unless they'd take more points than the lines do.
+static void AJRPathSimplifierEmitRun(AJRPathSimplifier *simplifier, NSInteger first, NSInteger last, BOOL isClosingRun) {
+    const CGPoint *points = simplifier->points;
+    NSInteger lineCount = 1;
+    
+    for (NSInteger x = first + 1; x < last; x++) {
+        if (simplifier->keep[x]) {
+            lineCount += 1;
+        }
+    }
+    
+    if (lineCount > 1) {
+        simplifier->curveCount = 0;
+        AJRBezierCurvesFromPoints(points + first, last - first + 1, simplifier->tolerance / 2.0, AJRPathSimplifierCollectCurve, simplifier);
+        if (simplifier->curveCount * 3 <= lineCount) {
+            for (NSInteger x = 0; x < simplifier->curveCount; x++) {
+                AJRPathSimplifierEmit(simplifier, AJRBezierPathElementCubicCurveTo, &simplifier->curves[x].handle1, 3);
+            }
+            return;
+        }
+    }
+    
+    for (NSInteger x = first + 1; x <= last; x++) {
+        // A closing line back to the start is left to the close.
+        if (simplifier->keep[x] && !(x == last && isClosingRun)) {
+            AJRPathSimplifierEmit(simplifier, AJRBezierPathElementLineTo, &points[x], 1);
+        }
+    }
+}
+
+static void AJRPathSimplifierAddSubpath(AJRPathSimplifier *simplifier, const CGPoint *subpathPoints, NSInteger subpathCount, BOOL closed) {
+    NSInteger count = closed ? subpathCount + 1 : subpathCount;
+    NSInteger start = 0;
+    NSInteger runStart = 0;
+    BOOL hasInteriorPoints = NO;
+    
+    if (subpathCount == 0) {
+        return;
+    }
+    if (count > simplifier->capacity) {
+        simplifier->capacity = MAX(count, simplifier->capacity * 2);
+        simplifier->points = (CGPoint *)NSZoneRealloc(NULL, simplifier->points, simplifier->capacity * sizeof(CGPoint));
+        simplifier->keep = (BOOL *)NSZoneRealloc(NULL, simplifier->keep, simplifier->capacity * sizeof(BOOL));
+        simplifier->stack = (NSInteger *)NSZoneRealloc(NULL, simplifier->stack, 2 * simplifier->capacity * sizeof(NSInteger));
+    }
+    
+    if (closed) {
+        // Start a closed subpath at its sharpest corner, if it has one, so that no curve has to be fit across a corner, and no corner is lost.
+        double sharpest = AJRSimplifyCornerCosine;
+        for (NSInteger x = 0; x < subpathCount; x++) {
+            double turn = AJRPathSimplifierTurnCosine(subpathPoints, subpathCount + 1, YES, x);
+            if (turn < sharpest) {
+                sharpest = turn;
+                start = x;
+            }
+        }
+        memcpy(simplifier->points, subpathPoints + start, (subpathCount - start) * sizeof(CGPoint));
+        memcpy(simplifier->points + subpathCount - start, subpathPoints, start * sizeof(CGPoint));
+        simplifier->points[subpathCount] = simplifier->points[0];
+    } else {
+        memcpy(simplifier->points, subpathPoints, subpathCount * sizeof(CGPoint));
+    }
+    
+    if (count > 1) {
+        AJRPathSimplifierMarkPoints(simplifier, count, simplifier->tolerance * 0.75);
+        for (NSInteger x = 1; x < count - 1 && !hasInteriorPoints; x++) {
+            hasInteriorPoints = simplifier->keep[x];
+        }
+    }
+    // A closed subpath that fits within the tolerance of a single point, such as a small island at a coarse level of detail, has nothing left to draw, so it's dropped.
+    if (closed && !hasInteriorPoints) {
+        return;
+    }
+    
+    AJRPathSimplifierEmit(simplifier, AJRBezierPathElementMoveTo, &simplifier->points[0], 1);
+    for (NSInteger x = 1; x < count; x++) {
+        if (x == count - 1 || (simplifier->keep[x] && AJRPathSimplifierTurnCosine(simplifier->points, count, closed, x) < AJRSimplifyCornerCosine)) {
+            AJRPathSimplifierEmitRun(simplifier, runStart, x, closed && x == count - 1);
+            runStart = x;
+        }
+    }
+    if (closed) {
+        AJRPathSimplifierEmit(simplifier, AJRBezierPathElementClose, NULL, 0);
+    }
+}
+
 @implementation AJRPathAnalysisCorner
 
 #pragma mark NSObject
@@ -161,6 +386,35 @@
     return path;
 }
 
+- (AJRBezierPath *)simplifiedPathWithTolerance:(CGFloat)tolerance {
+    AJRFlattenedPath *flattened;
+    AJRBezierPath *simplified;
+    AJRPathSimplifier simplifier = { .tolerance = tolerance };
+    
+    if (!(tolerance > 0.0) || isinf(tolerance)) {
+        [NSException raise:NSInvalidArgumentException format:@"A path can't be simplified to a tolerance of %g.", tolerance];
+    }
+    
+    // The flattening takes up a quarter of the tolerance, and Douglas-Peucker or the curve fitting the rest. We make our own flattening, rather than asking the path, so as not to push the levels of detail it's drawing with out of the cache.
+    flattened = [[AJRFlattenedPath alloc] initWithPath:_path tolerance:tolerance / 4.0];
+    for (NSUInteger x = 0; x < flattened.subpathCount; x++) {
+        NSRange range = [flattened rangeOfSubpathAtIndex:x];
+        AJRPathSimplifierAddSubpath(&simplifier, flattened.points + range.location, range.length, [flattened isSubpathClosedAtIndex:x]);
+    }
+    
+    simplified = [[AJRBezierPath alloc] init];
+    [simplified setWindingRule:[_path windingRule]];
+    [simplified setLineJoinStyle:[_path lineJoinStyle]];
+    [simplified setLineCapStyle:[_path lineCapStyle]];
+    [simplified setLineWidth:[_path lineWidth]];
+    [simplified setMiterLimit:[_path miterLimit]];
+    [simplified setFlatness:[_path flatness]];
+    [simplified appendElements:simplifier.elements count:simplifier.elementCount points:simplifier.outputPoints count:simplifier.outputPointCount];
+    AJRPathSimplifierFree(&simplifier);
+    
+    return simplified;
+}
+
 #pragma mark - NSObject
 
 - (NSString *)description {
@@ -168,3 +422,79 @@
 }
 
 @end
+
+
+@implementation AJRPathLevelsOfDetail {
+    NSArray<AJRBezierPath *> *_levels;
+}
+
+#pragma mark Creation
+
+- (instancetype)initWithPath:(AJRBezierPath *)path finestTolerance:(CGFloat)tolerance levelCount:(NSInteger)levelCount {
+    if (!(tolerance > 0.0) || isinf(tolerance)) {
+        [NSException raise:NSInvalidArgumentException format:@"A path can't be simplified to a tolerance of %g.", tolerance];
+    }
+    if (levelCount < 1) {
+        [NSException raise:NSInvalidArgumentException format:@"Levels of detail need at least one level, not %ld.", (long)levelCount];
+    }
+    if ((self = [super init])) {
+        AJRPathAnalyzer *analyzer = [[AJRPathAnalyzer alloc] initWithPath:path];
+        NSMutableArray<AJRBezierPath *> *levels = [NSMutableArray arrayWithCapacity:levelCount];
+        
+        _path = path;
+        _finestTolerance = tolerance;
+        // Every level is simplified from the path itself, rather than from the level before, so the errors don't add up.
+        for (NSInteger x = 0; x < levelCount; x++) {
+            [levels addObject:[analyzer simplifiedPathWithTolerance:[self toleranceAtLevel:x]]];
+        }
+        _levels = levels;
+    }
+    return self;
+}
+
+#pragma mark Levels
+
+- (NSInteger)levelCount {
+    return _levels.count;
+}
+
+- (CGFloat)toleranceAtLevel:(NSInteger)level {
+    return ldexp(_finestTolerance, (int)level);
+}
+
+- (AJRBezierPath *)pathAtLevel:(NSInteger)level {
+    if (level < 0 || level >= _levels.count) {
+        [NSException raise:NSRangeException format:@"Index %ld is out of range [0..%lu]", (long)level, (unsigned long)_levels.count - 1];
+    }
+    return _levels[level];
+}
+
+- (AJRBezierPath *)pathForTolerance:(CGFloat)tolerance {
+    NSInteger level;
+    
+    if (tolerance < _finestTolerance) {
+        return _path;
+    }
+    level = MIN((NSInteger)floor(log2(tolerance / _finestTolerance)), (NSInteger)_levels.count - 1);
+    
+    return _levels[level];
+}
+
+- (AJRBezierPath *)pathForScale:(CGFloat)scale {
+    // Like flattening, this keeps within the path's flatness in device space.
+    CGFloat flatness = [_path flatness] > 0.0 ? [_path flatness] : 0.1;
+    
+    return [self pathForTolerance:flatness / MAX(scale, 1.0e-6)];
+}
+
+- (AJRBezierPath *)pathForCurrentScale {
+    return [self pathForScale:AJRGetCurrentScale()];
+}
+
+#pragma mark - NSObject
+
+- (NSString *)description {
+    return AJRFormat(@"<%C: %ld levels from %g>", self, (long)_levels.count, _finestTolerance);
+}
+
+@end
@@ -0,0 +1,70 @@
+/*
+ AJRPathBoolean.h
+ AJRInterfaceFoundation
+
+ Copyright © 2022, AJ Raftis and AJRInterfaceFoundation authors
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of AJRInterfaceFoundation nor the names of its contributors may be
+   used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL AJ RAFTIS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#import <AJRInterfaceFoundation/AJRBezierPath.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(NSInteger, AJRPathBooleanOperation) {
+    /*! Everything inside any of the paths. */
+    AJRPathBooleanOperationUnion,
+    /*! Everything inside all of the paths. */
+    AJRPathBooleanOperationIntersection,
+    /*! Everything inside the first path, but not inside any of the others. */
+    AJRPathBooleanOperationSubtraction,
+    /*! Everything inside an odd number of the paths. */
+    AJRPathBooleanOperationExclusiveOr,
+};
+
+/*!
+ Combines any number of paths in a single pass, without going through CGPath, so it works anywhere the framework does.
+
+ Every path is treated as filled, so open subpaths are implicitly closed, and each path's inside is decided by its own winding rule. Curves are split into monotone pieces and flattened to within the first path's flatness to find the intersections, but the pieces of curves that survive are rebuilt from the original curves, so the result still contains curves. The result is an instance of the first path's class and uses the non-zero winding rule, with its outer contours running counter clockwise and its holes clockwise (when y points up).
+
+ @param paths The paths to combine. These may be AJRBezierPaths or NSBezierPaths.
+ @param operation How to combine them.
+
+ @return The combined path, or nil if paths is empty.
+ */
+extern id <AJRBezierPathProtocol> _Nullable AJRBezierPathByApplyingBooleanOperation(NSArray<id <AJRBezierPathProtocol>> *paths, AJRPathBooleanOperation operation);
+
+/*!
+ Unions a large number of paths. This produces the same shape as AJRBezierPathByApplyingBooleanOperation() with AJRPathBooleanOperationUnion, but scales much better when there are hundreds or thousands of paths, such as when merging the shapes of a map or a layout.
+
+ Paths whose bounds don't overlap, directly or through a chain of other paths, are split into separate clusters, and each cluster is unioned on its own. Within a cluster, the paths are ordered along a space filling curve, unioned in small groups, and the group results are merged pairwise until one remains. The clusters and the merges at each level run concurrently. Paths that lie entirely inside another path are dropped before any of this starts.
+
+ @param paths The paths to union. These may be AJRBezierPaths or NSBezierPaths, and must not be mutated while the union runs. When there are more than a few, any NSBezierPaths are first copied into AJRBezierPaths on the calling thread, and the result is an AJRBezierPath.
+
+ @return The union, or nil if paths is empty.
+ */
+extern id <AJRBezierPathProtocol> _Nullable AJRBezierPathByUnioningManyPaths(NSArray<id <AJRBezierPathProtocol>> *paths);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,1258 @@
+/*
+ AJRPathBoolean.m
+ AJRInterfaceFoundation
+
+ Copyright © 2022, AJ Raftis and AJRInterfaceFoundation authors
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of AJRInterfaceFoundation nor the names of its contributors may be
+   used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL AJ RAFTIS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#import "AJRPathBoolean.h"
+
+#import "AJRBezierCurves.h"
+#import "AJRBezierPathP.h"
+#import "AJRPathIterator.h"
+
+// Points closer than this, relative to the size of the coordinates involved, are treated as lying on an edge.
+#define AJRBooleanRelativeTolerance 1e-9
+// Splitting an edge bends it very slightly, which can, rarely, create a crossing that wasn't there before, so we keep splitting until nothing crosses, but not forever.
+#define AJRBooleanMaxSplitPasses 8
+
+typedef struct _ajrBooleanEdge {
+    // Edges are stored with start below end, or to the left of it when they're horizontal.
+    CGPoint start;
+    CGPoint end;
+    // Where start and end fall on curves[curveIndex], which is -1 for straight lines.
+    double startT;
+    double endT;
+    NSInteger curveIndex;
+    NSInteger operand;
+    // 1 if the path runs from start to end, -1 if it runs from end to start.
+    NSInteger direction;
+} AJRBooleanEdge;
+
+typedef struct _ajrBooleanSplit {
+    NSUInteger edgeIndex;
+    // How far along the edge the split falls, from 0 to 1.
+    double position;
+    CGPoint point;
+} AJRBooleanSplit;
+
+// A run of identical edges, which may come from several operands.
+typedef struct _ajrBooleanGroup {
+    NSUInteger first;
+    NSUInteger count;
+    // The height the group is measured at.
+    double y;
+} AJRBooleanGroup;
+
+// An edge of the result, pointed so that the inside of the result is on its left.
+typedef struct _ajrBooleanOutputEdge {
+    CGPoint from;
+    CGPoint to;
+    double fromT;
+    double toT;
+    NSInteger curveIndex;
+} AJRBooleanOutputEdge;
+
+typedef struct _ajrBooleanContext {
+    AJRBooleanEdge *edges;
+    NSUInteger edgeCount;
+    NSUInteger maxEdges;
+    AJRBezierCurve *curves;
+    NSUInteger curveCount;
+    NSUInteger maxCurves;
+    AJRWindingRule *windingRules;
+    NSInteger operandCount;
+    double error;
+    double tolerance;
+} AJRBooleanContext;
+
+#pragma mark - Edges
+
+static inline BOOL AJRBooleanPointsAreEqual(CGPoint a, CGPoint b) {
+    return a.x == b.x && a.y == b.y;
+}
+
+static inline NSInteger AJRBooleanComparePoints(CGPoint a, CGPoint b) {
+    if (a.y != b.y) return a.y < b.y ? -1 : 1;
+    if (a.x != b.x) return a.x < b.x ? -1 : 1;
+    return 0;
+}
+
+static void AJRBooleanAppendEdge(AJRBooleanContext *context, CGPoint from, CGPoint to, double fromT, double toT, NSInteger curveIndex, NSInteger operand, NSInteger direction) {
+    if (AJRBooleanPointsAreEqual(from, to)) {
+        return;
+    }
+    if (context->edgeCount == context->maxEdges) {
+        context->maxEdges = context->maxEdges ? context->maxEdges * 2 : 64;
+        context->edges = NSZoneRealloc(nil, context->edges, context->maxEdges * sizeof(AJRBooleanEdge));
+    }
+    if (AJRBooleanComparePoints(from, to) < 0) {
+        context->edges[context->edgeCount] = (AJRBooleanEdge){from, to, fromT, toT, curveIndex, operand, direction};
+    } else {
+        context->edges[context->edgeCount] = (AJRBooleanEdge){to, from, toT, fromT, curveIndex, operand, -direction};
+    }
+    context->edgeCount += 1;
+}
+
+// Splits the curve into monotone pieces, so every extremum becomes a vertex, and flattens each piece. The edges remember which part of the curve they came from, so the curve can be rebuilt once we know which parts survive.
+static void AJRBooleanAppendCurve(AJRBooleanContext *context, AJRBezierCurve curve, NSInteger operand) {
+    double tValues[6];
+    CGPoint boundaries[6];
+    NSInteger count;
+    NSInteger curveIndex;
+    
+    if (context->curveCount == context->maxCurves) {
+        context->maxCurves = context->maxCurves ? context->maxCurves * 2 : 16;
+        context->curves = NSZoneRealloc(nil, context->curves, context->maxCurves * sizeof(AJRBezierCurve));
+    }
+    curveIndex = context->curveCount;
+    context->curves[curveIndex] = curve;
+    context->curveCount += 1;
+    
+    tValues[0] = 0.0;
+    count = AJRBezierCurveGetMonotoneTValues(curve, tValues + 1) + 1;
+    tValues[count] = 1.0;
+    count += 1;
+    
+    // Compute each boundary once, so neighbouring pieces share it exactly.
+    boundaries[0] = curve.start;
+    for (NSInteger x = 1; x < count - 1; x++) {
+        boundaries[x] = AJRBezierCurveAtT(curve, tValues[x]);
+    }
+    boundaries[count - 1] = curve.end;
+    
+    for (NSInteger x = 0; x < count - 1; x++) {
+        AJRBezierCurve piece = AJRBezierCurveGetSubcurve(curve, tValues[x], tValues[x + 1]);
+        AJRCurveStepper stepper;
+        CGPoint previous = boundaries[x], point;
+        double previousT = tValues[x];
+        
+        piece.start = boundaries[x];
+        piece.end = boundaries[x + 1];
+        AJRCurveStepperInitWithBezierCurve(&stepper, piece, AJRBezierCurveFlattenedSegmentCount(piece, context->error));
+        while (AJRCurveStepperNextPoint(&stepper, &point)) {
+            double t = stepper.step == stepper.segmentCount ? tValues[x + 1] : tValues[x] + (tValues[x + 1] - tValues[x]) * AJRCurveStepperGetT(&stepper);
+            AJRBooleanAppendEdge(context, previous, point, previousT, t, curveIndex, operand, 1);
+            previous = point;
+            previousT = t;
+        }
+    }
+}
+
+static void AJRBooleanComputeTolerance(AJRBooleanContext *context) {
+    double magnitude = 1.0;
+    
+    for (NSUInteger x = 0; x < context->edgeCount; x++) {
+        const AJRBooleanEdge *edge = context->edges + x;
+        magnitude = MAX(magnitude, MAX(MAX(fabs(edge->start.x), fabs(edge->start.y)), MAX(fabs(edge->end.x), fabs(edge->end.y))));
+    }
+    context->tolerance = magnitude * AJRBooleanRelativeTolerance;
+}
+
+#pragma mark - Splitting
+
+static int AJRBooleanCompareEdgeStarts(const void *left, const void *right) {
+    const AJRBooleanEdge *a = left, *b = right;
+    NSInteger result = AJRBooleanComparePoints(a->start, b->start);
+    
+    return (int)(result ? result : AJRBooleanComparePoints(a->end, b->end));
+}
+
+static int AJRBooleanCompareSplits(const void *left, const void *right) {
+    const AJRBooleanSplit *a = left, *b = right;
+    
+    if (a->edgeIndex != b->edgeIndex) return a->edgeIndex < b->edgeIndex ? -1 : 1;
+    if (a->position != b->position) return a->position < b->position ? -1 : 1;
+    return 0;
+}
+
+static void AJRBooleanAppendSplit(AJRBooleanSplit **splits, NSUInteger *count, NSUInteger *max, NSUInteger edgeIndex, double position, CGPoint point) {
+    if (*count == *max) {
+        *max = *max ? *max * 2 : 64;
+        *splits = NSZoneRealloc(nil, *splits, *max * sizeof(AJRBooleanSplit));
+    }
+    (*splits)[*count] = (AJRBooleanSplit){edgeIndex, position, point};
+    *count += 1;
+}
+
+// Returns YES if point lies on edge, other than at its end points, and if so, how far along the edge it lies.
+static BOOL AJRBooleanPointIsOnEdge(const AJRBooleanEdge *edge, CGPoint point, double tolerance, double *position) {
+    double dx = edge->end.x - edge->start.x;
+    double dy = edge->end.y - edge->start.y;
+    double lengthSquared = dx * dx + dy * dy;
+    double s;
+    
+    if (AJRBooleanPointsAreEqual(point, edge->start) || AJRBooleanPointsAreEqual(point, edge->end)) {
+        return NO;
+    }
+    s = ((point.x - edge->start.x) * dx + (point.y - edge->start.y) * dy) / lengthSquared;
+    if (!(s > 0.0 && s < 1.0)) {
+        return NO;
+    }
+    if (fabs((point.x - edge->start.x) * dy - (point.y - edge->start.y) * dx) > tolerance * sqrt(lengthSquared)) {
+        return NO;
+    }
+    *position = s;
+    return YES;
+}
+
+static void AJRBooleanIntersectEdges(const AJRBooleanContext *context, NSUInteger i, NSUInteger j, AJRBooleanSplit **splits, NSUInteger *count, NSUInteger *max) {
+    const AJRBooleanEdge *a = context->edges + i, *b = context->edges + j;
+    double position, d1, d2, d3, d4;
+    double adx = a->end.x - a->start.x, ady = a->end.y - a->start.y;
+    double bdx = b->end.x - b->start.x, bdy = b->end.y - b->start.y;
+    BOOL touches = NO;
+    
+    // First, end points lying on the other edge. This catches T junctions and overlapping collinear edges, which are common when shapes share a side.
+    if (AJRBooleanPointIsOnEdge(b, a->start, context->tolerance, &position)) {
+        AJRBooleanAppendSplit(splits, count, max, j, position, a->start);
+        touches = YES;
+    }
+    if (AJRBooleanPointIsOnEdge(b, a->end, context->tolerance, &position)) {
+        AJRBooleanAppendSplit(splits, count, max, j, position, a->end);
+        touches = YES;
+    }
+    if (AJRBooleanPointIsOnEdge(a, b->start, context->tolerance, &position)) {
+        AJRBooleanAppendSplit(splits, count, max, i, position, b->start);
+        touches = YES;
+    }
+    if (AJRBooleanPointIsOnEdge(a, b->end, context->tolerance, &position)) {
+        AJRBooleanAppendSplit(splits, count, max, i, position, b->end);
+        touches = YES;
+    }
+    if (touches) {
+        return;
+    }
+    
+    // Then proper crossings, where each edge's end points lie strictly on opposite sides of the other.
+    d1 = bdx * (a->start.y - b->start.y) - bdy * (a->start.x - b->start.x);
+    d2 = bdx * (a->end.y - b->start.y) - bdy * (a->end.x - b->start.x);
+    if ((d1 > 0.0 && d2 < 0.0) || (d1 < 0.0 && d2 > 0.0)) {
+        d3 = adx * (b->start.y - a->start.y) - ady * (b->start.x - a->start.x);
+        d4 = adx * (b->end.y - a->start.y) - ady * (b->end.x - a->start.x);
+        if ((d3 > 0.0 && d4 < 0.0) || (d3 < 0.0 && d4 > 0.0)) {
+            double s = d1 / (d1 - d2);
+            CGPoint point = {a->start.x + s * adx, a->start.y + s * ady};
+            
+            // Both edges get exactly the same point, so they'll share the new vertex.
+            AJRBooleanAppendSplit(splits, count, max, i, s, point);
+            AJRBooleanAppendSplit(splits, count, max, j, d3 / (d3 - d4), point);
+        }
+    }
+}
+
+// One sweep from bottom to top. Each edge is only compared to the edges whose vertical extent overlaps its own, and of those, only the ones whose horizontal extent does too.
+static NSUInteger AJRBooleanFindSplits(AJRBooleanContext *context, AJRBooleanSplit **splits, NSUInteger *max) {
+    NSUInteger *active = NSZoneMalloc(nil, MAX(context->edgeCount, 1) * sizeof(NSUInteger));
+    NSUInteger activeCount = 0;
+    NSUInteger count = 0;
+    double tolerance = context->tolerance;
+    
+    qsort(context->edges, context->edgeCount, sizeof(AJRBooleanEdge), AJRBooleanCompareEdgeStarts);
+    
+    for (NSUInteger x = 0; x < context->edgeCount; x++) {
+        const AJRBooleanEdge *edge = context->edges + x;
+        double minX = MIN(edge->start.x, edge->end.x) - tolerance;
+        double maxX = MAX(edge->start.x, edge->end.x) + tolerance;
+        NSUInteger keep = 0;
+        
+        for (NSUInteger y = 0; y < activeCount; y++) {
+            const AJRBooleanEdge *other = context->edges + active[y];
+            
+            if (other->end.y < edge->start.y - tolerance) {
+                // Finished with, since every edge after this one starts higher still.
+                continue;
+            }
+            active[keep++] = active[y];
+            if (MAX(other->start.x, other->end.x) < minX || MIN(other->start.x, other->end.x) > maxX) {
+                continue;
+            }
+            AJRBooleanIntersectEdges(context, active[y], x, splits, &count, max);
+        }
+        activeCount = keep;
+        active[activeCount++] = x;
+    }
+    
+    NSZoneFree(nil, active);
+    
+    return count;
+}
+
+static void AJRBooleanApplySplits(AJRBooleanContext *context, AJRBooleanSplit *splits, NSUInteger splitCount) {
+    AJRBooleanEdge *edges = context->edges;
+    NSUInteger edgeCount = context->edgeCount;
+    NSUInteger splitIndex = 0;
+    
+    qsort(splits, splitCount, sizeof(AJRBooleanSplit), AJRBooleanCompareSplits);
+    
+    context->edges = NULL;
+    context->edgeCount = 0;
+    context->maxEdges = 0;
+    for (NSUInteger x = 0; x < edgeCount; x++) {
+        const AJRBooleanEdge *edge = edges + x;
+        CGPoint previous = edge->start;
+        double previousT = edge->startT;
+        
+        while (splitIndex < splitCount && splits[splitIndex].edgeIndex == x) {
+            const AJRBooleanSplit *split = splits + splitIndex;
+            double t = edge->startT + (edge->endT - edge->startT) * split->position;
+            
+            if (!AJRBooleanPointsAreEqual(split->point, previous) && !AJRBooleanPointsAreEqual(split->point, edge->end)) {
+                AJRBooleanAppendEdge(context, previous, split->point, previousT, t, edge->curveIndex, edge->operand, edge->direction);
+                previous = split->point;
+                previousT = t;
+            }
+            splitIndex += 1;
+        }
+        AJRBooleanAppendEdge(context, previous, edge->end, previousT, edge->endT, edge->curveIndex, edge->operand, edge->direction);
+    }
+    
+    NSZoneFree(nil, edges);
+}
+
+typedef struct _ajrBooleanVertex {
+    CGPoint point;
+    // Rows are one tolerance tall, so a vertex's neighbours are all in its own row or the rows on either side.
+    double row;
+    NSUInteger parent;
+} AJRBooleanVertex;
+
+static int AJRBooleanComparePointPointers(const void *left, const void *right) {
+    return (int)AJRBooleanComparePoints(**(const CGPoint **)left, **(const CGPoint **)right);
+}
+
+static int AJRBooleanCompareVertices(const void *left, const void *right) {
+    const AJRBooleanVertex *a = left, *b = right;
+    
+    if (a->row != b->row) return a->row < b->row ? -1 : 1;
+    if (a->point.x != b->point.x) return a->point.x < b->point.x ? -1 : 1;
+    return a->point.y < b->point.y ? -1 : (a->point.y > b->point.y ? 1 : 0);
+}
+
+static NSUInteger AJRBooleanFindVertexRoot(AJRBooleanVertex *vertices, NSUInteger index) {
+    while (vertices[index].parent != index) {
+        vertices[index].parent = vertices[vertices[index].parent].parent;
+        index = vertices[index].parent;
+    }
+    return index;
+}
+
+/*
+ When several edges cross at (nearly) the same place, the crossings we compute for each pair can differ in their last few bits, leaving tiny edges between them that have no meaningful inside or outside. So we merge any vertices that lie within the tolerance of each other, and drop the edges that collapse as a result. Since this moves points, it can create new crossings, so it's followed by another round of splitting.
+
+ Returns YES if anything moved.
+ */
+static BOOL AJRBooleanMergeVertices(AJRBooleanContext *context) {
+    NSUInteger pointCount = context->edgeCount * 2;
+    CGPoint **points = NSZoneMalloc(nil, MAX(pointCount, 1) * sizeof(CGPoint *));
+    AJRBooleanVertex *vertices = NSZoneMalloc(nil, MAX(pointCount, 1) * sizeof(AJRBooleanVertex));
+    NSUInteger vertexCount = 0;
+    double tolerance = context->tolerance;
+    BOOL changed = NO;
+    
+    // Collect the distinct points.
+    for (NSUInteger x = 0; x < context->edgeCount; x++) {
+        points[x * 2] = &context->edges[x].start;
+        points[x * 2 + 1] = &context->edges[x].end;
+    }
+    qsort(points, pointCount, sizeof(CGPoint *), AJRBooleanComparePointPointers);
+    
+    // Heights within the tolerance of each other become the same height. Otherwise, an edge that's almost, but not quite, horizontal has to be measured across a height range too small to measure anything.
+    for (NSUInteger x = 1, first = 0; x < pointCount; x++) {
+        if (points[x]->y - points[first]->y <= tolerance) {
+            if (points[x]->y != points[first]->y) {
+                points[x]->y = points[first]->y;
+                changed = YES;
+            }
+        } else {
+            first = x;
+        }
+    }
+    if (changed) {
+        qsort(points, pointCount, sizeof(CGPoint *), AJRBooleanComparePointPointers);
+    }
+    
+    for (NSUInteger x = 0; x < pointCount; x++) {
+        if (x == 0 || !AJRBooleanPointsAreEqual(*points[x], *points[x - 1])) {
+            vertices[vertexCount] = (AJRBooleanVertex){*points[x], floor(points[x]->y / tolerance), vertexCount};
+            vertexCount++;
+        }
+    }
+    qsort(vertices, vertexCount, sizeof(AJRBooleanVertex), AJRBooleanCompareVertices);
+    for (NSUInteger x = 0; x < vertexCount; x++) {
+        vertices[x].parent = x;
+    }
+    
+    // Join each vertex to its near neighbours further along its own row, and in the row above it.
+    for (NSUInteger x = 0; x < vertexCount; x++) {
+        const AJRBooleanVertex *vertex = vertices + x;
+        NSUInteger y = x + 1;
+        
+        for (NSInteger pass = 0; pass < 2; pass++) {
+            double row = vertex->row + pass;
+            
+            if (pass == 1) {
+                // Binary search for the first vertex of the next row that could be close enough.
+                NSUInteger high = vertexCount;
+                while (y < high) {
+                    NSUInteger middle = (y + high) / 2;
+                    if (vertices[middle].row < row || (vertices[middle].row == row && vertices[middle].point.x < vertex->point.x - tolerance)) {
+                        y = middle + 1;
+                    } else {
+                        high = middle;
+                    }
+                }
+            }
+            for (; y < vertexCount && vertices[y].row == row && vertices[y].point.x <= vertex->point.x + tolerance; y++) {
+                if (fabs(vertices[y].point.y - vertex->point.y) <= tolerance) {
+                    NSUInteger a = AJRBooleanFindVertexRoot(vertices, x), b = AJRBooleanFindVertexRoot(vertices, y);
+                    if (a != b) {
+                        vertices[MAX(a, b)].parent = MIN(a, b);
+                        changed = YES;
+                    }
+                }
+            }
+        }
+    }
+    
+    if (changed) {
+        AJRBooleanEdge *edges = context->edges;
+        NSUInteger edgeCount = context->edgeCount;
+        
+        // Find each end point's vertex, and move it to its group's first vertex.
+        for (NSUInteger x = 0; x < pointCount; x++) {
+            AJRBooleanVertex key = {*points[x], floor(points[x]->y / tolerance), 0};
+            AJRBooleanVertex *found = bsearch(&key, vertices, vertexCount, sizeof(AJRBooleanVertex), AJRBooleanCompareVertices);
+            *points[x] = vertices[AJRBooleanFindVertexRoot(vertices, found - vertices)].point;
+        }
+        
+        // And since the points moved, put the edges back in order, dropping any that collapsed.
+        context->edges = NULL;
+        context->edgeCount = 0;
+        context->maxEdges = 0;
+        for (NSUInteger x = 0; x < edgeCount; x++) {
+            const AJRBooleanEdge *edge = edges + x;
+            AJRBooleanAppendEdge(context, edge->start, edge->end, edge->startT, edge->endT, edge->curveIndex, edge->operand, edge->direction);
+        }
+        NSZoneFree(nil, edges);
+    }
+    
+    NSZoneFree(nil, points);
+    NSZoneFree(nil, vertices);
+    
+    return changed;
+}
+
+static void AJRBooleanSplitEdges(AJRBooleanContext *context) {
+    AJRBooleanSplit *splits = NULL;
+    NSUInteger maxSplits = 0;
+    
+    AJRBooleanMergeVertices(context);
+    for (NSInteger pass = 0; pass < AJRBooleanMaxSplitPasses; pass++) {
+        NSUInteger splitCount = AJRBooleanFindSplits(context, &splits, &maxSplits);
+        if (splitCount == 0) {
+            break;
+        }
+        AJRBooleanApplySplits(context, splits, splitCount);
+        AJRBooleanMergeVertices(context);
+    }
+    // Leave the edges sorted, which also brings identical edges together.
+    qsort(context->edges, context->edgeCount, sizeof(AJRBooleanEdge), AJRBooleanCompareEdgeStarts);
+    
+    NSZoneFree(nil, splits);
+}
+
+#pragma mark - Classification
+
+static inline BOOL AJRBooleanWindingIsInside(NSInteger winding, AJRWindingRule rule) {
+    return rule == AJRWindingRuleEvenOdd ? (winding & 1) != 0 : winding != 0;
+}
+
+static inline BOOL AJRBooleanOperationIsInside(AJRPathBooleanOperation operation, NSInteger insideCount, BOOL firstIsInside, NSInteger operandCount) {
+    switch (operation) {
+        case AJRPathBooleanOperationUnion:
+            return insideCount > 0;
+        case AJRPathBooleanOperationIntersection:
+            return insideCount == operandCount;
+        case AJRPathBooleanOperationSubtraction:
+            return firstIsInside && insideCount == 1;
+        case AJRPathBooleanOperationExclusiveOr:
+            return (insideCount & 1) != 0;
+    }
+    return NO;
+}
+
+// Running per operand winding numbers. Only the operands actually touched are visited, which matters when there are thousands of operands and any one point is only near a few of them.
+typedef struct _ajrBooleanWindings {
+    NSInteger *windings;
+    uint8_t *isTouched;
+    NSInteger *touched;
+    NSUInteger touchedCount;
+} AJRBooleanWindings;
+
+static inline void AJRBooleanWindingsAdd(AJRBooleanWindings *windings, NSInteger operand, NSInteger direction) {
+    if (!windings->isTouched[operand]) {
+        windings->isTouched[operand] = YES;
+        windings->touched[windings->touchedCount++] = operand;
+    }
+    windings->windings[operand] += direction;
+}
+
+static BOOL AJRBooleanWindingsAreInside(const AJRBooleanWindings *windings, const AJRBooleanContext *context, AJRPathBooleanOperation operation) {
+    NSInteger insideCount = 0;
+    
+    for (NSUInteger x = 0; x < windings->touchedCount; x++) {
+        NSInteger operand = windings->touched[x];
+        if (AJRBooleanWindingIsInside(windings->windings[operand], context->windingRules[operand])) {
+            insideCount += 1;
+        }
+    }
+    return AJRBooleanOperationIsInside(operation, insideCount, AJRBooleanWindingIsInside(windings->windings[0], context->windingRules[0]), context->operandCount);
+}
+
+static void AJRBooleanWindingsReset(AJRBooleanWindings *windings) {
+    for (NSUInteger x = 0; x < windings->touchedCount; x++) {
+        windings->windings[windings->touched[x]] = 0;
+        windings->isTouched[windings->touched[x]] = NO;
+    }
+    windings->touchedCount = 0;
+}
+
+static int AJRBooleanCompareGroups(const void *left, const void *right) {
+    double a = ((const AJRBooleanGroup *)left)->y, b = ((const AJRBooleanGroup *)right)->y;
+    return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+/*
+ Now that edges only meet at their end points, each distinct edge has a single inside/outside answer on each of its sides. We find the answer by sweeping upward, keeping the edges that span the current height, and for each edge, summing the directions of the edges that lie to its left, which gives the winding number of every operand just left of the edge. An edge whose sides disagree is part of the result.
+
+ A non-horizontal edge is measured at its middle height, using edges that span [bottom..top), which is the same as measuring just above that height, where nothing can touch the edge but the edge itself. A horizontal edge is measured just above and just below its height.
+ */
+static AJRBooleanOutputEdge *AJRBooleanClassifyEdges(AJRBooleanContext *context, AJRPathBooleanOperation operation, NSUInteger *outputCount) {
+    AJRBooleanGroup *groups = NSZoneMalloc(nil, MAX(context->edgeCount, 1) * sizeof(AJRBooleanGroup));
+    NSUInteger groupCount = 0;
+    NSUInteger *active = NSZoneMalloc(nil, MAX(context->edgeCount, 1) * sizeof(NSUInteger));
+    NSUInteger activeCount = 0, next = 0;
+    AJRBooleanOutputEdge *output = NULL;
+    NSUInteger count = 0, max = 0;
+    AJRBooleanWindings windings;
+    
+    windings.windings = NSZoneCalloc(nil, context->operandCount, sizeof(NSInteger));
+    windings.isTouched = NSZoneCalloc(nil, context->operandCount, sizeof(uint8_t));
+    windings.touched = NSZoneMalloc(nil, context->operandCount * sizeof(NSInteger));
+    windings.touchedCount = 0;
+    
+    for (NSUInteger x = 0; x < context->edgeCount; ) {
+        NSUInteger y = x + 1;
+        while (y < context->edgeCount && AJRBooleanPointsAreEqual(context->edges[y].start, context->edges[x].start) && AJRBooleanPointsAreEqual(context->edges[y].end, context->edges[x].end)) {
+            y++;
+        }
+        groups[groupCount++] = (AJRBooleanGroup){x, y - x, (context->edges[x].start.y + context->edges[x].end.y) / 2.0};
+        x = y;
+    }
+    qsort(groups, groupCount, sizeof(AJRBooleanGroup), AJRBooleanCompareGroups);
+    
+    for (NSUInteger g = 0; g < groupCount; g++) {
+        const AJRBooleanGroup *group = groups + g;
+        const AJRBooleanEdge *edge = context->edges + group->first;
+        BOOL isHorizontal = edge->start.y == edge->end.y;
+        double y = group->y;
+        double x = (edge->start.x + edge->end.x) / 2.0;
+        BOOL leftIsInside = NO, rightIsInside = NO;
+        NSUInteger keep = 0;
+        
+        while (next < context->edgeCount && context->edges[next].start.y <= y) {
+            if (context->edges[next].start.y != context->edges[next].end.y) {
+                active[activeCount++] = next;
+            }
+            next++;
+        }
+        for (NSUInteger a = 0; a < activeCount; a++) {
+            if (context->edges[active[a]].end.y >= y) {
+                active[keep++] = active[a];
+            }
+        }
+        activeCount = keep;
+        
+        // For a horizontal edge, "left" means below, and "right" means above.
+        for (NSInteger pass = 0; pass < (isHorizontal ? 2 : 1); pass++) {
+            BOOL above = !isHorizontal || pass == 1;
+            
+            for (NSUInteger a = 0; a < activeCount; a++) {
+                NSUInteger index = active[a];
+                const AJRBooleanEdge *other = context->edges + index;
+                
+                if (index >= group->first && index < group->first + group->count) {
+                    continue;
+                }
+                if (above ? (other->start.y <= y && y < other->end.y) : (other->start.y < y && y <= other->end.y)) {
+                    double otherX = other->start.x + (y - other->start.y) * (other->end.x - other->start.x) / (other->end.y - other->start.y);
+                    if (otherX < x) {
+                        AJRBooleanWindingsAdd(&windings, other->operand, other->direction);
+                    }
+                }
+            }
+            if (isHorizontal) {
+                if (pass == 0) {
+                    leftIsInside = AJRBooleanWindingsAreInside(&windings, context, operation);
+                } else {
+                    rightIsInside = AJRBooleanWindingsAreInside(&windings, context, operation);
+                }
+            } else {
+                leftIsInside = AJRBooleanWindingsAreInside(&windings, context, operation);
+                for (NSUInteger e = group->first; e < group->first + group->count; e++) {
+                    AJRBooleanWindingsAdd(&windings, context->edges[e].operand, context->edges[e].direction);
+                }
+                rightIsInside = AJRBooleanWindingsAreInside(&windings, context, operation);
+            }
+            AJRBooleanWindingsReset(&windings);
+        }
+        
+        if (leftIsInside != rightIsInside) {
+            if (count == max) {
+                max = max ? max * 2 : 64;
+                output = NSZoneRealloc(nil, output, max * sizeof(AJRBooleanOutputEdge));
+            }
+            // An upward edge has its left on its left, but a rightward edge has "left", which is below, on its right.
+            if (leftIsInside != isHorizontal) {
+                output[count++] = (AJRBooleanOutputEdge){edge->start, edge->end, edge->startT, edge->endT, edge->curveIndex};
+            } else {
+                output[count++] = (AJRBooleanOutputEdge){edge->end, edge->start, edge->endT, edge->startT, edge->curveIndex};
+            }
+        }
+    }
+    
+    NSZoneFree(nil, windings.windings);
+    NSZoneFree(nil, windings.isTouched);
+    NSZoneFree(nil, windings.touched);
+    NSZoneFree(nil, active);
+    NSZoneFree(nil, groups);
+    
+    *outputCount = count;
+    return output;
+}
+
+#pragma mark - Contours
+
+static int AJRBooleanCompareOutputEdges(const void *left, const void *right) {
+    return (int)AJRBooleanComparePoints(((const AJRBooleanOutputEdge *)left)->from, ((const AJRBooleanOutputEdge *)right)->from);
+}
+
+/*
+ Links the output edges into closed contours. Since every edge has the inside on its left, each vertex has as many edges leaving it as arriving, so we can always continue until we're back where we started. When there's a choice, we prefer the edge that continues the same curve, so it can be rebuilt in one piece.
+
+ On return, order holds the edge indexes, contour by contour, and contourEnds holds the index in order just past each contour. Returns the number of contours.
+ */
+static NSUInteger AJRBooleanLinkContours(AJRBooleanOutputEdge *edges, NSUInteger edgeCount, NSUInteger *order, NSUInteger *contourEnds) {
+    uint8_t *used = NSZoneCalloc(nil, MAX(edgeCount, 1), sizeof(uint8_t));
+    NSUInteger orderCount = 0, contourCount = 0;
+    
+    qsort(edges, edgeCount, sizeof(AJRBooleanOutputEdge), AJRBooleanCompareOutputEdges);
+    
+    for (NSUInteger x = 0; x < edgeCount; x++) {
+        NSUInteger current = x;
+        
+        if (used[x]) {
+            continue;
+        }
+        while (YES) {
+            const AJRBooleanOutputEdge *edge = edges + current;
+            NSUInteger low = 0, high = edgeCount, candidate = NSNotFound;
+            
+            used[current] = YES;
+            order[orderCount++] = current;
+            if (AJRBooleanPointsAreEqual(edge->to, edges[x].from)) {
+                break;
+            }
+            while (low < high) {
+                NSUInteger middle = (low + high) / 2;
+                if (AJRBooleanComparePoints(edges[middle].from, edge->to) < 0) {
+                    low = middle + 1;
+                } else {
+                    high = middle;
+                }
+            }
+            for (; low < edgeCount && AJRBooleanPointsAreEqual(edges[low].from, edge->to); low++) {
+                if (!used[low]) {
+                    if (candidate == NSNotFound) {
+                        candidate = low;
+                    }
+                    if (edges[low].curveIndex >= 0 && edges[low].curveIndex == edge->curveIndex && edges[low].fromT == edge->toT) {
+                        candidate = low;
+                        break;
+                    }
+                }
+            }
+            if (candidate == NSNotFound) {
+                // Only reachable through numerical trouble. Closing here is the best we can do.
+                break;
+            }
+            current = candidate;
+        }
+        contourEnds[contourCount++] = orderCount;
+    }
+    
+    NSZoneFree(nil, used);
+    
+    return contourCount;
+}
+
+static inline BOOL AJRBooleanPointsAreCollinear(CGPoint start, CGPoint middle, CGPoint end, double tolerance) {
+    double dx = end.x - start.x, dy = end.y - start.y;
+    double cross = (middle.x - start.x) * dy - (middle.y - start.y) * dx;
+    double dot = (middle.x - start.x) * dx + (middle.y - start.y) * dy;
+    
+    return dot > 0.0 && fabs(cross) <= tolerance * sqrt(dx * dx + dy * dy);
+}
+
+#pragma mark - Paths
+
+static void AJRBooleanAppendPath(AJRBooleanContext *context, id <AJRBezierPathProtocol> path, NSInteger operand) {
+    AJRPathIterator iterator;
+    AJRBezierPathElement element;
+    CGPoint points[3];
+    CGPoint current = CGPointZero, subpathStart = CGPointZero;
+    
+    AJRPathIteratorInit(&iterator, path);
+    while (AJRPathIteratorNextElement(&iterator, &element, points)) {
+        switch (element) {
+            case AJRBezierPathElementMoveTo:
+                // Filling closes every subpath, whether or not it asked to be.
+                AJRBooleanAppendEdge(context, current, subpathStart, 0.0, 0.0, -1, operand, 1);
+                current = subpathStart = points[0];
+                break;
+            case AJRBezierPathElementLineTo:
+                AJRBooleanAppendEdge(context, current, points[0], 0.0, 0.0, -1, operand, 1);
+                current = points[0];
+                break;
+            case AJRBezierPathElementCubicCurveTo:
+                AJRBooleanAppendCurve(context, (AJRBezierCurve){current, points[0], points[1], points[2]}, operand);
+                current = points[2];
+                break;
+            case AJRBezierPathElementQuadraticCurveTo:
+                AJRBooleanAppendCurve(context, AJRBezierCurveFromQuadraticCurve((AJRQuadraticCurve){current, points[0], points[1]}), operand);
+                current = points[1];
+                break;
+            case AJRBezierPathElementClose:
+                AJRBooleanAppendEdge(context, current, subpathStart, 0.0, 0.0, -1, operand, 1);
+                current = subpathStart;
+                break;
+            default:
+                break;
+        }
+    }
+    AJRBooleanAppendEdge(context, current, subpathStart, 0.0, 0.0, -1, operand, 1);
+}
+
+static void AJRBooleanBuildPath(AJRBezierPath *result, const AJRBooleanContext *context, const AJRBooleanOutputEdge *edges, const NSUInteger *order, const NSUInteger *contourEnds, NSUInteger contourCount) {
+    NSUInteger start = 0;
+    
+    for (NSUInteger c = 0; c < contourCount; c++) {
+        NSUInteger end = contourEnds[c];
+        CGPoint first = edges[order[start]].from;
+        
+        [result moveToPoint:first];
+        for (NSUInteger x = start; x < end; x++) {
+            const AJRBooleanOutputEdge *edge = edges + order[x];
+            CGPoint to = edge->to;
+            
+            if (edge->curveIndex >= 0) {
+                double toT = edge->toT;
+                AJRBezierCurve piece;
+                
+                // Gather the run of edges that came from consecutive parts of the same curve, and rebuild it in one piece.
+                while (x + 1 < end) {
+                    const AJRBooleanOutputEdge *next = edges + order[x + 1];
+                    if (next->curveIndex != edge->curveIndex || next->fromT != toT || (next->toT - next->fromT) * (edge->toT - edge->fromT) <= 0.0) {
+                        break;
+                    }
+                    toT = next->toT;
+                    to = next->to;
+                    x++;
+                }
+                piece = AJRBezierCurveGetSubcurve(context->curves[edge->curveIndex], edge->fromT, toT);
+                [result curveToPoint:to controlPoint1:piece.handle1 controlPoint2:piece.handle2];
+            } else {
+                // Splitting leaves straight edges in pieces, so put them back together.
+                while (x + 1 < end) {
+                    const AJRBooleanOutputEdge *next = edges + order[x + 1];
+                    if (next->curveIndex >= 0 || !AJRBooleanPointsAreCollinear(edge->from, to, next->to, context->tolerance)) {
+                        break;
+                    }
+                    to = next->to;
+                    x++;
+                }
+                // closePath draws the last line for us.
+                if (x + 1 < end || !AJRBooleanPointsAreEqual(to, first)) {
+                    [result lineToPoint:to];
+                }
+            }
+        }
+        [result closePath];
+        start = end;
+    }
+}
+
+id <AJRBezierPathProtocol> AJRBezierPathByApplyingBooleanOperation(NSArray<id <AJRBezierPathProtocol>> *paths, AJRPathBooleanOperation operation) {
+    AJRBooleanContext context = {0};
+    AJRBezierPath *result;
+    AJRBooleanOutputEdge *output;
+    NSUInteger outputCount;
+    
+    if (paths.count == 0) {
+        return nil;
+    }
+    
+    context.operandCount = paths.count;
+    context.error = paths[0].flatness;
+    context.windingRules = NSZoneMalloc(nil, paths.count * sizeof(AJRWindingRule));
+    for (NSInteger x = 0; x < paths.count; x++) {
+        context.windingRules[x] = (AJRWindingRule)paths[x].windingRule;
+        AJRBooleanAppendPath(&context, paths[x], x);
+    }
+    AJRBooleanComputeTolerance(&context);
+    AJRBooleanSplitEdges(&context);
+    output = AJRBooleanClassifyEdges(&context, operation, &outputCount);
+    
+    result = [[(Class)[paths[0] class] alloc] init];
+    [result setWindingRule:AJRWindingRuleNonZero];
+    [result setFlatness:paths[0].flatness];
+    if (outputCount) {
+        NSUInteger *order = NSZoneMalloc(nil, outputCount * sizeof(NSUInteger));
+        NSUInteger *contourEnds = NSZoneMalloc(nil, outputCount * sizeof(NSUInteger));
+        NSUInteger contourCount = AJRBooleanLinkContours(output, outputCount, order, contourEnds);
+        
+        AJRBooleanBuildPath(result, &context, output, order, contourEnds, contourCount);
+        
+        NSZoneFree(nil, order);
+        NSZoneFree(nil, contourEnds);
+    }
+    
+    NSZoneFree(nil, output);
+    NSZoneFree(nil, context.edges);
+    NSZoneFree(nil, context.curves);
+    NSZoneFree(nil, context.windingRules);
+    
+    return (id <AJRBezierPathProtocol>)result;
+}
+
+#pragma mark - Bulk Union
+
+// How many paths we union in a single pass before switching to a tree of smaller unions.
+#define AJRBooleanUnionChunkSize 32
+// A container that covers more grid cells than this is checked against everything, rather than being put in every cell.
+#define AJRBooleanMaxContainerCells 64
+
+typedef struct _ajrBooleanUnionItem {
+    CGRect bounds;
+    // The index of the path in the input array.
+    NSUInteger index;
+    // The item's overlap cluster. Items in different clusters can't touch.
+    NSUInteger cluster;
+    // The Morton code of the center of bounds, so items that are near each other in the array are near each other in space.
+    uint64_t order;
+} AJRBooleanUnionItem;
+
+static inline BOOL AJRBooleanRectsTouch(CGRect a, CGRect b) {
+    return (a.origin.x <= b.origin.x + b.size.width && b.origin.x <= a.origin.x + a.size.width
+            && a.origin.y <= b.origin.y + b.size.height && b.origin.y <= a.origin.y + a.size.height);
+}
+
+static inline uint64_t AJRBooleanSpreadBits(uint64_t value) {
+    value = (value | (value << 16)) & 0x0000FFFF0000FFFFULL;
+    value = (value | (value << 8)) & 0x00FF00FF00FF00FFULL;
+    value = (value | (value << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    value = (value | (value << 2)) & 0x3333333333333333ULL;
+    value = (value | (value << 1)) & 0x5555555555555555ULL;
+    return value;
+}
+
+static inline uint64_t AJRBooleanMortonCode(CGRect bounds, CGRect total) {
+    double x = total.size.width > 0.0 ? (CGRectGetMidX(bounds) - total.origin.x) / total.size.width : 0.0;
+    double y = total.size.height > 0.0 ? (CGRectGetMidY(bounds) - total.origin.y) / total.size.height : 0.0;
+    
+    return (AJRBooleanSpreadBits((uint64_t)(MIN(MAX(x, 0.0), 1.0) * 0xFFFFFFFF))
+            | (AJRBooleanSpreadBits((uint64_t)(MIN(MAX(y, 0.0), 1.0) * 0xFFFFFFFF)) << 1));
+}
+
+// Returns YES if rect is entirely inside path. If no piece of path's outline touches rect, then rect is either all inside or all outside, and its center tells us which.
+static BOOL AJRBooleanPathContainsRect(AJRBezierPath *path, CGRect rect) {
+    AJRPathSegmentTable *table = [path _pathSegmentTable];
+    
+    for (NSUInteger x = 0; x < table->segmentCount; x++) {
+        if (AJRBooleanRectsTouch(table->segments[x].bounds, rect)) {
+            return NO;
+        }
+    }
+    for (NSUInteger x = 0; x < table->closingSegmentCount; x++) {
+        if (AJRBooleanRectsTouch(table->closingSegments[x].bounds, rect)) {
+            return NO;
+        }
+    }
+    return AJRPathSegmentTableContainsPoint(table, CGRectGetMidX(rect), CGRectGetMidY(rect), [path windingRule]);
+}
+
+static inline NSUInteger AJRBooleanCellIndex(double value, double origin, double cellSize, NSUInteger cellsPerSide) {
+    return (NSUInteger)MIN(MAX((value - origin) / cellSize, 0.0), (double)(cellsPerSide - 1));
+}
+
+/*
+ Drops the items whose paths lie entirely inside another item's path, since they can't add anything to the union. Candidates are found through a uniform grid over total, with each container registered in the cells its bounds cover, and each item looked up by its center.
+
+ Returns the number of items left, which are moved to the front of items.
+ */
+static NSUInteger AJRBooleanDropContainedItems(NSArray<AJRBezierPath *> *paths, AJRBooleanUnionItem *items, NSUInteger count, CGRect total) {
+    NSUInteger cellsPerSide = MIN(MAX((NSUInteger)sqrt((double)count), 1), 256);
+    NSUInteger cellCount = cellsPerSide * cellsPerSide;
+    double cellWidth = total.size.width / cellsPerSide, cellHeight = total.size.height / cellsPerSide;
+    NSUInteger *cellStarts, *cellItems = NULL, *large, largeCount = 0, kept = 0;
+    uint8_t *dropped;
+    
+    if (!(cellWidth > 0.0 && cellHeight > 0.0)) {
+        return count;
+    }
+    
+    cellStarts = NSZoneCalloc(nil, cellCount + 1, sizeof(NSUInteger));
+    large = NSZoneMalloc(nil, count * sizeof(NSUInteger));
+    dropped = NSZoneCalloc(nil, count, sizeof(uint8_t));
+    
+    // Count, then fill, the cells.
+    for (NSInteger pass = 0; pass < 2; pass++) {
+        for (NSUInteger x = 0; x < count; x++) {
+            CGRect bounds = items[x].bounds;
+            NSUInteger minX = AJRBooleanCellIndex(CGRectGetMinX(bounds), total.origin.x, cellWidth, cellsPerSide);
+            NSUInteger maxX = AJRBooleanCellIndex(CGRectGetMaxX(bounds), total.origin.x, cellWidth, cellsPerSide);
+            NSUInteger minY = AJRBooleanCellIndex(CGRectGetMinY(bounds), total.origin.y, cellHeight, cellsPerSide);
+            NSUInteger maxY = AJRBooleanCellIndex(CGRectGetMaxY(bounds), total.origin.y, cellHeight, cellsPerSide);
+            
+            if ((maxX - minX + 1) * (maxY - minY + 1) > AJRBooleanMaxContainerCells) {
+                if (pass == 0) {
+                    large[largeCount++] = x;
+                }
+                continue;
+            }
+            for (NSUInteger cy = minY; cy <= maxY; cy++) {
+                for (NSUInteger cx = minX; cx <= maxX; cx++) {
+                    if (pass == 0) {
+                        cellStarts[cy * cellsPerSide + cx + 1] += 1;
+                    } else {
+                        cellItems[cellStarts[cy * cellsPerSide + cx]++] = x;
+                    }
+                }
+            }
+        }
+        if (pass == 0) {
+            for (NSUInteger x = 0; x < cellCount; x++) {
+                cellStarts[x + 1] += cellStarts[x];
+            }
+            cellItems = NSZoneMalloc(nil, MAX(cellStarts[cellCount], 1) * sizeof(NSUInteger));
+        } else {
+            // Filling advanced each cell's start to the next cell's start, so shift them back.
+            memmove(cellStarts + 1, cellStarts, cellCount * sizeof(NSUInteger));
+            cellStarts[0] = 0;
+        }
+    }
+    
+    for (NSUInteger x = 0; x < count; x++) {
+        CGRect bounds = items[x].bounds;
+        NSUInteger cell = (AJRBooleanCellIndex(CGRectGetMidY(bounds), total.origin.y, cellHeight, cellsPerSide) * cellsPerSide
+                           + AJRBooleanCellIndex(CGRectGetMidX(bounds), total.origin.x, cellWidth, cellsPerSide));
+        NSUInteger candidateCount = largeCount + cellStarts[cell + 1] - cellStarts[cell];
+        
+        for (NSUInteger c = 0; c < candidateCount && !dropped[x]; c++) {
+            NSUInteger other = c < largeCount ? large[c] : cellItems[cellStarts[cell] + c - largeCount];
+            
+            // Skipping dropped containers keeps two identical paths from dropping each other. Whatever contains a dropped container is a candidate too.
+            if (other != x && !dropped[other] && CGRectContainsRect(items[other].bounds, bounds)
+                && AJRBooleanPathContainsRect((AJRBezierPath *)paths[items[other].index], bounds)) {
+                dropped[x] = YES;
+            }
+        }
+    }
+    for (NSUInteger x = 0; x < count; x++) {
+        if (!dropped[x]) {
+            items[kept++] = items[x];
+        }
+    }
+    
+    NSZoneFree(nil, cellStarts);
+    NSZoneFree(nil, cellItems);
+    NSZoneFree(nil, large);
+    NSZoneFree(nil, dropped);
+    
+    return kept;
+}
+
+static NSUInteger AJRBooleanFindRoot(NSUInteger *parents, NSUInteger index) {
+    while (parents[index] != index) {
+        parents[index] = parents[parents[index]];
+        index = parents[index];
+    }
+    return index;
+}
+
+static int AJRBooleanCompareUnionItemsByMinX(const void *left, const void *right) {
+    CGFloat a = ((const AJRBooleanUnionItem *)left)->bounds.origin.x;
+    CGFloat b = ((const AJRBooleanUnionItem *)right)->bounds.origin.x;
+    return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+static int AJRBooleanCompareUnionItemsByClusterAndOrder(const void *left, const void *right) {
+    const AJRBooleanUnionItem *a = left, *b = right;
+    if (a->cluster != b->cluster) return a->cluster < b->cluster ? -1 : 1;
+    if (a->order != b->order) return a->order < b->order ? -1 : 1;
+    return 0;
+}
+
+/*
+ Groups the items into clusters whose bounds overlap, either directly or through a chain of other items, by sweeping them in x and joining any two whose bounds touch. Items in different clusters can't overlap, so each cluster can be unioned on its own. Leaves the items sorted by minimum x, and returns the number of clusters, which are numbered from 0.
+ */
+static NSUInteger AJRBooleanFindClusters(AJRBooleanUnionItem *items, NSUInteger count) {
+    NSUInteger *parents = NSZoneMalloc(nil, count * sizeof(NSUInteger));
+    NSUInteger *active = NSZoneMalloc(nil, count * sizeof(NSUInteger));
+    NSUInteger *clusters = NSZoneMalloc(nil, count * sizeof(NSUInteger));
+    NSUInteger activeCount = 0, clusterCount = 0;
+    
+    qsort(items, count, sizeof(AJRBooleanUnionItem), AJRBooleanCompareUnionItemsByMinX);
+    for (NSUInteger x = 0; x < count; x++) {
+        NSUInteger kept = 0;
+        
+        parents[x] = x;
+        for (NSUInteger a = 0; a < activeCount; a++) {
+            NSUInteger other = active[a];
+            
+            if (CGRectGetMaxX(items[other].bounds) < items[x].bounds.origin.x) {
+                continue;
+            }
+            active[kept++] = other;
+            if (AJRBooleanRectsTouch(items[other].bounds, items[x].bounds)) {
+                parents[AJRBooleanFindRoot(parents, other)] = AJRBooleanFindRoot(parents, x);
+            }
+        }
+        active[kept++] = x;
+        activeCount = kept;
+    }
+    
+    for (NSUInteger x = 0; x < count; x++) {
+        clusters[x] = NSNotFound;
+    }
+    for (NSUInteger x = 0; x < count; x++) {
+        NSUInteger root = AJRBooleanFindRoot(parents, x);
+        if (clusters[root] == NSNotFound) {
+            clusters[root] = clusterCount++;
+        }
+        items[x].cluster = clusters[root];
+    }
+    
+    NSZoneFree(nil, parents);
+    NSZoneFree(nil, active);
+    NSZoneFree(nil, clusters);
+    
+    return clusterCount;
+}
+
+/*
+ Unions the paths of count items, which should already be sorted so that neighbours in the array are neighbours in space. Small groups are unioned in a single pass. Larger ones are cut into chunks that are unioned concurrently, and then the chunk results are merged pairwise, also concurrently, until only one remains. Since each merge only involves nearby shapes, the intermediate results stay small.
+ */
+static id <AJRBezierPathProtocol> AJRBooleanUnionItems(NSArray<AJRBezierPath *> *paths, const AJRBooleanUnionItem *items, NSUInteger count) {
+    NSUInteger resultCount = (count + AJRBooleanUnionChunkSize - 1) / AJRBooleanUnionChunkSize;
+    __strong id <AJRBezierPathProtocol> *results;
+    id <AJRBezierPathProtocol> result;
+    
+    if (count <= AJRBooleanUnionChunkSize) {
+        NSMutableArray<id <AJRBezierPathProtocol>> *chunk = [NSMutableArray arrayWithCapacity:count];
+        for (NSUInteger x = 0; x < count; x++) {
+            [chunk addObject:paths[items[x].index]];
+        }
+        return AJRBezierPathByApplyingBooleanOperation(chunk, AJRPathBooleanOperationUnion);
+    }
+    
+    results = (__strong id <AJRBezierPathProtocol> *)calloc(resultCount, sizeof(id));
+    dispatch_apply(resultCount, DISPATCH_APPLY_AUTO, ^(size_t chunkIndex) {
+        NSUInteger first = chunkIndex * AJRBooleanUnionChunkSize;
+        NSUInteger last = MIN(first + AJRBooleanUnionChunkSize, count);
+        NSMutableArray<id <AJRBezierPathProtocol>> *chunk = [NSMutableArray arrayWithCapacity:last - first];
+        
+        for (NSUInteger x = first; x < last; x++) {
+            [chunk addObject:paths[items[x].index]];
+        }
+        results[chunkIndex] = AJRBezierPathByApplyingBooleanOperation(chunk, AJRPathBooleanOperationUnion);
+    });
+    
+    while (resultCount > 1) {
+        NSUInteger mergedCount = (resultCount + 1) / 2;
+        __strong id <AJRBezierPathProtocol> *merged = (__strong id <AJRBezierPathProtocol> *)calloc(mergedCount, sizeof(id));
+        __strong id <AJRBezierPathProtocol> *current = results;
+        NSUInteger currentCount = resultCount;
+        
+        dispatch_apply(mergedCount, DISPATCH_APPLY_AUTO, ^(size_t mergeIndex) {
+            if (mergeIndex * 2 + 1 < currentCount) {
+                merged[mergeIndex] = AJRBezierPathByApplyingBooleanOperation(@[current[mergeIndex * 2], current[mergeIndex * 2 + 1]], AJRPathBooleanOperationUnion);
+            } else {
+                merged[mergeIndex] = current[mergeIndex * 2];
+            }
+        });
+        
+        for (NSUInteger x = 0; x < resultCount; x++) {
+            results[x] = nil;
+        }
+        free(results);
+        results = merged;
+        resultCount = mergedCount;
+    }
+    
+    result = results[0];
+    results[0] = nil;
+    free(results);
+    
+    return result;
+}
+
+// Returns path itself if it's already an AJRBezierPath, otherwise an AJRBezierPath with the same elements, winding rule and flatness.
+static AJRBezierPath *AJRBooleanBezierPathFromPath(id <AJRBezierPathProtocol> path) {
+    AJRBezierPath *copy;
+    AJRPathIterator iterator;
+    AJRBezierPathElement element;
+    CGPoint points[3];
+    
+    if ([path isKindOfClass:[AJRBezierPath class]]) {
+        return (AJRBezierPath *)path;
+    }
+    
+    copy = [[AJRBezierPath alloc] init];
+    [copy setWindingRule:(AJRWindingRule)path.windingRule];
+    [copy setFlatness:path.flatness];
+    AJRPathIteratorInit(&iterator, path);
+    while (AJRPathIteratorNextElement(&iterator, &element, points)) {
+        switch (element) {
+            case AJRBezierPathElementMoveTo:
+                [copy moveToPoint:points[0]];
+                break;
+            case AJRBezierPathElementLineTo:
+                [copy lineToPoint:points[0]];
+                break;
+            case AJRBezierPathElementCubicCurveTo:
+                [copy curveToPoint:points[2] controlPoint1:points[0] controlPoint2:points[1]];
+                break;
+            case AJRBezierPathElementQuadraticCurveTo:
+                [copy curveToPoint:points[1] controlPoint:points[0]];
+                break;
+            case AJRBezierPathElementClose:
+                [copy closePath];
+                break;
+            default:
+                break;
+        }
+    }
+    
+    return copy;
+}
+
+id <AJRBezierPathProtocol> AJRBezierPathByUnioningManyPaths(NSArray<id <AJRBezierPathProtocol>> *inputPaths) {
+    NSUInteger count = inputPaths.count, itemCount = 0, clusterCount;
+    NSMutableArray<AJRBezierPath *> *paths;
+    AJRBooleanUnionItem *items;
+    CGRect total = CGRectNull;
+    __strong id <AJRBezierPathProtocol> *clusterResults;
+    NSUInteger *clusterStarts;
+    id <AJRBezierPathProtocol> result;
+    
+    if (count <= AJRBooleanUnionChunkSize) {
+        return AJRBezierPathByApplyingBooleanOperation(inputPaths, AJRPathBooleanOperationUnion);
+    }
+    
+    // Everything below works on AJRBezierPaths, so anything else is copied into one here, on the calling thread, rather than being walked from several threads at once.
+    paths = [NSMutableArray arrayWithCapacity:count];
+    for (id <AJRBezierPathProtocol> path in inputPaths) {
+        [paths addObject:AJRBooleanBezierPathFromPath(path)];
+    }
+    
+    // Gather the bounds up front. This also builds each path's segment table on this thread, so the concurrent passes below only ever read them.
+    items = NSZoneMalloc(nil, count * sizeof(AJRBooleanUnionItem));
+    for (NSUInteger x = 0; x < count; x++) {
+        CGRect bounds = [paths[x] bounds];
+        
+        [paths[x] _pathSegmentTable];
+        if (CGRectIsNull(bounds) || CGRectIsEmpty(bounds)) {
+            // Empty paths, and paths that enclose no area, can't add anything to the union.
+            continue;
+        }
+        items[itemCount].bounds = bounds;
+        items[itemCount].index = x;
+        items[itemCount].cluster = 0;
+        items[itemCount].order = 0;
+        itemCount += 1;
+        total = CGRectUnion(total, bounds);
+    }
+    
+    if (itemCount == 0) {
+        NSZoneFree(nil, items);
+        return AJRBezierPathByApplyingBooleanOperation(@[paths[0]], AJRPathBooleanOperationUnion);
+    }
+    
+    itemCount = AJRBooleanDropContainedItems(paths, items, itemCount, total);
+    for (NSUInteger x = 0; x < itemCount; x++) {
+        items[x].order = AJRBooleanMortonCode(items[x].bounds, total);
+    }
+    clusterCount = AJRBooleanFindClusters(items, itemCount);
+    qsort(items, itemCount, sizeof(AJRBooleanUnionItem), AJRBooleanCompareUnionItemsByClusterAndOrder);
+    
+    clusterStarts = NSZoneCalloc(nil, clusterCount + 1, sizeof(NSUInteger));
+    for (NSUInteger x = 0; x < itemCount; x++) {
+        clusterStarts[items[x].cluster + 1] += 1;
+    }
+    for (NSUInteger x = 0; x < clusterCount; x++) {
+        clusterStarts[x + 1] += clusterStarts[x];
+    }
+    
+    clusterResults = (__strong id <AJRBezierPathProtocol> *)calloc(clusterCount, sizeof(id));
+    dispatch_apply(clusterCount, DISPATCH_APPLY_AUTO, ^(size_t cluster) {
+        clusterResults[cluster] = AJRBooleanUnionItems(paths, items + clusterStarts[cluster], clusterStarts[cluster + 1] - clusterStarts[cluster]);
+    });
+    
+    if (clusterCount == 1) {
+        result = clusterResults[0];
+    } else {
+        // The clusters don't overlap, so their union is just all of their contours together.
+        AJRBezierPath *combined = [[AJRBezierPath alloc] init];
+        [combined setWindingRule:AJRWindingRuleNonZero];
+        [combined setFlatness:paths[0].flatness];
+        for (NSUInteger x = 0; x < clusterCount; x++) {
+            [combined appendBezierPath:(AJRBezierPath *)clusterResults[x]];
+        }
+        result = (id <AJRBezierPathProtocol>)combined;
+    }
+    
+    for (NSUInteger x = 0; x < clusterCount; x++) {
+        clusterResults[x] = nil;
+    }
+    free(clusterResults);
+    NSZoneFree(nil, clusterStarts);
+    NSZoneFree(nil, items);
+    
+    return result;
+}
@@ -0,0 +1,95 @@
+/*
+ AJRPathLengthTable.h
+ AJRInterfaceFoundation
+
+ Copyright © 2022, AJ Raftis and AJRInterfaceFoundation authors
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of AJRInterfaceFoundation nor the names of its contributors may be
+   used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL AJ RAFTIS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import <AJRInterfaceFoundation/AJRBezierPath.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*!
+ A stretch of one element, along with how far along the path it starts and ends. Curves are cut into a few stretches of equal t, so that finding a distance within one only has to measure a short piece of curve.
+ */
+typedef struct _ajrPathLengthSpan {
+    double startT;
+    double endT;
+    double startLength;
+    double endLength;
+    /*! The index of the element in the elements array the table was built from. */
+    NSUInteger elementIndex;
+} AJRPathLengthSpan;
+
+/*!
+ Maps distances along a path to the element and t found there, and back. The table holds the length of the path at the start of every element, and of every span, each measured with Gauss-Legendre quadrature, so a distance is found with a binary search over the spans, followed by a few Newton steps within one.
+
+ AJRBezierPath builds one of these lazily and throws it away whenever the path changes, so you'll normally just use the path's own methods. Like the segment table, the length table doesn't reference the arrays it was built from, and the query functions don't modify it, so it may be shared between threads.
+ */
+typedef struct _ajrPathLengthTable {
+    /*! The stretches of the path that have some length, in path order. */
+    AJRPathLengthSpan *spans;
+    NSUInteger spanCount;
+    /*! Parallel to the elements array the table was built from. Each element as a cubic, with lines having their handles on their end points. Elements that don't draw, such as move tos, have all four points at the current point. */
+    AJRBezierCurve *curves;
+    /*! Parallel to the elements array. YES for line tos and closes, which run at an even speed in t. A cubic whose handles sit on its end points traces a line too, but its t eases in and out along it, so it's measured like any other curve. */
+    BOOL *elementIsLine;
+    /*! Parallel to the elements array. The length of the path before each element, and the first of its spans. Elements without length have no spans, in which case this is the next element's first span. */
+    double *elementLengths;
+    NSUInteger *elementSpans;
+    NSUInteger elementCount;
+    /*! The length of the whole path. Move tos don't add to it, but closing lines do. */
+    double length;
+} AJRPathLengthTable;
+
+/*!
+ Builds a length table from a path's raw points and elements. The caller owns the result and must release it with AJRPathLengthTableFree().
+ */
+extern AJRPathLengthTable *AJRPathLengthTableCreate(const CGPoint *points, NSUInteger pointCount,
+                                                    const AJRBezierPathElement *elements, NSUInteger elementCount);
+extern void AJRPathLengthTableFree(AJRPathLengthTable * _Nullable table);
+
+/*!
+ Finds the element and t at length along the path. Lengths outside the path are clamped to its ends. Where length falls exactly between two elements, the earlier one is returned, at a t of 1, so a distance at the end of a subpath stays in that subpath.
+
+ @param point If not NULL, set to the point at length.
+ @param tangent If not NULL, set to the unit direction the path is heading in at length.
+
+ @returns The index of the element, or NSNotFound if the path has no length.
+ */
+extern NSUInteger AJRPathLengthTableLocate(const AJRPathLengthTable *table, CGFloat length, double * _Nullable t, CGPoint * _Nullable point, CGPoint * _Nullable tangent);
+
+/*! Returns how far along the path the point at t in the element at elementIndex lies. */
+extern CGFloat AJRPathLengthTableLengthAtElement(const AJRPathLengthTable *table, NSUInteger elementIndex, double t);
+
+/*!
+ Fills points, and tangents if it's not NULL, with count samples spread evenly along the path, from its start to its end. The samples are found with one walk through the spans, rather than a search each.
+
+ @returns The number of samples written, which is count, unless the path has no length, in which case it's 0.
+ */
+extern NSUInteger AJRPathLengthTableSample(const AJRPathLengthTable *table, NSUInteger count, CGPoint *points, CGPoint * _Nullable tangents);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,255 @@
+/*
+ AJRPathLengthTable.m
+ AJRInterfaceFoundation
+
+ Copyright © 2022, AJ Raftis and AJRInterfaceFoundation authors
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of AJRInterfaceFoundation nor the names of its contributors may be
+   used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL AJ RAFTIS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import "AJRPathLengthTable.h"
+
+#import "AJRBezierCurves.h"
+
+// How many spans each curve is cut into. More makes each search within a span cheaper, at the cost of memory.
+#define AJRPathLengthSpansPerCurve 8
+
+static void AJRPathLengthTableAppend(AJRPathLengthTable *table, NSUInteger *max, AJRPathLengthSpan span) {
+    if (table->spanCount == *max) {
+        *max = *max ? *max * 2 : 64;
+        table->spans = NSZoneRealloc(nil, table->spans, *max * sizeof(AJRPathLengthSpan));
+    }
+    table->spans[table->spanCount++] = span;
+}
+
+AJRPathLengthTable *AJRPathLengthTableCreate(const CGPoint *points, NSUInteger pointCount,
+                                             const AJRBezierPathElement *elements, NSUInteger elementCount) {
+    AJRPathLengthTable *table = NSZoneCalloc(nil, 1, sizeof(AJRPathLengthTable));
+    NSUInteger maxSpans = 0;
+    NSUInteger pointIndex = 0;
+    CGPoint current = CGPointZero;
+    CGPoint subpathStart = CGPointZero;
+    double length = 0.0;
+    
+    table->curves = NSZoneMalloc(nil, MAX(elementCount, 1) * sizeof(AJRBezierCurve));
+    table->elementIsLine = NSZoneCalloc(nil, MAX(elementCount, 1), sizeof(BOOL));
+    table->elementLengths = NSZoneMalloc(nil, MAX(elementCount, 1) * sizeof(double));
+    table->elementSpans = NSZoneMalloc(nil, MAX(elementCount, 1) * sizeof(NSUInteger));
+    table->elementCount = elementCount;
+    
+    for (NSUInteger elementIndex = 0; elementIndex < elementCount; elementIndex++) {
+        AJRBezierCurve curve = {current, current, current, current};
+        
+        switch (elements[elementIndex]) {
+            case AJRBezierPathElementSetBoundingBox:
+                pointIndex += 2;
+                break;
+            case AJRBezierPathElementMoveTo:
+                current = subpathStart = points[pointIndex];
+                curve = (AJRBezierCurve){current, current, current, current};
+                pointIndex += 1;
+                break;
+            case AJRBezierPathElementLineTo:
+                curve = (AJRBezierCurve){current, current, points[pointIndex], points[pointIndex]};
+                table->elementIsLine[elementIndex] = YES;
+                current = points[pointIndex];
+                pointIndex += 1;
+                break;
+            case AJRBezierPathElementCubicCurveTo:
+                curve = (AJRBezierCurve){current, points[pointIndex], points[pointIndex + 1], points[pointIndex + 2]};
+                current = points[pointIndex + 2];
+                pointIndex += 3;
+                break;
+            case AJRBezierPathElementQuadraticCurveTo:
+                curve = AJRBezierCurveFromQuadraticCurve((AJRQuadraticCurve){current, points[pointIndex], points[pointIndex + 1]});
+                current = points[pointIndex + 1];
+                pointIndex += 2;
+                break;
+            case AJRBezierPathElementClose:
+                curve = (AJRBezierCurve){current, current, subpathStart, subpathStart};
+                table->elementIsLine[elementIndex] = YES;
+                current = subpathStart;
+                break;
+        }
+        
+        table->curves[elementIndex] = curve;
+        table->elementLengths[elementIndex] = length;
+        table->elementSpans[elementIndex] = table->spanCount;
+        
+        if (table->elementIsLine[elementIndex]) {
+            double lineLength = hypot(curve.end.x - curve.start.x, curve.end.y - curve.start.y);
+            if (lineLength > 0.0) {
+                AJRPathLengthTableAppend(table, &maxSpans, (AJRPathLengthSpan){0.0, 1.0, length, length + lineLength, elementIndex});
+                length += lineLength;
+            }
+        } else {
+            for (NSInteger x = 0; x < AJRPathLengthSpansPerCurve; x++) {
+                double t0 = (double)x / AJRPathLengthSpansPerCurve;
+                double t1 = (double)(x + 1) / AJRPathLengthSpansPerCurve;
+                double spanLength = AJRBezierCurveLength(curve, t0, t1);
+                if (spanLength > 0.0) {
+                    AJRPathLengthTableAppend(table, &maxSpans, (AJRPathLengthSpan){t0, t1, length, length + spanLength, elementIndex});
+                    length += spanLength;
+                }
+            }
+        }
+    }
+    table->length = length;
+    
+    return table;
+}
+
+void AJRPathLengthTableFree(AJRPathLengthTable *table) {
+    if (table) {
+        if (table->spans) NSZoneFree(nil, table->spans);
+        NSZoneFree(nil, table->curves);
+        NSZoneFree(nil, table->elementIsLine);
+        NSZoneFree(nil, table->elementLengths);
+        NSZoneFree(nil, table->elementSpans);
+        NSZoneFree(nil, table);
+    }
+}
+
+// Finds the t in span's element at length, which must lie within the span.
+static double AJRPathLengthSpanTAtLength(const AJRPathLengthTable *table, const AJRPathLengthSpan *span, double length) {
+    AJRBezierCurve curve = table->curves[span->elementIndex];
+    double t;
+    
+    if (length <= span->startLength) {
+        return span->startT;
+    }
+    if (length >= span->endLength) {
+        return span->endT;
+    }
+    if (table->elementIsLine[span->elementIndex]) {
+        return (length - span->startLength) / (span->endLength - span->startLength);
+    }
+    t = AJRBezierCurveTAtLength(curve, span->startT, length - span->startLength);
+    
+    return MIN(t, span->endT);
+}
+
+// Gets the point and direction at t in span's element. A curve whose handle sits on its end point has no direction there, so we look further along it.
+static void AJRPathLengthSpanGetPoint(const AJRPathLengthTable *table, const AJRPathLengthSpan *span, double t, CGPoint *point, CGPoint *tangent) {
+    AJRBezierCurve curve = table->curves[span->elementIndex];
+    BOOL line = table->elementIsLine[span->elementIndex];
+    
+    if (point) {
+        if (t <= 0.0) {
+            *point = curve.start;
+        } else if (t >= 1.0) {
+            *point = curve.end;
+        } else if (line) {
+            *point = (CGPoint){curve.start.x + (curve.end.x - curve.start.x) * t, curve.start.y + (curve.end.y - curve.start.y) * t};
+        } else {
+            *point = AJRBezierCurveAtT(curve, t);
+        }
+    }
+    if (tangent) {
+        CGPoint direction = line ? (CGPoint){curve.end.x - curve.start.x, curve.end.y - curve.start.y} : AJRBezierCurveDerivativeAtT(curve, t);
+        double speed = hypot(direction.x, direction.y);
+        
+        if (speed == 0.0) {
+            // The derivative only vanishes at a cusp, or at an end with a handle on it, where the direction is the second derivative's, or failing that, the chord's.
+            CGPoint step = AJRBezierCurveDerivativeAtT(curve, t < 0.5 ? t + 1.0e-6 : t - 1.0e-6);
+            direction = (step.x != 0.0 || step.y != 0.0) ? step : (CGPoint){curve.end.x - curve.start.x, curve.end.y - curve.start.y};
+            speed = hypot(direction.x, direction.y);
+        }
+        *tangent = speed > 0.0 ? (CGPoint){direction.x / speed, direction.y / speed} : CGPointZero;
+    }
+}
+
+NSUInteger AJRPathLengthTableLocate(const AJRPathLengthTable *table, CGFloat length, double *t, CGPoint *point, CGPoint *tangent) {
+    NSUInteger low = 0, high;
+    const AJRPathLengthSpan *span;
+    double spanT;
+    
+    if (table->spanCount == 0) {
+        if (t) *t = 0.0;
+        return NSNotFound;
+    }
+    length = MIN(MAX(length, 0.0), table->length);
+    // The first span that ends at or after length.
+    high = table->spanCount - 1;
+    while (low < high) {
+        NSUInteger middle = (low + high) / 2;
+        if (table->spans[middle].endLength < length) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    span = table->spans + low;
+    spanT = AJRPathLengthSpanTAtLength(table, span, length);
+    if (t) *t = spanT;
+    if (point || tangent) {
+        AJRPathLengthSpanGetPoint(table, span, spanT, point, tangent);
+    }
+    
+    return span->elementIndex;
+}
+
+CGFloat AJRPathLengthTableLengthAtElement(const AJRPathLengthTable *table, NSUInteger elementIndex, double t) {
+    NSUInteger first, last;
+    
+    if (elementIndex >= table->elementCount) {
+        return table->length;
+    }
+    first = table->elementSpans[elementIndex];
+    last = elementIndex + 1 < table->elementCount ? table->elementSpans[elementIndex + 1] : table->spanCount;
+    t = MIN(MAX(t, 0.0), 1.0);
+    for (NSUInteger index = first; index < last; index++) {
+        const AJRPathLengthSpan *span = table->spans + index;
+        if (t <= span->endT || index == last - 1) {
+            AJRBezierCurve curve = table->curves[elementIndex];
+            if (table->elementIsLine[elementIndex]) {
+                return span->startLength + (span->endLength - span->startLength) * t;
+            }
+            return span->startLength + AJRBezierCurveLength(curve, span->startT, MIN(t, span->endT));
+        }
+    }
+    
+    return table->elementLengths[elementIndex];
+}
+
+NSUInteger AJRPathLengthTableSample(const AJRPathLengthTable *table, NSUInteger count, CGPoint *points, CGPoint *tangents) {
+    NSUInteger spanIndex = 0;
+    
+    if (table->spanCount == 0) {
+        return 0;
+    }
+    for (NSUInteger index = 0; index < count; index++) {
+        // The last sample is computed as the length itself, so that rounding can't leave it short of the end.
+        double length = count > 1 ? (index == count - 1 ? table->length : table->length * index / (count - 1)) : 0.0;
+        const AJRPathLengthSpan *span;
+        
+        while (spanIndex < table->spanCount - 1 && table->spans[spanIndex].endLength < length) {
+            spanIndex += 1;
+        }
+        span = table->spans + spanIndex;
+        AJRPathLengthSpanGetPoint(table, span, AJRPathLengthSpanTAtLength(table, span, length), points + index, tangents ? tangents + index : NULL);
+    }
+    
+    return count;
+}
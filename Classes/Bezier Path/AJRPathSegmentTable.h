@@ -0,0 +1,159 @@
+/*
+ AJRPathSegmentTable.h
+ AJRInterfaceFoundation
+
+ Copyright © 2022, AJ Raftis and AJRInterfaceFoundation authors
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of AJRInterfaceFoundation nor the names of its contributors may be
+   used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL AJ RAFTIS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#import <AJRInterfaceFoundation/AJRBezierPath.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_OPTIONS(uint8_t, AJRPathSegmentFlags) {
+    /*! The segment is a straight line, so curve's handles just repeat its end points. */
+    AJRPathSegmentFlagLine = 0x01,
+    /*! The segment is the implicit edge that closes an open subpath when it's filled. It takes part in fill queries, but not in stroke queries. */
+    AJRPathSegmentFlagImplicitClose = 0x02,
+};
+
+/*!
+ A piece of a path element that's monotone in both x and y. Because the piece is monotone, its bounds are just the box around its end points, and any horizontal or vertical line crosses it at most once.
+ */
+typedef struct _ajrPathSegment {
+    /*! The whole element the piece came from, expressed as a cubic. Quadratics are promoted and lines have their handles on their end points. */
+    AJRBezierCurve curve;
+    /*! The range of curve covered by the piece. */
+    double startT;
+    double endT;
+    /*! curve evaluated at startT and endT. */
+    CGPoint start;
+    CGPoint end;
+    CGRect bounds;
+    /*! The index of the source element in the elements array the table was built from. */
+    NSUInteger elementIndex;
+    /*! 1 if the piece heads up in y, -1 if it heads down, and 0 if it's horizontal. */
+    NSInteger yDirection;
+    AJRPathSegmentFlags flags;
+} AJRPathSegment;
+
+/*!
+ Per element summary. The segments for the element at index i are segments[firstSegment..firstSegment + segmentCount - 1]. Elements that don't draw anything, like move tos, have a segmentCount of 0 and CGRectNull bounds.
+ */
+typedef struct _ajrPathSegmentElement {
+    /*! The tight bounds of the element, computed from its curve extrema rather than from its control points. */
+    CGRect bounds;
+    NSUInteger firstSegment;
+    NSUInteger segmentCount;
+} AJRPathSegmentElement;
+
+/*!
+ A node in a segment table's bounding box tree. A leaf has a non-zero count, and holds the segments listed at nodeSegments[start..start + count - 1]. An interior node has a count of 0, its first child directly after it, and its second child at start.
+ */
+typedef struct _ajrPathSegmentNode {
+    CGRect bounds;
+    NSUInteger start;
+    NSUInteger count;
+} AJRPathSegmentNode;
+
+/*!
+ An acceleration structure for answering repeated geometric questions about a path. The table holds each element's tight bounding box and its curves pre-split into x/y monotone pieces, so queries can reject most elements with a box test and only do real work on the few that remain.
+
+ AJRBezierPath builds one of these lazily and throws it away whenever the path changes, so you'll normally just use the path's own query methods. The table doesn't reference the arrays it was built from, and none of the query functions modify it, so a table may be shared between threads once it's built.
+ */
+typedef struct _ajrPathSegmentTable {
+    AJRPathSegment *segments;
+    NSUInteger segmentCount;
+    /*! The implicit closing edges of open subpaths. These belong to no element, and only matter when filling. */
+    AJRPathSegment *closingSegments;
+    NSUInteger closingSegmentCount;
+    /*! Parallel to the elements array the table was built from. */
+    AJRPathSegmentElement *elements;
+    NSUInteger elementCount;
+    /*! The tight bounds of the whole path, or CGRectNull if the path draws nothing. */
+    CGRect bounds;
+    /*! A bounding box tree over segments, rooted at nodes[0], so that questions about another path or a rectangle only look at the segments near it. The closing segments aren't in it. */
+    AJRPathSegmentNode *nodes;
+    NSUInteger nodeCount;
+    NSUInteger *nodeSegments;
+} AJRPathSegmentTable;
+
+/*!
+ Builds a segment table from a path's raw points and elements. The caller owns the result and must release it with AJRPathSegmentTableFree().
+ */
+extern AJRPathSegmentTable *AJRPathSegmentTableCreate(const CGPoint *points, NSUInteger pointCount,
+                                                      const AJRBezierPathElement *elements, NSUInteger elementCount);
+extern void AJRPathSegmentTableFree(AJRPathSegmentTable * _Nullable table);
+
+/*! Returns the point on segment's curve at t, which should lie in [startT..endT]. */
+extern CGPoint AJRPathSegmentPointAtT(const AJRPathSegment *segment, double t);
+
+/*! Same as AJRpathwinding(), but answered from the table. */
+extern NSInteger AJRPathSegmentTableWinding(const AJRPathSegmentTable *table, CGFloat x, CGFloat y);
+/*! Same as AJRpathinfill(), but answered from the table. */
+extern BOOL AJRPathSegmentTableContainsPoint(const AJRPathSegmentTable *table, CGFloat x, CGFloat y, AJRWindingRule windingRule);
+/*! Same as AJRpathinstroke(), but answered from the table. */
+extern BOOL AJRPathSegmentTableStrokeContainsPoint(const AJRPathSegmentTable *table, CGFloat x, CGFloat y, CGFloat width);
+
+/*! Returns NO if the element at elementIndex lies entirely to one side of the infinite line through line, which means it can't intersect line. */
+extern BOOL AJRPathSegmentTableElementMayCrossLine(const AJRPathSegmentTable *table, NSUInteger elementIndex, AJRLine line);
+/*! Returns NO if every point of the element at elementIndex is further than distance from point. */
+extern BOOL AJRPathSegmentTableElementMayBeNearPoint(const AJRPathSegmentTable *table, NSUInteger elementIndex, CGPoint point, CGFloat distance);
+
+/*!
+ Finds where each of the horizontal lines at ys crosses the path, in a single pass over the table's pieces. Each piece is y monotone, so the lines that cross it are a contiguous run of ys, found by binary search, and each crosses it exactly once. That makes the cost proportional to the number of pieces plus the number of crossings, rather than to pieces times lines.
+
+ ys must be in ascending order. The crossings with ys[i] are appended to buffers[i], in ascending order of x. As with the winding functions, pieces include their lower end point and exclude their upper one, so a line through a vertex is only counted once, and horizontal pieces are never crossed. Open subpaths are treated as closed, the way they are when filled. Crossings with an implicit closing edge have a segment of NSNotFound. Otherwise segment is an index into the elements array the table was built from.
+ */
+extern void AJRPathSegmentTableIntersectHorizontalLines(const AJRPathSegmentTable *table, const CGFloat *ys, NSUInteger count, AJRIntersectionBuffer *buffers);
+
+/*!
+ For each band from baselines[i] to baselines[i] + height, calls block with the widest rectangles spanning the band's full height that lie inside the path, from left to right. baselines must be in ascending order. All the bands are answered with one pass over the table, by finding where the path is filled along each band's middle, and then cutting out wherever a piece of the path passes through the band. That includes pieces with the fill on both sides, such as where overlapping subpaths cross, so the rectangles can be narrower than they need to be for paths that overlap themselves.
+ */
+extern void AJRPathSegmentTableEnumerateInscribedRects(const AJRPathSegmentTable *table, AJRWindingRule windingRule, const CGFloat *baselines, NSUInteger count, CGFloat height, void (^block)(NSUInteger index, CGRect rect, BOOL *stop));
+/*! As above, but with bands of any height, running from bottoms[i] to tops[i]. Both arrays must be in ascending order. */
+extern void AJRPathSegmentTableEnumerateInscribedRectsInBands(const AJRPathSegmentTable *table, AJRWindingRule windingRule, const CGFloat *bottoms, const CGFloat *tops, NSUInteger count, void (^block)(NSUInteger index, CGRect rect, BOOL *stop));
+
+/*!
+ Finds the point on any segment nearest to point, searching the bounding box tree nearest first, and skipping any subtree whose box is further away than the best point found so far. The closing segments aren't included. Returns NO, and sets nearest's elementIndex to NSNotFound, if no segment is within maximumDistance. Otherwise, nearest's elementIndex is an index into the elements array the table was built from. Where two elements are equally near, such as at the vertex they share, the earlier element wins.
+ */
+extern BOOL AJRPathSegmentTableNearestPoint(const AJRPathSegmentTable *table, CGPoint point, CGFloat maximumDistance, AJRBezierPathNearestPoint *nearest);
+/*! Answers AJRPathSegmentTableNearestPoint() for each of count points, starting each search with the segment that answered the one before it. Returns how many points had a segment within maximumDistance. */
+extern NSUInteger AJRPathSegmentTableNearestPoints(const AJRPathSegmentTable *table, const CGPoint *points, NSUInteger count, CGFloat maximumDistance, AJRBezierPathNearestPoint *nearest);
+
+/*! Returns YES if any segment touches rect. Segments are treated as lines with no width, and the closing segments aren't included. */
+extern BOOL AJRPathSegmentTableIntersectsRect(const AJRPathSegmentTable *table, CGRect rect);
+
+/*!
+ Finds where the segments of table cross the segments of other, by walking both bounding box trees together, so only segments whose boxes overlap are ever compared. A line is intersected with a curve exactly. Two curves are split in half, again and again, keeping only the halves whose boxes still overlap, until both are flat enough to be treated as lines. Since the pieces are monotone, each half's box is just the box around its end points, so that stays cheap. Stretches where the segments run along each other aren't crossings, so nothing is reported for them.
+
+ If buffer and otherBuffer are both NULL, this stops at the first crossing, and returns 1 if there is one. Otherwise each crossing is appended to both, as seen from table in buffer, and as seen from other in otherBuffer, so the records at the same index describe the same crossing. Either buffer may be NULL if you only need one side. The records' segments are indexes into the elements arrays the tables were built from. Crossings are sorted by their segment and t in table, and crossings at a vertex shared by two segments are only reported once.
+
+ @returns The number of crossings found.
+ */
+extern NSUInteger AJRPathSegmentTableIntersectTable(const AJRPathSegmentTable *table, const AJRPathSegmentTable *other, AJRIntersectionBuffer * _Nullable buffer, AJRIntersectionBuffer * _Nullable otherBuffer);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,1206 @@
+/*
+ AJRPathSegmentTable.m
+ AJRInterfaceFoundation
+
+ Copyright © 2022, AJ Raftis and AJRInterfaceFoundation authors
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of AJRInterfaceFoundation nor the names of its contributors may be
+   used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL AJ RAFTIS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#import "AJRPathSegmentTable.h"
+
+#import "AJRBezierCurves.h"
+#import "AJRGeometry.h"
+
+static inline CGRect AJRRectFromEndPoints(CGPoint start, CGPoint end) {
+    return (CGRect){{MIN(start.x, end.x), MIN(start.y, end.y)}, {fabs(end.x - start.x), fabs(end.y - start.y)}};
+}
+
+static inline NSInteger AJRDirectionFromPoints(CGFloat start, CGFloat end) {
+    return start < end ? 1 : (start > end ? -1 : 0);
+}
+
+static void AJRPathSegmentTableAppend(AJRPathSegment **segments, NSUInteger *count, NSUInteger *max, AJRPathSegment segment) {
+    if (*count == *max) {
+        *max = *max ? *max * 2 : 16;
+        *segments = NSZoneRealloc(nil, *segments, *max * sizeof(AJRPathSegment));
+    }
+    (*segments)[*count] = segment;
+    *count += 1;
+}
+
+static AJRPathSegment AJRPathSegmentMakeLine(CGPoint start, CGPoint end, NSUInteger elementIndex, AJRPathSegmentFlags flags) {
+    AJRPathSegment segment;
+    
+    segment.curve = (AJRBezierCurve){start, start, end, end};
+    segment.startT = 0.0;
+    segment.endT = 1.0;
+    segment.start = start;
+    segment.end = end;
+    segment.bounds = AJRRectFromEndPoints(start, end);
+    segment.elementIndex = elementIndex;
+    segment.yDirection = AJRDirectionFromPoints(start.y, end.y);
+    segment.flags = AJRPathSegmentFlagLine | flags;
+    
+    return segment;
+}
+
+#pragma mark - Bounding Box Tree
+
+// The most segments a leaf of the tree holds.
+#define AJRPathSegmentLeafSize 4
+
+static inline CGFloat AJRPathSegmentCenter(const AJRPathSegmentTable *table, NSUInteger index, BOOL useX) {
+    CGRect bounds = table->segments[table->nodeSegments[index]].bounds;
+    return useX ? CGRectGetMidX(bounds) : CGRectGetMidY(bounds);
+}
+
+// Reorders nodeSegments[start..end - 1] so that the segment whose center would be at split if they were sorted along one axis is there, with no segment centered further along before it, and no segment centered less far along after it.
+static void AJRPathSegmentTableSelect(AJRPathSegmentTable *table, NSUInteger start, NSUInteger end, NSUInteger split, BOOL useX) {
+    NSUInteger *indexes = table->nodeSegments;
+    
+    while (end - start > 1) {
+        CGFloat pivot = AJRPathSegmentCenter(table, start + (end - start) / 2, useX);
+        NSUInteger low = start, high = end - 1;
+        
+        while (low <= high) {
+            while (AJRPathSegmentCenter(table, low, useX) < pivot) low++;
+            while (AJRPathSegmentCenter(table, high, useX) > pivot) high--;
+            if (low <= high) {
+                NSUInteger swap = indexes[low];
+                indexes[low] = indexes[high];
+                indexes[high] = swap;
+                low++;
+                if (high == 0) break;
+                high--;
+            }
+        }
+        // Everything in [start..high] is at or before the pivot and everything in [low..end - 1] is at or after it.
+        if (split <= high) {
+            end = high + 1;
+        } else if (split >= low) {
+            start = low;
+        } else {
+            return;
+        }
+    }
+}
+
+// Builds the subtree for nodeSegments[start..start + count - 1] at nodes[nodeIndex], and returns the index of the next free node.
+static NSUInteger AJRPathSegmentTableBuildNode(AJRPathSegmentTable *table, NSUInteger nodeIndex, NSUInteger start, NSUInteger count) {
+    AJRPathSegmentNode *node = table->nodes + nodeIndex;
+    CGRect bounds = CGRectNull;
+    BOOL splitX;
+    CGFloat middle;
+    NSUInteger low = start, high = start + count;
+    
+    for (NSUInteger index = start; index < start + count; index++) {
+        bounds = CGRectUnion(bounds, table->segments[table->nodeSegments[index]].bounds);
+    }
+    node->bounds = bounds;
+    if (count <= AJRPathSegmentLeafSize) {
+        node->start = start;
+        node->count = count;
+        return nodeIndex + 1;
+    }
+    
+    // Split across the middle of the longer side, so the children are as square as we can make them.
+    splitX = bounds.size.width >= bounds.size.height;
+    middle = splitX ? CGRectGetMidX(bounds) : CGRectGetMidY(bounds);
+    while (low < high) {
+        CGRect segmentBounds = table->segments[table->nodeSegments[low]].bounds;
+        if ((splitX ? CGRectGetMidX(segmentBounds) : CGRectGetMidY(segmentBounds)) < middle) {
+            low++;
+        } else {
+            NSUInteger swap = table->nodeSegments[low];
+            table->nodeSegments[low] = table->nodeSegments[--high];
+            table->nodeSegments[high] = swap;
+        }
+    }
+    // If either side got less than a quarter of the segments, such as when most of them are piled up in one corner, split them in half by their centers instead. That keeps the tree's depth logarithmic, so the queries' node stacks rarely need to leave the C stack.
+    if (low - start < count / 4 || start + count - low < count / 4) {
+        low = start + count / 2;
+        AJRPathSegmentTableSelect(table, start, start + count, low, splitX);
+    }
+    
+    node->count = 0;
+    node->start = AJRPathSegmentTableBuildNode(table, nodeIndex + 1, start, low - start);
+    return AJRPathSegmentTableBuildNode(table, node->start, low, start + count - low);
+}
+
+static void AJRPathSegmentTableBuildTree(AJRPathSegmentTable *table) {
+    if (table->segmentCount == 0) {
+        return;
+    }
+    // A binary tree with leaves of at least one segment never needs more than 2n - 1 nodes.
+    table->nodes = NSZoneMalloc(nil, (2 * table->segmentCount - 1) * sizeof(AJRPathSegmentNode));
+    table->nodeSegments = NSZoneMalloc(nil, table->segmentCount * sizeof(NSUInteger));
+    for (NSUInteger index = 0; index < table->segmentCount; index++) {
+        table->nodeSegments[index] = index;
+    }
+    table->nodeCount = AJRPathSegmentTableBuildNode(table, 0, 0, table->segmentCount);
+}
+
+/*
+ The stack of node indexes the queries walk the tree with. It starts out in local, which is deep enough for any tree we're likely to meet, and moves to the heap if a walk ever needs more. Since entries points into the struct itself, set one up in place with AJRNodeStackInit(), and release it with AJRNodeStackFree().
+ */
+typedef struct _ajrNodeStack {
+    NSUInteger *entries;
+    NSUInteger count;
+    NSUInteger max;
+    NSUInteger local[128];
+} AJRNodeStack;
+
+static inline void AJRNodeStackInit(AJRNodeStack *stack) {
+    stack->entries = stack->local;
+    stack->count = 0;
+    stack->max = sizeof(stack->local) / sizeof(stack->local[0]);
+}
+
+static void AJRNodeStackGrow(AJRNodeStack *stack) {
+    NSUInteger *entries = NSZoneMalloc(nil, stack->max * 2 * sizeof(NSUInteger));
+    
+    memcpy(entries, stack->entries, stack->count * sizeof(NSUInteger));
+    if (stack->entries != stack->local) {
+        NSZoneFree(nil, stack->entries);
+    }
+    stack->entries = entries;
+    stack->max *= 2;
+}
+
+static inline void AJRNodeStackPush(AJRNodeStack *stack, NSUInteger index) {
+    if (stack->count == stack->max) {
+        AJRNodeStackGrow(stack);
+    }
+    stack->entries[stack->count++] = index;
+}
+
+static inline NSUInteger AJRNodeStackPop(AJRNodeStack *stack) {
+    return stack->entries[--stack->count];
+}
+
+static inline void AJRNodeStackFree(AJRNodeStack *stack) {
+    if (stack->entries != stack->local) {
+        NSZoneFree(nil, stack->entries);
+    }
+}
+
+AJRPathSegmentTable *AJRPathSegmentTableCreate(const CGPoint *points, NSUInteger pointCount,
+                                               const AJRBezierPathElement *elements, NSUInteger elementCount) {
+    AJRPathSegmentTable *table = NSZoneCalloc(nil, 1, sizeof(AJRPathSegmentTable));
+    NSUInteger maxSegments = 0, maxClosingSegments = 0;
+    NSUInteger pointIndex = 0;
+    CGPoint current = CGPointZero;
+    CGPoint subpathStart = CGPointZero;
+    
+    table->elements = NSZoneMalloc(nil, MAX(elementCount, 1) * sizeof(AJRPathSegmentElement));
+    table->elementCount = elementCount;
+    table->bounds = CGRectNull;
+    
+    for (NSUInteger elementIndex = 0; elementIndex < elementCount; elementIndex++) {
+        AJRPathSegmentElement *element = table->elements + elementIndex;
+        AJRBezierCurve curve;
+        BOOL isCurve = NO;
+        
+        element->bounds = CGRectNull;
+        element->firstSegment = table->segmentCount;
+        element->segmentCount = 0;
+        
+        switch (elements[elementIndex]) {
+            case AJRBezierPathElementSetBoundingBox:
+                pointIndex += 2;
+                break;
+            case AJRBezierPathElementMoveTo:
+                if (!CGPointEqualToPoint(current, subpathStart)) {
+                    AJRPathSegmentTableAppend(&table->closingSegments, &table->closingSegmentCount, &maxClosingSegments, AJRPathSegmentMakeLine(current, subpathStart, elementIndex, AJRPathSegmentFlagImplicitClose));
+                }
+                current = subpathStart = points[pointIndex];
+                pointIndex += 1;
+                break;
+            case AJRBezierPathElementLineTo:
+                AJRPathSegmentTableAppend(&table->segments, &table->segmentCount, &maxSegments, AJRPathSegmentMakeLine(current, points[pointIndex], elementIndex, 0));
+                current = points[pointIndex];
+                pointIndex += 1;
+                break;
+            case AJRBezierPathElementCubicCurveTo:
+                curve = (AJRBezierCurve){current, points[pointIndex], points[pointIndex + 1], points[pointIndex + 2]};
+                isCurve = YES;
+                current = points[pointIndex + 2];
+                pointIndex += 3;
+                break;
+            case AJRBezierPathElementQuadraticCurveTo:
+                curve = AJRBezierCurveFromQuadraticCurve((AJRQuadraticCurve){current, points[pointIndex], points[pointIndex + 1]});
+                isCurve = YES;
+                current = points[pointIndex + 1];
+                pointIndex += 2;
+                break;
+            case AJRBezierPathElementClose:
+                AJRPathSegmentTableAppend(&table->segments, &table->segmentCount, &maxSegments, AJRPathSegmentMakeLine(current, subpathStart, elementIndex, 0));
+                current = subpathStart;
+                break;
+        }
+        
+        if (isCurve) {
+            double tValues[5];
+            NSInteger count = AJRBezierCurveGetMonotoneTValues(curve, tValues);
+            double t0 = 0.0;
+            CGPoint p0 = curve.start;
+            
+            tValues[count] = 1.0;
+            for (NSInteger index = 0; index <= count; index++) {
+                double t1 = tValues[index];
+                // Use the real end point rather than evaluating at 1.0, so that adjoining elements meet exactly. The winding count depends on that.
+                CGPoint p1 = index == count ? curve.end : AJRBezierCurveAtT(curve, t1);
+                AJRPathSegment segment;
+                
+                segment.curve = curve;
+                segment.startT = t0;
+                segment.endT = t1;
+                segment.start = p0;
+                segment.end = p1;
+                segment.bounds = AJRRectFromEndPoints(p0, p1);
+                segment.elementIndex = elementIndex;
+                segment.yDirection = AJRDirectionFromPoints(p0.y, p1.y);
+                segment.flags = 0;
+                AJRPathSegmentTableAppend(&table->segments, &table->segmentCount, &maxSegments, segment);
+                
+                t0 = t1;
+                p0 = p1;
+            }
+        }
+        
+        element->segmentCount = table->segmentCount - element->firstSegment;
+        for (NSUInteger index = element->firstSegment; index < table->segmentCount; index++) {
+            element->bounds = CGRectUnion(element->bounds, table->segments[index].bounds);
+        }
+        if (element->segmentCount) {
+            table->bounds = CGRectUnion(table->bounds, element->bounds);
+        }
+    }
+    // Filling implicitly closes the last subpath.
+    if (!CGPointEqualToPoint(current, subpathStart)) {
+        AJRPathSegmentTableAppend(&table->closingSegments, &table->closingSegmentCount, &maxClosingSegments, AJRPathSegmentMakeLine(current, subpathStart, elementCount, AJRPathSegmentFlagImplicitClose));
+    }
+    
+    AJRPathSegmentTableBuildTree(table);
+    
+    return table;
+}
+
+void AJRPathSegmentTableFree(AJRPathSegmentTable *table) {
+    if (table) {
+        if (table->segments) NSZoneFree(nil, table->segments);
+        if (table->closingSegments) NSZoneFree(nil, table->closingSegments);
+        if (table->nodes) NSZoneFree(nil, table->nodes);
+        if (table->nodeSegments) NSZoneFree(nil, table->nodeSegments);
+        NSZoneFree(nil, table->elements);
+        NSZoneFree(nil, table);
+    }
+}
+
+CGPoint AJRPathSegmentPointAtT(const AJRPathSegment *segment, double t) {
+    if (segment->flags & AJRPathSegmentFlagLine) {
+        return (CGPoint){segment->curve.start.x + (segment->curve.end.x - segment->curve.start.x) * t,
+                         segment->curve.start.y + (segment->curve.end.y - segment->curve.start.y) * t};
+    }
+    return AJRBezierCurveAtT(segment->curve, t);
+}
+
+static inline BOOL AJRRectIsWithinDistanceOfPoint(CGRect rect, CGPoint point, CGFloat distance) {
+    return (!CGRectIsNull(rect)
+            && point.x >= rect.origin.x - distance
+            && point.x <= rect.origin.x + rect.size.width + distance
+            && point.y >= rect.origin.y - distance
+            && point.y <= rect.origin.y + rect.size.height + distance);
+}
+
+static inline NSInteger AJRPathSegmentWinding(const AJRPathSegment *segment, CGFloat x, CGFloat y) {
+    CGPoint low, high;
+    
+    if (segment->yDirection == 0) {
+        return 0;
+    }
+    // Test against the end points rather than bounds, since origin + size doesn't always round back to the end point exactly.
+    low = segment->yDirection > 0 ? segment->start : segment->end;
+    high = segment->yDirection > 0 ? segment->end : segment->start;
+    // Pieces include their lower end point and exclude their upper one, which matches AJRpathwinding(), so a ray through a vertex is only counted once.
+    if (y < low.y || y >= high.y || (x >= low.x && x >= high.x)) {
+        return 0;
+    }
+    if (x < low.x && x < high.x) {
+        // Entirely to the right, so we cross it without having to find out where.
+        return segment->yDirection;
+    }
+    if (segment->flags & AJRPathSegmentFlagLine) {
+        double cross = ((double)high.x - (double)low.x) * ((double)y - (double)low.y) - ((double)x - (double)low.x) * ((double)high.y - (double)low.y);
+        return cross > 0.0 ? segment->yDirection : 0;
+    }
+    return AJRBezierCurveAtT(segment->curve, AJRBezierCurveTForY(segment->curve, y, segment->startT, segment->endT)).x > x ? segment->yDirection : 0;
+}
+
+NSInteger AJRPathSegmentTableWinding(const AJRPathSegmentTable *table, CGFloat x, CGFloat y) {
+    NSInteger winding = 0;
+    
+    for (NSUInteger elementIndex = 0; elementIndex < table->elementCount; elementIndex++) {
+        const AJRPathSegmentElement *element = table->elements + elementIndex;
+        
+        // This is only a coarse reject, so it's inclusive. The pieces make the exact decision.
+        if (element->segmentCount == 0
+            || y < element->bounds.origin.y
+            || y > element->bounds.origin.y + element->bounds.size.height
+            || x > element->bounds.origin.x + element->bounds.size.width) {
+            continue;
+        }
+        for (NSUInteger index = 0; index < element->segmentCount; index++) {
+            winding += AJRPathSegmentWinding(table->segments + element->firstSegment + index, x, y);
+        }
+    }
+    for (NSUInteger index = 0; index < table->closingSegmentCount; index++) {
+        winding += AJRPathSegmentWinding(table->closingSegments + index, x, y);
+    }
+    
+    return winding;
+}
+
+BOOL AJRPathSegmentTableContainsPoint(const AJRPathSegmentTable *table, CGFloat x, CGFloat y, AJRWindingRule windingRule) {
+    NSInteger winding;
+    
+    if (!AJRRectIsWithinDistanceOfPoint(table->bounds, (CGPoint){x, y}, 0.0)) {
+        return NO;
+    }
+    winding = AJRPathSegmentTableWinding(table, x, y);
+    
+    return windingRule == AJRWindingRuleEvenOdd ? (winding % 2) != 0 : winding != 0;
+}
+
+BOOL AJRPathSegmentTableStrokeContainsPoint(const AJRPathSegmentTable *table, CGFloat x, CGFloat y, CGFloat width) {
+    CGPoint point = (CGPoint){x, y};
+    double distance = width / 2.0;
+    
+    if (!AJRRectIsWithinDistanceOfPoint(table->bounds, point, distance)) {
+        return NO;
+    }
+    for (NSUInteger elementIndex = 0; elementIndex < table->elementCount; elementIndex++) {
+        const AJRPathSegmentElement *element = table->elements + elementIndex;
+        const AJRPathSegment *segment;
+        
+        if (element->segmentCount == 0 || !AJRRectIsWithinDistanceOfPoint(element->bounds, point, distance)) {
+            continue;
+        }
+        segment = table->segments + element->firstSegment;
+        if (segment->flags & AJRPathSegmentFlagLine) {
+            if (AJRDistanceBetweenPointAndLineSegment(point, (AJRLine){segment->start, segment->end}) <= distance) {
+                return YES;
+            }
+        } else if (AJRBezierCurveIsWithinDistanceOfPoint(segment->curve, point, distance)) {
+            return YES;
+        }
+    }
+    
+    return NO;
+}
+
+BOOL AJRPathSegmentTableElementMayCrossLine(const AJRPathSegmentTable *table, NSUInteger elementIndex, AJRLine line) {
+    CGRect bounds;
+    double dx, dy, side, sign = 0.0;
+    CGPoint corners[4];
+    
+    if (elementIndex >= table->elementCount || table->elements[elementIndex].segmentCount == 0) {
+        return NO;
+    }
+    bounds = table->elements[elementIndex].bounds;
+    corners[0] = bounds.origin;
+    corners[1] = (CGPoint){CGRectGetMaxX(bounds), bounds.origin.y};
+    corners[2] = (CGPoint){CGRectGetMaxX(bounds), CGRectGetMaxY(bounds)};
+    corners[3] = (CGPoint){bounds.origin.x, CGRectGetMaxY(bounds)};
+    dx = line.end.x - line.start.x;
+    dy = line.end.y - line.start.y;
+    for (NSInteger index = 0; index < 4; index++) {
+        side = dx * (corners[index].y - line.start.y) - dy * (corners[index].x - line.start.x);
+        if (side == 0.0 || (sign != 0.0 && (side > 0.0) != (sign > 0.0))) {
+            return YES;
+        }
+        sign = side;
+    }
+    
+    return NO;
+}
+
+BOOL AJRPathSegmentTableElementMayBeNearPoint(const AJRPathSegmentTable *table, NSUInteger elementIndex, CGPoint point, CGFloat distance) {
+    if (elementIndex >= table->elementCount) {
+        return NO;
+    }
+    return AJRRectIsWithinDistanceOfPoint(table->elements[elementIndex].bounds, point, distance);
+}
+
+#pragma mark - Scanlines
+
+// Returns the index of the first value that isn't less than value (or, if after is YES, that's greater than value). values must be in ascending order.
+static NSUInteger AJRFirstIndexOfValue(const CGFloat *values, NSUInteger count, CGFloat value, BOOL after) {
+    NSUInteger low = 0, high = count;
+    
+    while (low < high) {
+        NSUInteger middle = low + (high - low) / 2;
+        if (values[middle] < value || (after && values[middle] == value)) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    
+    return low;
+}
+
+// Returns the t on segment's curve where it passes through y, which must be within the segment's y range.
+static inline double AJRPathSegmentTForY(const AJRPathSegment *segment, CGFloat y) {
+    if (segment->flags & AJRPathSegmentFlagLine) {
+        return segment->end.y == segment->start.y ? 0.0 : ((double)y - (double)segment->start.y) / ((double)segment->end.y - (double)segment->start.y);
+    }
+    return AJRBezierCurveTForY(segment->curve, y, segment->startT, segment->endT);
+}
+
+static void AJRPathSegmentIntersectHorizontalLines(const AJRPathSegment *segment, NSUInteger segmentIndex, const CGFloat *ys, NSUInteger count, AJRIntersectionBuffer *buffers) {
+    CGFloat lowY, highY;
+    NSUInteger direction;
+    
+    if (segment->yDirection == 0) {
+        return;
+    }
+    lowY = segment->yDirection > 0 ? segment->start.y : segment->end.y;
+    highY = segment->yDirection > 0 ? segment->end.y : segment->start.y;
+    direction = (segment->start.x < segment->end.x ? AJRLeftToRightDirection : AJRRightToLeftDirection) | (segment->yDirection > 0 ? AJRTopToBottomDirection : AJRBottomToTopDirection);
+    for (NSUInteger index = AJRFirstIndexOfValue(ys, count, lowY, NO); index < count && ys[index] < highY; index++) {
+        AJRIntersectionRecord *record = AJRIntersectionBufferAppend(buffers + index);
+        double t = AJRPathSegmentTForY(segment, ys[index]);
+        
+        record->point.x = ys[index] == segment->start.y ? segment->start.x : AJRPathSegmentPointAtT(segment, t).x;
+        record->point.y = ys[index];
+        record->t = t;
+        record->segment = segmentIndex;
+        record->direction = direction;
+        if (t == 0.0 || t == 1.0) {
+            record->flags = AJRIntersectionFlagEndPoint;
+        }
+    }
+}
+
+static int AJRCompareIntersectionRecordsByX(const void *first, const void *second) {
+    CGFloat x1 = ((const AJRIntersectionRecord *)first)->point.x;
+    CGFloat x2 = ((const AJRIntersectionRecord *)second)->point.x;
+    
+    return x1 < x2 ? -1 : (x1 > x2 ? 1 : 0);
+}
+
+void AJRPathSegmentTableIntersectHorizontalLines(const AJRPathSegmentTable *table, const CGFloat *ys, NSUInteger count, AJRIntersectionBuffer *buffers) {
+    NSUInteger *starts;
+    
+    if (count == 0 || CGRectIsNull(table->bounds)) {
+        return;
+    }
+    // Remember where each buffer's new records begin, so that we only sort what we added.
+    starts = NSZoneMalloc(nil, count * sizeof(NSUInteger));
+    for (NSUInteger index = 0; index < count; index++) {
+        starts[index] = buffers[index].count;
+    }
+    for (NSUInteger index = 0; index < table->segmentCount; index++) {
+        AJRPathSegmentIntersectHorizontalLines(table->segments + index, table->segments[index].elementIndex, ys, count, buffers);
+    }
+    for (NSUInteger index = 0; index < table->closingSegmentCount; index++) {
+        AJRPathSegmentIntersectHorizontalLines(table->closingSegments + index, NSNotFound, ys, count, buffers);
+    }
+    for (NSUInteger index = 0; index < count; index++) {
+        if (buffers[index].count - starts[index] > 1) {
+            qsort(buffers[index].records + starts[index], buffers[index].count - starts[index], sizeof(AJRIntersectionRecord), AJRCompareIntersectionRecordsByX);
+        }
+    }
+    NSZoneFree(nil, starts);
+}
+
+typedef struct _ajrSpan {
+    NSUInteger band;
+    CGFloat minX;
+    CGFloat maxX;
+} AJRSpan;
+
+static int AJRCompareSpans(const void *first, const void *second) {
+    const AJRSpan *one = first, *two = second;
+    
+    if (one->band != two->band) {
+        return one->band < two->band ? -1 : 1;
+    }
+    return one->minX < two->minX ? -1 : (one->minX > two->minX ? 1 : 0);
+}
+
+static void AJRSpansAppend(AJRSpan **spans, NSUInteger *count, NSUInteger *max, AJRSpan span) {
+    if (*count == *max) {
+        *max = *max ? *max * 2 : 16;
+        *spans = NSZoneRealloc(nil, *spans, *max * sizeof(AJRSpan));
+    }
+    (*spans)[*count] = span;
+    *count += 1;
+}
+
+// Adds a span to blocked for each band segment passes through. Since the segment is monotone, the x range of the part inside a band is just the range between its x values where it enters and leaves.
+static void AJRPathSegmentBlockBands(const AJRPathSegment *segment, const CGFloat *bottoms, const CGFloat *tops, NSUInteger count, AJRSpan **blocked, NSUInteger *blockedCount, NSUInteger *blockedMax) {
+    CGFloat lowY = MIN(segment->start.y, segment->end.y);
+    CGFloat highY = MAX(segment->start.y, segment->end.y);
+    
+    // A band is passed through if its open interval overlaps the segment's y range. Both ends of the bands are ascending, so the candidates are a contiguous run. Horizontal segments end up needing to lie strictly inside the band.
+    for (NSUInteger band = AJRFirstIndexOfValue(tops, count, lowY, YES); band < count && bottoms[band] < highY; band++) {
+        CGFloat y0 = MAX(lowY, bottoms[band]);
+        CGFloat y1 = MIN(highY, tops[band]);
+        CGFloat x0, x1;
+        
+        if (segment->yDirection == 0) {
+            x0 = segment->start.x;
+            x1 = segment->end.x;
+        } else {
+            x0 = y0 == segment->start.y ? segment->start.x : (y0 == segment->end.y ? segment->end.x : AJRPathSegmentPointAtT(segment, AJRPathSegmentTForY(segment, y0)).x);
+            x1 = y1 == segment->start.y ? segment->start.x : (y1 == segment->end.y ? segment->end.x : AJRPathSegmentPointAtT(segment, AJRPathSegmentTForY(segment, y1)).x);
+        }
+        AJRSpansAppend(blocked, blockedCount, blockedMax, (AJRSpan){band, MIN(x0, x1), MAX(x0, x1)});
+    }
+}
+
+void AJRPathSegmentTableEnumerateInscribedRectsInBands(const AJRPathSegmentTable *table, AJRWindingRule windingRule, const CGFloat *bottoms, const CGFloat *tops, NSUInteger count, void (^block)(NSUInteger index, CGRect rect, BOOL *stop)) {
+    AJRIntersectionBuffer *crossings;
+    CGFloat *middles;
+    AJRSpan *blocked = NULL;
+    NSUInteger blockedCount = 0, blockedMax = 0, nextBlocked = 0;
+    BOOL stop = NO;
+    
+    if (count == 0 || CGRectIsNull(table->bounds)) {
+        return;
+    }
+    
+    // Nothing crosses a band's middle without also passing through the band, so anywhere that's filled along the middle and not blocked is filled for the whole height of the band.
+    middles = NSZoneMalloc(nil, count * sizeof(CGFloat));
+    crossings = NSZoneCalloc(nil, count, sizeof(AJRIntersectionBuffer));
+    for (NSUInteger band = 0; band < count; band++) {
+        middles[band] = (bottoms[band] + tops[band]) / 2.0;
+    }
+    AJRPathSegmentTableIntersectHorizontalLines(table, middles, count, crossings);
+    
+    for (NSUInteger index = 0; index < table->segmentCount; index++) {
+        AJRPathSegmentBlockBands(table->segments + index, bottoms, tops, count, &blocked, &blockedCount, &blockedMax);
+    }
+    for (NSUInteger index = 0; index < table->closingSegmentCount; index++) {
+        AJRPathSegmentBlockBands(table->closingSegments + index, bottoms, tops, count, &blocked, &blockedCount, &blockedMax);
+    }
+    if (blockedCount > 1) {
+        qsort(blocked, blockedCount, sizeof(AJRSpan), AJRCompareSpans);
+    }
+    
+    for (NSUInteger band = 0; band < count && !stop; band++) {
+        const AJRIntersectionBuffer *buffer = crossings + band;
+        NSUInteger firstBlocked = nextBlocked;
+        NSInteger winding = 0;
+        CGFloat minX = 0.0;
+        
+        while (nextBlocked < blockedCount && blocked[nextBlocked].band == band) {
+            nextBlocked++;
+        }
+        if (tops[band] <= bottoms[band]) {
+            continue;
+        }
+        for (NSUInteger index = 0; index < buffer->count && !stop; index++) {
+            BOOL wasInside = windingRule == AJRWindingRuleEvenOdd ? (winding % 2) != 0 : winding != 0;
+            BOOL isInside;
+            
+            winding += (buffer->records[index].direction & AJRTopToBottomDirection) ? 1 : -1;
+            isInside = windingRule == AJRWindingRuleEvenOdd ? (winding % 2) != 0 : winding != 0;
+            if (!wasInside && isInside) {
+                minX = buffer->records[index].point.x;
+            } else if (wasInside && !isInside) {
+                CGFloat maxX = buffer->records[index].point.x;
+                
+                // Cut the blocked spans, which are sorted by their left edges, out of the filled span.
+                for (NSUInteger blockedIndex = firstBlocked; blockedIndex < nextBlocked && blocked[blockedIndex].minX < maxX && !stop; blockedIndex++) {
+                    if (blocked[blockedIndex].maxX <= minX) {
+                        continue;
+                    }
+                    if (blocked[blockedIndex].minX > minX) {
+                        block(band, CGRectMake(minX, bottoms[band], blocked[blockedIndex].minX - minX, tops[band] - bottoms[band]), &stop);
+                    }
+                    minX = blocked[blockedIndex].maxX;
+                }
+                if (minX < maxX && !stop) {
+                    block(band, CGRectMake(minX, bottoms[band], maxX - minX, tops[band] - bottoms[band]), &stop);
+                }
+            }
+        }
+    }
+    
+    for (NSUInteger band = 0; band < count; band++) {
+        AJRIntersectionBufferFree(crossings + band);
+    }
+    NSZoneFree(nil, crossings);
+    NSZoneFree(nil, middles);
+    if (blocked) NSZoneFree(nil, blocked);
+}
+
+void AJRPathSegmentTableEnumerateInscribedRects(const AJRPathSegmentTable *table, AJRWindingRule windingRule, const CGFloat *baselines, NSUInteger count, CGFloat height, void (^block)(NSUInteger index, CGRect rect, BOOL *stop)) {
+    CGFloat *tops;
+    
+    if (count == 0 || height <= 0.0) {
+        return;
+    }
+    tops = NSZoneMalloc(nil, count * sizeof(CGFloat));
+    for (NSUInteger band = 0; band < count; band++) {
+        tops[band] = baselines[band] + height;
+    }
+    AJRPathSegmentTableEnumerateInscribedRectsInBands(table, windingRule, baselines, tops, count, block);
+    NSZoneFree(nil, tops);
+}
+
+#pragma mark - Path Intersections
+
+static inline BOOL AJRRectsTouch(CGRect first, CGRect second) {
+    // Unlike CGRectIntersectsRect(), rects that only share an edge, or have no width or height, still count.
+    return (first.origin.x <= second.origin.x + second.size.width && second.origin.x <= first.origin.x + first.size.width
+            && first.origin.y <= second.origin.y + second.size.height && second.origin.y <= first.origin.y + first.size.height);
+}
+
+// Narrows [*t0..*t1] to where the coordinate of segment, which runs monotonically from start to end, lies within [low..high]. Returns NO if it never does.
+static BOOL AJRPathSegmentClipT(const AJRPathSegment *segment, BOOL useX, CGFloat low, CGFloat high, double *t0, double *t1) {
+    CGFloat start = useX ? segment->start.x : segment->start.y;
+    CGFloat end = useX ? segment->end.x : segment->end.y;
+    BOOL ascending = start <= end;
+    CGFloat first = ascending ? low : high, last = ascending ? high : low;
+    double tFirst, tLast;
+    
+    if (MAX(start, end) < low || MIN(start, end) > high) {
+        return NO;
+    }
+    if (start == end) {
+        return YES;
+    }
+    if (segment->flags & AJRPathSegmentFlagLine) {
+        tFirst = (first - start) / (end - start);
+        tLast = (last - start) / (end - start);
+    } else {
+        // Only solve for the limits that actually cut the piece.
+        tFirst = (ascending ? first <= start : first >= start) ? segment->startT : (useX ? AJRBezierCurveTForX : AJRBezierCurveTForY)(segment->curve, first, segment->startT, segment->endT);
+        tLast = (ascending ? last >= end : last <= end) ? segment->endT : (useX ? AJRBezierCurveTForX : AJRBezierCurveTForY)(segment->curve, last, segment->startT, segment->endT);
+    }
+    *t0 = MAX(*t0, tFirst);
+    *t1 = MIN(*t1, tLast);
+    
+    return *t0 <= *t1;
+}
+
+static BOOL AJRPathSegmentIntersectsRect(const AJRPathSegment *segment, CGRect rect) {
+    double t0 = segment->startT, t1 = segment->endT;
+    
+    if (!AJRRectsTouch(segment->bounds, rect)) {
+        return NO;
+    }
+    // Since the piece is monotone in both x and y, the stretches where x and y are each within the rect are single ranges of t, and the piece touches the rect if they overlap.
+    if (segment->flags & AJRPathSegmentFlagLine) {
+        t0 = 0.0;
+        t1 = 1.0;
+    }
+    return (AJRPathSegmentClipT(segment, YES, rect.origin.x, CGRectGetMaxX(rect), &t0, &t1)
+            && AJRPathSegmentClipT(segment, NO, rect.origin.y, CGRectGetMaxY(rect), &t0, &t1));
+}
+
+BOOL AJRPathSegmentTableIntersectsRect(const AJRPathSegmentTable *table, CGRect rect) {
+    AJRNodeStack stack;
+    BOOL intersects = NO;
+    
+    if (table->nodeCount == 0 || !AJRRectsTouch(table->bounds, rect)) {
+        return NO;
+    }
+    AJRNodeStackInit(&stack);
+    AJRNodeStackPush(&stack, 0);
+    while (stack.count > 0 && !intersects) {
+        const AJRPathSegmentNode *node = table->nodes + AJRNodeStackPop(&stack);
+        
+        if (!AJRRectsTouch(node->bounds, rect)) {
+            continue;
+        }
+        if (node->count) {
+            for (NSUInteger index = node->start; index < node->start + node->count && !intersects; index++) {
+                intersects = AJRPathSegmentIntersectsRect(table->segments + table->nodeSegments[index], rect);
+            }
+        } else {
+            AJRNodeStackPush(&stack, node->start);
+            AJRNodeStackPush(&stack, (node - table->nodes) + 1);
+        }
+    }
+    AJRNodeStackFree(&stack);
+    
+    return intersects;
+}
+
+typedef struct _ajrPathCrossing {
+    AJRIntersectionRecord first;
+    AJRIntersectionRecord second;
+} AJRPathCrossing;
+
+typedef struct _ajrPathCrossings {
+    AJRPathCrossing *crossings;
+    NSUInteger count;
+    NSUInteger max;
+    // When YES, we only want to know if there's a crossing, so we stop at the first.
+    BOOL any;
+    // Curves are split until they're within this distance of their chords.
+    double flatness;
+} AJRPathCrossings;
+
+static NSUInteger AJRPathSegmentDirectionAtT(const AJRPathSegment *segment, double t) {
+    CGPoint heading;
+    
+    if (segment->flags & AJRPathSegmentFlagLine) {
+        heading = (CGPoint){segment->end.x - segment->start.x, segment->end.y - segment->start.y};
+    } else {
+        heading = AJRBezierCurveDerivativeAtT(segment->curve, t);
+        if (heading.x == 0.0 && heading.y == 0.0) {
+            heading = (CGPoint){segment->end.x - segment->start.x, segment->end.y - segment->start.y};
+        }
+    }
+    return (heading.x > 0.0 ? AJRLeftToRightDirection : AJRRightToLeftDirection) | (heading.y > 0.0 ? AJRTopToBottomDirection : AJRBottomToTopDirection);
+}
+
+static void AJRPathCrossingsAppend(AJRPathCrossings *crossings, const AJRPathSegment *first, double t1, const AJRPathSegment *second, double t2, CGPoint point) {
+    AJRPathCrossing *crossing;
+    
+    if (crossings->count == crossings->max) {
+        crossings->max = crossings->max ? crossings->max * 2 : 16;
+        crossings->crossings = NSZoneRealloc(nil, crossings->crossings, crossings->max * sizeof(AJRPathCrossing));
+    }
+    crossing = crossings->crossings + crossings->count++;
+    crossing->first = (AJRIntersectionRecord){point, t1, first->elementIndex, AJRPathSegmentDirectionAtT(first, t1), (t1 == 0.0 || t1 == 1.0) ? AJRIntersectionFlagEndPoint : 0};
+    crossing->second = (AJRIntersectionRecord){point, t2, second->elementIndex, AJRPathSegmentDirectionAtT(second, t2), (t2 == 0.0 || t2 == 1.0) ? AJRIntersectionFlagEndPoint : 0};
+}
+
+// Intersects two line segments, including their end points. Returns NO if they miss, or are parallel.
+static BOOL AJRIntersectChords(CGPoint a0, CGPoint a1, CGPoint b0, CGPoint b1, double *s, double *u) {
+    double dax = (double)a1.x - a0.x, day = (double)a1.y - a0.y;
+    double dbx = (double)b1.x - b0.x, dby = (double)b1.y - b0.y;
+    double denominator = dax * dby - day * dbx;
+    double ex = (double)b0.x - a0.x, ey = (double)b0.y - a0.y;
+    
+    if (denominator == 0.0) {
+        return NO;
+    }
+    *s = (ex * dby - ey * dbx) / denominator;
+    *u = (ex * day - ey * dax) / denominator;
+    
+    return *s >= 0.0 && *s <= 1.0 && *u >= 0.0 && *u <= 1.0;
+}
+
+// Returns YES if both ends of the second chord lie within tolerance of the line through the first.
+static BOOL AJRChordsAreCollinear(CGPoint a0, CGPoint a1, CGPoint b0, CGPoint b1, double tolerance) {
+    double dx = (double)a1.x - a0.x, dy = (double)a1.y - a0.y;
+    double length = sqrt(dx * dx + dy * dy);
+    
+    if (length == 0.0) {
+        return NO;
+    }
+    return (fabs(((double)b0.x - a0.x) * dy - ((double)b0.y - a0.y) * dx) <= tolerance * length
+            && fabs(((double)b1.x - a0.x) * dy - ((double)b1.y - a0.y) * dx) <= tolerance * length);
+}
+
+static inline BOOL AJRBezierCurveIsFlat(AJRBezierCurve curve, double flatness) {
+    double dx = (double)curve.end.x - curve.start.x, dy = (double)curve.end.y - curve.start.y;
+    double length2 = dx * dx + dy * dy;
+    double d1 = ((double)curve.handle1.x - curve.start.x) * dy - ((double)curve.handle1.y - curve.start.y) * dx;
+    double d2 = ((double)curve.handle2.x - curve.start.x) * dy - ((double)curve.handle2.y - curve.start.y) * dx;
+    
+    // The cross products are the handles' distances from the chord, scaled by its length.
+    if (length2 == 0.0) {
+        return AJRDistanceBetweenPoints(curve.start, curve.handle1) <= flatness && AJRDistanceBetweenPoints(curve.start, curve.handle2) <= flatness;
+    }
+    return d1 * d1 <= flatness * flatness * length2 && d2 * d2 <= flatness * flatness * length2;
+}
+
+static void AJRIntersectLineAndCurveSegments(AJRPathCrossings *crossings, const AJRPathSegment *line, const AJRPathSegment *curve, BOOL lineIsFirst) {
+    double tValues[3];
+    CGPoint points[3];
+    NSInteger count = AJRBezierCurveIntersectLine(curve->curve, (AJRLine){line->start, line->end}, tValues, points);
+    double dx = (double)line->end.x - line->start.x, dy = (double)line->end.y - line->start.y;
+    double length2 = dx * dx + dy * dy;
+    
+    for (NSInteger index = 0; index < count && !(crossings->any && crossings->count); index++) {
+        double lineT;
+        
+        if (tValues[index] < curve->startT || tValues[index] > curve->endT) {
+            continue;
+        }
+        lineT = length2 == 0.0 ? 0.0 : MAX(0.0, MIN(1.0, (((double)points[index].x - line->start.x) * dx + ((double)points[index].y - line->start.y) * dy) / length2));
+        if (lineIsFirst) {
+            AJRPathCrossingsAppend(crossings, line, lineT, curve, tValues[index], points[index]);
+        } else {
+            AJRPathCrossingsAppend(crossings, curve, tValues[index], line, lineT, points[index]);
+        }
+    }
+}
+
+#define AJRCurvePairStackSize 64
+#define AJRCurvePairMaxDepth 48
+
+typedef struct _ajrCurvePiece {
+    AJRBezierCurve curve;
+    double t0;
+    double t1;
+} AJRCurvePiece;
+
+static inline CGRect AJRCurvePieceBounds(const AJRCurvePiece *piece) {
+    // Halves of monotone pieces are monotone too, so the end points bound them.
+    return CGRectStandardize((CGRect){piece->curve.start, {piece->curve.end.x - piece->curve.start.x, piece->curve.end.y - piece->curve.start.y}});
+}
+
+static void AJRIntersectCurveSegments(AJRPathCrossings *crossings, const AJRPathSegment *first, const AJRPathSegment *second) {
+    AJRCurvePiece stack[AJRCurvePairStackSize][2];
+    NSInteger depths[AJRCurvePairStackSize];
+    NSInteger top = 0;
+    
+    stack[0][0] = (AJRCurvePiece){AJRBezierCurveGetSubcurve(first->curve, first->startT, first->endT), first->startT, first->endT};
+    stack[0][1] = (AJRCurvePiece){AJRBezierCurveGetSubcurve(second->curve, second->startT, second->endT), second->startT, second->endT};
+    depths[0] = 0;
+    top = 1;
+    
+    while (top > 0 && !(crossings->any && crossings->count)) {
+        AJRCurvePiece one, two;
+        NSInteger depth;
+        BOOL oneIsFlat, twoIsFlat;
+        
+        top--;
+        one = stack[top][0];
+        two = stack[top][1];
+        depth = depths[top];
+        
+        if (!AJRRectsTouch(AJRCurvePieceBounds(&one), AJRCurvePieceBounds(&two))) {
+            continue;
+        }
+        oneIsFlat = AJRBezierCurveIsFlat(one.curve, crossings->flatness);
+        twoIsFlat = AJRBezierCurveIsFlat(two.curve, crossings->flatness);
+        if ((oneIsFlat && twoIsFlat) || depth >= AJRCurvePairMaxDepth || top + 2 > AJRCurvePairStackSize) {
+            double s, u;
+            // Where the curves run along each other, neighboring chords meet end to end, and every one of those would be reported. Like lines that overlap, curves that overlap don't cross, so skip them.
+            if (AJRChordsAreCollinear(one.curve.start, one.curve.end, two.curve.start, two.curve.end, 10.0 * crossings->flatness)) {
+                continue;
+            }
+            if (AJRIntersectChords(one.curve.start, one.curve.end, two.curve.start, two.curve.end, &s, &u)) {
+                AJRPathCrossingsAppend(crossings, first, one.t0 + s * (one.t1 - one.t0), second, two.t0 + u * (two.t1 - two.t0),
+                                       (CGPoint){one.curve.start.x + s * (one.curve.end.x - one.curve.start.x), one.curve.start.y + s * (one.curve.end.y - one.curve.start.y)});
+            }
+            continue;
+        }
+        
+        // Split whichever piece is still curved, or the bigger one if both are, and keep both halves.
+        {
+            CGRect bounds1 = AJRCurvePieceBounds(&one), bounds2 = AJRCurvePieceBounds(&two);
+            BOOL splitOne = twoIsFlat || (!oneIsFlat && bounds1.size.width + bounds1.size.height >= bounds2.size.width + bounds2.size.height);
+            AJRCurvePiece *piece = splitOne ? &one : &two;
+            AJRCurvePiece left, right;
+            double middle = (piece->t0 + piece->t1) / 2.0;
+            
+            AJRSplitBezierCurve(piece->curve, &left.curve, &right.curve);
+            left.t0 = piece->t0;
+            left.t1 = middle;
+            right.t0 = middle;
+            right.t1 = piece->t1;
+            // Push the far half first, so that crossings come out roughly in order.
+            stack[top][0] = splitOne ? right : one;
+            stack[top][1] = splitOne ? two : right;
+            depths[top++] = depth + 1;
+            stack[top][0] = splitOne ? left : one;
+            stack[top][1] = splitOne ? two : left;
+            depths[top++] = depth + 1;
+        }
+    }
+}
+
+static void AJRIntersectSegments(AJRPathCrossings *crossings, const AJRPathSegment *first, const AJRPathSegment *second) {
+    BOOL firstIsLine = (first->flags & AJRPathSegmentFlagLine) != 0;
+    BOOL secondIsLine = (second->flags & AJRPathSegmentFlagLine) != 0;
+    
+    if (!AJRRectsTouch(first->bounds, second->bounds)) {
+        return;
+    }
+    if (firstIsLine && secondIsLine) {
+        double s, u;
+        if (AJRIntersectChords(first->start, first->end, second->start, second->end, &s, &u)) {
+            AJRPathCrossingsAppend(crossings, first, s, second, u, (CGPoint){first->start.x + s * (first->end.x - first->start.x), first->start.y + s * (first->end.y - first->start.y)});
+        }
+    } else if (firstIsLine) {
+        AJRIntersectLineAndCurveSegments(crossings, first, second, YES);
+    } else if (secondIsLine) {
+        AJRIntersectLineAndCurveSegments(crossings, second, first, NO);
+    } else {
+        AJRIntersectCurveSegments(crossings, first, second);
+    }
+}
+
+static int AJRComparePathCrossingsByX(const void *first, const void *second) {
+    CGFloat x1 = ((const AJRPathCrossing *)first)->first.point.x, x2 = ((const AJRPathCrossing *)second)->first.point.x;
+    return x1 < x2 ? -1 : (x1 > x2 ? 1 : 0);
+}
+
+static int AJRComparePathCrossingsByParameter(const void *first, const void *second) {
+    const AJRIntersectionRecord *one = &((const AJRPathCrossing *)first)->first, *two = &((const AJRPathCrossing *)second)->first;
+    
+    if (one->segment != two->segment) {
+        return one->segment < two->segment ? -1 : 1;
+    }
+    return one->t < two->t ? -1 : (one->t > two->t ? 1 : 0);
+}
+
+NSUInteger AJRPathSegmentTableIntersectTable(const AJRPathSegmentTable *table, const AJRPathSegmentTable *other, AJRIntersectionBuffer *buffer, AJRIntersectionBuffer *otherBuffer) {
+    AJRPathCrossings crossings = {};
+    AJRNodeStack stack;
+    NSUInteger count;
+    double scale;
+    
+    if (table->nodeCount == 0 || other->nodeCount == 0 || !AJRRectsTouch(table->bounds, other->bounds)) {
+        return 0;
+    }
+    scale = MAX(1.0, MAX(MAX(table->bounds.size.width, table->bounds.size.height), MAX(other->bounds.size.width, other->bounds.size.height)));
+    crossings.any = buffer == NULL && otherBuffer == NULL;
+    crossings.flatness = 1.0e-9 * scale;
+    
+    // Entries are pairs of node indexes, the first into table and the second into other, so they're pushed and popped two at a time.
+    AJRNodeStackInit(&stack);
+    AJRNodeStackPush(&stack, 0);
+    AJRNodeStackPush(&stack, 0);
+    while (stack.count > 0 && !(crossings.any && crossings.count)) {
+        const AJRPathSegmentNode *node1, *node2;
+        
+        node2 = other->nodes + AJRNodeStackPop(&stack);
+        node1 = table->nodes + AJRNodeStackPop(&stack);
+        if (!AJRRectsTouch(node1->bounds, node2->bounds)) {
+            continue;
+        }
+        if (node1->count && node2->count) {
+            for (NSUInteger x = node1->start; x < node1->start + node1->count && !(crossings.any && crossings.count); x++) {
+                for (NSUInteger y = node2->start; y < node2->start + node2->count && !(crossings.any && crossings.count); y++) {
+                    AJRIntersectSegments(&crossings, table->segments + table->nodeSegments[x], other->segments + other->nodeSegments[y]);
+                }
+            }
+        } else {
+            // Descend into the bigger of the two nodes, or the one that isn't a leaf.
+            BOOL splitFirst = node2->count || (!node1->count && node1->bounds.size.width + node1->bounds.size.height >= node2->bounds.size.width + node2->bounds.size.height);
+            NSUInteger index1 = node1 - table->nodes, index2 = node2 - other->nodes;
+            
+            if (splitFirst) {
+                AJRNodeStackPush(&stack, node1->start); AJRNodeStackPush(&stack, index2);
+                AJRNodeStackPush(&stack, index1 + 1); AJRNodeStackPush(&stack, index2);
+            } else {
+                AJRNodeStackPush(&stack, index1); AJRNodeStackPush(&stack, node2->start);
+                AJRNodeStackPush(&stack, index1); AJRNodeStackPush(&stack, index2 + 1);
+            }
+        }
+    }
+    AJRNodeStackFree(&stack);
+    
+    count = crossings.count;
+    if (count > 1 && !crossings.any) {
+        // Where a crossing lands on a vertex, both of the pieces meeting there find it. Sorting by x brings such duplicates together, even across the ends of a closed subpath.
+        double tolerance = 1.0e3 * crossings.flatness;
+        NSUInteger kept = 0;
+        
+        qsort(crossings.crossings, count, sizeof(AJRPathCrossing), AJRComparePathCrossingsByX);
+        for (NSUInteger x = 0; x < count; x++) {
+            BOOL duplicate = NO;
+            for (NSUInteger y = kept; y > 0 && crossings.crossings[x].first.point.x - crossings.crossings[y - 1].first.point.x <= tolerance; y--) {
+                if (fabs(crossings.crossings[x].first.point.y - crossings.crossings[y - 1].first.point.y) <= tolerance) {
+                    duplicate = YES;
+                    break;
+                }
+            }
+            if (!duplicate) {
+                crossings.crossings[kept++] = crossings.crossings[x];
+            }
+        }
+        count = kept;
+        qsort(crossings.crossings, count, sizeof(AJRPathCrossing), AJRComparePathCrossingsByParameter);
+    }
+    for (NSUInteger x = 0; x < count; x++) {
+        if (buffer) *AJRIntersectionBufferAppend(buffer) = crossings.crossings[x].first;
+        if (otherBuffer) *AJRIntersectionBufferAppend(otherBuffer) = crossings.crossings[x].second;
+    }
+    if (crossings.crossings) NSZoneFree(nil, crossings.crossings);
+    
+    return count;
+}
+
+#pragma mark - Nearest Points
+
+static inline CGFloat AJRRectDistanceToPoint(CGRect rect, CGPoint point) {
+    CGFloat dx = MAX(MAX(rect.origin.x - point.x, point.x - CGRectGetMaxX(rect)), 0.0);
+    CGFloat dy = MAX(MAX(rect.origin.y - point.y, point.y - CGRectGetMaxY(rect)), 0.0);
+    return sqrt(dx * dx + dy * dy);
+}
+
+// Returns the distance from point to the nearest point on segment, and where that is.
+static CGFloat AJRPathSegmentNearestPoint(const AJRPathSegment *segment, CGPoint point, CGPoint *nearest, double *t) {
+    if (segment->flags & AJRPathSegmentFlagLine) {
+        CGPoint delta = {segment->end.x - segment->start.x, segment->end.y - segment->start.y};
+        double length = delta.x * delta.x + delta.y * delta.y;
+        double u = length == 0.0 ? 0.0 : ((point.x - segment->start.x) * delta.x + (point.y - segment->start.y) * delta.y) / length;
+        
+        // Use the end points themselves at the ends, so that the elements meeting at a vertex agree on exactly where it is.
+        if (u <= 0.0) {
+            *t = 0.0;
+            *nearest = segment->start;
+        } else if (u >= 1.0) {
+            *t = 1.0;
+            *nearest = segment->end;
+        } else {
+            *t = u;
+            *nearest = (CGPoint){segment->start.x + delta.x * u, segment->start.y + delta.y * u};
+        }
+    } else {
+        *t = AJRBezierCurveNearestT(segment->curve, point, segment->startT, segment->endT, nearest);
+        if (*t == segment->startT) {
+            *nearest = segment->start;
+        } else if (*t == segment->endT) {
+            *nearest = segment->end;
+        }
+    }
+    return hypot(nearest->x - point.x, nearest->y - point.y);
+}
+
+// The best answer found so far by a search.
+typedef struct _ajrNearestSearch {
+    CGPoint point;
+    CGFloat distance;
+    // Distances within this of each other are considered equal, and the earlier element wins.
+    CGFloat tolerance;
+    NSUInteger segment;
+    AJRBezierPathNearestPoint *nearest;
+} AJRNearestSearch;
+
+static inline void AJRNearestSearchConsider(AJRNearestSearch *search, const AJRPathSegmentTable *table, NSUInteger segmentIndex) {
+    const AJRPathSegment *segment = table->segments + segmentIndex;
+    CGPoint where;
+    double t;
+    CGFloat distance = AJRPathSegmentNearestPoint(segment, search->point, &where, &t);
+    
+    if (distance > search->distance + search->tolerance) {
+        return;
+    }
+    if (search->segment != NSNotFound && distance >= search->distance - search->tolerance) {
+        // A tie, which happens where elements meet, so prefer the earlier element.
+        if (segment->elementIndex >= search->nearest->elementIndex) {
+            return;
+        }
+    } else if (distance > search->distance) {
+        return;
+    }
+    search->distance = MIN(distance, search->distance);
+    search->segment = segmentIndex;
+    search->nearest->point = where;
+    search->nearest->elementIndex = segment->elementIndex;
+    search->nearest->t = t;
+    search->nearest->distance = distance;
+}
+
+static BOOL AJRPathSegmentTableSearchNearest(const AJRPathSegmentTable *table, AJRNearestSearch *search) {
+    AJRNodeStack stack;
+    
+    if (search->segment != NSNotFound) {
+        // Start from a segment we expect to be close, so that the search can prune from the beginning.
+        NSUInteger seed = search->segment;
+        search->segment = NSNotFound;
+        AJRNearestSearchConsider(search, table, seed);
+    }
+    if (table->nodeCount == 0) {
+        return search->segment != NSNotFound;
+    }
+    AJRNodeStackInit(&stack);
+    AJRNodeStackPush(&stack, 0);
+    while (stack.count > 0) {
+        const AJRPathSegmentNode *node = table->nodes + AJRNodeStackPop(&stack);
+        
+        if (AJRRectDistanceToPoint(node->bounds, search->point) > search->distance + search->tolerance) {
+            continue;
+        }
+        if (node->count) {
+            for (NSUInteger index = node->start; index < node->start + node->count; index++) {
+                NSUInteger segmentIndex = table->nodeSegments[index];
+                if (AJRRectDistanceToPoint(table->segments[segmentIndex].bounds, search->point) <= search->distance + search->tolerance) {
+                    AJRNearestSearchConsider(search, table, segmentIndex);
+                }
+            }
+        } else {
+            NSUInteger first = (node - table->nodes) + 1;
+            NSUInteger second = node->start;
+            
+            // Push the nearer child last, so that it's searched first, and has the best chance of pruning its sibling.
+            if (AJRRectDistanceToPoint(table->nodes[first].bounds, search->point) < AJRRectDistanceToPoint(table->nodes[second].bounds, search->point)) {
+                AJRNodeStackPush(&stack, second);
+                AJRNodeStackPush(&stack, first);
+            } else {
+                AJRNodeStackPush(&stack, first);
+                AJRNodeStackPush(&stack, second);
+            }
+        }
+    }
+    AJRNodeStackFree(&stack);
+    
+    return search->segment != NSNotFound;
+}
+
+static void AJRNearestSearchPrepare(AJRNearestSearch *search, const AJRPathSegmentTable *table, CGPoint point, CGFloat maximumDistance, AJRBezierPathNearestPoint *nearest) {
+    CGFloat scale = CGRectIsNull(table->bounds) ? 0.0 : MAX(table->bounds.size.width, table->bounds.size.height);
+    
+    search->point = point;
+    search->distance = maximumDistance;
+    search->tolerance = 1.0e-12 * MAX(scale, 1.0);
+    search->nearest = nearest;
+    nearest->point = CGPointZero;
+    nearest->elementIndex = NSNotFound;
+    nearest->t = 0.0;
+    nearest->distance = CGFLOAT_MAX;
+}
+
+BOOL AJRPathSegmentTableNearestPoint(const AJRPathSegmentTable *table, CGPoint point, CGFloat maximumDistance, AJRBezierPathNearestPoint *nearest) {
+    AJRNearestSearch search;
+    
+    AJRNearestSearchPrepare(&search, table, point, maximumDistance, nearest);
+    search.segment = NSNotFound;
+    
+    return AJRPathSegmentTableSearchNearest(table, &search);
+}
+
+NSUInteger AJRPathSegmentTableNearestPoints(const AJRPathSegmentTable *table, const CGPoint *points, NSUInteger count, CGFloat maximumDistance, AJRBezierPathNearestPoint *nearest) {
+    AJRNearestSearch search;
+    NSUInteger previous = NSNotFound;
+    NSUInteger found = 0;
+    
+    for (NSUInteger index = 0; index < count; index++) {
+        AJRNearestSearchPrepare(&search, table, points[index], maximumDistance, nearest + index);
+        search.segment = previous;
+        if (AJRPathSegmentTableSearchNearest(table, &search)) {
+            previous = search.segment;
+            found += 1;
+        }
+    }
+    
+    return found;
+}
@@ -0,0 +1,62 @@
+/*
+ AJRPathStroker.h
+ AJRInterfaceFoundation
+
+ Copyright © 2022, AJ Raftis and AJRInterfaceFoundation authors
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of AJRInterfaceFoundation nor the names of its contributors may be
+   used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL AJ RAFTIS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#import <AJRInterfaceFoundation/AJRBezierPath.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*! Everything about how a path is stroked. */
+typedef struct _ajrStrokeStyle {
+    CGFloat lineWidth;
+    AJRLineCapStyle lineCap;
+    AJRLineJoinStyle lineJoin;
+    /*! Miter joins whose miter would be longer than this many line widths are beveled instead. */
+    CGFloat miterLimit;
+    /*! The lengths of alternating dashes and gaps, or NULL for a solid line. The pattern starts over at the beginning of each subpath. */
+    const CGFloat * _Nullable dashes;
+    NSUInteger dashCount;
+    /*! How far into the dash pattern each subpath starts. */
+    CGFloat dashPhase;
+    /*! How far the outline's edges may stray from their true distance from a curve. Lines are always offset exactly. */
+    CGFloat error;
+} AJRStrokeStyle;
+
+/*!
+ Returns the outline of path's stroke, as a path to be filled with the non-zero winding rule. This doesn't involve Core Graphics, so it works anywhere the framework does, and it's safe to call from any thread.
+
+ Each stretch of the path, or each dash, is outlined by running along its left side, around the cap at its end, back along its right side, and around the cap at its start. Closed subpaths get an outline for each side instead, and no caps. The sides of a curve are approximated by cubic curves, split until they're within style's error of the true offset. Where the path turns, the outside of the turn gets the join, while the inside just cuts back through the vertex, which leaves a little overlap for the non-zero rule to sort out, but never a gap. Subpaths of zero length draw a dot, if the caps are round or square, like Core Graphics does.
+
+ @param path An AJRBezierPath or NSBezierPath.
+ @param style How to stroke it. A line width of 0 or less gives an empty path.
+ */
+extern AJRBezierPath *AJRBezierPathByStrokingPath(id <AJRBezierPathProtocol> path, AJRStrokeStyle style);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,695 @@
+/*
+ AJRPathStroker.m
+ AJRInterfaceFoundation
+
+ Copyright © 2022, AJ Raftis and AJRInterfaceFoundation authors
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of AJRInterfaceFoundation nor the names of its contributors may be
+   used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL AJ RAFTIS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#import "AJRPathStroker.h"
+
+#import "AJRBezierCurves.h"
+#import "AJRPathIterator.h"
+
+// How many times a curve is halved while looking for a close enough offset, before we settle for a line.
+#define AJRStrokeMaxOffsetDepth 12
+
+#pragma mark - Vectors
+
+static inline CGPoint AJRStrokeAdd(CGPoint a, CGPoint b) {
+    return (CGPoint){a.x + b.x, a.y + b.y};
+}
+
+static inline CGPoint AJRStrokeSubtract(CGPoint a, CGPoint b) {
+    return (CGPoint){a.x - b.x, a.y - b.y};
+}
+
+static inline CGPoint AJRStrokeScale(CGPoint a, double scale) {
+    return (CGPoint){a.x * scale, a.y * scale};
+}
+
+static inline double AJRStrokeCross(CGPoint a, CGPoint b) {
+    return a.x * b.y - a.y * b.x;
+}
+
+static inline double AJRStrokeDot(CGPoint a, CGPoint b) {
+    return a.x * b.x + a.y * b.y;
+}
+
+static inline CGPoint AJRStrokeUnit(CGPoint a) {
+    double length = hypot(a.x, a.y);
+    return length > 0.0 ? (CGPoint){a.x / length, a.y / length} : CGPointZero;
+}
+
+// The normal on the left of a direction, which is counter clockwise when y points up.
+static inline CGPoint AJRStrokeLeftNormal(CGPoint direction) {
+    return (CGPoint){-direction.y, direction.x};
+}
+
+#pragma mark - Pieces
+
+// A piece of the path being stroked. Lines and quadratics are carried as cubics, but lines are flagged, so they can be offset exactly.
+typedef struct _ajrStrokePiece {
+    AJRBezierCurve curve;
+    BOOL line;
+} AJRStrokePiece;
+
+static inline AJRStrokePiece AJRStrokePieceReversed(AJRStrokePiece piece) {
+    return (AJRStrokePiece){{piece.curve.end, piece.curve.handle2, piece.curve.handle1, piece.curve.start}, piece.line};
+}
+
+static inline BOOL AJRStrokePieceIsEmpty(const AJRStrokePiece *piece) {
+    return (CGPointEqualToPoint(piece->curve.start, piece->curve.end)
+            && CGPointEqualToPoint(piece->curve.start, piece->curve.handle1)
+            && CGPointEqualToPoint(piece->curve.start, piece->curve.handle2));
+}
+
+// The unit direction the piece leaves its start in. A handle sitting on its end point doesn't say anything about direction, so we look further along.
+static CGPoint AJRStrokePieceStartTangent(const AJRStrokePiece *piece) {
+    const AJRBezierCurve *curve = &piece->curve;
+    CGPoint direction = AJRStrokeSubtract(curve->handle1, curve->start);
+    
+    if (direction.x == 0.0 && direction.y == 0.0) direction = AJRStrokeSubtract(curve->handle2, curve->start);
+    if (direction.x == 0.0 && direction.y == 0.0) direction = AJRStrokeSubtract(curve->end, curve->start);
+    
+    return AJRStrokeUnit(direction);
+}
+
+static CGPoint AJRStrokePieceEndTangent(const AJRStrokePiece *piece) {
+    const AJRBezierCurve *curve = &piece->curve;
+    CGPoint direction = AJRStrokeSubtract(curve->end, curve->handle2);
+    
+    if (direction.x == 0.0 && direction.y == 0.0) direction = AJRStrokeSubtract(curve->end, curve->handle1);
+    if (direction.x == 0.0 && direction.y == 0.0) direction = AJRStrokeSubtract(curve->end, curve->start);
+    
+    return AJRStrokeUnit(direction);
+}
+
+static inline void AJRStrokePiecesAppend(AJRStrokePiece **pieces, NSUInteger *count, NSUInteger *max, AJRStrokePiece piece) {
+    if (AJRStrokePieceIsEmpty(&piece)) {
+        return;
+    }
+    if (*count == *max) {
+        *max = *max ? *max * 2 : 16;
+        *pieces = NSZoneRealloc(nil, *pieces, *max * sizeof(AJRStrokePiece));
+    }
+    (*pieces)[*count] = piece;
+    *count += 1;
+}
+
+#pragma mark - Stroker
+
+typedef struct _ajrStroker {
+    AJRStrokeStyle style;
+    double halfWidth;
+    
+    // The outline, built up in the form -appendElements:count:points:count: takes.
+    AJRBezierPathElement *elements;
+    NSUInteger elementCount;
+    NSUInteger maxElements;
+    CGPoint *points;
+    NSUInteger pointCount;
+    NSUInteger maxPoints;
+    CGPoint currentPoint;
+    
+    // The subpath being collected.
+    AJRStrokePiece *pieces;
+    NSUInteger pieceCount;
+    NSUInteger maxPieces;
+    CGPoint subpathStart;
+    CGPoint lastPoint;
+    BOOL subpathDraws;
+    
+    // The dash being collected, when dashing.
+    AJRStrokePiece *dash;
+    NSUInteger dashPieceCount;
+    NSUInteger maxDashPieces;
+    NSUInteger dashIndex;
+    double dashRemaining;
+    BOOL dashOn;
+} AJRStroker;
+
+static void AJRStrokerEmit(AJRStroker *stroker, AJRBezierPathElement element, const CGPoint *points, NSUInteger count) {
+    if (stroker->elementCount == stroker->maxElements) {
+        stroker->maxElements = stroker->maxElements ? stroker->maxElements * 2 : 64;
+        stroker->elements = NSZoneRealloc(nil, stroker->elements, stroker->maxElements * sizeof(AJRBezierPathElement));
+    }
+    if (stroker->pointCount + count > stroker->maxPoints) {
+        stroker->maxPoints = MAX(stroker->maxPoints * 2, 128);
+        stroker->points = NSZoneRealloc(nil, stroker->points, stroker->maxPoints * sizeof(CGPoint));
+    }
+    stroker->elements[stroker->elementCount++] = element;
+    memcpy(stroker->points + stroker->pointCount, points, count * sizeof(CGPoint));
+    stroker->pointCount += count;
+    if (count) {
+        stroker->currentPoint = points[count - 1];
+    }
+}
+
+static inline void AJRStrokerMoveTo(AJRStroker *stroker, CGPoint point) {
+    AJRStrokerEmit(stroker, AJRBezierPathElementMoveTo, &point, 1);
+}
+
+static inline void AJRStrokerLineTo(AJRStroker *stroker, CGPoint point) {
+    if (!CGPointEqualToPoint(point, stroker->currentPoint)) {
+        AJRStrokerEmit(stroker, AJRBezierPathElementLineTo, &point, 1);
+    }
+}
+
+static inline void AJRStrokerCurveTo(AJRStroker *stroker, CGPoint handle1, CGPoint handle2, CGPoint end) {
+    CGPoint points[3] = {handle1, handle2, end};
+    AJRStrokerEmit(stroker, AJRBezierPathElementCubicCurveTo, points, 3);
+}
+
+static inline void AJRStrokerClose(AJRStroker *stroker) {
+    AJRStrokerEmit(stroker, AJRBezierPathElementClose, NULL, 0);
+}
+
+// Draws an arc around center from the current point, which must be at startAngle, turning through sweep radians, counter clockwise when positive. Each quarter turn or less is one cubic.
+static void AJRStrokerArc(AJRStroker *stroker, CGPoint center, double radius, double startAngle, double sweep) {
+    NSInteger count = MAX((NSInteger)ceil(fabs(sweep) / M_PI_2 - 1.0e-9), 1);
+    double step = sweep / count;
+    double handle = 4.0 / 3.0 * tan(step / 4.0) * radius;
+    
+    for (NSInteger x = 0; x < count; x++) {
+        double angle0 = startAngle + x * step;
+        double angle1 = angle0 + step;
+        CGPoint start = {center.x + radius * cos(angle0), center.y + radius * sin(angle0)};
+        CGPoint end = {center.x + radius * cos(angle1), center.y + radius * sin(angle1)};
+        
+        AJRStrokerCurveTo(stroker,
+                          (CGPoint){start.x - handle * sin(angle0), start.y + handle * cos(angle0)},
+                          (CGPoint){end.x + handle * sin(angle1), end.y - handle * cos(angle1)},
+                          end);
+    }
+}
+
+#pragma mark - Joins and Caps
+
+// Turns the left side from heading along incoming to heading along outgoing at vertex. Inside the turn, the side goes by way of the vertex, so nothing is left uncovered when the pieces overlap.
+static void AJRStrokerJoin(AJRStroker *stroker, CGPoint vertex, CGPoint incoming, CGPoint outgoing, AJRLineJoinStyle join) {
+    double distance = stroker->halfWidth;
+    CGPoint inNormal = AJRStrokeLeftNormal(incoming);
+    CGPoint outNormal = AJRStrokeLeftNormal(outgoing);
+    CGPoint target = AJRStrokeAdd(vertex, AJRStrokeScale(outNormal, distance));
+    double cross = AJRStrokeCross(incoming, outgoing);
+    double dot = AJRStrokeDot(incoming, outgoing);
+    
+    if (dot > 0.0 && fabs(cross) <= 1.0e-12) {
+        // Straight on.
+        AJRStrokerLineTo(stroker, target);
+    } else if (cross > 0.0) {
+        // Turning left, so this is the inside of the turn.
+        AJRStrokerLineTo(stroker, vertex);
+        AJRStrokerLineTo(stroker, target);
+    } else {
+        switch (join) {
+            case AJRLineJoinStyleRound:
+                AJRStrokerArc(stroker, vertex, distance, atan2(inNormal.y, inNormal.x), -fabs(atan2(cross, dot)));
+                break;
+            case AJRLineJoinStyleMitered: {
+                // The miter is 1 / cos(half the turn) line widths long.
+                double cosine = sqrt(MAX((1.0 + dot) / 2.0, 0.0));
+                if (cosine > 0.0 && 1.0 / cosine <= stroker->style.miterLimit) {
+                    CGPoint direction = AJRStrokeUnit(AJRStrokeAdd(inNormal, outNormal));
+                    AJRStrokerLineTo(stroker, AJRStrokeAdd(vertex, AJRStrokeScale(direction, distance / cosine)));
+                }
+                AJRStrokerLineTo(stroker, target);
+                break;
+            }
+            case AJRLineJoinStyleBeveled:
+            default:
+                AJRStrokerLineTo(stroker, target);
+                break;
+        }
+    }
+}
+
+#pragma mark - Offsetting
+
+// Offsets curve to its left by distance using the Tiller-Hanson construction: each leg of the control polygon is moved out by distance, and the new handles are where the moved legs meet. Returns NO if the polygon is too degenerate for that, in which case offset still gets sensible end points.
+static BOOL AJRStrokeApproximateOffset(AJRBezierCurve curve, double distance, AJRBezierCurve *offset) {
+    AJRStrokePiece piece = {curve, NO};
+    CGPoint legs[3] = {AJRStrokeSubtract(curve.handle1, curve.start), AJRStrokeSubtract(curve.handle2, curve.handle1), AJRStrokeSubtract(curve.end, curve.handle2)};
+    CGPoint bases[3] = {curve.start, curve.handle1, curve.handle2};
+    CGPoint shifted[3];
+    
+    offset->start = AJRStrokeAdd(curve.start, AJRStrokeScale(AJRStrokeLeftNormal(AJRStrokePieceStartTangent(&piece)), distance));
+    offset->end = AJRStrokeAdd(curve.end, AJRStrokeScale(AJRStrokeLeftNormal(AJRStrokePieceEndTangent(&piece)), distance));
+    offset->handle1 = AJRStrokeAdd(offset->start, legs[0]);
+    offset->handle2 = AJRStrokeSubtract(offset->end, legs[2]);
+    
+    for (NSInteger x = 0; x < 3; x++) {
+        CGPoint unit = AJRStrokeUnit(legs[x]);
+        if (unit.x == 0.0 && unit.y == 0.0) {
+            return NO;
+        }
+        shifted[x] = AJRStrokeAdd(bases[x], AJRStrokeScale(AJRStrokeLeftNormal(unit), distance));
+    }
+    for (NSInteger x = 0; x < 2; x++) {
+        double denominator = AJRStrokeCross(legs[x], legs[x + 1]);
+        CGPoint *handle = x == 0 ? &offset->handle1 : &offset->handle2;
+        
+        if (fabs(denominator) <= 1.0e-9 * hypot(legs[x].x, legs[x].y) * hypot(legs[x + 1].x, legs[x + 1].y)) {
+            // The legs are parallel, so their moved lines are the same line, and the moved corner lies on it.
+            if (AJRStrokeDot(legs[x], legs[x + 1]) < 0.0) {
+                return NO;
+            }
+            *handle = shifted[x + 1];
+        } else {
+            double s = AJRStrokeCross(AJRStrokeSubtract(shifted[x + 1], shifted[x]), legs[x + 1]) / denominator;
+            *handle = AJRStrokeAdd(shifted[x], AJRStrokeScale(legs[x], s));
+        }
+    }
+    
+    return YES;
+}
+
+// Returns how far offset strays from the true offset of curve, measured at a few points along it. The two needn't share a parameterization, so each point is compared against the point on curve nearest it, found with a few Newton steps from the same t.
+static double AJRStrokeOffsetError(AJRBezierCurve curve, AJRBezierCurve offset, double distance) {
+    static const double samples[3] = {0.25, 0.5, 0.75};
+    CGPoint a = AJRStrokeAdd(AJRStrokeSubtract(curve.end, curve.start), AJRStrokeScale(AJRStrokeSubtract(curve.handle1, curve.handle2), 3.0));
+    CGPoint b = AJRStrokeScale(AJRStrokeAdd(AJRStrokeSubtract(curve.start, AJRStrokeScale(curve.handle1, 2.0)), curve.handle2), 3.0);
+    double error = 0.0;
+    
+    for (NSInteger x = 0; x < 3; x++) {
+        CGPoint actual = AJRBezierCurveAtT(offset, samples[x]);
+        double t = samples[x];
+        CGPoint point, tangent;
+        
+        for (NSInteger step = 0; step < 4; step++) {
+            CGPoint second = AJRStrokeAdd(AJRStrokeScale(a, 6.0 * t), AJRStrokeScale(b, 2.0));
+            CGPoint away;
+            double slope;
+            
+            point = AJRBezierCurveAtT(curve, t);
+            tangent = AJRBezierCurveDerivativeAtT(curve, t);
+            away = AJRStrokeSubtract(point, actual);
+            slope = AJRStrokeDot(tangent, tangent) + AJRStrokeDot(away, second);
+            if (!(slope > 0.0)) {
+                break;
+            }
+            t = MIN(MAX(t - AJRStrokeDot(away, tangent) / slope, 0.0), 1.0);
+        }
+        point = AJRBezierCurveAtT(curve, t);
+        tangent = AJRBezierCurveDerivativeAtT(curve, t);
+        if (AJRStrokeCross(tangent, AJRStrokeSubtract(actual, point)) < 0.0) {
+            // On the wrong side entirely.
+            return INFINITY;
+        }
+        error = MAX(error, fabs(hypot(actual.x - point.x, actual.y - point.y) - distance));
+    }
+    
+    return error;
+}
+
+// Returns YES if curve bends tighter than distance to its left anywhere we look, or stops dead. There, the true offset doubles back on itself, and an outline made from it would leave holes under the nonzero rule.
+static BOOL AJRStrokeCurveIsTight(AJRBezierCurve curve, double distance) {
+    for (NSInteger x = 0; x <= 8; x++) {
+        double t = x / 8.0;
+        CGPoint first = AJRBezierCurveDerivativeAtT(curve, t);
+        CGPoint second = AJRStrokeAdd(AJRStrokeScale(AJRStrokeAdd(AJRStrokeSubtract(curve.handle2, AJRStrokeScale(curve.handle1, 2.0)), curve.start), 6.0 * (1.0 - t)),
+                                      AJRStrokeScale(AJRStrokeAdd(AJRStrokeSubtract(curve.end, AJRStrokeScale(curve.handle2, 2.0)), curve.handle1), 6.0 * t));
+        double speed = hypot(first.x, first.y);
+        
+        if (speed == 0.0 || AJRStrokeCross(first, second) * distance >= speed * speed * speed) {
+            return YES;
+        }
+    }
+    return NO;
+}
+
+// Strokes a tight curve as the polygon that flattens it, joining its sides round, and going by way of the curve inside each bend, just as with a path made of lines.
+static void AJRStrokerOffsetTightCurve(AJRStroker *stroker, AJRBezierCurve curve, double distance) {
+    AJRStrokePiece piece = {curve, NO};
+    NSInteger count = AJRBezierCurveFlattenedSegmentCount(curve, stroker->style.error);
+    CGPoint incoming = AJRStrokePieceStartTangent(&piece);
+    CGPoint previous = curve.start;
+    CGPoint point;
+    AJRCurveStepper stepper;
+    
+    AJRCurveStepperInitWithBezierCurve(&stepper, curve, count);
+    while (AJRCurveStepperNextPoint(&stepper, &point)) {
+        CGPoint outgoing = AJRStrokeUnit(AJRStrokeSubtract(point, previous));
+        if (outgoing.x != 0.0 || outgoing.y != 0.0) {
+            AJRStrokerJoin(stroker, previous, incoming, outgoing, AJRLineJoinStyleRound);
+            AJRStrokerLineTo(stroker, AJRStrokeAdd(point, AJRStrokeScale(AJRStrokeLeftNormal(outgoing), distance)));
+            incoming = outgoing;
+            previous = point;
+        }
+    }
+    AJRStrokerJoin(stroker, curve.end, incoming, AJRStrokePieceEndTangent(&piece), AJRLineJoinStyleRound);
+}
+
+static void AJRStrokerOffsetCurve(AJRStroker *stroker, AJRBezierCurve curve, double distance, NSInteger depth) {
+    AJRBezierCurve offset, left, right;
+    
+    if (depth < AJRStrokeMaxOffsetDepth) {
+        if (AJRStrokeCurveIsTight(curve, distance)) {
+            // Narrow the tight part down before flattening it, so the rest of the curve stays a curve.
+            if (AJRBezierCurveLength(curve, 0.0, 1.0) > distance) {
+                AJRSplitBezierCurve(curve, &left, &right);
+                AJRStrokerOffsetCurve(stroker, left, distance, depth + 1);
+                AJRStrokerOffsetCurve(stroker, right, distance, depth + 1);
+                return;
+            }
+        } else if (AJRStrokeApproximateOffset(curve, distance, &offset) && AJRStrokeOffsetError(curve, offset, distance) <= stroker->style.error) {
+            // The offset's start is left where the last piece ended, which is the same point, give or take rounding.
+            AJRStrokerCurveTo(stroker, offset.handle1, offset.handle2, offset.end);
+            return;
+        } else {
+            AJRSplitBezierCurve(curve, &left, &right);
+            AJRStrokerOffsetCurve(stroker, left, distance, depth + 1);
+            AJRStrokerOffsetCurve(stroker, right, distance, depth + 1);
+            return;
+        }
+    }
+    // Either the curve bends too tightly, or it has a cusp we've been closing in on. Both are best handled as lines.
+    AJRStrokerOffsetTightCurve(stroker, curve, distance);
+}
+
+// Draws the left side of piece, from the current point, which must be the left side of its start.
+static void AJRStrokerOffsetPiece(AJRStroker *stroker, const AJRStrokePiece *piece) {
+    if (piece->line) {
+        CGPoint normal = AJRStrokeLeftNormal(AJRStrokePieceStartTangent(piece));
+        AJRStrokerLineTo(stroker, AJRStrokeAdd(piece->curve.end, AJRStrokeScale(normal, stroker->halfWidth)));
+    } else {
+        AJRStrokerOffsetCurve(stroker, piece->curve, stroker->halfWidth, 0);
+    }
+}
+
+// Goes around the end of a stroke heading along tangent at point, from its left side to its right.
+static void AJRStrokerCap(AJRStroker *stroker, CGPoint point, CGPoint tangent) {
+    double distance = stroker->halfWidth;
+    CGPoint normal = AJRStrokeScale(AJRStrokeLeftNormal(tangent), distance);
+    CGPoint ahead = AJRStrokeScale(tangent, distance);
+    
+    switch (stroker->style.lineCap) {
+        case AJRLineCapStyleRound:
+            AJRStrokerArc(stroker, point, distance, atan2(normal.y, normal.x), -M_PI);
+            break;
+        case AJRLineCapStyleSquare:
+            AJRStrokerLineTo(stroker, AJRStrokeAdd(AJRStrokeAdd(point, normal), ahead));
+            AJRStrokerLineTo(stroker, AJRStrokeAdd(AJRStrokeSubtract(point, normal), ahead));
+            AJRStrokerLineTo(stroker, AJRStrokeSubtract(point, normal));
+            break;
+        case AJRLineCapStyleButt:
+        default:
+            AJRStrokerLineTo(stroker, AJRStrokeSubtract(point, normal));
+            break;
+    }
+}
+
+// What a stroke of no length looks like: nothing with butt caps, and otherwise both caps, back to back.
+static void AJRStrokerDot(AJRStroker *stroker, CGPoint point, CGPoint tangent) {
+    if (stroker->style.lineCap == AJRLineCapStyleButt) {
+        return;
+    }
+    if (tangent.x == 0.0 && tangent.y == 0.0) {
+        tangent = (CGPoint){1.0, 0.0};
+    }
+    AJRStrokerMoveTo(stroker, AJRStrokeAdd(point, AJRStrokeScale(AJRStrokeLeftNormal(tangent), stroker->halfWidth)));
+    AJRStrokerCap(stroker, point, tangent);
+    AJRStrokerCap(stroker, point, AJRStrokeScale(tangent, -1.0));
+    AJRStrokerClose(stroker);
+}
+
+#pragma mark - Outlining
+
+// Runs along the left side of pieces, or of their reverse. A closed side starts with the join from the last piece back around to the first. Otherwise, if move is NO, the side is joined on to the current point, which is where the cap before it left off.
+static void AJRStrokerSide(AJRStroker *stroker, const AJRStrokePiece *pieces, NSUInteger count, BOOL closed, BOOL reversed, BOOL move) {
+    AJRStrokePiece previous = reversed ? AJRStrokePieceReversed(pieces[0]) : pieces[count - 1];
+    
+    for (NSUInteger x = 0; x < count; x++) {
+        AJRStrokePiece piece = reversed ? AJRStrokePieceReversed(pieces[count - 1 - x]) : pieces[x];
+        CGPoint tangent = AJRStrokePieceStartTangent(&piece);
+        CGPoint start = AJRStrokeAdd(piece.curve.start, AJRStrokeScale(AJRStrokeLeftNormal(tangent), stroker->halfWidth));
+        
+        if (x > 0 || closed) {
+            if (x == 0) {
+                AJRStrokerMoveTo(stroker, AJRStrokeAdd(piece.curve.start, AJRStrokeScale(AJRStrokeLeftNormal(AJRStrokePieceEndTangent(&previous)), stroker->halfWidth)));
+            }
+            AJRStrokerJoin(stroker, piece.curve.start, AJRStrokePieceEndTangent(&previous), tangent, stroker->style.lineJoin);
+        } else if (move) {
+            AJRStrokerMoveTo(stroker, start);
+        } else {
+            AJRStrokerLineTo(stroker, start);
+        }
+        AJRStrokerOffsetPiece(stroker, &piece);
+        previous = piece;
+    }
+}
+
+static void AJRStrokerOutline(AJRStroker *stroker, const AJRStrokePiece *pieces, NSUInteger count, BOOL closed) {
+    if (count == 0) {
+        return;
+    }
+    if (closed) {
+        AJRStrokerSide(stroker, pieces, count, YES, NO, YES);
+        AJRStrokerClose(stroker);
+        AJRStrokerSide(stroker, pieces, count, YES, YES, YES);
+        AJRStrokerClose(stroker);
+    } else {
+        AJRStrokerSide(stroker, pieces, count, NO, NO, YES);
+        AJRStrokerCap(stroker, pieces[count - 1].curve.end, AJRStrokePieceEndTangent(&pieces[count - 1]));
+        AJRStrokerSide(stroker, pieces, count, NO, YES, NO);
+        AJRStrokerCap(stroker, pieces[0].curve.start, AJRStrokeScale(AJRStrokePieceStartTangent(&pieces[0]), -1.0));
+        AJRStrokerClose(stroker);
+    }
+}
+
+#pragma mark - Dashing
+
+static inline BOOL AJRStrokerIsDashing(const AJRStroker *stroker) {
+    return stroker->style.dashes != NULL && stroker->style.dashCount > 0;
+}
+
+// Winds the dash pattern forward to the phase, as it is at the start of each subpath.
+static void AJRStrokerResetDash(AJRStroker *stroker) {
+    const CGFloat *dashes = stroker->style.dashes;
+    NSUInteger count = stroker->style.dashCount;
+    double period = 0.0, phase;
+    
+    for (NSUInteger x = 0; x < count; x++) {
+        period += dashes[x];
+    }
+    // With an odd number of lengths, it takes two passes to get back to a dash.
+    period *= count % 2 ? 2.0 : 1.0;
+    phase = fmod(stroker->style.dashPhase, period);
+    if (phase < 0.0) {
+        phase += period;
+    }
+    
+    stroker->dashIndex = 0;
+    stroker->dashOn = YES;
+    stroker->dashRemaining = dashes[0];
+    while (phase > 0.0) {
+        if (phase < stroker->dashRemaining) {
+            stroker->dashRemaining -= phase;
+            break;
+        }
+        phase -= stroker->dashRemaining;
+        stroker->dashIndex = (stroker->dashIndex + 1) % count;
+        stroker->dashOn = !stroker->dashOn;
+        stroker->dashRemaining = dashes[stroker->dashIndex];
+    }
+    stroker->dashPieceCount = 0;
+}
+
+// Outlines the dash collected so far.
+static void AJRStrokerEndDash(AJRStroker *stroker) {
+    AJRStrokerOutline(stroker, stroker->dash, stroker->dashPieceCount, NO);
+    stroker->dashPieceCount = 0;
+}
+
+static inline double AJRStrokePieceLength(const AJRStrokePiece *piece) {
+    if (piece->line) {
+        return hypot(piece->curve.end.x - piece->curve.start.x, piece->curve.end.y - piece->curve.start.y);
+    }
+    return AJRBezierCurveLength(piece->curve, 0.0, 1.0);
+}
+
+// Lines are parameterized by how far along them we are, rather than as the cubics they're carried as, which would crowd their ends.
+static inline CGPoint AJRStrokePieceAtT(const AJRStrokePiece *piece, double t) {
+    if (piece->line) {
+        return AJRStrokeAdd(piece->curve.start, AJRStrokeScale(AJRStrokeSubtract(piece->curve.end, piece->curve.start), t));
+    }
+    return AJRBezierCurveAtT(piece->curve, t);
+}
+
+static AJRStrokePiece AJRStrokePieceSubpiece(const AJRStrokePiece *piece, double t0, double t1) {
+    if (piece->line) {
+        CGPoint start = AJRStrokePieceAtT(piece, t0);
+        CGPoint end = AJRStrokePieceAtT(piece, t1);
+        return (AJRStrokePiece){{start, start, end, end}, YES};
+    }
+    return (AJRStrokePiece){AJRBezierCurveGetSubcurve(piece->curve, t0, t1), NO};
+}
+
+// Walks piece through the dash pattern, adding the parts that fall in dashes to the current dash, and outlining each dash as it ends.
+static void AJRStrokerDashPiece(AJRStroker *stroker, const AJRStrokePiece *piece) {
+    double length = AJRStrokePieceLength(piece);
+    double epsilon = 1.0e-9 * MAX(length, 1.0);
+    double position = 0.0, t = 0.0;
+    
+    while (YES) {
+        while (stroker->dashRemaining <= epsilon) {
+            if (stroker->dashOn) {
+                AJRStrokerEndDash(stroker);
+            }
+            stroker->dashIndex = (stroker->dashIndex + 1) % stroker->style.dashCount;
+            stroker->dashOn = !stroker->dashOn;
+            stroker->dashRemaining = stroker->style.dashes[stroker->dashIndex];
+            if (stroker->dashOn && stroker->dashRemaining <= epsilon) {
+                CGPoint tangent = piece->line ? AJRStrokePieceStartTangent(piece) : AJRStrokeUnit(AJRBezierCurveDerivativeAtT(piece->curve, t));
+                AJRStrokerDot(stroker, AJRStrokePieceAtT(piece, t), tangent);
+            }
+        }
+        if (stroker->dashRemaining >= length - position - epsilon) {
+            if (stroker->dashOn && length - position > epsilon) {
+                AJRStrokePiecesAppend(&stroker->dash, &stroker->dashPieceCount, &stroker->maxDashPieces, AJRStrokePieceSubpiece(piece, t, 1.0));
+            }
+            stroker->dashRemaining -= length - position;
+            break;
+        } else {
+            double next = piece->line ? (position + stroker->dashRemaining) / length : AJRBezierCurveTAtLength(piece->curve, t, stroker->dashRemaining);
+            if (stroker->dashOn) {
+                AJRStrokePiecesAppend(&stroker->dash, &stroker->dashPieceCount, &stroker->maxDashPieces, AJRStrokePieceSubpiece(piece, t, next));
+            }
+            position += stroker->dashRemaining;
+            t = next;
+            stroker->dashRemaining = 0.0;
+        }
+    }
+}
+
+#pragma mark - Subpaths
+
+static void AJRStrokerEndSubpath(AJRStroker *stroker, BOOL closed) {
+    if (closed && !CGPointEqualToPoint(stroker->lastPoint, stroker->subpathStart)) {
+        AJRStrokePiecesAppend(&stroker->pieces, &stroker->pieceCount, &stroker->maxPieces, (AJRStrokePiece){{stroker->lastPoint, stroker->lastPoint, stroker->subpathStart, stroker->subpathStart}, YES});
+    }
+    if (stroker->pieceCount == 0) {
+        // Like PostScript, a subpath that goes nowhere is only drawn if it was closed or tried to draw.
+        if (stroker->subpathDraws || closed) {
+            AJRStrokerDot(stroker, stroker->subpathStart, CGPointZero);
+        }
+    } else if (AJRStrokerIsDashing(stroker)) {
+        AJRStrokerResetDash(stroker);
+        for (NSUInteger x = 0; x < stroker->pieceCount; x++) {
+            AJRStrokerDashPiece(stroker, stroker->pieces + x);
+        }
+        if (stroker->dashOn) {
+            AJRStrokerEndDash(stroker);
+        }
+    } else {
+        AJRStrokerOutline(stroker, stroker->pieces, stroker->pieceCount, closed);
+    }
+    stroker->pieceCount = 0;
+    stroker->subpathDraws = NO;
+    stroker->lastPoint = stroker->subpathStart;
+}
+
+static void AJRStrokerAddElement(AJRStroker *stroker, AJRBezierPathElement element, const CGPoint *points) {
+    AJRStrokePiece piece;
+    
+    switch (element) {
+        case AJRBezierPathElementMoveTo:
+            AJRStrokerEndSubpath(stroker, NO);
+            stroker->subpathStart = stroker->lastPoint = points[0];
+            return;
+        case AJRBezierPathElementLineTo:
+            piece = (AJRStrokePiece){{stroker->lastPoint, stroker->lastPoint, points[0], points[0]}, YES};
+            stroker->lastPoint = points[0];
+            break;
+        case AJRBezierPathElementCubicCurveTo:
+            piece = (AJRStrokePiece){{stroker->lastPoint, points[0], points[1], points[2]}, NO};
+            stroker->lastPoint = points[2];
+            break;
+        case AJRBezierPathElementQuadraticCurveTo:
+            piece = (AJRStrokePiece){AJRBezierCurveFromQuadraticCurve((AJRQuadraticCurve){stroker->lastPoint, points[0], points[1]}), NO};
+            stroker->lastPoint = points[1];
+            break;
+        case AJRBezierPathElementClose:
+            AJRStrokerEndSubpath(stroker, YES);
+            return;
+        default:
+            return;
+    }
+    stroker->subpathDraws = YES;
+    AJRStrokePiecesAppend(&stroker->pieces, &stroker->pieceCount, &stroker->maxPieces, piece);
+}
+
+static void AJRStrokerFree(AJRStroker *stroker) {
+    if (stroker->elements) NSZoneFree(nil, stroker->elements);
+    if (stroker->points) NSZoneFree(nil, stroker->points);
+    if (stroker->pieces) NSZoneFree(nil, stroker->pieces);
+    if (stroker->dash) NSZoneFree(nil, stroker->dash);
+}
+
+AJRBezierPath *AJRBezierPathByStrokingPath(id <AJRBezierPathProtocol> path, AJRStrokeStyle style) {
+    AJRBezierPath *result = [[AJRBezierPath alloc] init];
+    AJRStroker stroker = {0};
+    AJRPathIterator iterator;
+    AJRBezierPathElement element;
+    CGPoint points[3];
+    double dashTotal = 0.0;
+    
+    [result setWindingRule:AJRWindingRuleNonZero];
+    if (!(style.lineWidth > 0.0)) {
+        return result;
+    }
+    // A pattern with nothing in it, or with negative lengths, can't be followed, so it's stroked solid.
+    for (NSUInteger x = 0; style.dashes && x < style.dashCount; x++) {
+        if (style.dashes[x] < 0.0) {
+            dashTotal = 0.0;
+            break;
+        }
+        dashTotal += style.dashes[x];
+    }
+    if (!(dashTotal > 0.0)) {
+        style.dashes = NULL;
+        style.dashCount = 0;
+    }
+    if (!(style.error > 0.0)) {
+        style.error = 0.01;
+    }
+    stroker.style = style;
+    stroker.halfWidth = style.lineWidth / 2.0;
+    
+    AJRPathIteratorInit(&iterator, path);
+    while (AJRPathIteratorNextElement(&iterator, &element, points)) {
+        AJRStrokerAddElement(&stroker, element, points);
+    }
+    AJRStrokerEndSubpath(&stroker, NO);
+    
+    if (stroker.elementCount) {
+        [result appendElements:stroker.elements count:stroker.elementCount points:stroker.points count:stroker.pointCount];
+    }
+    AJRStrokerFree(&stroker);
+    
+    return result;
+}
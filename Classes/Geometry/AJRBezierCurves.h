@@ -32,12 +32,112 @@
 #import <AJRInterfaceFoundation/AJRGeometry.h>
 #import <AJRInterfaceFoundation/AJRTrigonometry.h>
 
+// Fitting curves to points, such as those from a pen or a mouse, using Schneider's algorithm from Graphics Gems. In each case, error is the farthest any point may be from the curves.
+
+// Returns the single curve that best fits the points, which runs from the first point to the last.
 extern AJRBezierCurve AJRBezierCurveFromPoints(CGPoint *points, NSInteger pointCount, double error);
 
+typedef void (*AJRBezierCurveFitCallback)(AJRBezierCurve curve, void *context);
+
+// Fits as few curves as it takes to come within error of every point. The curves are joined smoothly, and are passed to callback in order. Returns how many curves were made.
+extern NSInteger AJRBezierCurvesFromPoints(const CGPoint *points, NSInteger pointCount, double error, AJRBezierCurveFitCallback callback, void *context);
+
+// Fits one curve to the points, which leaves the first point heading along startTangent, and arrives at the last point from the direction of endTangent, so endTangent points back along the curve. Both must be unit vectors. scratch must have room for 2 * pointCount doubles, which lets callers fitting over and over reuse the same memory. pointCount must be at least 2. Returns the farthest any point is from the curve, and sets splitIndex, if it's not NULL, to the index of that point.
+extern double AJRBezierCurveFitToPoints(const CGPoint *points, NSInteger pointCount, CGPoint startTangent, CGPoint endTangent, double error, double *scratch, AJRBezierCurve *curve, NSInteger *splitIndex);
+
 // Splits a bezier curve into two curves at t = 0.5
 extern void AJRSplitBezierCurve(AJRBezierCurve input, AJRBezierCurve *left, AJRBezierCurve *right);
 // Splits a bezier curve into two curves at t.
 extern void AJRSplitBezierCurveAtT(AJRBezierCurve input, AJRBezierCurve *left, AJRBezierCurve *right, double t);
 
+// Returns the piece of curve between t0 and t1. If t0 is greater than t1, the piece is reversed. If they're equal, every point of the piece is the point at t0.
+extern AJRBezierCurve AJRBezierCurveGetSubcurve(AJRBezierCurve curve, double t0, double t1);
+
 // Computes curve at t. t is a value between 0.0 and 1.0.
 extern CGPoint AJRBezierCurveAtT(AJRBezierCurve curve, double t);
+
+// Computes a quadratic curve at t. t is a value between 0.0 and 1.0.
+extern CGPoint AJRQuadraticCurveAtT(AJRQuadraticCurve curve, double t);
+// Returns the cubic curve that traces exactly the same shape as the quadratic curve.
+extern AJRBezierCurve AJRBezierCurveFromQuadraticCurve(AJRQuadraticCurve curve);
+
+// Computes the curve's first derivative at t, which points along the curve in the direction of increasing t.
+extern CGPoint AJRBezierCurveDerivativeAtT(AJRBezierCurve curve, double t);
+extern CGPoint AJRQuadraticCurveDerivativeAtT(AJRQuadraticCurve curve, double t);
+
+// Finds where the curve crosses the line segment. The curve is rotated into the line's frame, where the crossings are the roots of a single cubic (or quadratic) in t, so the answer is exact, and nothing is subdivided or allocated. Returns how many were found, at most 3, in ascending order of t. Either tValues or points may be NULL, and otherwise must have room for 3 values. A curve lying along the line has no isolated crossings, so it returns 0.
+extern NSInteger AJRBezierCurveIntersectLine(AJRBezierCurve curve, AJRLine line, double *tValues, CGPoint *points);
+extern NSInteger AJRQuadraticCurveIntersectLine(AJRQuadraticCurve curve, AJRLine line, double *tValues, CGPoint *points);
+
+// Returns, in ascending order, the t values in (0.0..1.0) where y changes direction. Splitting the curve at these values yields pieces that are monotone in y. tValues must have room for 2 values.
+extern NSInteger AJRBezierCurveGetYMonotoneTValues(AJRBezierCurve curve, double *tValues);
+// As above, but splits wherever either x or y changes direction. tValues must have room for 4 values.
+extern NSInteger AJRBezierCurveGetMonotoneTValues(AJRBezierCurve curve, double *tValues);
+extern NSInteger AJRQuadraticCurveGetYMonotoneTValues(AJRQuadraticCurve curve, double *tValues);
+extern NSInteger AJRQuadraticCurveGetMonotoneTValues(AJRQuadraticCurve curve, double *tValues);
+
+// Returns the smallest rectangle enclosing the curve, found from the roots of its derivative. This is usually much tighter than the bounds of the control points, and unlike flattening, it's exact.
+extern CGRect AJRBezierCurveGetBounds(AJRBezierCurve curve);
+extern CGRect AJRQuadraticCurveGetBounds(AJRQuadraticCurve curve);
+
+// Finds t in [t0..t1] where the curve passes through y (or x). The curve must be monotone in that coordinate over [t0..t1], which is what the Get*MonotoneTValues() functions are for.
+extern double AJRBezierCurveTForY(AJRBezierCurve curve, double y, double t0, double t1);
+extern double AJRBezierCurveTForX(AJRBezierCurve curve, double x, double t0, double t1);
+
+// The most line segments a single curve will ever be flattened into, no matter how small the error.
+#define AJRCurveMaxFlattenedSegments 65536
+
+// Returns how many equal steps in t are needed so that no point on the curve is farther than error from the line segments joining them. This is Wang's formula, which only looks at the control points, so the answer is known before any point is computed. The result is always between 1 and AJRCurveMaxFlattenedSegments.
+extern NSInteger AJRBezierCurveFlattenedSegmentCount(AJRBezierCurve curve, double error);
+extern NSInteger AJRQuadraticCurveFlattenedSegmentCount(AJRQuadraticCurve curve, double error);
+
+// Walks a curve in equal steps of t using forward differencing, so each point costs six additions. Initialize one with the segment count from the functions above, then call AJRCurveStepperNextPoint() until it returns NO. The final point is always exactly the curve's end point.
+typedef struct _ajrCurveStepper {
+    CGPoint point;
+    CGPoint end;
+    CGPoint d1, d2, d3;
+    NSInteger segmentCount;
+    NSInteger step;
+} AJRCurveStepper;
+
+extern void AJRCurveStepperInitWithBezierCurve(AJRCurveStepper *stepper, AJRBezierCurve curve, NSInteger segmentCount);
+extern void AJRCurveStepperInitWithQuadraticCurve(AJRCurveStepper *stepper, AJRQuadraticCurve curve, NSInteger segmentCount);
+
+// Advances to the next point. stepper->point holds the previous point until this is called, so the line segment is {stepper->point, *point}.
+NS_INLINE BOOL AJRCurveStepperNextPoint(AJRCurveStepper *stepper, CGPoint *point) {
+    if (stepper->step >= stepper->segmentCount) {
+        return NO;
+    }
+    stepper->step += 1;
+    if (stepper->step == stepper->segmentCount) {
+        // Don't let the accumulated rounding error leave a gap before the next element.
+        stepper->point = stepper->end;
+    } else {
+        stepper->point.x += stepper->d1.x;
+        stepper->point.y += stepper->d1.y;
+        stepper->d1.x += stepper->d2.x;
+        stepper->d1.y += stepper->d2.y;
+        stepper->d2.x += stepper->d3.x;
+        stepper->d2.y += stepper->d3.y;
+    }
+    *point = stepper->point;
+    return YES;
+}
+
+// The t value of the stepper's current point.
+NS_INLINE double AJRCurveStepperGetT(const AJRCurveStepper *stepper) {
+    return stepper->segmentCount == 0 ? 0.0 : (double)stepper->step / (double)stepper->segmentCount;
+}
+
+// Returns YES if some point on the curve lies within distance of point. This subdivides on the stack, so it's safe to call from any thread.
+extern BOOL AJRBezierCurveIsWithinDistanceOfPoint(AJRBezierCurve curve, CGPoint point, double distance);
+
+// Returns the t in [t0..t1] of the point on the curve nearest to point, and stores that point in nearest, if it's not NULL. The range is split where the curve turns in x or y, each piece is sampled to find the nearest dip in distance, and that's polished with Newton's method. Nothing is allocated.
+extern double AJRBezierCurveNearestT(AJRBezierCurve curve, CGPoint point, double t0, double t1, CGPoint *nearest);
+// As above, over the whole curve. For a quadratic, the nearest point is a root of a cubic, so this is solved exactly.
+extern double AJRQuadraticCurveNearestT(AJRQuadraticCurve curve, CGPoint point, CGPoint *nearest);
+
+// Returns the length of the curve between t0 and t1, found by adaptive Gauss-Legendre quadrature to within about one part in 10^10.
+extern double AJRBezierCurveLength(AJRBezierCurve curve, double t0, double t1);
+// Returns the t at which the curve has run length beyond t0, or 1.0 if the curve isn't that long.
+extern double AJRBezierCurveTAtLength(AJRBezierCurve curve, double t0, double length);
@@ -36,114 +36,147 @@
 
 #import "AJRGeometry.h"
 #import "AJRVector.h"
-#import "NSValue+Extensions.h"
 
 #import <math.h>
 
 /* Forward declarations */
-static void FitCubic(CGPoint *points, NSInteger first, NSInteger last, AJRVector tHat1, AJRVector tHat2, double error, NSMutableArray *curves);
-static double *Reparameterize(CGPoint *points, NSInteger first, NSInteger last, double *u, AJRBezierCurve bezierCurve);
+static void FitCubic(const CGPoint *points, NSInteger first, NSInteger last, AJRVector tHat1, AJRVector tHat2, double error, double *scratch, AJRBezierCurveFitCallback callback, void *context, NSInteger *curveCount);
+static void Reparameterize(const CGPoint *points, NSInteger first, NSInteger last, const double *u, AJRBezierCurve bezierCurve, double *uPrime);
 static double NewtonRaphsonRootFind(AJRBezierCurve Q, CGPoint P, double u);
 static CGPoint Bezier(NSInteger degree, CGPoint *V, double t);
 static double B0(double), B1(double), B2(double), B3(double);
-static AJRVector ComputeLeftTangent(CGPoint *points, NSInteger end);
-static AJRVector ComputeRightTangent(CGPoint *points, NSInteger end);
-static AJRVector ComputeCenterTangent(CGPoint *points, NSInteger center);
-static double ComputeMaxError(CGPoint *points, NSInteger first, NSInteger last, AJRBezierCurve bezierCurve, double *u, NSInteger *splitPoint);
-static double *ChordLengthParameterize(CGPoint *points, NSInteger first, NSInteger last);
-static AJRBezierCurve GenerateBezier(CGPoint    *points, NSInteger first, NSInteger last, double *uPrime, AJRVector tHat1, AJRVector tHat2);
-
-#define MAXPOINTS    1000       /* The most points you can have */
-
-/*!
- * Fit a Bezier curve to a set of digitized points
- *
- * @param
- * points        array of digitized points
- * pointCount    count of points
- * error           user defined error squared
- */
-static NSArray __attribute__((unused)) *AJRBezierCurvesFromPoints(CGPoint *points, NSInteger pointCount, double error) {
-    AJRVector tangentHat1, tangentHat2;   /*  Unit tangent vectors at endpoints */
-    NSMutableArray *array;
+static AJRVector ComputeLeftTangent(const CGPoint *points, NSInteger end);
+static AJRVector ComputeRightTangent(const CGPoint *points, NSInteger end);
+static AJRVector ComputeCenterTangent(const CGPoint *points, NSInteger center);
+static double ComputeMaxError(const CGPoint *points, NSInteger first, NSInteger last, AJRBezierCurve bezierCurve, const double *u, NSInteger *splitPoint);
+static void ChordLengthParameterize(const CGPoint *points, NSInteger first, NSInteger last, double *u);
+static AJRBezierCurve GenerateBezier(const CGPoint *points, NSInteger first, NSInteger last, const double *uPrime, AJRVector tHat1, AJRVector tHat2);
+
+#define MAXITERATIONS    4      /* The most times we'll reparameterize a fit */
+
+AJRBezierCurve AJRBezierCurveFromPoints(CGPoint *points, NSInteger pointCount, double error) {
+    AJRBezierCurve curve;
+    double *scratch;
     
-    tangentHat1 = ComputeLeftTangent(points, 0);
-    tangentHat2 = ComputeRightTangent(points, pointCount - 1);
+    if (pointCount < 2) {
+        curve.start = curve.handle1 = curve.handle2 = curve.end = pointCount == 1 ? points[0] : CGPointZero;
+        return curve;
+    }
     
-    array = [NSMutableArray arrayWithCapacity:16];
+    scratch = (double *)NSZoneMalloc(NULL, 2 * pointCount * sizeof(double));
+    AJRBezierCurveFitToPoints(points, pointCount, ComputeLeftTangent(points, 0), ComputeRightTangent(points, pointCount - 1), error, scratch, &curve, NULL);
+    NSZoneFree(NULL, scratch);
     
-    FitCubic(points, 0, pointCount - 1, tangentHat1, tangentHat2, error, array);
+    return curve;
+}
+
+NSInteger AJRBezierCurvesFromPoints(const CGPoint *points, NSInteger pointCount, double error, AJRBezierCurveFitCallback callback, void *context) {
+    NSInteger curveCount = 0;
+    double *scratch;
     
-    return array;
+    if (pointCount < 2) {
+        return 0;
+    }
+    
+    // One scratch buffer does for every fit, because each only ever uses the stretch of it that lines up with its own points.
+    scratch = (double *)NSZoneMalloc(NULL, 2 * pointCount * sizeof(double));
+    FitCubic(points, 0, pointCount - 1, ComputeLeftTangent(points, 0), ComputeRightTangent(points, pointCount - 1), error, scratch, callback, context, &curveCount);
+    NSZoneFree(NULL, scratch);
+    
+    return curveCount;
+}
+
+double AJRBezierCurveFitToPoints(const CGPoint *points, NSInteger pointCount, CGPoint startTangent, CGPoint endTangent, double error, double *scratch, AJRBezierCurve *curve, NSInteger *splitIndex) {
+    double *u = scratch;            /* Parameter values for point  */
+    double *uPrime = scratch + pointCount; /* Improved parameter values */
+    double *swap;
+    double maxError;                /* Maximum fitting error, squared */
+    double errorSquared = error * error;
+    NSInteger splitPoint = 0;       /* Point of maximum error */
+    NSInteger last = pointCount - 1;
+    AJRBezierCurve bezierCurve;
+    AJRBezierCurve candidate;
+    NSInteger candidateSplitPoint;
+    double candidateError;
+    
+    /*  Use heuristic if region only has two points in it */
+    if (pointCount == 2) {
+        double dist = AJRDistanceBetweenPoints(points[last], points[0]) / 3.0;
+        
+        curve->start = points[0];
+        curve->end = points[last];
+        curve->handle1 = AJRVectorAdd(curve->start, AJRVectorScale(startTangent, dist));
+        curve->handle2 = AJRVectorAdd(curve->end, AJRVectorScale(endTangent, dist));
+        if (splitIndex) {
+            *splitIndex = 1;
+        }
+        
+        return 0.0;
+    }
+    
+    /*  Parameterize points, and attempt to fit curve */
+    ChordLengthParameterize(points, 0, last, u);
+    bezierCurve = GenerateBezier(points, 0, last, u, startTangent, endTangent);
+    maxError = ComputeMaxError(points, 0, last, bezierCurve, u, &splitPoint);
+    
+    /*  If error not too large, try some reparameterization and iteration. We keep whichever fit was best, since a step can make things worse. */
+    if (maxError >= errorSquared && maxError < errorSquared * 4.0) {
+        for (NSInteger i = 0; i < MAXITERATIONS; i++) {
+            Reparameterize(points, 0, last, u, bezierCurve, uPrime);
+            candidate = GenerateBezier(points, 0, last, uPrime, startTangent, endTangent);
+            candidateError = ComputeMaxError(points, 0, last, candidate, uPrime, &candidateSplitPoint);
+            if (candidateError >= maxError) {
+                break;
+            }
+            bezierCurve = candidate;
+            maxError = candidateError;
+            splitPoint = candidateSplitPoint;
+            swap = u;
+            u = uPrime;
+            uPrime = swap;
+            if (maxError < errorSquared) {
+                break;
+            }
+        }
+    }
+    
+    *curve = bezierCurve;
+    if (splitIndex) {
+        *splitIndex = splitPoint;
+    }
+    
+    return sqrt(maxError);
 }
 
 /*
  FitCubic :
  Fit a Bezier curve to a (sub)set of digitized points
  */
-static void FitCubic(CGPoint *points, NSInteger first, NSInteger last, AJRVector tHat1, AJRVector tHat2, double error, NSMutableArray *curves) {
+static void FitCubic(const CGPoint *points, NSInteger first, NSInteger last, AJRVector tHat1, AJRVector tHat2, double error, double *scratch, AJRBezierCurveFitCallback callback, void *context, NSInteger *curveCount) {
     AJRBezierCurve bezierCurve;     /* Control points of fitted Bezier curve*/
-    double *u;                      /* Parameter values for point  */
-    double *uPrime;                 /* Improved parameter values */
     double maxError;                /* Maximum fitting error     */
     NSInteger splitPoint;           /* Point to split point set at     */
     NSInteger nPts;                 /* Number of points in subset  */
-    double iterationError;          /* Error below which you try iterating  */
-    NSInteger maxIterations = 4;    /*  Max times to try iterating  */
     AJRVector tHatCenter;           /* Unit tangent vector at splitPoint */
-    NSInteger i;
-
-    iterationError = error * error;
-    nPts = last - first + 1;
-    
-    /*  Use heuristic if region only has two points in it */
-    if (nPts == 2) {
-        double dist = AJRDistanceBetweenPoints(points[last], points[first]) / 3.0;
-        
-        bezierCurve.start = points[first];
-        bezierCurve.end = points[last];
-        bezierCurve.handle1 = AJRVectorAdd(bezierCurve.start, AJRVectorScale(tHat1, dist));
-        bezierCurve.handle2 = AJRVectorAdd(bezierCurve.end, AJRVectorScale(tHat2, dist));
-        
-        [curves addObject:[NSValue valueWithBezierCurve:bezierCurve]];
-        
-        return;
-    }
-    
-    /*  Parameterize points, and attempt to fit curve */
-    u = ChordLengthParameterize(points, first, last);
-    bezierCurve = GenerateBezier(points, first, last, u, tHat1, tHat2);
-    
-    /*  Find max deviation of points to fitted curve */
-    maxError = ComputeMaxError(points, first, last, bezierCurve, u, &splitPoint);
-    if (maxError < error) {
-        [curves addObject:[NSValue valueWithBezierCurve:bezierCurve]];
-        free((char *)u);
-        return;
-    }
     
+    nPts = last - first + 1;
     
-    /*  If error not too large, try some reparameterization  */
-    /*  and iteration */
-    if (maxError < iterationError) {
-        for (i = 0; i < maxIterations; i++) {
-            uPrime = Reparameterize(points, first, last, u, bezierCurve);
-            bezierCurve = GenerateBezier(points, first, last, uPrime, tHat1, tHat2);
-            maxError = ComputeMaxError(points, first, last, bezierCurve, uPrime, &splitPoint);
-            if (maxError < error) {
-                [curves addObject:[NSValue valueWithBezierCurve:bezierCurve]];
-                return;
-            }
-            free((char *)u);
-            u = uPrime;
+    /* The subset's parameters go in the matching stretch of scratch, so nothing else needs to be allocated as we recurse. */
+    maxError = AJRBezierCurveFitToPoints(points + first, nPts, tHat1, tHat2, error, scratch + 2 * first, &bezierCurve, &splitPoint);
+    if (maxError <= error) {
+        if (callback) {
+            callback(bezierCurve, context);
         }
+        *curveCount += 1;
+        return;
     }
     
     /* Fitting failed -- split at max error point and fit recursively */
+    splitPoint += first;
     tHatCenter = ComputeCenterTangent(points, splitPoint);
-    FitCubic(points, first, splitPoint, tHat1, tHatCenter, error, curves);
+    FitCubic(points, first, splitPoint, tHat1, tHatCenter, error, scratch, callback, context, curveCount);
     tHatCenter = AJRVectorNegate(tHatCenter);
-    FitCubic(points, splitPoint, last, tHatCenter, tHat2, error, curves);
+    FitCubic(points, splitPoint, last, tHatCenter, tHat2, error, scratch, callback, context, curveCount);
 }
 
 
@@ -151,14 +184,14 @@ static void FitCubic(CGPoint *points, NSInteger first, NSInteger last, AJRVector
  *  GenerateBezier :
  *  Use least-squares method to find Bezier control points for region.
  */
-static AJRBezierCurve GenerateBezier(CGPoint *points, NSInteger first, NSInteger last, double *uPrime, AJRVector tHat1, AJRVector tHat2)
+static AJRBezierCurve GenerateBezier(const CGPoint *points, NSInteger first, NSInteger last, const double *uPrime, AJRVector tHat1, AJRVector tHat2)
 // points                Array of digitized points
 // first, last            Indices defining region
 // uPrime                Parameter values for region
 // tHat1, tHat2        Unit tangents at endpoints
 {
     NSInteger                 i;
-    AJRVector         A[MAXPOINTS][2];    /* Precomputed rhs for eqn    */
+    AJRVector         A[2];                /* Rhs for eqn, computed per point */
     NSInteger                 nPts;                    /* Number of pts in sub-curve */
     double             C[2][2];                /* Matrix C       */
     double             X[2];                    /* Matrix X         */
@@ -172,12 +205,6 @@ static AJRBezierCurve GenerateBezier(CGPoint *points, NSInteger first, NSInteger
     
     nPts = last - first + 1;
     
-    /* Compute the A's    */
-    for (i = 0; i < nPts; i++) {
-        A[i][0] = AJRVectorScale(tHat1, B1(uPrime[i]));
-        A[i][1] = AJRVectorScale(tHat2, B2(uPrime[i]));
-    }
-    
     /* Create the C and X matrices    */
     C[0][0] = 0.0;
     C[0][1] = 0.0;
@@ -186,25 +213,24 @@ static AJRBezierCurve GenerateBezier(CGPoint *points, NSInteger first, NSInteger
     X[0] = 0.0;
     X[1] = 0.0;
     
+    /* The A's are only needed once each, so they're computed as we go, rather than kept in an array, which put a limit on how many points could be fit. */
     for (i = 0; i < nPts; i++) {
-        C[0][0] += AJRVectorDotProduct(A[i][0], A[i][0]);
-        C[0][1] += AJRVectorDotProduct(A[i][0], A[i][1]);
-        /* C[1][0] += AJRVectorDotProduct(&A[i][0], &A[i][1]);*/
+        A[0] = AJRVectorScale(tHat1, B1(uPrime[i]));
+        A[1] = AJRVectorScale(tHat2, B2(uPrime[i]));
+        
+        C[0][0] += AJRVectorDotProduct(A[0], A[0]);
+        C[0][1] += AJRVectorDotProduct(A[0], A[1]);
         C[1][0] = C[0][1];
-        C[1][1] += AJRVectorDotProduct(A[i][1], A[i][1]);
+        C[1][1] += AJRVectorDotProduct(A[1], A[1]);
         
+        /* This is the point less what the end points alone contribute to the curve at u. */
         tmp = AJRVectorSubtract(points[first + i],
-                               AJRVectorAdd(
-                                           AJRVectorScale(points[first], B0(uPrime[i])),
-                                           AJRVectorAdd(
-                                                       AJRVectorScale(points[first], B1(uPrime[i])),
-                                                       AJRVectorAdd(
-                                                                   AJRVectorScale(points[last], B2(uPrime[i])),
-                                                                   AJRVectorScale(points[last], B3(uPrime[i]))))));
-        
+                                AJRVectorCombination(points[first], points[last],
+                                                     B0(uPrime[i]) + B1(uPrime[i]),
+                                                     B2(uPrime[i]) + B3(uPrime[i])));
         
-        X[0] += AJRVectorDotProduct(A[i][0], tmp);
-        X[1] += AJRVectorDotProduct(A[i][1], tmp);
+        X[0] += AJRVectorDotProduct(A[0], tmp);
+        X[1] += AJRVectorDotProduct(A[1], tmp);
     }
     
     /* Compute the determinants of C and X    */
@@ -220,8 +246,9 @@ static AJRBezierCurve GenerateBezier(CGPoint *points, NSInteger first, NSInteger
     alpha_r = det_C0_X / det_C0_C1;
     
     
-    /*  If alpha negative, use the Wu/Barsky heuristic (see text) */
-    if (alpha_l < 0.0 || alpha_r < 0.0) {
+    /*  If alpha negative, or so small that the handles would sit on the end points, use the Wu/Barsky heuristic (see text) */
+    double epsilon = 1.0e-6 * AJRDistanceBetweenPoints(points[last], points[first]);
+    if (alpha_l < epsilon || alpha_r < epsilon) {
         double    dist = AJRDistanceBetweenPoints(points[last], points[first]) / 3.0;
         
         bezierCurve.start = points[first];
@@ -249,22 +276,18 @@ static AJRBezierCurve GenerateBezier(CGPoint *points, NSInteger first, NSInteger
  *  Reparameterize:
  *    Given set of points and their parameterization, try to find a better parameterization.
  */
-static double *Reparameterize(CGPoint *points, NSInteger first, NSInteger last, double *u, AJRBezierCurve bezierCurve)
+static void Reparameterize(const CGPoint *points, NSInteger first, NSInteger last, const double *u, AJRBezierCurve bezierCurve, double *uPrime)
 // points            Array of digitized points
 // first, last        Indices defining region
 // u                Current parameter values
 // bezierCurve    Current fitted curve
+// uPrime            Filled in with the new parameter values
 {
-    NSInteger         nPts = last - first + 1;
     NSInteger         i;
-    double    *uPrime;     /*  New parameter values    */
     
-    uPrime = (double *)malloc(nPts * sizeof(double));
     for (i = first; i <= last; i++) {
         uPrime[i - first] = NewtonRaphsonRootFind(bezierCurve, points[i], u[i - first]);
     }
-    
-    return uPrime;
 }
 
 
@@ -311,6 +334,9 @@ static double NewtonRaphsonRootFind(AJRBezierCurve curve, CGPoint P, double u)
     denominator = (Q1_u.x) * (Q1_u.x) + (Q1_u.y) * (Q1_u.y) + (Q_u.x - P.x) * (Q2_u.x) + (Q_u.y - P.y) * (Q2_u.y);
     
     /* u = u - f(u)/f'(u) */
+    if (denominator == 0.0) {
+        return u;
+    }
     uPrime = u - (numerator / denominator);
     
     return uPrime;
@@ -328,11 +354,11 @@ static CGPoint Bezier(NSInteger degree, CGPoint *V, double t)
 // t                Parametric value to find point for
 {
     NSInteger     i, j;
-    CGPoint        Q;            /* Point on curve at parameter t    */
-    CGPoint        *Vtemp;        /* Local copy of control points       */
+    CGPoint        Vtemp[4];    /* Local copy of control points, we never go above degree 3 */
+    
+    NSCAssert(degree <= 3, @"Bezier() only handles up to cubic curves");
     
     /* Copy array    */
-    Vtemp = (CGPoint *)NSZoneMalloc(NSDefaultMallocZone(), (NSUInteger)((degree+1) * sizeof (CGPoint)) + 1024);
     for (i = 0; i <= degree; i++) {
         Vtemp[i] = V[i];
     }
@@ -345,10 +371,7 @@ static CGPoint Bezier(NSInteger degree, CGPoint *V, double t)
         }
     }
     
-    Q = Vtemp[0];
-    NSZoneFree(NSDefaultMallocZone(), Vtemp);
-    
-    return Q;
+    return Vtemp[0];
 }
 
 
@@ -392,7 +415,7 @@ static double B3(double u)
  * ComputeLeftTangent, ComputeRightTangent, ComputeCenterTangent :
  *Approximate unit tangents at endpoints and "center" of digitized curve
  */
-static AJRVector ComputeLeftTangent(CGPoint *points, NSInteger end)
+static AJRVector ComputeLeftTangent(const CGPoint *points, NSInteger end)
 // points        Digitized points
 // end            Index to "left" end of region
 {
@@ -402,7 +425,7 @@ static AJRVector ComputeLeftTangent(CGPoint *points, NSInteger end)
     return tHat1;
 }
 
-static AJRVector ComputeRightTangent(CGPoint *points, NSInteger end)
+static AJRVector ComputeRightTangent(const CGPoint *points, NSInteger end)
 // points        Digitized points
 // end            Index to "right" end of region
 {
@@ -413,7 +436,7 @@ static AJRVector ComputeRightTangent(CGPoint *points, NSInteger end)
 }
 
 
-static AJRVector ComputeCenterTangent(CGPoint *points, NSInteger center)
+static AJRVector ComputeCenterTangent(const CGPoint *points, NSInteger center)
 // points        Digitized points
 // center        Index to point inside region
 {
@@ -434,14 +457,12 @@ static AJRVector ComputeCenterTangent(CGPoint *points, NSInteger center)
  *    Assign parameter values to digitized points
  *    using relative distances between points.
  */
-static double *ChordLengthParameterize(CGPoint *points, NSInteger first, NSInteger last)
+static void ChordLengthParameterize(const CGPoint *points, NSInteger first, NSInteger last, double *u)
 // points            Array of digitized points
 // first, last        Indices defining region
+// u                Filled in with the parameterization
 {
     NSInteger        i;
-    double    *u;       /*  Parameterization       */
-    
-    u = (double *)malloc((NSUInteger)(last - first + 1) * sizeof(double));
     
     u[0] = 0.0;
     for (i = first+1; i <= last; i++) {
@@ -449,11 +470,16 @@ static double *ChordLengthParameterize(CGPoint *points, NSInteger first, NSInteg
         AJRDistanceBetweenPoints(points[i], points[i - 1]);
     }
     
+    if (u[last - first] == 0.0) {
+        /* All the points are on top of one another, so just space them out evenly. */
+        for (i = first + 1; i <= last; i++) {
+            u[i - first] = (double)(i - first) / (double)(last - first);
+        }
+        return;
+    }
     for (i = first + 1; i <= last; i++) {
         u[i - first] = u[i - first] / u[last - first];
     }
-    
-    return u;
 }
 
 /*
@@ -461,7 +487,7 @@ static double *ChordLengthParameterize(CGPoint *points, NSInteger first, NSInteg
  *    Find the maximum squared distance of digitized points
  *    to fitted curve.
  */
-static double ComputeMaxError(CGPoint *points, NSInteger first, NSInteger last, AJRBezierCurve bezierCurve, double *u, NSInteger *splitPoint)
+static double ComputeMaxError(const CGPoint *points, NSInteger first, NSInteger last, AJRBezierCurve bezierCurve, const double *u, NSInteger *splitPoint)
 // points                Array of digitized points
 // first, last            Indices defining region
 // bezierCurve        Fitted Bezier curve
@@ -473,7 +499,7 @@ static double ComputeMaxError(CGPoint *points, NSInteger first, NSInteger last,
     double        dist;            /*  Current error       */
     CGPoint        P;                /*  Point on curve       */
     
-    *splitPoint = (last - first + 1) / 2;
+    *splitPoint = first + (last - first + 1) / 2;
     maxDist = 0.0;
     for (i = first + 1; i < last; i++) {
         P = Bezier(3, (CGPoint *)&bezierCurve, u[i-first]);
@@ -520,3 +546,780 @@ extern void AJRSplitBezierCurveAtT(AJRBezierCurve input, AJRBezierCurve *left, A
     left->end.y = (double)left->handle2.y + t * ((double)right->handle1.y - left->handle2.y);
     right->start = left->end;
 }
+
+/*
+ *  AJRBezierCurveGetSubcurve :
+ *    Cut off everything after t1, then everything before t0, which by then sits at t0 / t1.
+ *    An empty range is just the point at t0, since neither cut would take anything off at the ends.
+ */
+AJRBezierCurve AJRBezierCurveGetSubcurve(AJRBezierCurve curve, double t0, double t1)
+{
+    AJRBezierCurve    left, right;
+    
+    if (t0 == t1) {
+        CGPoint    point = AJRBezierCurveAtT(curve, t0);
+        return (AJRBezierCurve){point, point, point, point};
+    }
+    if (t0 > t1) {
+        AJRBezierCurve    reversed = AJRBezierCurveGetSubcurve(curve, t1, t0);
+        return (AJRBezierCurve){reversed.end, reversed.handle2, reversed.handle1, reversed.start};
+    }
+    if (t1 > 0.0 && t1 < 1.0) {
+        AJRSplitBezierCurveAtT(curve, &left, &right, t1);
+        curve = left;
+        t0 = t0 / t1;
+    }
+    if (t0 > 0.0 && t0 < 1.0) {
+        AJRSplitBezierCurveAtT(curve, &left, &right, t0);
+        curve = right;
+    }
+    return curve;
+}
+
+/*
+ *  AJRQuadraticCurveAtT :
+ *    Evaluate a quadratic curve at a particular parameter value
+ */
+CGPoint AJRQuadraticCurveAtT(AJRQuadraticCurve curve, double t)
+{
+    double    mt = 1.0 - t;
+    double    a = mt * mt, b = 2.0 * mt * t, c = t * t;
+    
+    return (CGPoint){a * curve.start.x + b * curve.controlPoint.x + c * curve.end.x,
+                     a * curve.start.y + b * curve.controlPoint.y + c * curve.end.y};
+}
+
+/*
+ *  AJRBezierCurveFromQuadraticCurve :
+ *    Degree elevation. The result is the same curve, not an approximation of it.
+ */
+AJRBezierCurve AJRBezierCurveFromQuadraticCurve(AJRQuadraticCurve curve)
+{
+    AJRBezierCurve    result;
+    
+    result.start = curve.start;
+    result.handle1.x = curve.start.x + (2.0 / 3.0) * (curve.controlPoint.x - curve.start.x);
+    result.handle1.y = curve.start.y + (2.0 / 3.0) * (curve.controlPoint.y - curve.start.y);
+    result.handle2.x = curve.end.x + (2.0 / 3.0) * (curve.controlPoint.x - curve.end.x);
+    result.handle2.y = curve.end.y + (2.0 / 3.0) * (curve.controlPoint.y - curve.end.y);
+    result.end = curve.end;
+    
+    return result;
+}
+
+/*
+ *  ClampSegmentCount :
+ *    Shared tail of Wang's formula. scaledLength is the largest second difference of the
+ *    control points times d(d-1)/8, for a curve of degree d. A bad error (zero, negative, or
+ *    NaN) gets the most segments we're willing to produce, rather than dividing by it.
+ */
+static NSInteger ClampSegmentCount(double scaledLength, double error)
+{
+    double    count;
+    
+    if (scaledLength <= 0.0) {
+        return 1;
+    }
+    if (!(error > 0.0)) {
+        return AJRCurveMaxFlattenedSegments;
+    }
+    count = ceil(sqrt(scaledLength / error));
+    if (!(count <= AJRCurveMaxFlattenedSegments)) {
+        return AJRCurveMaxFlattenedSegments;
+    }
+    return count < 1.0 ? 1 : (NSInteger)count;
+}
+
+static inline double SecondDifferenceLength(CGPoint p0, CGPoint p1, CGPoint p2)
+{
+    return hypot(p0.x - 2.0 * p1.x + p2.x, p0.y - 2.0 * p1.y + p2.y);
+}
+
+NSInteger AJRBezierCurveFlattenedSegmentCount(AJRBezierCurve curve, double error)
+{
+    double    length = MAX(SecondDifferenceLength(curve.start, curve.handle1, curve.handle2),
+                           SecondDifferenceLength(curve.handle1, curve.handle2, curve.end));
+    
+    return ClampSegmentCount(0.75 * length, error);
+}
+
+NSInteger AJRQuadraticCurveFlattenedSegmentCount(AJRQuadraticCurve curve, double error)
+{
+    return ClampSegmentCount(0.25 * SecondDifferenceLength(curve.start, curve.controlPoint, curve.end), error);
+}
+
+/*
+ *  AJRCurveStepperInitWithBezierCurve :
+ *    With the curve written as a*t^3 + b*t^2 + c*t + start and a step of h, the first three
+ *    forward differences at t = 0 are a*h^3 + b*h^2 + c*h, 6*a*h^3 + 2*b*h^2 and 6*a*h^3.
+ */
+void AJRCurveStepperInitWithBezierCurve(AJRCurveStepper *stepper, AJRBezierCurve curve, NSInteger segmentCount)
+{
+    double    h = segmentCount > 0 ? 1.0 / (double)segmentCount : 0.0;
+    double    h2 = h * h, h3 = h2 * h;
+    CGPoint    a, b, c;
+    
+    a.x = -curve.start.x + 3.0 * (curve.handle1.x - curve.handle2.x) + curve.end.x;
+    a.y = -curve.start.y + 3.0 * (curve.handle1.y - curve.handle2.y) + curve.end.y;
+    b.x = 3.0 * (curve.start.x - 2.0 * curve.handle1.x + curve.handle2.x);
+    b.y = 3.0 * (curve.start.y - 2.0 * curve.handle1.y + curve.handle2.y);
+    c.x = 3.0 * (curve.handle1.x - curve.start.x);
+    c.y = 3.0 * (curve.handle1.y - curve.start.y);
+    
+    stepper->point = curve.start;
+    stepper->end = curve.end;
+    stepper->d1 = (CGPoint){a.x * h3 + b.x * h2 + c.x * h, a.y * h3 + b.y * h2 + c.y * h};
+    stepper->d2 = (CGPoint){6.0 * a.x * h3 + 2.0 * b.x * h2, 6.0 * a.y * h3 + 2.0 * b.y * h2};
+    stepper->d3 = (CGPoint){6.0 * a.x * h3, 6.0 * a.y * h3};
+    stepper->segmentCount = MAX(segmentCount, 0);
+    stepper->step = 0;
+}
+
+/*
+ *  AJRCurveStepperInitWithQuadraticCurve :
+ *    As above, with a*t^2 + b*t + start, so the third difference is zero.
+ */
+void AJRCurveStepperInitWithQuadraticCurve(AJRCurveStepper *stepper, AJRQuadraticCurve curve, NSInteger segmentCount)
+{
+    double    h = segmentCount > 0 ? 1.0 / (double)segmentCount : 0.0;
+    double    h2 = h * h;
+    CGPoint    a, b;
+    
+    a.x = curve.start.x - 2.0 * curve.controlPoint.x + curve.end.x;
+    a.y = curve.start.y - 2.0 * curve.controlPoint.y + curve.end.y;
+    b.x = 2.0 * (curve.controlPoint.x - curve.start.x);
+    b.y = 2.0 * (curve.controlPoint.y - curve.start.y);
+    
+    stepper->point = curve.start;
+    stepper->end = curve.end;
+    stepper->d1 = (CGPoint){a.x * h2 + b.x * h, a.y * h2 + b.y * h};
+    stepper->d2 = (CGPoint){2.0 * a.x * h2, 2.0 * a.y * h2};
+    stepper->d3 = CGPointZero;
+    stepper->segmentCount = MAX(segmentCount, 0);
+    stepper->step = 0;
+}
+
+/*
+ *  AppendCubicExtrema :
+ *    Adds the roots of the derivative of one coordinate of a cubic that fall inside (0..1).
+ *    The derivative, divided by 3, is a*t^2 + b*t + c.
+ */
+static NSInteger AppendCubicExtrema(double p0, double p1, double p2, double p3, double *tValues, NSInteger count)
+{
+    double        roots[2];
+    double        a = -p0 + 3.0 * p1 - 3.0 * p2 + p3;
+    double        b = 2.0 * (p0 - 2.0 * p1 + p2);
+    double        c = p1 - p0;
+    NSInteger    rootCount, i;
+    
+    rootCount = AJRQuadraticRoots(a, b, c, roots);
+    for (i = 0; i < rootCount; i++) {
+        if (roots[i] > 0.0 && roots[i] < 1.0) {
+            tValues[count++] = roots[i];
+        }
+    }
+    
+    return count;
+}
+
+static NSInteger AppendQuadraticExtrema(double p0, double p1, double p2, double *tValues, NSInteger count)
+{
+    double    denominator = p0 - 2.0 * p1 + p2;
+    
+    if (denominator != 0.0) {
+        double t = (p0 - p1) / denominator;
+        if (t > 0.0 && t < 1.0) {
+            tValues[count++] = t;
+        }
+    }
+    
+    return count;
+}
+
+/*
+ *  SortTValues :
+ *    Insertion sort (there are never more than four) that also drops duplicates.
+ */
+static NSInteger SortTValues(double *tValues, NSInteger count)
+{
+    NSInteger    i, j, unique;
+    
+    for (i = 1; i < count; i++) {
+        double value = tValues[i];
+        for (j = i - 1; j >= 0 && tValues[j] > value; j--) {
+            tValues[j + 1] = tValues[j];
+        }
+        tValues[j + 1] = value;
+    }
+    unique = 0;
+    for (i = 0; i < count; i++) {
+        if (unique == 0 || tValues[i] - tValues[unique - 1] > 1.0e-12) {
+            tValues[unique++] = tValues[i];
+        }
+    }
+    
+    return unique;
+}
+
+NSInteger AJRBezierCurveGetYMonotoneTValues(AJRBezierCurve curve, double *tValues)
+{
+    NSInteger count = AppendCubicExtrema(curve.start.y, curve.handle1.y, curve.handle2.y, curve.end.y, tValues, 0);
+    return SortTValues(tValues, count);
+}
+
+NSInteger AJRBezierCurveGetMonotoneTValues(AJRBezierCurve curve, double *tValues)
+{
+    NSInteger count = AppendCubicExtrema(curve.start.x, curve.handle1.x, curve.handle2.x, curve.end.x, tValues, 0);
+    count = AppendCubicExtrema(curve.start.y, curve.handle1.y, curve.handle2.y, curve.end.y, tValues, count);
+    return SortTValues(tValues, count);
+}
+
+NSInteger AJRQuadraticCurveGetYMonotoneTValues(AJRQuadraticCurve curve, double *tValues)
+{
+    return AppendQuadraticExtrema(curve.start.y, curve.controlPoint.y, curve.end.y, tValues, 0);
+}
+
+NSInteger AJRQuadraticCurveGetMonotoneTValues(AJRQuadraticCurve curve, double *tValues)
+{
+    NSInteger count = AppendQuadraticExtrema(curve.start.x, curve.controlPoint.x, curve.end.x, tValues, 0);
+    count = AppendQuadraticExtrema(curve.start.y, curve.controlPoint.y, curve.end.y, tValues, count);
+    return SortTValues(tValues, count);
+}
+
+CGPoint AJRBezierCurveDerivativeAtT(AJRBezierCurve curve, double t)
+{
+    double    mt = 1.0 - t;
+    double    b0 = 3.0 * mt * mt, b1 = 6.0 * mt * t, b2 = 3.0 * t * t;
+    
+    return (CGPoint){b0 * (curve.handle1.x - curve.start.x) + b1 * (curve.handle2.x - curve.handle1.x) + b2 * (curve.end.x - curve.handle2.x),
+                     b0 * (curve.handle1.y - curve.start.y) + b1 * (curve.handle2.y - curve.handle1.y) + b2 * (curve.end.y - curve.handle2.y)};
+}
+
+CGPoint AJRQuadraticCurveDerivativeAtT(AJRQuadraticCurve curve, double t)
+{
+    double    mt = 1.0 - t;
+    
+    return (CGPoint){2.0 * mt * (curve.controlPoint.x - curve.start.x) + 2.0 * t * (curve.end.x - curve.controlPoint.x),
+                     2.0 * mt * (curve.controlPoint.y - curve.start.y) + 2.0 * t * (curve.end.y - curve.controlPoint.y)};
+}
+
+#define AJRIntersectionTolerance    1.0e-9
+
+/*
+ *  KeepLineCrossings :
+ *    Takes the roots of the curve's distance from the line, and keeps those on both the curve
+ *    and the line segment. Roots a hair outside either are pulled back onto the ends, since
+ *    a crossing right at a segment's end point is exactly what adjacent segments share.
+ */
+static NSInteger KeepLineCrossings(double *roots, NSInteger rootCount, AJRBezierCurve curve, AJRLine line, double *tValues, CGPoint *points)
+{
+    double        dx = line.end.x - line.start.x;
+    double        dy = line.end.y - line.start.y;
+    double        lengthSquared = dx * dx + dy * dy;
+    NSInteger    count = 0, i;
+    
+    for (i = 0; i < rootCount; i++) {
+        double t = roots[i];
+        if (t >= -AJRIntersectionTolerance && t <= 1.0 + AJRIntersectionTolerance) {
+            roots[count++] = MAX(0.0, MIN(1.0, t));
+        }
+    }
+    count = SortTValues(roots, count);
+    
+    rootCount = count;
+    count = 0;
+    for (i = 0; i < rootCount; i++) {
+        CGPoint point = roots[i] == 0.0 ? curve.start : (roots[i] == 1.0 ? curve.end : AJRBezierCurveAtT(curve, roots[i]));
+        double s = ((point.x - line.start.x) * dx + (point.y - line.start.y) * dy) / lengthSquared;
+        if (s >= -AJRIntersectionTolerance && s <= 1.0 + AJRIntersectionTolerance) {
+            if (tValues) tValues[count] = roots[i];
+            if (points) points[count] = point;
+            count++;
+        }
+    }
+    
+    return count;
+}
+
+/*
+ *  AJRBezierCurveIntersectLine :
+ *    Each control point's signed distance from the line is a cross product with the line's
+ *    direction, and since distance is linear, the curve's distance at t is the cubic with
+ *    those four distances as its Bernstein coefficients. The crossings are its roots.
+ */
+NSInteger AJRBezierCurveIntersectLine(AJRBezierCurve curve, AJRLine line, double *tValues, CGPoint *points)
+{
+    double        dx = line.end.x - line.start.x;
+    double        dy = line.end.y - line.start.y;
+    double        length = sqrt(dx * dx + dy * dy);
+    double        d0, d1, d2, d3;
+    double        roots[3];
+    NSInteger    rootCount;
+    
+    if (length == 0.0) return 0;
+    
+    d0 = ((curve.start.x - line.start.x) * dy - (curve.start.y - line.start.y) * dx) / length;
+    d1 = ((curve.handle1.x - line.start.x) * dy - (curve.handle1.y - line.start.y) * dx) / length;
+    d2 = ((curve.handle2.x - line.start.x) * dy - (curve.handle2.y - line.start.y) * dx) / length;
+    d3 = ((curve.end.x - line.start.x) * dy - (curve.end.y - line.start.y) * dx) / length;
+    
+    // If every control point is on the same side of the line, so is the curve.
+    if ((d0 > 0.0 && d1 > 0.0 && d2 > 0.0 && d3 > 0.0) || (d0 < 0.0 && d1 < 0.0 && d2 < 0.0 && d3 < 0.0)) {
+        return 0;
+    }
+    
+    rootCount = AJRCubicRoots(-d0 + 3.0 * d1 - 3.0 * d2 + d3,
+                              3.0 * d0 - 6.0 * d1 + 3.0 * d2,
+                              -3.0 * d0 + 3.0 * d1,
+                              d0, roots);
+    
+    return KeepLineCrossings(roots, rootCount, curve, line, tValues, points);
+}
+
+NSInteger AJRQuadraticCurveIntersectLine(AJRQuadraticCurve curve, AJRLine line, double *tValues, CGPoint *points)
+{
+    double        dx = line.end.x - line.start.x;
+    double        dy = line.end.y - line.start.y;
+    double        length = sqrt(dx * dx + dy * dy);
+    double        d0, d1, d2;
+    double        roots[2];
+    NSInteger    rootCount;
+    
+    if (length == 0.0) return 0;
+    
+    d0 = ((curve.start.x - line.start.x) * dy - (curve.start.y - line.start.y) * dx) / length;
+    d1 = ((curve.controlPoint.x - line.start.x) * dy - (curve.controlPoint.y - line.start.y) * dx) / length;
+    d2 = ((curve.end.x - line.start.x) * dy - (curve.end.y - line.start.y) * dx) / length;
+    
+    if ((d0 > 0.0 && d1 > 0.0 && d2 > 0.0) || (d0 < 0.0 && d1 < 0.0 && d2 < 0.0)) {
+        return 0;
+    }
+    
+    if (d0 - 2.0 * d1 + d2 == 0.0 && d1 == d0) {
+        // Lies along the line.
+        return 0;
+    }
+    rootCount = AJRQuadraticRoots(d0 - 2.0 * d1 + d2, 2.0 * (d1 - d0), d0, roots);
+    if (rootCount == 0 && d0 - 2.0 * d1 + d2 != 0.0) {
+        // Just touching the line is a double root, which rounding can push to a slightly negative discriminant.
+        double vertex = (d0 - d1) / (d0 - 2.0 * d1 + d2);
+        double mt = 1.0 - vertex;
+        if (fabs(mt * mt * d0 + 2.0 * mt * vertex * d1 + vertex * vertex * d2) <= AJRIntersectionTolerance * MAX(fabs(d0), MAX(fabs(d1), fabs(d2)))) {
+            roots[rootCount++] = vertex;
+        }
+    }
+    
+    return KeepLineCrossings(roots, rootCount, AJRBezierCurveFromQuadraticCurve(curve), line, tValues, points);
+}
+
+/*
+ *  ExtendCubicRange :
+ *    Grows [*min..*max] to cover one coordinate of a cubic. The end points are already in the
+ *    range, so we only need to look at the extrema, and only if a handle lies outside it.
+ */
+static void ExtendCubicRange(double p0, double p1, double p2, double p3, double *min, double *max)
+{
+    double        tValues[2];
+    NSInteger    count, i;
+    
+    if (p1 >= *min && p1 <= *max && p2 >= *min && p2 <= *max) {
+        // The curve lies in the hull of its control points, so it can't leave the range either.
+        return;
+    }
+    count = AppendCubicExtrema(p0, p1, p2, p3, tValues, 0);
+    for (i = 0; i < count; i++) {
+        double t = tValues[i], mt = 1.0 - t;
+        double value = mt * mt * mt * p0 + 3.0 * mt * mt * t * p1 + 3.0 * mt * t * t * p2 + t * t * t * p3;
+        if (value < *min) *min = value;
+        if (value > *max) *max = value;
+    }
+}
+
+CGRect AJRBezierCurveGetBounds(AJRBezierCurve curve)
+{
+    double    minX = MIN(curve.start.x, curve.end.x), maxX = MAX(curve.start.x, curve.end.x);
+    double    minY = MIN(curve.start.y, curve.end.y), maxY = MAX(curve.start.y, curve.end.y);
+    
+    ExtendCubicRange(curve.start.x, curve.handle1.x, curve.handle2.x, curve.end.x, &minX, &maxX);
+    ExtendCubicRange(curve.start.y, curve.handle1.y, curve.handle2.y, curve.end.y, &minY, &maxY);
+    
+    return (CGRect){{minX, minY}, {maxX - minX, maxY - minY}};
+}
+
+CGRect AJRQuadraticCurveGetBounds(AJRQuadraticCurve curve)
+{
+    return AJRBezierCurveGetBounds(AJRBezierCurveFromQuadraticCurve(curve));
+}
+
+/*
+ *  SolveMonotoneCubic :
+ *    Newton-Raphson, falling back to bisection whenever a step leaves the bracket. Since the
+ *    coordinate is monotone over [t0..t1], the root is unique and the bracket never loses it.
+ */
+static double SolveMonotoneCubic(double p0, double p1, double p2, double p3, double value, double t0, double t1)
+{
+    double        a = -p0 + 3.0 * p1 - 3.0 * p2 + p3;
+    double        b = 3.0 * (p0 - 2.0 * p1 + p2);
+    double        c = 3.0 * (p1 - p0);
+    double        d = p0 - value;
+    double        f0 = ((a * t0 + b) * t0 + c) * t0 + d;
+    double        f1 = ((a * t1 + b) * t1 + c) * t1 + d;
+    double        t, f, df;
+    NSInteger    iteration;
+    
+    if (f0 == 0.0) return t0;
+    if (f1 == 0.0) return t1;
+    // Rounding can leave a value that's right at one end of the range just outside it, and then the bracket has nothing to close in on, so take the nearer end.
+    if ((f0 < 0.0) == (f1 < 0.0)) return fabs(f0) <= fabs(f1) ? t0 : t1;
+    
+    t = (t0 + t1) / 2.0;
+    for (iteration = 0; iteration < 64; iteration++) {
+        f = ((a * t + b) * t + c) * t + d;
+        if (f == 0.0) break;
+        if ((f < 0.0) == (f0 < 0.0)) {
+            t0 = t;
+        } else {
+            t1 = t;
+        }
+        if (t1 - t0 < 1.0e-14) break;
+        df = (3.0 * a * t + 2.0 * b) * t + c;
+        t = (df != 0.0) ? t - f / df : -1.0;
+        if (t <= t0 || t >= t1) {
+            t = (t0 + t1) / 2.0;
+        }
+    }
+    
+    return t;
+}
+
+double AJRBezierCurveTForY(AJRBezierCurve curve, double y, double t0, double t1)
+{
+    return SolveMonotoneCubic(curve.start.y, curve.handle1.y, curve.handle2.y, curve.end.y, y, t0, t1);
+}
+
+double AJRBezierCurveTForX(AJRBezierCurve curve, double x, double t0, double t1)
+{
+    return SolveMonotoneCubic(curve.start.x, curve.handle1.x, curve.handle2.x, curve.end.x, x, t0, t1);
+}
+
+#define AJRDistanceStackSize    32
+
+/*
+ *  AJRBezierCurveIsWithinDistanceOfPoint :
+ *    Depth first subdivision. A piece is discarded as soon as its control hull, grown by
+ *    distance, misses the point, and once a piece is flat it's measured as a line segment.
+ *    Since each split pushes two pieces and pops one, the stack never needs to be deeper
+ *    than the maximum subdivision depth.
+ */
+BOOL AJRBezierCurveIsWithinDistanceOfPoint(AJRBezierCurve curve, CGPoint point, double distance)
+{
+    AJRBezierCurve    stack[AJRDistanceStackSize];
+    NSInteger        depths[AJRDistanceStackSize];
+    NSInteger        top = 0;
+    double            tolerance = 0.01 * MAX(distance, 1.0);
+    
+    stack[top] = curve;
+    depths[top] = 0;
+    top++;
+    
+    while (top > 0) {
+        AJRBezierCurve    piece;
+        NSInteger        depth;
+        AJRLine            chord;
+        double            minX, maxX, minY, maxY;
+        
+        top--;
+        piece = stack[top];
+        depth = depths[top];
+        
+        minX = MIN(MIN(piece.start.x, piece.handle1.x), MIN(piece.handle2.x, piece.end.x));
+        maxX = MAX(MAX(piece.start.x, piece.handle1.x), MAX(piece.handle2.x, piece.end.x));
+        minY = MIN(MIN(piece.start.y, piece.handle1.y), MIN(piece.handle2.y, piece.end.y));
+        maxY = MAX(MAX(piece.start.y, piece.handle1.y), MAX(piece.handle2.y, piece.end.y));
+        if (point.x < minX - distance || point.x > maxX + distance || point.y < minY - distance || point.y > maxY + distance) {
+            continue;
+        }
+        
+        chord = (AJRLine){piece.start, piece.end};
+        if (depth >= AJRDistanceStackSize - 2
+            || (AJRDistanceBetweenPointAndLineSegment(piece.handle1, chord) <= tolerance
+                && AJRDistanceBetweenPointAndLineSegment(piece.handle2, chord) <= tolerance)) {
+            if (AJRDistanceBetweenPointAndLineSegment(point, chord) <= distance) {
+                return YES;
+            }
+        } else {
+            AJRBezierCurve left, right;
+            AJRSplitBezierCurve(piece, &left, &right);
+            stack[top] = right;
+            depths[top] = depth + 1;
+            top++;
+            stack[top] = left;
+            depths[top] = depth + 1;
+            top++;
+        }
+    }
+    
+    return NO;
+}
+
+#define AJRNearestSamplesPerPiece    8
+#define AJRNearestMaxIterations      24
+
+static inline double SquaredDistance(CGPoint one, CGPoint two)
+{
+    double dx = one.x - two.x, dy = one.y - two.y;
+    return dx * dx + dy * dy;
+}
+
+/*
+ *  NearestDistanceSlope :
+ *    Half the derivative of the squared distance from point to the curve, which is zero
+ *    where the curve passes closest to point. Also returns its own derivative, for Newton.
+ */
+static double NearestDistanceSlope(AJRBezierCurve curve, CGPoint point, double t, double *slope)
+{
+    double    mt = 1.0 - t;
+    CGPoint   where = AJRBezierCurveAtT(curve, t);
+    CGPoint   d1 = AJRBezierCurveDerivativeAtT(curve, t);
+    double    d2x = 6.0 * mt * (curve.handle2.x - 2.0 * curve.handle1.x + curve.start.x) + 6.0 * t * (curve.end.x - 2.0 * curve.handle2.x + curve.handle1.x);
+    double    d2y = 6.0 * mt * (curve.handle2.y - 2.0 * curve.handle1.y + curve.start.y) + 6.0 * t * (curve.end.y - 2.0 * curve.handle2.y + curve.handle1.y);
+    double    dx = where.x - point.x, dy = where.y - point.y;
+    
+    *slope = d1.x * d1.x + d1.y * d1.y + dx * d2x + dy * d2y;
+    
+    return dx * d1.x + dy * d1.y;
+}
+
+/*
+ *  RefineNearestT :
+ *    Newton's method on NearestDistanceSlope(), kept inside [low..high] by bisecting
+ *    whenever a step would leave it. The slope must go from negative at low to positive
+ *    at high, which is what brackets a minimum.
+ */
+static double RefineNearestT(AJRBezierCurve curve, CGPoint point, double low, double high, double t)
+{
+    NSInteger    iteration;
+    
+    for (iteration = 0; iteration < AJRNearestMaxIterations; iteration++) {
+        double    slope;
+        double    f = NearestDistanceSlope(curve, point, t, &slope);
+        double    next;
+        
+        if (f == 0.0) break;
+        if (f < 0.0) low = t; else high = t;
+        next = slope > 0.0 ? t - f / slope : (low + high) / 2.0;
+        if (next <= low || next >= high) {
+            next = (low + high) / 2.0;
+        }
+        if (fabs(next - t) <= 1.0e-14) {
+            t = next;
+            break;
+        }
+        t = next;
+    }
+    
+    return t;
+}
+
+/*
+ *  AJRBezierCurveNearestT :
+ *    The nearest point is where the curve's tangent is perpendicular to the line back to
+ *    point, which is a quintic, so there's no closed form. Within a piece that's monotone in
+ *    x and y, though, distance has few dips, so sampling the slope of the distance finds
+ *    each dip between a pair of samples, and that pair brackets it for Newton's method.
+ *    The ends of the pieces are candidates too, since the nearest point is often an end.
+ */
+double AJRBezierCurveNearestT(AJRBezierCurve curve, CGPoint point, double t0, double t1, CGPoint *nearest)
+{
+    double       splits[6];
+    NSInteger    splitCount = 0, piece, i;
+    double       tValues[4];
+    NSInteger    tCount = AJRBezierCurveGetMonotoneTValues(curve, tValues);
+    double       bestT = t0, bestDistance;
+    CGPoint      bestPoint = AJRBezierCurveAtT(curve, t0);
+    
+    bestDistance = SquaredDistance(bestPoint, point);
+    splits[splitCount++] = t0;
+    for (i = 0; i < tCount; i++) {
+        if (tValues[i] > t0 && tValues[i] < t1) {
+            splits[splitCount++] = tValues[i];
+        }
+    }
+    splits[splitCount++] = t1;
+    
+    for (piece = 0; piece + 1 < splitCount; piece++) {
+        double    low = splits[piece], high = splits[piece + 1];
+        double    step = (high - low) / AJRNearestSamplesPerPiece;
+        double    previousT = low, previousSlope = 0.0, slope;
+        
+        for (i = 0; i <= AJRNearestSamplesPerPiece; i++) {
+            double    t = i == AJRNearestSamplesPerPiece ? high : low + i * step;
+            double    f = NearestDistanceSlope(curve, point, t, &slope);
+            double    candidates[2];
+            NSInteger candidateCount = 0, j;
+            
+            if (i > 0 && previousSlope < 0.0 && f > 0.0) {
+                candidates[candidateCount++] = RefineNearestT(curve, point, previousT, t, previousT + (t - previousT) / 2.0);
+            }
+            if (i == AJRNearestSamplesPerPiece || f == 0.0) {
+                candidates[candidateCount++] = t;
+            }
+            for (j = 0; j < candidateCount; j++) {
+                CGPoint    where = AJRBezierCurveAtT(curve, candidates[j]);
+                double     distance = SquaredDistance(where, point);
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    bestT = candidates[j];
+                    bestPoint = where;
+                }
+            }
+            previousT = t;
+            previousSlope = f;
+        }
+    }
+    
+    if (nearest) {
+        *nearest = bestPoint;
+    }
+    
+    return bestT;
+}
+
+/*
+ *  AJRQuadraticCurveNearestT :
+ *    With B(t) = P0 + 2bt + at^2, where a = P0 - 2P1 + P2 and b = P1 - P0, the tangent
+ *    is perpendicular to B(t) - P where (B(t) - P) . (b + at) = 0, which is a cubic in t.
+ *    The nearest point is one of its roots, or an end point.
+ */
+double AJRQuadraticCurveNearestT(AJRQuadraticCurve curve, CGPoint point, CGPoint *nearest)
+{
+    double       ax = curve.start.x - 2.0 * curve.controlPoint.x + curve.end.x;
+    double       ay = curve.start.y - 2.0 * curve.controlPoint.y + curve.end.y;
+    double       bx = curve.controlPoint.x - curve.start.x, by = curve.controlPoint.y - curve.start.y;
+    double       dx = curve.start.x - point.x, dy = curve.start.y - point.y;
+    double       roots[3];
+    NSInteger    rootCount, i;
+    double       bestT = 0.0, bestDistance = SquaredDistance(curve.start, point);
+    CGPoint      bestPoint = curve.start;
+    
+    if (SquaredDistance(curve.end, point) < bestDistance) {
+        bestT = 1.0;
+        bestDistance = SquaredDistance(curve.end, point);
+        bestPoint = curve.end;
+    }
+    rootCount = AJRCubicRoots(ax * ax + ay * ay,
+                              3.0 * (ax * bx + ay * by),
+                              2.0 * (bx * bx + by * by) + ax * dx + ay * dy,
+                              bx * dx + by * dy, roots);
+    for (i = 0; i < rootCount; i++) {
+        if (roots[i] > 0.0 && roots[i] < 1.0) {
+            CGPoint    where = AJRQuadraticCurveAtT(curve, roots[i]);
+            double     distance = SquaredDistance(where, point);
+            if (distance < bestDistance) {
+                bestT = roots[i];
+                bestDistance = distance;
+                bestPoint = where;
+            }
+        }
+    }
+    
+    if (nearest) *nearest = bestPoint;
+    
+    return bestT;
+}
+
+#define AJRArcLengthMaxDepth 16
+#define AJRArcLengthMaxIterations 32
+
+/*
+ *  ArcLengthGauss :
+ *    Five point Gauss-Legendre quadrature of the curve's speed over [t0..t1]. The speed is
+ *    the square root of a quartic, so this is only exact in the limit, but it's very close
+ *    on any stretch of the curve that doesn't turn sharply.
+ */
+static double ArcLengthGauss(AJRBezierCurve curve, double t0, double t1)
+{
+    static const double    abscissae[5] = {0.0, -0.5384693101056831, 0.5384693101056831, -0.9061798459386640, 0.9061798459386640};
+    static const double    weights[5] = {0.5688888888888889, 0.4786286704993665, 0.4786286704993665, 0.2369268850561891, 0.2369268850561891};
+    double       half = (t1 - t0) / 2.0, middle = (t0 + t1) / 2.0, sum = 0.0;
+    NSInteger    i;
+    
+    for (i = 0; i < 5; i++) {
+        CGPoint    derivative = AJRBezierCurveDerivativeAtT(curve, middle + half * abscissae[i]);
+        sum += weights[i] * hypot(derivative.x, derivative.y);
+    }
+    
+    return sum * half;
+}
+
+/*
+ *  AdaptiveArcLength :
+ *    Halves [t0..t1] until the quadrature of the halves agrees with that of the whole.
+ */
+static double AdaptiveArcLength(AJRBezierCurve curve, double t0, double t1, double whole, NSInteger depth)
+{
+    double       middle = (t0 + t1) / 2.0;
+    double       left = ArcLengthGauss(curve, t0, middle);
+    double       right = ArcLengthGauss(curve, middle, t1);
+    
+    if (depth >= AJRArcLengthMaxDepth || fabs(left + right - whole) <= 1.0e-12 + 1.0e-10 * (left + right)) {
+        return left + right;
+    }
+    return AdaptiveArcLength(curve, t0, middle, left, depth + 1) + AdaptiveArcLength(curve, middle, t1, right, depth + 1);
+}
+
+/*
+ *  AJRBezierCurveLength :
+ */
+double AJRBezierCurveLength(AJRBezierCurve curve, double t0, double t1)
+{
+    if (t1 <= t0) {
+        return 0.0;
+    }
+    return AdaptiveArcLength(curve, t0, t1, ArcLengthGauss(curve, t0, t1), 0);
+}
+
+/*
+ *  AJRBezierCurveTAtLength :
+ *    Arc length only ever grows with t, so Newton's method, using the speed as the
+ *    derivative, converges quickly, and we fall back to bisection whenever a step would
+ *    leave the bracket, such as where the curve stops at a cusp.
+ */
+double AJRBezierCurveTAtLength(AJRBezierCurve curve, double t0, double length)
+{
+    double       total, low = t0, high = 1.0, t, tolerance;
+    NSInteger    i;
+    
+    if (length <= 0.0) {
+        return t0;
+    }
+    total = AJRBezierCurveLength(curve, t0, 1.0);
+    if (length >= total) {
+        return 1.0;
+    }
+    tolerance = 1.0e-12 * MAX(total, 1.0);
+    t = t0 + (1.0 - t0) * length / total;
+    for (i = 0; i < AJRArcLengthMaxIterations; i++) {
+        double     error = AJRBezierCurveLength(curve, t0, t) - length;
+        CGPoint    derivative;
+        double     speed, next;
+        
+        if (fabs(error) <= tolerance) {
+            break;
+        }
+        if (error > 0.0) {
+            high = t;
+        } else {
+            low = t;
+        }
+        derivative = AJRBezierCurveDerivativeAtT(curve, t);
+        speed = hypot(derivative.x, derivative.y);
+        next = speed > 0.0 ? t - error / speed : low;
+        if (next <= low || next >= high) {
+            next = (low + high) / 2.0;
+        }
+        t = next;
+    }
+    
+    return t;
+}
@@ -114,6 +114,8 @@ extern AJRRectAdjustment AJRUnionRectAdjustment(AJRRectAdjustment one, AJRRectAd
 extern CGRect AJRAdjustRect(CGRect rect, AJRRectAdjustment adjustment);
 
 extern double AJRDistanceBetweenPointAndLine(CGPoint point, AJRLine line);
+/* Unlike AJRDistanceBetweenPointAndLine(), which measures to the infinite line through line.start and line.end, this measures to the closest point on the segment itself. */
+extern double AJRDistanceBetweenPointAndLineSegment(CGPoint point, AJRLine line);
 extern CGPoint AJRMidpointBetweenPoints(CGPoint one, CGPoint two);
 
 extern CGSize AJRSizeByScaling(CGSize size, CGFloat scale);
@@ -276,6 +276,27 @@ double AJRDistanceBetweenPointAndLine(CGPoint point, AJRLine line) {
     return fabs(lp);
 }
 
+double AJRDistanceBetweenPointAndLineSegment(CGPoint point, AJRLine line) {
+    double dx = (double)line.end.x - (double)line.start.x;
+    double dy = (double)line.end.y - (double)line.start.y;
+    double px = (double)point.x - (double)line.start.x;
+    double py = (double)point.y - (double)line.start.y;
+    double lengthSquared = dx * dx + dy * dy;
+    
+    if (lengthSquared > 0.0) {
+        double t = (px * dx + py * dy) / lengthSquared;
+        if (t >= 1.0) {
+            px -= dx;
+            py -= dy;
+        } else if (t > 0.0) {
+            px -= t * dx;
+            py -= t * dy;
+        }
+    }
+    
+    return sqrt(px * px + py * py);
+}
+
 inline CGPoint AJRMidpointBetweenPoints(CGPoint one, CGPoint two) {
     return (CGPoint){(one.x + two.x) / 2.0, (one.y + two.y) / 2.0};
 }
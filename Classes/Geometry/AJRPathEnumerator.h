@@ -51,13 +51,20 @@ NS_ASSUME_NONNULL_BEGIN
 /*!
  Initializes an enumerator with the provided path.
 
- Note that the error value used to flatten bezier segments will be taken from the path at this point. It's important to note that if you're enumerating a path that will be displayed at a scale other than 1, you may need to adjust the error value on the enumerator.
+ Note that the error value used to flatten bezier segments will be taken from the path at this point. If you're enumerating a path that will be displayed at a scale other than 1, use -initWithBezierPath:scale: instead. If you're flattening the same path over and over, such as to draw it, -[AJRBezierPath flattenedPathForScale:] will keep the flattening around for you.
 
  When enumerating a path, you can enumerate the actual segments, or you can enumerate by just line segments, which effectively flattens all bezier path segments in the input path. Which type of enumeration is controlled by call -nextLineSegmentIsNewSubpath: or -nextElementWithPoints:. You should only call one of these methods, as alternating calls between these methods can cause undefined results.
 
  @param path The path to enumerate.
  */
 - (id)initWithBezierPath:(id <AJRBezierPathProtocol>)path;
+/*!
+ Initializes an enumerator that flattens path for display at scale, so curves stay within the path's flatness of their line segments in device space, rather than in the path's own units.
+
+ @param path The path to enumerate.
+ @param scale The scale the path will be displayed at, such as the result of AJRGetCurrentScale().
+ */
+- (id)initWithBezierPath:(id <AJRBezierPathProtocol>)path scale:(CGFloat)scale;
 
 /*!
  The path we're enumerator. This can only be set at the time of creation.
@@ -93,9 +100,9 @@ NS_ASSUME_NONNULL_BEGIN
 /*! Error value used when flattening bezier curves. This is derived from the initializing input path. */
 @property (nonatomic, assign) double error;
 
-/*! If currently enumerating a bezier curve, this is the current tValue of the curve. */
+/*! If currently enumerating a bezier curve, this is the tValue of the end of the current line segment. Curves are flattened in equal steps of t, with the number of steps chosen up front from the curve's control points and `error`. */
 @property (nonatomic, readonly) double tValue;
-/*! The definitive of the current bezier curve, but this is only valid if `elementType ==  `AJRBezierPathElementCubicCurveTo`. */
+/*! The definitive of the current bezier curve, but this is only valid if `elementType ==  `AJRBezierPathElementCubicCurveTo` or `AJRBezierPathElementQuadraticCurveTo`. Quadratic curves are returned as the equivalent cubic curve. */
 @property (nonatomic, readonly) AJRBezierCurve curve;    // Only valid if the current elementType is NSCurveToBezierPathElement
 /*! The current element index we're enumeration. This doesn't necessarily increment with each call, since each line segment of a bezier path with have the same elementIndex. */
 @property (nonatomic,readonly) NSInteger elementIndex;
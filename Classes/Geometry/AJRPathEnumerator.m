@@ -32,17 +32,6 @@
 #import "AJRBezierCurves.h"
 #import "AJRPathEnumerator.h"
 
-// This is a hack of major proportions. Don't try this at home, kids.
-#define MAXSTACKSIZE    200
-
-typedef struct __ajrEdgeEnumeratorStackElement {
-    AJRBezierCurve left;
-    AJRBezierCurve right;
-    BOOL usedLeft;
-} _AJREdgeEnumeratorStackElement;
-
-#define STACK ((_AJREdgeEnumeratorStackElement *)_stack)
-
 @implementation AJRPathEnumerator
 {
     double _error;
@@ -54,8 +43,7 @@ typedef struct __ajrEdgeEnumeratorStackElement {
     CGPoint _lastPoint;
     CGPoint _moveToPoint;
     
-    void *_stack;
-    NSInteger _stackPosition;
+    AJRCurveStepper _stepper;
     
     BOOL _flattenCurves;
     BOOL _dontFlattenCurves;
@@ -71,8 +59,6 @@ typedef struct __ajrEdgeEnumeratorStackElement {
         _path = path;
         // We were using -1 here, because for AJRBezierPath meant we enumerating the setboundingbox, but NSBezierPath doesn't support doing that, and we want to work with both.
         _elementIndex = 0;
-        _stack = NSZoneMalloc(nil, sizeof(_AJREdgeEnumeratorStackElement) * MAXSTACKSIZE);
-        _stackPosition = 0;
         _error = path.flatness;
 
         _flattenCurves = NO;
@@ -81,8 +67,11 @@ typedef struct __ajrEdgeEnumeratorStackElement {
     return self;
 }
 
-- (void)dealloc {
-    NSZoneFree(nil, _stack);
+- (id)initWithBezierPath:(id <AJRBezierPathProtocol>)path scale:(CGFloat)scale {
+    if ((self = [self initWithBezierPath:path])) {
+        _error = path.flatness / MAX(scale, 1.0e-6);
+    }
+    return self;
 }
 
 - (id)nextObject {
@@ -90,50 +79,14 @@ typedef struct __ajrEdgeEnumeratorStackElement {
     return nil;
 }
 
-- (void)_nextBezierLineSegment {
-    CGPoint midpoint;
-    float distance;
-    AJRLine handleLine;
-    AJRBezierCurve subcurve;
-    
-    if (_stackPosition == 0) {
-        subcurve = _curve;
-    } else {
-        if (STACK[_stackPosition].usedLeft) {
-            subcurve = STACK[_stackPosition].right;
-            _stackPosition--;
-        } else {
-            subcurve = STACK[_stackPosition].left;
-        }
-    }
+- (BOOL)_nextBezierLineSegment {
+    CGPoint start = _stepper.point;
     
-    while (1) {
-        handleLine.start = subcurve.start;
-        handleLine.end = subcurve.end;
-        
-        // Find the mid point value of the subcurve and the distance between that midpoint and the line formed by our subcurve's start and end.
-        midpoint = AJRBezierCurveAtT(subcurve, 0.5);
-        distance = AJRDistanceBetweenPointAndLine(midpoint, handleLine);
-        
-        // If the distance is less than error, we're sufficiently flat, and we'll compute the intersection. Otherwise, divide our subcurve in two, and check each side for intersection.
-        if (distance < _error) {
-            // Here, we're small enough that we'll return a line segment.
-            _line = handleLine;
-            if (_stackPosition == 0) {
-                // Our original curve is sufficiently flat to consider a line.
-            } else {
-                STACK[_stackPosition].usedLeft = YES;
-            }
-            break;
-        } else {
-            _stackPosition++;
-            if (_stackPosition >= MAXSTACKSIZE) {
-                [NSException raise:NSInternalInconsistencyException format:@"%@ blew the stack at %d", NSStringFromSelector(_cmd), MAXSTACKSIZE];
-            }
-            AJRSplitBezierCurve(subcurve, &(STACK[_stackPosition].left), &(STACK[_stackPosition].right));
-            subcurve = STACK[_stackPosition].left;
-        }
+    if (AJRCurveStepperNextPoint(&_stepper, &_line.end)) {
+        _line.start = start;
+        return YES;
     }
+    return NO;
 }
 
 - (AJRLine *)nextLineSegment {
@@ -152,7 +105,7 @@ typedef struct __ajrEdgeEnumeratorStackElement {
     _isMoveTo = NO;
     AJRSetOutParameter(isNewSubpath, NO);
     
-    if (_stackPosition == 0) {
+    if (![self _nextBezierLineSegment]) {
         do {
             if (_elementIndex == [_path elementCount]) return NULL;
             switch ([_path elementAtIndex:_elementIndex associatedPoints:points]) {
@@ -173,20 +126,20 @@ typedef struct __ajrEdgeEnumeratorStackElement {
                     _curve.handle1 = points[0];
                     _curve.handle2 = points[1];
                     _curve.end = points[2];
+                    AJRCurveStepperInitWithBezierCurve(&_stepper, _curve, AJRBezierCurveFlattenedSegmentCount(_curve, _error));
                     [self _nextBezierLineSegment];
                     _lastPoint = points[2];
                     done = YES;
                     break;
-                case AJRBezierPathElementQuadraticCurveTo:
-//                    _curve.start = _lastPoint;
-//                    _curve.handle1 = points[0];
-//                    _curve.handle2 = points[1];
-//                    _curve.end = points[2];
-//                    [self _nextBezierLineSegment];
-//                    _lastPoint = points[2];
-//                    done = YES;
-                    // TODO: Handle flattening quadratic curves.
+                case AJRBezierPathElementQuadraticCurveTo: {
+                    AJRQuadraticCurve quadratic = (AJRQuadraticCurve){_lastPoint, points[0], points[1]};
+                    _curve = AJRBezierCurveFromQuadraticCurve(quadratic);
+                    AJRCurveStepperInitWithQuadraticCurve(&_stepper, quadratic, AJRQuadraticCurveFlattenedSegmentCount(quadratic, _error));
+                    [self _nextBezierLineSegment];
+                    _lastPoint = points[1];
+                    done = YES;
                     break;
+                }
                 case AJRBezierPathElementClose:
                     _line.start = _lastPoint;
                     _line.end = _moveToPoint;
@@ -198,8 +151,6 @@ typedef struct __ajrEdgeEnumeratorStackElement {
             }
             _elementIndex++;
         } while (!done);
-    } else {
-        [self _nextBezierLineSegment];
     }
     
     return &_line;
@@ -244,7 +195,7 @@ typedef struct __ajrEdgeEnumeratorStackElement {
 }
 
 - (double)tValue {
-    return 0.0;
+    return AJRCurveStepperGetT(&_stepper);
 }
 
 - (AJRBezierCurve)curve {
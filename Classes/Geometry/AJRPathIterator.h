@@ -0,0 +1,129 @@
+/*
+ AJRPathIterator.h
+ AJRInterfaceFoundation
+
+ Copyright © 2022, AJ Raftis and AJRInterfaceFoundation authors
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of AJRInterfaceFoundation nor the names of its contributors may be
+   used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL AJ RAFTIS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import <AJRInterfaceFoundation/AJRGeometry.h>
+#import <AJRInterfaceFoundation/AJRBezierCurves.h>
+#import <AJRInterfaceFoundation/AJRBezierPath.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*!
+ A stack allocated, C level alternative to AJRPathEnumerator for tight loops. Unlike the enumerator, an iterator never allocates anything, and when walking an AJRBezierPath, it reads the path's points and elements directly rather than sending a message per element. When walking an NSBezierPath, it looks up -elementAtIndex:associatedPoints: once and calls the implementation directly.
+
+ Declare one on the stack and set it up with AJRPathIteratorInit(). Then, just like the enumerator, either walk the elements with AJRPathIteratorNextElement(), or walk the flattened line segments with AJRPathIteratorNextLine() or AJRPathIteratorFlatten(), but don't mix the two.
+
+ The iterator doesn't retain the path, and the path must not be changed while it's being iterated.
+
+ Treat the fields as private, other than `error`, which you may change after calling AJRPathIteratorInit(), and `elementIndex`, which is the index of the element last returned.
+ */
+typedef struct _ajrPathIterator {
+    __unsafe_unretained id <AJRBezierPathProtocol> path;
+    /*! Set when path is an AJRBezierPath. */
+    const CGPoint * _Nullable points;
+    const AJRBezierPathElement * _Nullable elements;
+    /*! Otherwise, path's -elementAtIndex:associatedPoints:. */
+    IMP _Nullable elementAtIndex;
+    
+    NSInteger elementCount;
+    NSInteger elementIndex;
+    NSUInteger pointIndex;
+    
+    /*! The maximum distance allowed between a curve and the line segments that replace it. Initialized from the path's flatness. */
+    double error;
+    
+    CGPoint currentPoint;
+    CGPoint subpathStart;
+    BOOL isNewSubpath;
+    
+    /*! Steps through the curve being flattened. */
+    AJRCurveStepper stepper;
+} AJRPathIterator;
+
+/*! Prepares iterator to walk path. path may be an AJRBezierPath or an NSBezierPath. */
+extern void AJRPathIteratorInit(AJRPathIterator *iterator, id <AJRBezierPathProtocol> path);
+
+/*!
+ Advances to the next element of the path, which is returned in element, along with its associated points. Like -[AJRPathEnumerator nextElementWithPoints:], points must have room for three points.
+
+ @result NO when there are no more elements.
+ */
+NS_INLINE BOOL AJRPathIteratorNextElement(AJRPathIterator *iterator, AJRBezierPathElement *element, CGPoint *points) {
+    if (iterator->elementIndex + 1 >= iterator->elementCount) {
+        return NO;
+    }
+    iterator->elementIndex += 1;
+    if (iterator->elements) {
+        // Public element indexes are one less than the path's own, because of the set bounding box element, and public point indexes are two less.
+        const CGPoint *source = iterator->points + iterator->pointIndex;
+        switch ((*element = iterator->elements[iterator->elementIndex + 1])) {
+            case AJRBezierPathElementCubicCurveTo:
+                points[2] = source[2];
+                // Fall through
+            case AJRBezierPathElementQuadraticCurveTo:
+                points[1] = source[1];
+                // Fall through
+            case AJRBezierPathElementMoveTo:
+            case AJRBezierPathElementLineTo:
+                points[0] = source[0];
+                break;
+            default:
+                break;
+        }
+        switch (*element) {
+            case AJRBezierPathElementMoveTo: iterator->pointIndex += 1; break;
+            case AJRBezierPathElementLineTo: iterator->pointIndex += 1; break;
+            case AJRBezierPathElementCubicCurveTo: iterator->pointIndex += 3; break;
+            case AJRBezierPathElementQuadraticCurveTo: iterator->pointIndex += 2; break;
+            default: break;
+        }
+    } else {
+        *element = (AJRBezierPathElement)((NSBezierPathElement (*)(id, SEL, NSInteger, NSPointArray))iterator->elementAtIndex)(iterator->path, @selector(elementAtIndex:associatedPoints:), iterator->elementIndex, points);
+    }
+    return YES;
+}
+
+/*!
+ Returns the next line segment of the flattened path in line. If the segment begins a new subpath, isNewSubpath is set to YES. You may pass NULL for isNewSubpath.
+
+ @result NO when there are no more line segments.
+ */
+extern BOOL AJRPathIteratorNextLine(AJRPathIterator *iterator, AJRLine *line, BOOL * _Nullable isNewSubpath);
+
+/*!
+ Fills lines with up to maxCount line segments of the flattened path, and returns how many it wrote. Call it repeatedly until it returns 0 to process a path of any size in fixed size chunks.
+
+ If newSubpaths isn't NULL, it must also have room for maxCount entries, and each is set to whether the corresponding line begins a new subpath.
+ */
+extern NSUInteger AJRPathIteratorFlatten(AJRPathIterator *iterator, AJRLine *lines, BOOL * _Nullable newSubpaths, NSUInteger maxCount);
+
+NS_ASSUME_NONNULL_END
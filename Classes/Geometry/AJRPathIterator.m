@@ -0,0 +1,118 @@
+/*
+ AJRPathIterator.m
+ AJRInterfaceFoundation
+
+ Copyright © 2022, AJ Raftis and AJRInterfaceFoundation authors
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of AJRInterfaceFoundation nor the names of its contributors may be
+   used to endorse or promote products derived from this software without
+   specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL AJ RAFTIS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#import "AJRPathIterator.h"
+
+#import "AJRBezierCurves.h"
+#import "AJRBezierPathP.h"
+
+void AJRPathIteratorInit(AJRPathIterator *iterator, id <AJRBezierPathProtocol> path) {
+    iterator->path = path;
+    iterator->points = NULL;
+    iterator->elements = NULL;
+    iterator->elementAtIndex = NULL;
+    if ([path isKindOfClass:[AJRBezierPath class]]) {
+        [(AJRBezierPath *)path _getPoints:&iterator->points elements:&iterator->elements];
+    } else {
+        iterator->elementAtIndex = [(NSObject *)path methodForSelector:@selector(elementAtIndex:associatedPoints:)];
+    }
+    iterator->elementCount = path.elementCount;
+    iterator->elementIndex = -1;
+    iterator->pointIndex = 2;
+    iterator->error = path.flatness;
+    iterator->currentPoint = CGPointZero;
+    iterator->subpathStart = CGPointZero;
+    iterator->isNewSubpath = NO;
+    iterator->stepper.segmentCount = 0;
+    iterator->stepper.step = 0;
+}
+
+BOOL AJRPathIteratorNextLine(AJRPathIterator *iterator, AJRLine *line, BOOL *isNewSubpath) {
+    AJRBezierPathElement element;
+    CGPoint points[3];
+    
+    while (YES) {
+        CGPoint previous = iterator->stepper.point;
+        if (AJRCurveStepperNextPoint(&iterator->stepper, &line->end)) {
+            line->start = previous;
+            break;
+        }
+        if (!AJRPathIteratorNextElement(iterator, &element, points)) {
+            return NO;
+        }
+        switch (element) {
+            case AJRBezierPathElementMoveTo:
+                iterator->currentPoint = iterator->subpathStart = points[0];
+                iterator->isNewSubpath = YES;
+                continue;
+            case AJRBezierPathElementLineTo:
+                *line = (AJRLine){iterator->currentPoint, points[0]};
+                iterator->currentPoint = points[0];
+                break;
+            case AJRBezierPathElementCubicCurveTo: {
+                AJRBezierCurve curve = (AJRBezierCurve){iterator->currentPoint, points[0], points[1], points[2]};
+                AJRCurveStepperInitWithBezierCurve(&iterator->stepper, curve, AJRBezierCurveFlattenedSegmentCount(curve, iterator->error));
+                iterator->currentPoint = points[2];
+                continue;
+            }
+            case AJRBezierPathElementQuadraticCurveTo: {
+                AJRQuadraticCurve curve = (AJRQuadraticCurve){iterator->currentPoint, points[0], points[1]};
+                AJRCurveStepperInitWithQuadraticCurve(&iterator->stepper, curve, AJRQuadraticCurveFlattenedSegmentCount(curve, iterator->error));
+                iterator->currentPoint = points[1];
+                continue;
+            }
+            case AJRBezierPathElementClose:
+                *line = (AJRLine){iterator->currentPoint, iterator->subpathStart};
+                iterator->currentPoint = iterator->subpathStart;
+                break;
+            default:
+                continue;
+        }
+        break;
+    }
+    
+    if (isNewSubpath) {
+        *isNewSubpath = iterator->isNewSubpath;
+    }
+    iterator->isNewSubpath = NO;
+    
+    return YES;
+}
+
+NSUInteger AJRPathIteratorFlatten(AJRPathIterator *iterator, AJRLine *lines, BOOL *newSubpaths, NSUInteger maxCount) {
+    NSUInteger count = 0;
+    
+    while (count < maxCount && AJRPathIteratorNextLine(iterator, lines + count, newSubpaths ? newSubpaths + count : NULL)) {
+        count++;
+    }
+    
+    return count;
+}
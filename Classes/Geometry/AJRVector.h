@@ -38,7 +38,7 @@ typedef CGPoint AJRVector;
 #define AJRLinearInterpolation(a,l,h)  ((l) + (((h) - (l)) * (a)))
 
 /* take binary sign of a, either -1, or 1 if >= 0 */
-#define AJRBinarySign(a)    (((a) < 0) ? -1 : 0)
+#define AJRBinarySign(a)    (((a) < 0) ? -1 : 1)
 
 /* returns squared length of input vector */    
 double AJRVectorSquaredLength(AJRVector a);
@@ -87,6 +87,11 @@ NSInteger AJRGreatestCommonDivisor(NSInteger u, NSInteger v);
 /* stable algebra derived from Numerical Recipes by Press et al.*/
 NSInteger AJRQuadraticRoots(double a, double b, double c, double *roots);
 
+/* return real roots of ax^3+bx^2+cx+d, polished with Newton-Raphson. */
+/* falls back to AJRQuadraticRoots() when a is negligible. roots must */
+/* have room for 3 values. */
+NSInteger AJRCubicRoots(double a, double b, double c, double d, double *roots);
+
 /* generic 1d regula-falsi step.  f is function to evaluate */
 /* interval known to contain root is given in left, right */
 /* returns new estimate */
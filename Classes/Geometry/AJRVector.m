@@ -220,6 +220,60 @@ NSInteger AJRQuadraticRoots(double a, double b, double c, double *roots)
 }
 
 
+/* return real roots of ax^3+bx^2+cx+d, polished with Newton-Raphson. */
+/* Numerical Recipes again: the trigonometric form when there are three */
+/* real roots, and Cardano's when there's one. */
+NSInteger AJRCubicRoots(double a, double b, double c, double d, double *roots)
+{
+   double     A, B, C, Q, R, Q3, R2, shift;
+   NSInteger  count = 0, i, iteration;
+   
+   if (fabs(a) <= 1.0e-12 * MAX(fabs(b), MAX(fabs(c), fabs(d)))) {
+      return AJRQuadraticRoots(b, c, d, roots);
+   }
+   
+   A = b / a;
+   B = c / a;
+   C = d / a;
+   Q = (A * A - 3.0 * B) / 9.0;
+   R = (2.0 * A * A * A - 9.0 * A * B + 27.0 * C) / 54.0;
+   Q3 = Q * Q * Q;
+   R2 = R * R;
+   shift = A / 3.0;
+   
+   if (R2 < Q3) {
+      double theta = acos(MAX(-1.0, MIN(1.0, R / sqrt(Q3))));
+      double m = -2.0 * sqrt(Q);
+      roots[count++] = m * cos(theta / 3.0) - shift;
+      roots[count++] = m * cos((theta + 2.0 * M_PI) / 3.0) - shift;
+      roots[count++] = m * cos((theta - 2.0 * M_PI) / 3.0) - shift;
+   } else {
+      double S = -AJRBinarySign(R) * cbrt(fabs(R) + sqrt(R2 - Q3));
+      double T = (S == 0.0) ? 0.0 : Q / S;
+      roots[count++] = (S + T) - shift;
+      /* When R^2 and Q^3 are equal, up to rounding, there's also a */
+      /* double root, which is where a curve just touches a line. */
+      if (S != 0.0 && (R2 - Q3) <= 1.0e-12 * MAX(R2, fabs(Q3))) {
+         roots[count++] = -0.5 * (S + T) - shift;
+      }
+   }
+   
+   for (i = 0; i < count; i++) {
+      double x = roots[i];
+      for (iteration = 0; iteration < 2; iteration++) {
+         double f = ((a * x + b) * x + c) * x + d;
+         double df = (3.0 * a * x + 2.0 * b) * x + c;
+         if (df == 0.0) break;
+         double next = x - f / df;
+         if (fabs(((a * next + b) * next + c) * next + d) >= fabs(f)) break;
+         x = next;
+      }
+      roots[i] = x;
+   }
+   
+   return count;
+}
+
 /* generic 1d regula-falsi step.  f is function to evaluate */
 /* interval known to contain root is given in left, right */
 /* returns new estimate */